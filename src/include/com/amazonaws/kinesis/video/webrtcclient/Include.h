@@ -127,6 +127,8 @@ extern "C" {
 #define STATUS_SOCKET_SET_SEND_BUFFER_SIZE_FAILED                                   STATUS_NETWORKING_BASE + 0x00000023
 #define STATUS_GET_SOCKET_FLAG_FAILED                                               STATUS_NETWORKING_BASE + 0x00000024
 #define STATUS_SET_SOCKET_FLAG_FAILED                                               STATUS_NETWORKING_BASE + 0x00000025
+#define STATUS_CREATE_EVENT_LOOP_FAILED                                             STATUS_NETWORKING_BASE + 0x00000026
+#define STATUS_EVENT_LOOP_REGISTER_SOCKET_FAILED                                    STATUS_NETWORKING_BASE + 0x00000027
 /*!@} */
 
 /*===========================================================================================*/
@@ -317,6 +319,7 @@ extern "C" {
 #define STATUS_RTCP_INPUT_PARTIAL_PACKET                                            STATUS_RTCP_BASE + 0x00000006
 #define STATUS_RTCP_INPUT_REMB_TOO_SMALL                                            STATUS_RTCP_BASE + 0x00000007
 #define STATUS_RTCP_INPUT_REMB_INVALID                                              STATUS_RTCP_BASE + 0x00000008
+#define STATUS_RTCP_INPUT_TWCC_INVALID                                              STATUS_RTCP_BASE + 0x00000009
 /*!@} */
 
 /*===========================================================================================*/
@@ -405,6 +408,11 @@ extern "C" {
  */
 #define MAX_RTCCONFIGURATION_CERTIFICATES                                           3
 
+/**
+ * Max SRTP protection profiles an RtcConfiguration can list
+ */
+#define MAX_RTCCONFIGURATION_SRTP_PROFILES                                          4
+
 /**
  * Maximum length of a MediaStream's Track ID
  */
@@ -429,6 +437,36 @@ extern "C" {
  * Maximum length of signaling message
  */
 #define MAX_SIGNALING_MESSAGE_LEN                                                   (10 * 1024)
+
+/**
+ * Maximum number of I/O worker threads receiving data for all RtcPeerConnections
+ */
+#define MAX_IO_WORKER_COUNT                                                         64
+
+/**
+ * Maximum number of certificates the DTLS certificate pool keeps ready
+ */
+#define MAX_DTLS_CERTIFICATE_POOL_SIZE                                              16
+
+/**
+ * Maximum number of RtcPeerConnections a peer connection pool keeps ready
+ */
+#define MAX_PEER_CONNECTION_POOL_SIZE                                               32
+
+/**
+ * Maximum number of RtcRtpTransceivers a broadcast group sends to
+ */
+#define MAX_BROADCAST_GROUP_TRANSCEIVER_COUNT                                       256
+
+/**
+ * Maximum number of send worker threads, see initSendWorkerPool
+ */
+#define MAX_SEND_WORKER_COUNT                                                       64
+
+/**
+ * Maximum number of frames a peer connection can have waiting for its send worker
+ */
+#define MAX_SEND_QUEUE_SIZE                                                         1024
 /*!@} */
 
 /*===========================================================================================*/
@@ -561,6 +599,21 @@ extern "C" {
  * Default jitter buffer tolerated latency, frame will be dropped if it is out of window
  */
 #define DEFAULT_JITTER_BUFFER_MAX_LATENCY                                           (2000L * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+/**
+ * Default shortest wait of an adaptive jitter buffer for missing packets
+ */
+#define DEFAULT_JITTER_BUFFER_MIN_LATENCY                                           (50L * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+/**
+ * Default number of inbound packets a peer connection queues while its I/O worker is shared, see KvsRtcConfiguration.inboundPacketQueueSize
+ */
+#define DEFAULT_INBOUND_PACKET_QUEUE_SIZE                                           256
+
+/**
+ * KvsRtcConfiguration.inboundPacketQueueSize processing inbound packets on the receiving thread
+ */
+#define INBOUND_PACKET_QUEUE_SIZE_DISABLED                                          MAX_UINT32
 /*!@} */
 
 /**
@@ -627,6 +680,46 @@ typedef SIGNALING_CLIENT_HANDLE* PSIGNALING_CLIENT_HANDLE;
 #define IS_VALID_SIGNALING_CLIENT_HANDLE(h) ((h) != INVALID_SIGNALING_CLIENT_HANDLE_VALUE)
 #endif
 
+/**
+ * @brief Definition of the peer connection pool handle
+ */
+typedef UINT64 PEER_CONNECTION_POOL_HANDLE;
+typedef PEER_CONNECTION_POOL_HANDLE* PPEER_CONNECTION_POOL_HANDLE;
+
+/**
+ * @brief This is a sentinel indicating an invalid handle value
+ */
+#ifndef INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE
+#define INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE ((PEER_CONNECTION_POOL_HANDLE) INVALID_PIC_HANDLE_VALUE)
+#endif
+
+/**
+ * @brief Checks for the handle validity
+ */
+#ifndef IS_VALID_PEER_CONNECTION_POOL_HANDLE
+#define IS_VALID_PEER_CONNECTION_POOL_HANDLE(h) ((h) != INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE)
+#endif
+
+/**
+ * @brief Definition of the broadcast group handle
+ */
+typedef UINT64 BROADCAST_GROUP_HANDLE;
+typedef BROADCAST_GROUP_HANDLE* PBROADCAST_GROUP_HANDLE;
+
+/**
+ * @brief This is a sentinel indicating an invalid handle value
+ */
+#ifndef INVALID_BROADCAST_GROUP_HANDLE_VALUE
+#define INVALID_BROADCAST_GROUP_HANDLE_VALUE ((BROADCAST_GROUP_HANDLE) INVALID_PIC_HANDLE_VALUE)
+#endif
+
+/**
+ * @brief Checks for the handle validity
+ */
+#ifndef IS_VALID_BROADCAST_GROUP_HANDLE
+#define IS_VALID_BROADCAST_GROUP_HANDLE(h) ((h) != INVALID_BROADCAST_GROUP_HANDLE_VALUE)
+#endif
+
 ////////////////////////////////////////////////////
 /// Extra callbacks definitions
 ////////////////////////////////////////////////////
@@ -639,6 +732,36 @@ typedef SIGNALING_CLIENT_HANDLE* PSIGNALING_CLIENT_HANDLE;
  */
 typedef VOID (*RtcOnFrame)(UINT64, PFrame);
 
+/**
+ * @brief Slice of a received frame, pointing into the packet it was received in
+ */
+typedef struct {
+    PBYTE pData; //!< Depayloaded bytes of the frame
+    UINT32 size; //!< Number of bytes
+} RtcFrameSegment, *PRtcFrameSegment;
+
+/**
+ * @brief Received frame handed over as the depayloaded slices of its packets instead of a contiguous copy.
+ * Writing out the segments in order gives the same bytes RtcOnFrame would have received. The segments stay
+ * valid until the frame is released with freeRtcFrameSegments.
+ */
+typedef struct {
+    UINT64 presentationTs; //!< Presentation timestamp, in the units of the Frame given to RtcOnFrame
+    UINT32 size; //!< Sum of the sizes of the segments
+    UINT32 segmentCount; //!< Number of segments
+    PRtcFrameSegment pSegments; //!< Segments in frame order
+} RtcFrameSegments, *PRtcFrameSegments;
+
+/**
+ * @brief RtcOnFrameSegments is fired everytime a frame is received from
+ * the remote peer, instead of RtcOnFrame. The application owns the frame and must
+ * release it with freeRtcFrameSegments, at the latest before the peer connection is freed.
+ *
+ * NOTE: RtcOnFrameSegments is a KVS specific method
+ *
+ */
+typedef VOID (*RtcOnFrameSegments)(UINT64, PRtcFrameSegments);
+
 /**
  * @brief RtcOnBandwidthEstimation is fired everytime a bandwidth estimation value
  * is computed. This will be fired for sender or receiver side estimation
@@ -780,6 +903,20 @@ typedef enum {
     RTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY = 3, //!< This indicates that the peer can only receive information
 } RTC_RTP_TRANSCEIVER_DIRECTION;
 
+/**
+ * @brief SRTP protection profiles negotiated in the DTLS handshake. Values are the DTLS-SRTP protection profile ids.
+ *
+ * Reference: https://tools.ietf.org/html/rfc5764#section-4.1.2, https://tools.ietf.org/html/rfc7714#section-14.2
+ */
+typedef enum {
+    RTC_SRTP_PROFILE_NONE = 0,                           //!< Ends a list of profiles
+    RTC_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80 = 0x0001,    //!< AES counter mode and an 80 bit HMAC-SHA1 tag
+    RTC_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32 = 0x0002,    //!< AES counter mode and a 32 bit HMAC-SHA1 tag
+    RTC_SRTP_PROFILE_AEAD_AES_128_GCM = 0x0007,          //!< AES-GCM with a 128 bit key, encrypts and authenticates
+                                                         //!< in a single pass
+    RTC_SRTP_PROFILE_AEAD_AES_256_GCM = 0x0008,          //!< AES-GCM with a 256 bit key
+} RTC_SRTP_PROFILE, *PRTC_SRTP_PROFILE;
+
 /**
  * @brief Defines channel status as reported by the service
  */
@@ -962,6 +1099,21 @@ typedef struct {
 
     UINT32 sendBufSize; //!< Socket send buffer length. Item larger then this size will get dropped. Use system default if 0.
 
+    UINT32 receiveBatchSize; //!< Max number of UDP datagrams read from a socket in one call, at most 64. Use default if 0.
+
+    //!< Number of inbound RTP/RTCP packets that can wait to be decrypted and processed on a dedicated thread of the
+    //!< peer connection, so that a slow RtcOnFrame callback does not stall reception. Packets are dropped when the
+    //!< queue is full. 0 uses DEFAULT_INBOUND_PACKET_QUEUE_SIZE when the I/O workers are shared by all peer connections,
+    //!< see initKvsWebRtcWithIoWorkerCount, and processes packets on the receiving thread of the peer connection otherwise.
+    //!< INBOUND_PACKET_QUEUE_SIZE_DISABLED always processes them on the receiving thread, RtcOnFrame and the other
+    //!< receive callbacks then run on the shared worker and one of them taking long delays every peer connection it serves.
+    UINT32 inboundPacketQueueSize;
+
+    //!< SRTP protection profiles offered in the DTLS handshake, the most preferred first. The list ends at the first
+    //!< RTC_SRTP_PROFILE_NONE. If unset AEAD_AES_128_GCM, AEAD_AES_256_GCM, AES128_CM_HMAC_SHA1_32 and
+    //!< AES128_CM_HMAC_SHA1_80 are offered in that order.
+    RTC_SRTP_PROFILE srtpProfiles[MAX_RTCCONFIGURATION_SRTP_PROFILES];
+
     UINT64 filterCustomData; //!< Custom Data that can be populated by the developer while developing filter function
 
     IceSetInterfaceFilterFunc iceSetInterfaceFilterFunc; //!< Filter function callback to be set when the developer
@@ -1243,6 +1395,22 @@ typedef struct {
     RTC_RTP_TRANSCEIVER_DIRECTION direction; //!< Transceiver direction - SENDONLY, RECVONLY, SENDRECV
 } RtcRtpTransceiverInit, *PRtcRtpTransceiverInit;
 
+/**
+ * @brief How the jitter buffer of an RtcRtpTransceiver handles missing packets, see transceiverSetJitterBufferConfiguration.
+ * A zeroed struct keeps the defaults.
+ */
+typedef struct {
+    UINT64 maxLatency; //!< Longest time a frame waits for its missing packets before it is dropped.
+                       //!< Use DEFAULT_JITTER_BUFFER_MAX_LATENCY if 0.
+    BOOL adaptiveLatency; //!< Wait for missing packets only as long as the measured interarrival jitter and the time
+                          //!< retransmissions take require, between minLatency and maxLatency
+    UINT64 minLatency; //!< Shortest wait of an adaptive jitter buffer. Use DEFAULT_JITTER_BUFFER_MIN_LATENCY if 0.
+    BOOL releaseOnMarker; //!< Hand a video frame over as soon as the packet with the marker bit completes it instead of
+                          //!< when the next frame starts. Only for senders that set the marker bit on the last packet
+                          //!< of every frame, ignored for audio.
+    BOOL disableNack; //!< Do not ask the remote peer to retransmit the packets missing from a received video stream
+} RtcJitterBufferConfiguration, *PRtcJitterBufferConfiguration;
+
 /**
  * @brief RtcDataChannelInit dictionary used to configure properties of the
  * underlying channel such as data reliability
@@ -1298,6 +1466,112 @@ typedef struct {
     SignalingClientStats signalingClientStats; //!< Signaling client metrics stats. Reference in Stats.h
 } SignalingClientMetrics, *PSignalingClientMetrics;
 
+/**
+ * @brief Load of one of the I/O worker threads receiving data for all RtcPeerConnections
+ */
+typedef struct {
+    UINT32 peerConnectionCount; //!< Number of peer connections assigned to the worker
+    UINT32 socketCount; //!< Number of sockets the worker is currently receiving on
+    UINT64 packetsReceived; //!< Total number of packets received by the worker
+    UINT64 bytesReceived; //!< Total number of bytes received by the worker
+    UINT64 busyTime; //!< Total time in 100ns units the worker spent handling received data, including the callbacks
+} IoWorkerMetrics, *PIoWorkerMetrics;
+
+/**
+ * @brief Configuration of the process wide pool of pre-generated DTLS certificates, see initDtlsCertificatePool
+ */
+typedef struct {
+    UINT32 certificateCount; //!< Number of certificates kept ready, up to MAX_DTLS_CERTIFICATE_POOL_SIZE. Default if 0
+    //!< Same as KvsRtcConfiguration.generateRSACertificate. Only peer connections with the same setting use the pool
+    BOOL generateRSACertificate;
+    //!< Same as KvsRtcConfiguration.generatedCertificateBits. Only peer connections with the same setting use the pool
+    INT32 generatedCertificateBits;
+    //!< Certificates are replaced with new ones once they are this old, in 100ns. Default if 0
+    UINT64 maxCertificateAge;
+} DtlsCertificatePoolConfiguration, *PDtlsCertificatePoolConfiguration;
+
+/**
+ * @brief Configuration of a pool of RtcPeerConnections created ahead of time, see createPeerConnectionPool
+ */
+typedef struct {
+    UINT32 peerConnectionCount; //!< Number of peer connections kept ready, up to MAX_PEER_CONNECTION_POOL_SIZE. Default if 0
+    //!< Ready peer connections are replaced with new ones once they are this old, in 100ns, so that the NAT bindings
+    //!< of their candidates are still open when they are handed out. Default if 0
+    UINT64 maxPeerConnectionAge;
+} PeerConnectionPoolConfiguration, *PPeerConnectionPoolConfiguration;
+
+/**
+ * @brief Counters of a peer connection pool
+ */
+typedef struct {
+    UINT32 readyCount; //!< Number of peer connections currently ready
+    UINT64 hitCount; //!< Number of peer connections handed out ready
+    UINT64 missCount; //!< Number of peer connections created on the spot because none was ready
+    UINT64 expiredCount; //!< Number of ready peer connections replaced because of their age
+} PeerConnectionPoolMetrics, *PPeerConnectionPoolMetrics;
+
+/**
+ * @brief Counters of the inbound packet queue of an RtcPeerConnection, see KvsRtcConfiguration.inboundPacketQueueSize
+ */
+typedef struct {
+    UINT64 packetsQueued; //!< Number of packets handed to the processing thread
+    UINT64 packetsDropped; //!< Number of packets dropped because the queue was full or they were too large
+    UINT64 overflowCount; //!< Number of times the queue ran full
+    UINT32 maxQueueDepth; //!< Largest number of packets that were waiting in the queue at once
+} InboundPacketQueueStats, *PInboundPacketQueueStats;
+
+/**
+ * @brief Configuration of the process wide pool of send workers, see initSendWorkerPool
+ */
+typedef struct {
+    UINT32 workerCount; //!< Number of send workers, up to MAX_SEND_WORKER_COUNT. 0 uses one worker per online CPU core
+    UINT32 queueSize; //!< Frames each peer connection can have waiting for its worker, up to MAX_SEND_QUEUE_SIZE. Default if 0
+    //!< Longest time in 100ns a writer waits for room in the full queue of a peer connection before the frame is
+    //!< dropped for that peer connection. Default if 0
+    UINT64 maxEnqueueWait;
+} SendWorkerPoolConfiguration, *PSendWorkerPoolConfiguration;
+
+/**
+ * @brief Load of one of the send worker threads
+ */
+typedef struct {
+    UINT32 peerConnectionCount; //!< Number of peer connections assigned to the worker
+    UINT64 framesSent; //!< Total number of queued frames the worker encrypted and sent
+    UINT64 busyTime; //!< Total time in 100ns units the worker spent encrypting and sending
+} SendWorkerMetrics, *PSendWorkerMetrics;
+
+/**
+ * @brief Counters of the queue of frames an RtcPeerConnection has waiting for its send worker
+ */
+typedef struct {
+    UINT32 queueDepth; //!< Number of frames currently waiting in the queue
+    UINT32 maxQueueDepth; //!< Largest number of frames that were waiting in the queue at once
+    UINT64 framesQueued; //!< Number of frames handed to the send worker
+    UINT64 framesSent; //!< Number of queued frames the send worker encrypted and sent
+    //!< Number of frames dropped because the queue stayed full, or because their transceiver left the broadcast group
+    //!< before they were sent
+    UINT64 framesDropped;
+    UINT64 blockedTime; //!< Total time in 100ns units writers waited for room in the full queue
+} SendQueueStats, *PSendQueueStats;
+
+/**
+ * @brief Counters of a broadcast group. What each transceiver of the group sends is in its outbound RTP stream stats
+ */
+typedef struct {
+    UINT64 framesWritten; //!< Number of frames written to the group
+    UINT64 packetsCreated; //!< Number of packets the frames were split into, once per frame no matter how many transceivers it went to
+    UINT64 allocationCount; //!< Heap allocations made to packetize the frames. Stays flat once the group has seen its largest frame
+} BroadcastGroupStats, *PBroadcastGroupStats;
+
+/**
+ * @brief Counters of the generic NACKs an RtcRtpTransceiver sends for the packets missing from the stream it receives
+ */
+typedef struct {
+    UINT64 nackPacketsSent; //!< Number of RTCP NACK packets sent
+    UINT64 packetsNacked; //!< Number of times a missing packet was asked for, retries included
+    UINT64 packetsRecovered; //!< Number of packets that were asked for and then received in time to be kept
+} RtcNackStats, *PRtcNackStats;
+
 /**
  * @brief The stats object is populated based on RTCStatsType request
  *
@@ -1306,6 +1580,8 @@ typedef struct {
     UINT64 timestamp; //!< Timestamp of request for stats
     RTC_STATS_TYPE requestedTypeOfStats; //!< Type of stats requested. Set to RTC_ALL to get all supported stats
     RtcStatsObject rtcStatsObject; //!< Object that is populated by the SDK on request
+    PRtcRtpTransceiver pRtcRtpTransceiver; //!< Transceiver whose RTP streams are reported. Required by the RTP stream stats types,
+                                           //!< RTC_STATS_TYPE_RTC_ALL leaves the RTP stream stats out without one
 } RtcStats, *PRtcStats;
 
 ////////////////////////////////////////////////////
@@ -1333,6 +1609,53 @@ PUBLIC_API STATUS createPeerConnection(PRtcConfiguration, PRtcPeerConnection*);
  */
 PUBLIC_API STATUS freePeerConnection(PRtcPeerConnection*);
 
+/**
+ * @brief Create a pool that keeps RtcPeerConnections ready to be handed out. They are created on a background thread
+ * and start gathering candidates right away, so the DTLS certificate is ready, the host candidates are bound and the
+ * server reflexive and relay candidates are known by the time an offer arrives. Their candidates are only reported
+ * through RtcOnIceCandidate after setLocalDescription, like for any other peer connection, and are included in the
+ * SDP created before that.
+ *
+ * @param[in] PRtcConfiguration Configuration of every peer connection of the pool. Certificates it points to must
+ *                              outlive the pool
+ * @param[in] PPeerConnectionPoolConfiguration Pool configuration
+ * @param[out] PPEER_CONNECTION_POOL_HANDLE Created pool
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS createPeerConnectionPool(PRtcConfiguration, PPeerConnectionPoolConfiguration, PPEER_CONNECTION_POOL_HANDLE);
+
+/**
+ * @brief Take a peer connection out of the pool, it is freed with freePeerConnection like any other. When none is
+ * ready a new one is created on the calling thread.
+ *
+ * @param[in] PEER_CONNECTION_POOL_HANDLE Pool
+ * @param[out] PRtcPeerConnection* Peer connection
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS peerConnectionPoolGetPeerConnection(PEER_CONNECTION_POOL_HANDLE, PRtcPeerConnection*);
+
+/**
+ * @brief Get the counters of a peer connection pool
+ *
+ * @param[in] PEER_CONNECTION_POOL_HANDLE Pool
+ * @param[out] PPeerConnectionPoolMetrics Counters
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS peerConnectionPoolGetMetrics(PEER_CONNECTION_POOL_HANDLE, PPeerConnectionPoolMetrics);
+
+/**
+ * @brief Free a peer connection pool and the peer connections still in it. Peer connections taken out of it are not
+ * affected.
+ *
+ * @param[in/out] PPEER_CONNECTION_POOL_HANDLE Pool to free, set to INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS freePeerConnectionPool(PPEER_CONNECTION_POOL_HANDLE);
+
 /**
  * @brief Set a callback when new Ice collects new local candidate.
  *
@@ -1524,6 +1847,18 @@ PUBLIC_API STATUS closePeerConnection(PRtcPeerConnection);
  */
 PUBLIC_API STATUS addTransceiver(PRtcPeerConnection, PRtcMediaStreamTrack, PRtcRtpTransceiverInit, PRtcRtpTransceiver*);
 
+/**
+ * @brief Configure the jitter buffer of a transceiver. Transceivers use the defaults until this is called, call it
+ * before the remote description is set so that it applies before any media is received.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] PRtcJitterBufferConfiguration Configuration, zeroed fields use the defaults
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_INVALID_ARG if an adaptive minLatency is
+ * above maxLatency
+ */
+PUBLIC_API STATUS transceiverSetJitterBufferConfiguration(PRtcRtpTransceiver, PRtcJitterBufferConfiguration);
+
 /**
  * @brief Set a callback for transceiver frame
  *
@@ -1535,6 +1870,48 @@ PUBLIC_API STATUS addTransceiver(PRtcPeerConnection, PRtcMediaStreamTrack, PRtcR
  */
 PUBLIC_API STATUS transceiverOnFrame(PRtcRtpTransceiver, UINT64, RtcOnFrame);
 
+/**
+ * @brief Set a callback that receives frames without copying them. Replaces the RtcOnFrame callback.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT64 User customData that will be passed along when RtcOnFrameSegments is called
+ * @param[in] RtcOnFrameSegments User RtcOnFrameSegments callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverOnFrameSegments(PRtcRtpTransceiver, UINT64, RtcOnFrameSegments);
+
+/**
+ * @brief Release a frame received by RtcOnFrameSegments
+ *
+ * @param[in,out] PRtcFrameSegments* Frame to release, set to NULL
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS freeRtcFrameSegments(PRtcFrameSegments*);
+
+/**
+ * @brief Get the counters of the NACKs sent for the packets missing from the stream received by a transceiver
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[out] PRtcNackStats Counters of the NACKs
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverGetNackStats(PRtcRtpTransceiver, PRtcNackStats);
+
+/**
+ * @brief Ask the remote sender of a video transceiver for a key frame with a FIR and a PLI. Requests are rate limited
+ * to one per round trip, the ones sent while a key frame is already on its way are dropped.
+ *
+ * NOTE: Frames the jitter buffer drops trigger a PLI on their own, this is for decoders that lost their state otherwise
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverRequestKeyFrame(PRtcRtpTransceiver);
+
 /**
  * @brief Set a callback for bandwidth estimation results
  *
@@ -1562,6 +1939,18 @@ PUBLIC_API STATUS freeTransceiver(PRtcRtpTransceiver*);
  */
 PUBLIC_API STATUS initKvsWebRtc(VOID);
 
+/**
+ * @brief Same as initKvsWebRtc but sets the number of I/O worker threads that receive data for all RtcPeerConnections.
+ * All packets of a peer connection are handled on the same worker so they are processed in order. Each new peer
+ * connection is assigned to the least loaded worker. Only applies to linux, other platforms use a thread per peer
+ * connection.
+ *
+ * @param[in] UINT32 Number of I/O workers, up to MAX_IO_WORKER_COUNT. 0 uses one worker per online CPU core
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS initKvsWebRtcWithIoWorkerCount(UINT32);
+
 /**
  * @brief Deinitializes global state needed for all RtcPeerConnections. It must only be called once
  *
@@ -1569,6 +1958,35 @@ PUBLIC_API STATUS initKvsWebRtc(VOID);
  */
 PUBLIC_API STATUS deinitKvsWebRtc(VOID);
 
+/**
+ * @brief Starts generating DTLS certificates on a background thread ahead of time. RtcPeerConnections that do not set
+ * RtcConfiguration.certificates then take one of the ready certificates instead of generating their own, which takes
+ * hundreds of milliseconds for RSA. Peer connections taking the same certificate share one read-only SSL_CTX, each
+ * of them still has its own DTLS session. Certificates are replaced once they are older than the configured age,
+ * peer connections already using a replaced certificate keep it. Must be called after initKvsWebRtc, the pool is
+ * stopped by deinitKvsWebRtc.
+ *
+ * @param[in] PDtlsCertificatePoolConfiguration Pool configuration
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS initDtlsCertificatePool(PDtlsCertificatePoolConfiguration);
+
+/**
+ * @brief Starts a pool of send worker threads. Every RtcPeerConnection created afterwards is assigned to the worker
+ * with the fewest peer connections and gets a queue of frames waiting for it. broadcastGroupWriteFrame then only
+ * packetizes the frame and queues it to the peer connection of each transceiver, the workers rewrite, encrypt and send
+ * it, so sending to many viewers is spread over several cores while the frames of a peer connection still go out in
+ * order. When the queue of a peer connection is full the writer waits for room, up to the configured time, and then
+ * drops the frame for that peer connection only. writeFrame keeps sending on the calling thread. Must be called after
+ * initKvsWebRtc, the pool is stopped by deinitKvsWebRtc once every peer connection has been freed.
+ *
+ * @param[in] PSendWorkerPoolConfiguration Pool configuration
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS initSendWorkerPool(PSendWorkerPoolConfiguration);
+
 /**
  * @brief Adds to the list of codecs we support receiving.
  *
@@ -1591,6 +2009,76 @@ PUBLIC_API STATUS addSupportedCodec(PRtcPeerConnection, RTC_CODEC);
  */
 PUBLIC_API STATUS writeFrame(PRtcRtpTransceiver, PFrame);
 
+/**
+ * @brief Create a broadcast group that sends the same media to many RtcRtpTransceivers. A frame written to the group
+ * is packetized and serialized once, only rewriting the SSRC, sequence numbers and payload type of the packets and
+ * encrypting them is done for every transceiver.
+ *
+ * @param[in] RTC_CODEC Codec of the media, every transceiver of the group sends this codec
+ * @param[out] PBROADCAST_GROUP_HANDLE Created group
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS createBroadcastGroup(RTC_CODEC, PBROADCAST_GROUP_HANDLE);
+
+/**
+ * @brief Add an RtcRtpTransceiver to a broadcast group, up to MAX_BROADCAST_GROUP_TRANSCEIVER_COUNT of them. Adding
+ * one already in the group does nothing. A transceiver has to be removed from the group before its RtcPeerConnection
+ * is freed.
+ *
+ * @param[in] BROADCAST_GROUP_HANDLE Group
+ * @param[in] PRtcRtpTransceiver Transceiver sending the codec of the group
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupAddTransceiver(BROADCAST_GROUP_HANDLE, PRtcRtpTransceiver);
+
+/**
+ * @brief Remove an RtcRtpTransceiver from a broadcast group. Removing one not in the group does nothing. Frames of the
+ * group still queued for it, see initSendWorkerPool, are dropped. Waits for the frames that were being written to the
+ * group when it was removed to be sent or queued first, frames written after that do not hold it back.
+ *
+ * @param[in] BROADCAST_GROUP_HANDLE Group
+ * @param[in] PRtcRtpTransceiver Transceiver
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupRemoveTransceiver(BROADCAST_GROUP_HANDLE, PRtcRtpTransceiver);
+
+/**
+ * @brief Packetize a frame once and send it through every RtcRtpTransceiver of a broadcast group, same as calling
+ * writeFrame for each of them. Transceivers whose RtcPeerConnection is not connected yet are skipped, a failure to
+ * send to one of them does not stop the others and the first one is returned. With a send worker pool, see
+ * initSendWorkerPool, the frame is queued to the peer connections instead and their workers send it. The group is not
+ * locked while the frame is sent or waits for room in a queue, frames written from several threads at once may go out
+ * in any order.
+ *
+ * @param[in] BROADCAST_GROUP_HANDLE Group
+ * @param[in] PFrame Frame of media that will be sent
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupWriteFrame(BROADCAST_GROUP_HANDLE, PFrame);
+
+/**
+ * @brief Get the counters of a broadcast group
+ *
+ * @param[in] BROADCAST_GROUP_HANDLE Group
+ * @param[out] PBroadcastGroupStats Counters of the group
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupGetStats(BROADCAST_GROUP_HANDLE, PBroadcastGroupStats);
+
+/**
+ * @brief Free a broadcast group. Its transceivers are not affected.
+ *
+ * @param[in/out] PBROADCAST_GROUP_HANDLE Group to free, set to INVALID_BROADCAST_GROUP_HANDLE_VALUE
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS freeBroadcastGroup(PBROADCAST_GROUP_HANDLE);
+
 /**
  * @brief Provides a remote candidate to the ICE Agent.
  *
@@ -1795,11 +2283,57 @@ PUBLIC_API STATUS signalingClientGetMetrics(SIGNALING_CLIENT_HANDLE, PSignalingC
  * @brief Get the relevant/all metrics based on the RTCStatsType field. This does not include
  * any signaling related metrics
  *
+ * Supported types are RTC_STATS_TYPE_CANDIDATE_PAIR, RTC_STATS_TYPE_TRANSPORT, RTC_STATS_TYPE_OUTBOUND_RTP,
+ * RTC_STATS_TYPE_INBOUND_RTP, RTC_STATS_TYPE_REMOTE_INBOUND_RTP and RTC_STATS_TYPE_REMOTE_OUTBOUND_RTP. Only the counters
+ * the SDK maintains are filled, other fields are zeroed. Collecting the stats does not block sending or receiving media.
+ *
  * @param PRtcPeerConnection Peer connection for which the stats need to be collected
  * @param[in/out] PRtcStats The stats object with the RTCStatsType field populated
  */
 PUBLIC_API STATUS RtcPeerConnectionGetMetrics(PRtcPeerConnection, PRtcStats);
 
+/**
+ * @brief Get the load of each I/O worker thread. See initKvsWebRtcWithIoWorkerCount
+ *
+ * @param[out/opt] PIoWorkerMetrics Array receiving one entry per worker. NULL only queries the number of workers
+ * @param[in/out] PUINT32 IN - number of entries the array can hold, OUT - number of workers
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_BUFFER_TOO_SMALL if the array is too small
+ */
+PUBLIC_API STATUS getIoWorkerMetrics(PIoWorkerMetrics, PUINT32);
+
+/**
+ * @brief Get the counters of the inbound packet queue of a peer connection
+ *
+ * @param[in] PRtcPeerConnection Peer connection with an inbound packet queue, see KvsRtcConfiguration.inboundPacketQueueSize
+ * @param[out] PInboundPacketQueueStats Counters of the queue
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_INVALID_OPERATION if the peer connection
+ * has no inbound packet queue
+ */
+PUBLIC_API STATUS peerConnectionGetInboundPacketQueueStats(PRtcPeerConnection, PInboundPacketQueueStats);
+
+/**
+ * @brief Get the load of each send worker thread. See initSendWorkerPool
+ *
+ * @param[out/opt] PSendWorkerMetrics Array receiving one entry per worker. NULL only queries the number of workers
+ * @param[in/out] PUINT32 IN - number of entries the array can hold, OUT - number of workers
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_BUFFER_TOO_SMALL if the array is too small
+ */
+PUBLIC_API STATUS getSendWorkerMetrics(PSendWorkerMetrics, PUINT32);
+
+/**
+ * @brief Get the counters of the queue of frames a peer connection has waiting for its send worker
+ *
+ * @param[in] PRtcPeerConnection Peer connection created after initSendWorkerPool
+ * @param[out] PSendQueueStats Counters of the queue
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_INVALID_OPERATION if the peer connection
+ * has no send worker
+ */
+PUBLIC_API STATUS peerConnectionGetSendQueueStats(PRtcPeerConnection, PSendQueueStats);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -272,6 +272,12 @@ typedef struct {
     QualityLimitationDurationsRecord qualityLimitationDurations; //!< Total time (seconds) spent in each reason state
     DscpPacketsSentRecord perDscpPacketsSent; //!< Total number of packets sent for this SSRC, per DSCP
     RTC_QUALITY_LIMITATION_REASON qualityLimitationReason; //!< Only valid for video.
+    UINT64 sendBufferAllocations; //!< Non standard. Heap allocations made to packetize the frames of this stream. Stays flat once
+                                  //!< the buffers fit the largest frame sent
+    UINT64 retransmissionBufferAllocations; //!< Non standard. Heap allocations made to keep the packets of this stream for
+                                            //!< retransmission. Stays flat once the retransmission buffer is full
+    UINT64 packetsSent; //!< Total number of RTP packets sent for this SSRC, wraps around at 32 bits when reported by a remote sender
+    UINT64 bytesSent; //!< Total number of payload bytes sent for this SSRC, wraps around at 32 bits when reported by a remote sender
 } RtcOutboundRtpStreamStats, *PRtcOutboundRtpStreamStats;
 
 /**
@@ -281,13 +287,30 @@ typedef struct {
  */
 typedef struct {
     CHAR localId[MAX_STATS_STRING_LENGTH + 1]; //!< Used to look up RTCOutboundRtpStreamStats for the SSRC
-    UINT64 roundTripTime; //!< Estimated round trip time (seconds) for this SSRC based on the RTCP timestamps
-    UINT64 totalRoundTripTime; //!< The cumulative sum of all round trip time measurements in seconds since the beginning of the session
-    UINT64 fractionLost; //!< The fraction packet loss reported for this SSRC
+    UINT64 roundTripTime; //!< Estimated round trip time (100ns units) for this SSRC based on the RTCP timestamps
+    UINT64 totalRoundTripTime; //!< The cumulative sum of all round trip time measurements in 100ns units since the beginning of the session
+    UINT64 fractionLost; //!< The fraction packet loss reported for this SSRC, in 1/256ths of the packets expected
     UINT64 reportsReceived; //!< Total number of RTCP RR blocks received for this SSRC
     UINT64 roundTripTimeMeasurements; //!< Total number of RTCP RR blocks received for this SSRC that contain a valid round trip time
 } RtcRemoteInboundRtpStreamStats, *PRtcRemoteInboundRtpStreamStats;
 
+/**
+ * @brief RtcInboundRtpStreamStats Represents the measurement metrics for the incoming RTP media stream
+ *
+ * Reference: https://www.w3.org/TR/webrtc-stats/#inboundrtpstats-dict*
+ */
+typedef struct {
+    UINT64 packetsReceived; //!< Total number of RTP packets received for this SSRC
+    UINT64 bytesReceived; //!< Total number of payload bytes received for this SSRC
+    INT64 packetsLost; //!< Total number of RTP packets lost for this SSRC as of the last receiver report sent. Negative with duplicates
+    UINT64 jitter; //!< Packet jitter in RTP timestamp units for this SSRC as of the last receiver report sent
+    UINT64 framesReceived; //!< Total number of complete frames handed to the application
+    UINT64 framesDropped; //!< Total number of frames dropped because packets were still missing after the jitter buffer latency
+    UINT64 nackCount; //!< Total number of NACK packets sent by this receiver
+    UINT64 firCount; //!< Only valid for video. Total number of FIR packets sent by this receiver
+    UINT64 pliCount; //!< Only valid for video. Total number of PLI packets sent by this receiver
+} RtcInboundRtpStreamStats, *PRtcInboundRtpStreamStats;
+
 /**
  * @brief SignalingClientMetrics Represent the stats related to the KVS WebRTC SDK signaling client
  */
@@ -311,8 +334,10 @@ typedef struct {
     RtcIceCandidateStats iceCandidateStats; //!< ICE Candidate stats object
     RtcIceServerStats iceServerStats; //!< ICE Server Pair stats object
     RtcTransportStats transportStats; //!< Transport stats object
-    RtcOutboundRtpStreamStats remoteOutboundRtpStreamStats; //!< Outbound RTP Stream stats object
-    RtcRemoteInboundRtpStreamStats remoteInboundRtpStreamStats; //!< Inbound RTP Stream stats object
+    RtcOutboundRtpStreamStats remoteOutboundRtpStreamStats; //!< Outbound RTP Stream stats object of the remote sender, from its sender reports
+    RtcRemoteInboundRtpStreamStats remoteInboundRtpStreamStats; //!< Inbound RTP Stream stats object of the remote receiver, from its receiver reports
+    RtcOutboundRtpStreamStats outboundRtpStreamStats; //!< Outbound RTP Stream stats object of the local sender
+    RtcInboundRtpStreamStats inboundRtpStreamStats; //!< Inbound RTP Stream stats object of the local receiver
 } RtcStatsObject, *PRtcStatsObject;
 
 #ifdef  __cplusplus
@@ -183,7 +183,7 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo pCertificates, UINT32 certCount,
     #endif
 
     SSL_CTX_set_verify(pSslCtx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, dtlsCertificateVerifyCallback);
-    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, "SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80") == 0, STATUS_SSL_CTX_CREATION_FAILED);
+    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, DTLS_DEFAULT_SRTP_PROFILES) == 0, STATUS_SSL_CTX_CREATION_FAILED);
 
     for (i = 0; i < certCount; i++) {
         CHK(SSL_CTX_use_certificate(pSslCtx, pCertificates[i].pCert) == 1, STATUS_SSL_CTX_CREATION_FAILED);
@@ -295,7 +295,7 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PDtlsSession pDtlsSession = NULL;
-    UINT32 i, certCount;
+    UINT32 i, certCount = 0;
     DtlsSessionCertificateInfo certInfos[MAX_RTCCONFIGURATION_CERTIFICATES];
     MEMSET(certInfos, 0x00, SIZEOF(certInfos));
 
@@ -319,6 +319,14 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
     }
 
     if (certCount == 0) {
+        // A certificate generated ahead of time comes with a read-only SSL_CTX shared with other sessions
+        CHK_STATUS(dtlsCertificatePoolGetSslCtx(certificateBits, generateRSACertificate, &pDtlsSession->pSslCtx,
+                pDtlsSession->certFingerprints[0]));
+    }
+
+    if (pDtlsSession->pSslCtx != NULL) {
+        pDtlsSession->certificateCount = 1;
+    } else if (certCount == 0) {
         CHK_STATUS(createCertificateAndKey(certificateBits, generateRSACertificate, &certInfos[0].pCert,
                 &certInfos[0].pKey));
         certInfos[0].created = TRUE;
@@ -332,11 +340,14 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
         }
     }
 
-    CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx));
-    CHK_STATUS(createSsl(pDtlsSession->pSslCtx, &pDtlsSession->pSsl));
+    if (pDtlsSession->pSslCtx == NULL) {
+        CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx));
+
+        // Generate and store the certificate fingerprints
+        CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
+    }
 
-    // Generate and store the certificate fingerprints
-    CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
+    CHK_STATUS(createSsl(pDtlsSession->pSslCtx, &pDtlsSession->pSsl));
 
     *ppDtlsSession = pDtlsSession;
 
@@ -460,10 +471,11 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
     }
 
     if (pDtlsSession->pSsl != NULL) {
-        SSL_CTX_free(pDtlsSession->pSslCtx);
+        SSL_free(pDtlsSession->pSsl);
     }
+    // Only drops the reference of the session when the SSL_CTX is shared
     if (pDtlsSession->pSslCtx != NULL) {
-        SSL_free(pDtlsSession->pSsl);
+        SSL_CTX_free(pDtlsSession->pSslCtx);
     }
     if (IS_VALID_MUTEX_VALUE(pDtlsSession->sslLock)) {
         MUTEX_FREE(pDtlsSession->sslLock);
@@ -677,8 +689,9 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 offset = 0;
+    UINT32 offset = 0, keyLen = 0, saltLen = 0;
     BYTE keyingMaterialBuffer[MAX_SRTP_MASTER_KEY_LEN * 2 + MAX_SRTP_SALT_KEY_LEN * 2];
+    SRTP_PROTECTION_PROFILE *pSrtpProfile = NULL;
     BOOL locked = FALSE;
 
     CHK(pDtlsSession != NULL && pDtlsKeyingMaterial != NULL, STATUS_NULL_ARG);
@@ -686,29 +699,26 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
 
-    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, SIZEOF(keyingMaterialBuffer), KEYING_EXTRACTOR_LABEL, ARRAY_SIZE(KEYING_EXTRACTOR_LABEL) - 1, NULL, 0, 0), STATUS_INTERNAL_ERROR);
+    CHK((pSrtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)) != NULL, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    pDtlsKeyingMaterial->srtpProfile = (SRTP_PROFILE) pSrtpProfile->id;
 
-    pDtlsKeyingMaterial->key_length = MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN;
+    // The amount of keying material depends on the negotiated profile https://tools.ietf.org/html/rfc5764#section-4.2
+    CHK_STATUS(dtlsGetSrtpProfileKeyLength(pDtlsKeyingMaterial->srtpProfile, &keyLen, &saltLen));
 
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
+    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, (keyLen + saltLen) * 2, KEYING_EXTRACTOR_LABEL, ARRAY_SIZE(KEYING_EXTRACTOR_LABEL) - 1, NULL, 0, 0), STATUS_INTERNAL_ERROR);
 
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
+    pDtlsKeyingMaterial->key_length = (UINT8) (keyLen + saltLen);
 
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-    offset += MAX_SRTP_SALT_KEY_LEN;
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], keyLen);
+    offset += keyLen;
 
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], keyLen);
+    offset += keyLen;
 
-    switch(SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id) {
-      case SRTP_AES128_CM_SHA1_32:
-      case SRTP_AES128_CM_SHA1_80:
-          pDtlsKeyingMaterial->srtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id;
-          break;
-    default:
-        CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
-    }
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + keyLen, &keyingMaterialBuffer[offset], saltLen);
+    offset += saltLen;
+
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + keyLen, &keyingMaterialBuffer[offset], saltLen);
 
 CleanUp:
     if (locked) {
@@ -719,6 +729,88 @@ CleanUp:
     return retStatus;
 }
 
+STATUS dtlsGetSrtpProfileKeyLength(SRTP_PROFILE srtpProfile, PUINT32 pKeyLen, PUINT32 pSaltLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKeyLen != NULL && pSaltLen != NULL, STATUS_NULL_ARG);
+
+    switch (srtpProfile) {
+        case SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
+        case SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
+            *pKeyLen = SRTP_AES_128_MASTER_KEY_LEN;
+            *pSaltLen = SRTP_AES_CM_SALT_KEY_LEN;
+            break;
+        case SRTP_PROFILE_AEAD_AES_128_GCM:
+            *pKeyLen = SRTP_AES_128_MASTER_KEY_LEN;
+            *pSaltLen = SRTP_AEAD_SALT_KEY_LEN;
+            break;
+        case SRTP_PROFILE_AEAD_AES_256_GCM:
+            *pKeyLen = SRTP_AES_256_MASTER_KEY_LEN;
+            *pSaltLen = SRTP_AEAD_SALT_KEY_LEN;
+            break;
+        default:
+            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    }
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS dtlsSessionSetSrtpProfiles(PDtlsSession pDtlsSession, PRTC_SRTP_PROFILE pSrtpProfiles, UINT32 profileCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR profiles[DTLS_SRTP_PROFILES_STRING_LEN + 1];
+    PCHAR pProfileName = NULL;
+    UINT32 i, length = 0;
+    BOOL locked = FALSE;
+
+    CHK(pDtlsSession != NULL && pSrtpProfiles != NULL, STATUS_NULL_ARG);
+    CHK(!ATOMIC_LOAD_BOOL(&pDtlsSession->isStarted), STATUS_INVALID_OPERATION);
+
+    MEMSET(profiles, 0x00, SIZEOF(profiles));
+
+    // OpenSSL takes the profiles as a colon separated list of their names
+    for (i = 0; i < profileCount && pSrtpProfiles[i] != RTC_SRTP_PROFILE_NONE; i++) {
+        switch (pSrtpProfiles[i]) {
+            case RTC_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
+                pProfileName = "SRTP_AES128_CM_SHA1_80";
+                break;
+            case RTC_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
+                pProfileName = "SRTP_AES128_CM_SHA1_32";
+                break;
+            case RTC_SRTP_PROFILE_AEAD_AES_128_GCM:
+                pProfileName = "SRTP_AEAD_AES_128_GCM";
+                break;
+            case RTC_SRTP_PROFILE_AEAD_AES_256_GCM:
+                pProfileName = "SRTP_AEAD_AES_256_GCM";
+                break;
+            default:
+                CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+        }
+
+        CHK(length + STRLEN(pProfileName) + 1 <= DTLS_SRTP_PROFILES_STRING_LEN, STATUS_INVALID_ARG);
+        length += SNPRINTF(profiles + length, SIZEOF(profiles) - length, "%s%s", length == 0 ? "" : ":", pProfileName);
+    }
+
+    // Keep the profiles of the SSL_CTX, which can be shared with other sessions
+    CHK(length > 0, retStatus);
+
+    MUTEX_LOCK(pDtlsSession->sslLock);
+    locked = TRUE;
+
+    // Returns 0 on success unlike most of OpenSSL
+    CHK(SSL_set_tlsext_use_srtp(pDtlsSession->pSsl, profiles) == 0, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pDtlsSession->sslLock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
 
 STATUS dtlsSessionGetLocalCertificateFingerprint(PDtlsSession pDtlsSession, PCHAR pBuff, UINT32 buffLen)
 {
@@ -11,9 +11,20 @@
 extern "C" {
 #endif
 
-#define MAX_SRTP_MASTER_KEY_LEN 16
+#define MAX_SRTP_MASTER_KEY_LEN 32
 #define MAX_SRTP_SALT_KEY_LEN 14
 
+// Master key and salt lengths of the protection profiles, https://tools.ietf.org/html/rfc7714#section-12
+#define SRTP_AES_128_MASTER_KEY_LEN 16
+#define SRTP_AES_256_MASTER_KEY_LEN 32
+#define SRTP_AES_CM_SALT_KEY_LEN 14
+#define SRTP_AEAD_SALT_KEY_LEN 12
+
+// Offered when the configuration lists no protection profile. AES-GCM encrypts and authenticates in a single pass
+// so it goes first, AES-CM stays for peers without AES-GCM.
+#define DTLS_DEFAULT_SRTP_PROFILES "SRTP_AEAD_AES_128_GCM:SRTP_AEAD_AES_256_GCM:SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80"
+#define DTLS_SRTP_PROFILES_STRING_LEN 128
+
 #define GENERATED_CERTIFICATE_BITS 2048
 #define GENERATED_CERTIFICATE_SERIAL 0
 #define GENERATED_CERTIFICATE_DAYS 365
@@ -38,6 +49,8 @@ extern "C" {
 typedef enum {
    SRTP_PROFILE_AES128_CM_HMAC_SHA1_80 = SRTP_AES128_CM_SHA1_80,
    SRTP_PROFILE_AES128_CM_HMAC_SHA1_32 = SRTP_AES128_CM_SHA1_32,
+   SRTP_PROFILE_AEAD_AES_128_GCM = SRTP_AEAD_AES_128_GCM,
+   SRTP_PROFILE_AEAD_AES_256_GCM = SRTP_AEAD_AES_256_GCM,
 } SRTP_PROFILE;
 
 typedef enum {
@@ -62,7 +75,8 @@ typedef struct {
 } DtlsSessionCallbacks, *PDtlsSessionCallbacks;
 
 // DtlsKeyingMaterial is information extracted via https://tools.ietf.org/html/rfc5705
-// also includes the use_srtp value from Handshake
+// also includes the use_srtp value from Handshake. Each write key is the master key followed by the master salt,
+// key_length is their combined length for the negotiated profile
 typedef struct {
   BYTE clientWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
   BYTE serverWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
@@ -127,6 +141,15 @@ STATUS dtlsSessionStart(PDtlsSession, BOOL);
 STATUS dtlsSessionProcessPacket(PDtlsSession, PBYTE, PINT32);
 STATUS dtlsSessionIsInitFinished(PDtlsSession, PBOOL);
 STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession, PDtlsKeyingMaterial);
+
+/**
+ * Set the SRTP protection profiles offered in the handshake. Must be called before dtlsSessionStart.
+ * @param PDtlsSession - DtlsSession object
+ * @param PRTC_SRTP_PROFILE - profiles, the most preferred first. An empty list keeps the default ones
+ * @param UINT32 - number of entries, the list also ends at the first RTC_SRTP_PROFILE_NONE
+ * @return STATUS - status of operation
+ */
+STATUS dtlsSessionSetSrtpProfiles(PDtlsSession, PRTC_SRTP_PROFILE, UINT32);
 STATUS dtlsSessionGetLocalCertificateFingerprint(PDtlsSession, PCHAR, UINT32);
 STATUS dtlsSessionVerifyRemoteCertificateFingerprint(PDtlsSession, PCHAR);
 STATUS dtlsSessionPutApplicationData(PDtlsSession, PBYTE, INT32);
@@ -143,7 +166,9 @@ STATUS createCertificateAndKey(INT32, BOOL, X509 **ppCert, EVP_PKEY **ppPkey);
 STATUS freeCertificateAndKey(X509 **ppCert, EVP_PKEY **ppPkey);
 STATUS dtlsValidateRtcCertificates(PRtcCertificate, PUINT32);
 STATUS createSslCtx(PDtlsSessionCertificateInfo, UINT32, SSL_CTX**);
+STATUS createSsl(SSL_CTX*, SSL**);
 STATUS dtlsSessionChangeState(PDtlsSession, RTC_DTLS_TRANSPORT_STATE);
+STATUS dtlsGetSrtpProfileKeyLength(SRTP_PROFILE, PUINT32, PUINT32);
 
 #ifdef  __cplusplus
 }
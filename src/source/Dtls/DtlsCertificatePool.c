@@ -0,0 +1,301 @@
+#define LOG_CLASS "DtlsCertificatePool"
+#include "../Include_i.h"
+
+static PDtlsCertificatePool gDtlsCertificatePool = NULL;
+
+STATUS initDtlsCertificatePool(PDtlsCertificatePoolConfiguration pConfiguration)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pCertificatePool = NULL;
+
+    CHK(pConfiguration != NULL, STATUS_NULL_ARG);
+    CHK(pConfiguration->certificateCount <= MAX_DTLS_CERTIFICATE_POOL_SIZE, STATUS_INVALID_ARG);
+    CHK(pConfiguration->generatedCertificateBits >= 0, STATUS_SSL_INVALID_CERTIFICATE_BITS);
+    CHK(gDtlsCertificatePool == NULL, STATUS_INVALID_OPERATION);
+
+    pCertificatePool = (PDtlsCertificatePool) MEMCALLOC(1, SIZEOF(DtlsCertificatePool));
+    CHK(pCertificatePool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pCertificatePool->lock = MUTEX_CREATE(FALSE);
+    pCertificatePool->generateCvar = CVAR_CREATE();
+    pCertificatePool->generatorRoutine = INVALID_TID_VALUE;
+    ATOMIC_STORE_BOOL(&pCertificatePool->terminate, FALSE);
+
+    pCertificatePool->generateRSACertificate = pConfiguration->generateRSACertificate;
+    pCertificatePool->certificateBits =
+        pConfiguration->generatedCertificateBits == 0 ? GENERATED_CERTIFICATE_BITS : pConfiguration->generatedCertificateBits;
+    pCertificatePool->maxCertificateAge =
+        pConfiguration->maxCertificateAge == 0 ? DTLS_CERTIFICATE_POOL_DEFAULT_MAX_AGE : pConfiguration->maxCertificateAge;
+    pCertificatePool->certificateCount =
+        pConfiguration->certificateCount == 0 ? DTLS_CERTIFICATE_POOL_DEFAULT_SIZE : pConfiguration->certificateCount;
+
+    CHK_STATUS(THREAD_CREATE(&pCertificatePool->generatorRoutine, dtlsCertificatePoolGeneratorRoutine, (PVOID) pCertificatePool));
+
+    DLOGI("Generating %u %s DTLS certificates ahead of time", pCertificatePool->certificateCount,
+          pCertificatePool->generateRSACertificate ? "RSA" : "ECDSA");
+
+    gDtlsCertificatePool = pCertificatePool;
+    pCertificatePool = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (pCertificatePool != NULL) {
+        gDtlsCertificatePool = pCertificatePool;
+        deinitDtlsCertificatePool();
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS deinitDtlsCertificatePool()
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pCertificatePool = gDtlsCertificatePool;
+    UINT32 i;
+
+    CHK(pCertificatePool != NULL, retStatus);
+    gDtlsCertificatePool = NULL;
+
+    ATOMIC_STORE_BOOL(&pCertificatePool->terminate, TRUE);
+
+    if (IS_VALID_TID_VALUE(pCertificatePool->generatorRoutine)) {
+        // Signal under the lock so the generator can not miss it between checking the flag and waiting
+        MUTEX_LOCK(pCertificatePool->lock);
+        CVAR_SIGNAL(pCertificatePool->generateCvar);
+        MUTEX_UNLOCK(pCertificatePool->lock);
+
+        THREAD_JOIN(pCertificatePool->generatorRoutine, NULL);
+        pCertificatePool->generatorRoutine = INVALID_TID_VALUE;
+    }
+
+    // Sessions using the certificates hold their own references to the SSL_CTX
+    for (i = 0; i < pCertificatePool->certificateCount; i++) {
+        if (pCertificatePool->certificates[i].pSslCtx != NULL) {
+            SSL_CTX_free(pCertificatePool->certificates[i].pSslCtx);
+        }
+    }
+
+    if (IS_VALID_CVAR_VALUE(pCertificatePool->generateCvar)) {
+        CVAR_FREE(pCertificatePool->generateCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pCertificatePool->lock)) {
+        MUTEX_FREE(pCertificatePool->lock);
+    }
+
+    MEMFREE(pCertificatePool);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dtlsCertificatePoolGetSslCtx(INT32 certificateBits, BOOL generateRSACertificate, SSL_CTX** ppSslCtx, PCHAR pFingerprint)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pCertificatePool = gDtlsCertificatePool;
+    PDtlsPooledCertificate pCertificate = NULL;
+    BOOL locked = FALSE;
+    UINT32 i, index;
+
+    CHK(ppSslCtx != NULL && pFingerprint != NULL, STATUS_NULL_ARG);
+    *ppSslCtx = NULL;
+
+    CHK(pCertificatePool != NULL && pCertificatePool->generateRSACertificate == generateRSACertificate, retStatus);
+    // Key size only matters for RSA, ECDSA certificates always use prime256v1
+    CHK(!generateRSACertificate || pCertificatePool->certificateBits == certificateBits, retStatus);
+
+    MUTEX_LOCK(pCertificatePool->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pCertificatePool->certificateCount && pCertificate == NULL; i++) {
+        index = (pCertificatePool->nextCertificate + i) % pCertificatePool->certificateCount;
+        if (pCertificatePool->certificates[index].pSslCtx != NULL) {
+            pCertificate = &pCertificatePool->certificates[index];
+            pCertificatePool->nextCertificate = (index + 1) % pCertificatePool->certificateCount;
+        }
+    }
+
+    if (pCertificate == NULL) {
+        // Still generating the first ones, the session generates its own
+        pCertificatePool->missCount++;
+        CVAR_SIGNAL(pCertificatePool->generateCvar);
+        CHK(FALSE, retStatus);
+    }
+
+    // The reference is taken under the lock so the generator can not free a replaced certificate in between
+    CHK_STATUS(dtlsTakeSslCtxReference(pCertificate->pSslCtx));
+    pCertificatePool->hitCount++;
+
+    *ppSslCtx = pCertificate->pSslCtx;
+    STRCPY(pFingerprint, pCertificate->fingerprint);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCertificatePool->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dtlsCertificatePoolGetStats(PUINT32 pReadyCount, PUINT64 pHitCount, PUINT64 pMissCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pCertificatePool = gDtlsCertificatePool;
+    UINT32 i, readyCount = 0;
+
+    CHK(pCertificatePool != NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pCertificatePool->lock);
+
+    for (i = 0; i < pCertificatePool->certificateCount; i++) {
+        if (pCertificatePool->certificates[i].pSslCtx != NULL) {
+            readyCount++;
+        }
+    }
+
+    if (pReadyCount != NULL) {
+        *pReadyCount = readyCount;
+    }
+    if (pHitCount != NULL) {
+        *pHitCount = pCertificatePool->hitCount;
+    }
+    if (pMissCount != NULL) {
+        *pMissCount = pCertificatePool->missCount;
+    }
+
+    MUTEX_UNLOCK(pCertificatePool->lock);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dtlsTakeSslCtxReference(SSL_CTX* pSslCtx)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSslCtx != NULL, STATUS_NULL_ARG);
+
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+    CHK(SSL_CTX_up_ref(pSslCtx) == 1, STATUS_SSL_CTX_CREATION_FAILED);
+#else
+    CRYPTO_add(&pSslCtx->references, 1, CRYPTO_LOCK_SSL_CTX);
+#endif
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS dtlsCertificatePoolGenerate(PDtlsCertificatePool pCertificatePool, PDtlsPooledCertificate pCertificate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    DtlsSessionCertificateInfo certInfo;
+
+    MEMSET(&certInfo, 0x00, SIZEOF(DtlsSessionCertificateInfo));
+
+    CHK(pCertificatePool != NULL && pCertificate != NULL, STATUS_NULL_ARG);
+    MEMSET(pCertificate, 0x00, SIZEOF(DtlsPooledCertificate));
+
+    CHK_STATUS(createCertificateAndKey(pCertificatePool->certificateBits, pCertificatePool->generateRSACertificate, &certInfo.pCert,
+                                       &certInfo.pKey));
+    CHK_STATUS(dtlsCertificateFingerprint(certInfo.pCert, pCertificate->fingerprint));
+    CHK_STATUS(createSslCtx(&certInfo, 1, &pCertificate->pSslCtx));
+    pCertificate->createTime = GETTIME();
+
+CleanUp:
+
+    // The SSL_CTX holds its own references
+    freeCertificateAndKey(&certInfo.pCert, &certInfo.pKey);
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Fills the empty slots first and then keeps replacing the oldest certificate once it is older than the max age.
+ * Certificates are generated without holding the lock, sessions keep taking the current ones meanwhile.
+ */
+PVOID dtlsCertificatePoolGeneratorRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pCertificatePool = (PDtlsCertificatePool) arg;
+    DtlsPooledCertificate certificate;
+    SSL_CTX* pReplacedSslCtx;
+    UINT64 now, waitTime, oldestCreateTime;
+    UINT32 i, index;
+    BOOL found;
+
+    CHK(pCertificatePool != NULL, STATUS_NULL_ARG);
+
+    while (!ATOMIC_LOAD_BOOL(&pCertificatePool->terminate)) {
+        MUTEX_LOCK(pCertificatePool->lock);
+
+        found = FALSE;
+        index = 0;
+        oldestCreateTime = MAX_UINT64;
+        for (i = 0; i < pCertificatePool->certificateCount && oldestCreateTime != 0; i++) {
+            if (pCertificatePool->certificates[i].pSslCtx == NULL) {
+                index = i;
+                oldestCreateTime = 0;
+            } else if (pCertificatePool->certificates[i].createTime < oldestCreateTime) {
+                index = i;
+                oldestCreateTime = pCertificatePool->certificates[i].createTime;
+            }
+        }
+
+        now = GETTIME();
+        if (oldestCreateTime == 0 || now - oldestCreateTime >= pCertificatePool->maxCertificateAge) {
+            found = TRUE;
+        } else if (!ATOMIC_LOAD_BOOL(&pCertificatePool->terminate)) {
+            waitTime = pCertificatePool->maxCertificateAge - (now - oldestCreateTime);
+            CVAR_WAIT(pCertificatePool->generateCvar, pCertificatePool->lock, waitTime);
+        }
+
+        MUTEX_UNLOCK(pCertificatePool->lock);
+
+        if (!found) {
+            continue;
+        }
+
+        if (STATUS_FAILED(dtlsCertificatePoolGenerate(pCertificatePool, &certificate))) {
+            DLOGW("Failed to generate a DTLS certificate, retrying in %" PRIu64 " ms",
+                  DTLS_CERTIFICATE_POOL_RETRY_INTERVAL / HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            MUTEX_LOCK(pCertificatePool->lock);
+            if (!ATOMIC_LOAD_BOOL(&pCertificatePool->terminate)) {
+                CVAR_WAIT(pCertificatePool->generateCvar, pCertificatePool->lock, DTLS_CERTIFICATE_POOL_RETRY_INTERVAL);
+            }
+            MUTEX_UNLOCK(pCertificatePool->lock);
+            continue;
+        }
+
+        MUTEX_LOCK(pCertificatePool->lock);
+        pReplacedSslCtx = pCertificatePool->certificates[index].pSslCtx;
+        pCertificatePool->certificates[index] = certificate;
+        MUTEX_UNLOCK(pCertificatePool->lock);
+
+        // Sessions still using the replaced certificate keep the SSL_CTX alive until they are freed
+        if (pReplacedSslCtx != NULL) {
+            SSL_CTX_free(pReplacedSslCtx);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
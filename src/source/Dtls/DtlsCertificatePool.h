@@ -0,0 +1,88 @@
+//
+// Pool of pre-generated DTLS certificates shared by all peer connections
+//
+
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_DTLS_DTLS_CERTIFICATE_POOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_DTLS_DTLS_CERTIFICATE_POOL__
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define DTLS_CERTIFICATE_POOL_DEFAULT_SIZE              4
+#define DTLS_CERTIFICATE_POOL_DEFAULT_MAX_AGE           (1 * HUNDREDS_OF_NANOS_IN_AN_HOUR)
+
+// Wait before trying again after a certificate could not be generated
+#define DTLS_CERTIFICATE_POOL_RETRY_INTERVAL            (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+/*
+ * A ready certificate. The SSL_CTX holds the only references to the certificate and the key, every session using
+ * the certificate holds a reference to the SSL_CTX.
+ */
+typedef struct {
+    SSL_CTX *pSslCtx;
+    CHAR fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    UINT64 createTime;
+} DtlsPooledCertificate, *PDtlsPooledCertificate;
+
+typedef struct {
+    MUTEX lock;
+    // Signaled to wake the generator up early, on shutdown or when a session found no certificate ready
+    CVAR generateCvar;
+    TID generatorRoutine;
+    volatile ATOMIC_BOOL terminate;
+
+    BOOL generateRSACertificate;
+    INT32 certificateBits;
+    UINT64 maxCertificateAge;
+    UINT32 certificateCount;
+
+    // Slots without a certificate yet have a NULL SSL_CTX, sessions take the ready ones round robin
+    DtlsPooledCertificate certificates[MAX_DTLS_CERTIFICATE_POOL_SIZE];
+    UINT32 nextCertificate;
+
+    UINT64 hitCount;
+    UINT64 missCount;
+} DtlsCertificatePool, *PDtlsCertificatePool;
+
+/**
+ * Stop the generator and release the pool's references to the certificates. Sessions keep the ones they use.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS deinitDtlsCertificatePool();
+
+/**
+ * Take a reference to the SSL_CTX of a ready certificate
+ *
+ * @param - INT32 - IN - Bits of the certificate the session would generate
+ * @param - BOOL - IN - Whether the session would generate an RSA certificate
+ * @param - SSL_CTX** - OUT - SSL_CTX the caller frees, NULL when there is no pool for this kind of certificate or
+ *                            none is ready yet
+ * @param - PCHAR - OUT - Fingerprint of the certificate, CERTIFICATE_FINGERPRINT_LENGTH + 1 bytes
+ *
+ * @return - STATUS status of execution
+ */
+STATUS dtlsCertificatePoolGetSslCtx(INT32, BOOL, SSL_CTX**, PCHAR);
+
+/**
+ * Get the number of ready certificates and how many sessions found one ready
+ *
+ * @param - PUINT32 - OUT/OPT - Number of ready certificates
+ * @param - PUINT64 - OUT/OPT - Number of sessions that took a ready certificate
+ * @param - PUINT64 - OUT/OPT - Number of sessions that had to generate their own
+ *
+ * @return - STATUS status of execution, STATUS_INVALID_OPERATION if there is no pool
+ */
+STATUS dtlsCertificatePoolGetStats(PUINT32, PUINT64, PUINT64);
+
+PVOID dtlsCertificatePoolGeneratorRoutine(PVOID);
+STATUS dtlsCertificatePoolGenerate(PDtlsCertificatePool, PDtlsPooledCertificate);
+STATUS dtlsTakeSslCtxReference(SSL_CTX*);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  //__KINESIS_VIDEO_WEBRTC_CLIENT_DTLS_DTLS_CERTIFICATE_POOL__
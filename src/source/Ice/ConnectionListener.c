@@ -2,15 +2,46 @@
  * Kinesis Video Producer ConnectionListener
  */
 #define LOG_CLASS "ConnectionListener"
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// recvmmsg is a GNU extension
+#define _GNU_SOURCE
+#endif
+
 #include "../Include_i.h"
 
+// Shared by all connection listeners. Only set between initKvsWebRtc and deinitKvsWebRtc on linux.
+static PConnectionListenerEventLoopPool gConnectionListenerEventLoopPool = NULL;
+
 STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
+{
+    return createConnectionListenerWithReceiveBatchSize(CONNECTION_LISTENER_DEFAULT_RECEIVE_BATCH_SIZE, ppConnectionListener);
+}
+
+STATUS createConnectionListenerWithReceiveBatchSize(UINT32 receiveBatchSize, PConnectionListener* ppConnectionListener)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 allocationSize = SIZEOF(ConnectionListener) + MAX_UDP_PACKET_SIZE;
+    UINT32 allocationSize;
+    BOOL useEventLoop = FALSE;
     PConnectionListener pConnectionListener = NULL;
 
     CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
+    CHK(receiveBatchSize <= CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE, STATUS_INVALID_ARG);
+
+    if (receiveBatchSize == 0) {
+        receiveBatchSize = CONNECTION_LISTENER_DEFAULT_RECEIVE_BATCH_SIZE;
+    }
+
+#if defined(__linux__)
+    useEventLoop = gConnectionListenerEventLoopPool != NULL;
+#else
+    // recvmmsg is only available on linux
+    receiveBatchSize = 1;
+#endif
+
+    // Only the pages the datagrams are written into are ever touched so the batch buffers cost little in practice.
+    // Listeners served by the event loop receive into the buffers of the loop.
+    allocationSize = SIZEOF(ConnectionListener) + (useEventLoop ? 0 : receiveBatchSize * MAX_UDP_PACKET_SIZE);
 
     pConnectionListener = (PConnectionListener) MEMCALLOC(1, allocationSize);
     CHK(pConnectionListener != NULL, STATUS_NOT_ENOUGH_MEMORY);
@@ -25,8 +56,12 @@ STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
     pConnectionListener->removeConnectionComplete = CVAR_CREATE();
 
     // pConnectionListener->pBuffer starts at the end of ConnectionListener struct
-    pConnectionListener->pBuffer = (PBYTE) (pConnectionListener + 1);
+    pConnectionListener->pBuffer = useEventLoop ? NULL : (PBYTE) (pConnectionListener + 1);
     pConnectionListener->bufferLen = MAX_UDP_PACKET_SIZE;
+    pConnectionListener->receiveBatchSize = receiveBatchSize;
+    if (useEventLoop) {
+        pConnectionListener->pEventLoop = connectionListenerAcquireEventLoop();
+    }
 
 CleanUp:
 
@@ -54,6 +89,16 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
 
     ATOMIC_STORE_BOOL(&pConnectionListener->terminate, TRUE);
 
+    if (pConnectionListener->pEventLoop != NULL) {
+        // The event loop must be done with our sockets before the listener goes away
+        if (pConnectionListener->connectionList != NULL) {
+            CHK_LOG_ERR(connectionListenerDetachAllConnection(pConnectionListener, FALSE));
+        }
+
+        connectionListenerReleaseEventLoop(pConnectionListener->pEventLoop);
+        pConnectionListener->pEventLoop = NULL;
+    }
+
     if (IS_VALID_CVAR_VALUE(pConnectionListener->removeConnectionComplete)) {
         CVAR_SIGNAL(pConnectionListener->removeConnectionComplete);
     }
@@ -100,6 +145,11 @@ STATUS connectionListenerAddConnection(PConnectionListener pConnectionListener,
 
     CHK_STATUS(doubleListInsertItemHead(pConnectionListener->connectionList, (UINT64) pSocketConnection));
 
+    // Sockets added before the start are registered by connectionListenerStart
+    if (pConnectionListener->pEventLoop != NULL && ATOMIC_LOAD_BOOL(&pConnectionListener->listenerRoutineStarted)) {
+        CHK_STATUS(connectionListenerEventLoopRegister(pConnectionListener, pSocketConnection));
+    }
+
     MUTEX_UNLOCK(pConnectionListener->lock);
     locked = FALSE;
 
@@ -118,6 +168,7 @@ STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListene
 {
     STATUS retStatus = STATUS_SUCCESS, cvarWaitStatus = STATUS_SUCCESS;
     BOOL locked = FALSE;
+    PDoubleListNode pCurNode = NULL;
 
     CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
@@ -125,6 +176,25 @@ STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListene
     /* mark socket as closed. Will be cleaned up by connectionListenerReceiveDataRoutine */
     CHK_STATUS(socketConnectionClosed(pSocketConnection));
 
+    if (pConnectionListener->pEventLoop != NULL) {
+        /* returns once the event loop no longer touches the socket */
+        CHK_STATUS(connectionListenerEventLoopUnregister(pConnectionListener, pSocketConnection));
+
+        MUTEX_LOCK(pConnectionListener->lock);
+        locked = TRUE;
+
+        CHK_STATUS(doubleListGetHeadNode(pConnectionListener->connectionList, &pCurNode));
+        while (pCurNode != NULL && pCurNode->data != (UINT64) pSocketConnection) {
+            pCurNode = pCurNode->pNext;
+        }
+
+        if (pCurNode != NULL) {
+            CHK_STATUS(doubleListDeleteNode(pConnectionListener->connectionList, pCurNode));
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
     ATOMIC_STORE_BOOL(&pConnectionListener->connectionListChanged, TRUE);
 
     MUTEX_LOCK(pConnectionListener->lock);
@@ -161,6 +231,11 @@ STATUS connectionListenerRemoveAllConnection(PConnectionListener pConnectionList
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
 
+    if (pConnectionListener->pEventLoop != NULL) {
+        CHK_STATUS(connectionListenerDetachAllConnection(pConnectionListener, TRUE));
+        CHK(FALSE, retStatus);
+    }
+
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
@@ -200,9 +275,36 @@ STATUS connectionListenerStart(PConnectionListener pConnectionListener)
 {
     STATUS retStatus = STATUS_SUCCESS;
     ATOMIC_BOOL listenerRoutineStarted = FALSE;
+    BOOL locked = FALSE;
+    PDoubleListNode pCurNode = NULL;
+    PSocketConnection pSocketConnection = NULL;
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
+
+    if (pConnectionListener->pEventLoop != NULL) {
+        CHK_STATUS(connectionListenerEventLoopStart(pConnectionListener->pEventLoop));
+
+        // Flip the flag under the lock so that a concurrent connectionListenerAddConnection registers its socket
+        // exactly once
+        MUTEX_LOCK(pConnectionListener->lock);
+        locked = TRUE;
+
+        listenerRoutineStarted = ATOMIC_EXCHANGE_BOOL(&pConnectionListener->listenerRoutineStarted, TRUE);
+        CHK(!listenerRoutineStarted, retStatus);
+
+        CHK_STATUS(doubleListGetHeadNode(pConnectionListener->connectionList, &pCurNode));
+        while (pCurNode != NULL) {
+            pSocketConnection = (PSocketConnection) pCurNode->data;
+            pCurNode = pCurNode->pNext;
+            if (!socketConnectionIsClosed(pSocketConnection)) {
+                CHK_STATUS(connectionListenerEventLoopRegister(pConnectionListener, pSocketConnection));
+            }
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
     listenerRoutineStarted = ATOMIC_EXCHANGE_BOOL(&pConnectionListener->listenerRoutineStarted, TRUE);
     CHK(!listenerRoutineStarted, retStatus);
     CHK_STATUS(THREAD_CREATE(&pConnectionListener->receiveDataRoutine,
@@ -211,6 +313,55 @@ STATUS connectionListenerStart(PConnectionListener pConnectionListener)
 
 CleanUp:
 
+    if (locked) {
+        MUTEX_UNLOCK(pConnectionListener->lock);
+    }
+
+    return retStatus;
+}
+
+/*
+ * Take all connections off the listener one at a time without holding the listener lock while waiting on the event
+ * loop, since a data callback running on the loop may itself add a connection.
+ */
+STATUS connectionListenerDetachAllConnection(PConnectionListener pConnectionListener, BOOL closeConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PDoubleListNode pCurNode = NULL;
+    PSocketConnection pSocketConnection = NULL;
+
+    CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
+
+    do {
+        MUTEX_LOCK(pConnectionListener->lock);
+        locked = TRUE;
+
+        pSocketConnection = NULL;
+        CHK_STATUS(doubleListGetHeadNode(pConnectionListener->connectionList, &pCurNode));
+        if (pCurNode != NULL) {
+            pSocketConnection = (PSocketConnection) pCurNode->data;
+            CHK_STATUS(doubleListDeleteHead(pConnectionListener->connectionList));
+        }
+
+        MUTEX_UNLOCK(pConnectionListener->lock);
+        locked = FALSE;
+
+        if (pSocketConnection != NULL) {
+            if (closeConnection) {
+                CHK_STATUS(socketConnectionClosed(pSocketConnection));
+            }
+
+            CHK_STATUS(connectionListenerEventLoopUnregister(pConnectionListener, pSocketConnection));
+        }
+    } while (pSocketConnection != NULL);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pConnectionListener->lock);
+    }
+
     return retStatus;
 }
 
@@ -220,7 +371,7 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
     PConnectionListener pConnectionListener = (PConnectionListener) arg;
     PDoubleListNode pCurNode = NULL, pNodeToDelete = NULL;
     PSocketConnection pSocketConnection;
-    BOOL locked = FALSE, iterate = TRUE;
+    BOOL locked = FALSE;
     PSocketConnection socketList[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION];
     UINT32 socketCount = 0, i;
 
@@ -228,14 +379,6 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
     fd_set rfds;
     struct timeval tv;
     INT32 retval;
-    INT64 readLen;
-    // the source address is put here. sockaddr_storage can hold either sockaddr_in or sockaddr_in6
-    struct sockaddr_storage srcAddrBuff;
-    socklen_t srcAddrBuffLen = SIZEOF(srcAddrBuff);
-    struct sockaddr_in *pIpv4Addr;
-    struct sockaddr_in6 *pIpv6Addr;
-    KvsIpAddress srcAddr;
-    PKvsIpAddress pSrcAddr = NULL;
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
 
@@ -244,8 +387,6 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
      * implemented in assembly. */
     MEMSET(&rfds, 0x00, SIZEOF(fd_set));
 
-    srcAddr.isPointToPoint = FALSE;
-
     while(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate)) {
         FD_ZERO(&rfds);
         nfds = 0;
@@ -310,68 +451,15 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
 
         for (i = 0; i < socketCount; ++i) {
             pSocketConnection = socketList[i];
-            if (!socketConnectionIsClosed(pSocketConnection) && FD_ISSET(pSocketConnection->localSocket, &rfds)) {
-                iterate = TRUE;
-                while(iterate) {
-                    readLen = recvfrom(pSocketConnection->localSocket, pConnectionListener->pBuffer, pConnectionListener->bufferLen, 0,
-                                       (struct sockaddr *) &srcAddrBuff, &srcAddrBuffLen);
-                    if (readLen < 0 ) {
-                        switch (errno) {
-                            case EWOULDBLOCK:
-                                break;
-                            default:
-                                /* on any other error, close connection */
-                                CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                                DLOGD("recvfrom() failed with errno %s for socket %d", strerror(errno), pSocketConnection->localSocket);
-                                break;
-                        }
-
-                        iterate = FALSE;
-                    } else if (readLen == 0) {
-                        CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                        iterate = FALSE;
-                    } else if (/* readLen > 0 */
-                               ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) &&
-                               pSocketConnection->dataAvailableCallbackFn != NULL &&
-                               /* data could be encrypted so they need to be decrypted through socketConnectionReadData
-                                * and get the decrypted data length. */
-                               STATUS_SUCCEEDED(socketConnectionReadData(pSocketConnection,
-                                                                         pConnectionListener->pBuffer,
-                                                                         pConnectionListener->bufferLen,
-                                                                         (PUINT32) &readLen))) {
-                        if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
-                            if (srcAddrBuff.ss_family == AF_INET) {
-                                srcAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
-                                pIpv4Addr = (struct sockaddr_in *) &srcAddrBuff;
-                                MEMCPY(srcAddr.address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
-                                srcAddr.port = pIpv4Addr->sin_port;
-                            } else if (srcAddrBuff.ss_family == AF_INET6) {
-                                srcAddr.family = KVS_IP_FAMILY_TYPE_IPV6;
-                                pIpv6Addr = (struct sockaddr_in6 *) &srcAddrBuff;
-                                MEMCPY(srcAddr.address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
-                                srcAddr.port = pIpv6Addr->sin6_port;
-                            }
-                            pSrcAddr = &srcAddr;
-                        } else {
-                            // srcAddr is ignored in TCP callback handlers
-                            pSrcAddr = NULL;
-                        }
-
-                        // readLen may be 0 if SSL does not emit any application data.
-                        // in that case, no need to call dataAvailable callback
-                        if (readLen > 0) {
-                            pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData,
-                                                                       pSocketConnection,
-                                                                       pConnectionListener->pBuffer,
-                                                                       (UINT32) readLen,
-                                                                       pSrcAddr,
-                                                                       NULL); // no dest information available right now.
-                        }
-                    }
+            if (socketConnectionIsClosed(pSocketConnection) || !FD_ISSET(pSocketConnection->localSocket, &rfds)) {
+                continue;
+            }
 
-                    // reset srcAddrBuffLen to actual size
-                    srcAddrBuffLen = SIZEOF(srcAddrBuff);
-                }
+            if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP && pConnectionListener->receiveBatchSize > 1) {
+                CHK_STATUS(connectionListenerReceiveBatch(pSocketConnection, pConnectionListener->pBuffer, pConnectionListener->bufferLen,
+                                                          pConnectionListener->receiveBatchSize, NULL));
+            } else {
+                CHK_STATUS(connectionListenerReceiveData(pSocketConnection, pConnectionListener->pBuffer, pConnectionListener->bufferLen, NULL));
             }
         }
     }
@@ -388,3 +476,696 @@ CleanUp:
 
     return (PVOID) (ULONG_PTR) retStatus;
 }
+
+/*
+ * Read datagrams or stream data one recvfrom at a time into pBuffer and dispatch them until the socket has no more
+ * data. Any error other than would block closes the connection. What was read is added to pMetrics if not NULL.
+ */
+STATUS connectionListenerReceiveData(PSocketConnection pSocketConnection, PBYTE pBuffer, UINT64 bufferLen, PIoWorkerMetrics pMetrics)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL iterate = TRUE;
+    INT64 readLen;
+    // the source address is put here. sockaddr_storage can hold either sockaddr_in or sockaddr_in6
+    struct sockaddr_storage srcAddrBuff;
+    socklen_t srcAddrBuffLen = SIZEOF(srcAddrBuff);
+    KvsIpAddress srcAddr;
+    PKvsIpAddress pSrcAddr = NULL;
+
+    CHK(pSocketConnection != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+
+    srcAddr.isPointToPoint = FALSE;
+
+    while(iterate) {
+        readLen = recvfrom(pSocketConnection->localSocket, pBuffer, bufferLen, 0,
+                           (struct sockaddr *) &srcAddrBuff, &srcAddrBuffLen);
+        if (readLen < 0 ) {
+            switch (errno) {
+                case EWOULDBLOCK:
+                    break;
+                default:
+                    /* on any other error, close connection */
+                    CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                    DLOGD("recvfrom() failed with errno %s for socket %d", strerror(errno), pSocketConnection->localSocket);
+                    break;
+            }
+
+            iterate = FALSE;
+        } else if (readLen == 0) {
+            CHK_STATUS(socketConnectionClosed(pSocketConnection));
+            iterate = FALSE;
+        } else {
+            if (pMetrics != NULL) {
+                pMetrics->packetsReceived++;
+                pMetrics->bytesReceived += readLen;
+            }
+
+            if (ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) &&
+                pSocketConnection->dataAvailableCallbackFn != NULL &&
+                /* data could be encrypted so they need to be decrypted through socketConnectionReadData
+                 * and get the decrypted data length. */
+                STATUS_SUCCEEDED(socketConnectionReadData(pSocketConnection,
+                                                          pBuffer,
+                                                          (UINT32) bufferLen,
+                                                          (PUINT32) &readLen))) {
+                if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
+                    connectionListenerGetSrcAddr(&srcAddrBuff, &srcAddr);
+                    pSrcAddr = &srcAddr;
+                } else {
+                    // srcAddr is ignored in TCP callback handlers
+                    pSrcAddr = NULL;
+                }
+
+                // readLen may be 0 if SSL does not emit any application data.
+                // in that case, no need to call dataAvailable callback
+                if (readLen > 0) {
+                    pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData,
+                                                               pSocketConnection,
+                                                               pBuffer,
+                                                               (UINT32) readLen,
+                                                               pSrcAddr,
+                                                               NULL); // no dest information available right now.
+                }
+            }
+        }
+
+        // reset srcAddrBuffLen to actual size
+        srcAddrBuffLen = SIZEOF(srcAddrBuff);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Drain up to batchSize datagrams from the UDP socket per recvmmsg call into pBuffers, which holds batchSize buffers of
+ * bufferLen bytes, and dispatch them in order once the call returns. Keeps reading until the socket has no more data.
+ * What was read is added to pMetrics if not NULL.
+ */
+STATUS connectionListenerReceiveBatch(PSocketConnection pSocketConnection, PBYTE pBuffers, UINT64 bufferLen, UINT32 batchSize,
+                                      PIoWorkerMetrics pMetrics)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+#if defined(__linux__)
+    struct mmsghdr messages[CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE];
+    struct iovec iovs[CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE];
+    struct sockaddr_storage srcAddrBuffs[CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE];
+    KvsIpAddress srcAddr;
+    PBYTE pBuffer;
+    UINT32 i, readLen;
+    INT32 messageCount = batchSize;
+
+    CHK(pSocketConnection != NULL && pBuffers != NULL, STATUS_NULL_ARG);
+    CHK(batchSize > 0 && batchSize <= CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE, STATUS_INVALID_ARG);
+
+    srcAddr.isPointToPoint = FALSE;
+
+    for (i = 0; i < batchSize; i++) {
+        iovs[i].iov_base = pBuffers + i * bufferLen;
+        iovs[i].iov_len = bufferLen;
+    }
+
+    // A full batch means there might be more data waiting
+    while (messageCount == (INT32) batchSize && !socketConnectionIsClosed(pSocketConnection)) {
+        MEMSET(messages, 0x00, batchSize * SIZEOF(struct mmsghdr));
+        for (i = 0; i < batchSize; i++) {
+            messages[i].msg_hdr.msg_iov = &iovs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &srcAddrBuffs[i];
+            messages[i].msg_hdr.msg_namelen = SIZEOF(struct sockaddr_storage);
+        }
+
+        messageCount = recvmmsg(pSocketConnection->localSocket, messages, batchSize, MSG_DONTWAIT, NULL);
+        if (messageCount < 0) {
+            if (errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR) {
+                /* on any other error, close connection */
+                CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                DLOGD("recvmmsg() failed with errno %s for socket %d", strerror(errno), pSocketConnection->localSocket);
+            }
+
+            break;
+        }
+
+        for (i = 0; i < (UINT32) messageCount; i++) {
+            pBuffer = (PBYTE) iovs[i].iov_base;
+            readLen = messages[i].msg_len;
+
+            if (pMetrics != NULL) {
+                pMetrics->packetsReceived++;
+                pMetrics->bytesReceived += readLen;
+            }
+
+            if (readLen == 0 || !ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) ||
+                pSocketConnection->dataAvailableCallbackFn == NULL ||
+                STATUS_FAILED(socketConnectionReadData(pSocketConnection, pBuffer, (UINT32) bufferLen, &readLen)) ||
+                readLen == 0) {
+                continue;
+            }
+
+            connectionListenerGetSrcAddr(&srcAddrBuffs[i], &srcAddr);
+            pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData,
+                                                       pSocketConnection,
+                                                       pBuffer,
+                                                       readLen,
+                                                       &srcAddr,
+                                                       NULL); // no dest information available right now.
+        }
+    }
+
+CleanUp:
+#else
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pBuffers);
+    UNUSED_PARAM(bufferLen);
+    UNUSED_PARAM(batchSize);
+    UNUSED_PARAM(pMetrics);
+#endif
+
+    return retStatus;
+}
+
+VOID connectionListenerGetSrcAddr(struct sockaddr_storage* pSrcAddrBuff, PKvsIpAddress pSrcAddr)
+{
+    struct sockaddr_in *pIpv4Addr;
+    struct sockaddr_in6 *pIpv6Addr;
+
+    if (pSrcAddrBuff->ss_family == AF_INET) {
+        pSrcAddr->family = KVS_IP_FAMILY_TYPE_IPV4;
+        pIpv4Addr = (struct sockaddr_in *) pSrcAddrBuff;
+        MEMCPY(pSrcAddr->address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
+        pSrcAddr->port = pIpv4Addr->sin_port;
+    } else if (pSrcAddrBuff->ss_family == AF_INET6) {
+        pSrcAddr->family = KVS_IP_FAMILY_TYPE_IPV6;
+        pIpv6Addr = (struct sockaddr_in6 *) pSrcAddrBuff;
+        MEMCPY(pSrcAddr->address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
+        pSrcAddr->port = pIpv6Addr->sin6_port;
+    }
+}
+
+STATUS initConnectionListenerEventLoop(UINT32 eventLoopCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoopPool pEventLoopPool = NULL;
+
+    CHK(eventLoopCount <= MAX_IO_WORKER_COUNT, STATUS_INVALID_ARG);
+
+#if defined(__linux__)
+    UINT32 i;
+    INT64 cpuCount;
+
+    CHK(gConnectionListenerEventLoopPool == NULL, retStatus);
+
+    if (eventLoopCount == 0) {
+        cpuCount = (INT64) sysconf(_SC_NPROCESSORS_ONLN);
+        eventLoopCount = (UINT32) MIN(MAX(cpuCount, 1), MAX_IO_WORKER_COUNT);
+    }
+
+    pEventLoopPool = (PConnectionListenerEventLoopPool) MEMCALLOC(1, SIZEOF(ConnectionListenerEventLoopPool));
+    CHK(pEventLoopPool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pEventLoopPool->lock = MUTEX_CREATE(FALSE);
+
+    for (i = 0; i < eventLoopCount; i++) {
+        CHK_STATUS(createConnectionListenerEventLoop(i, &pEventLoopPool->eventLoops[i]));
+        pEventLoopPool->eventLoopCount++;
+    }
+
+    DLOGI("Receiving data of all peer connections on %u I/O workers", eventLoopCount);
+
+    gConnectionListenerEventLoopPool = pEventLoopPool;
+    pEventLoopPool = NULL;
+#endif
+
+CleanUp:
+
+    if (pEventLoopPool != NULL) {
+        gConnectionListenerEventLoopPool = pEventLoopPool;
+        deinitConnectionListenerEventLoop();
+    }
+
+    return retStatus;
+}
+
+STATUS deinitConnectionListenerEventLoop()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoopPool pEventLoopPool = gConnectionListenerEventLoopPool;
+    UINT32 i;
+
+    CHK(pEventLoopPool != NULL, retStatus);
+    gConnectionListenerEventLoopPool = NULL;
+
+    for (i = 0; i < pEventLoopPool->eventLoopCount; i++) {
+        CHK_LOG_ERR(freeConnectionListenerEventLoop(&pEventLoopPool->eventLoops[i]));
+    }
+
+    if (pEventLoopPool->lock != INVALID_MUTEX_VALUE) {
+        MUTEX_FREE(pEventLoopPool->lock);
+    }
+
+    MEMFREE(pEventLoopPool);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Pick the event loop serving the fewest peer connections, preferring the one that has been the least busy so far
+ * among those. The listener stays on it until it is freed so its packets are never handled concurrently.
+ */
+PConnectionListenerEventLoop connectionListenerAcquireEventLoop()
+{
+    PConnectionListenerEventLoopPool pEventLoopPool = gConnectionListenerEventLoopPool;
+    PConnectionListenerEventLoop pEventLoop = NULL, pCurEventLoop;
+    UINT32 i, peerConnectionCount, minPeerConnectionCount = MAX_UINT32;
+    UINT64 busyTime, minBusyTime = MAX_UINT64;
+
+    if (pEventLoopPool == NULL) {
+        return NULL;
+    }
+
+    MUTEX_LOCK(pEventLoopPool->lock);
+
+    for (i = 0; i < pEventLoopPool->eventLoopCount; i++) {
+        pCurEventLoop = pEventLoopPool->eventLoops[i];
+
+        MUTEX_LOCK(pCurEventLoop->lock);
+        peerConnectionCount = pCurEventLoop->metrics.peerConnectionCount;
+        busyTime = pCurEventLoop->metrics.busyTime;
+        MUTEX_UNLOCK(pCurEventLoop->lock);
+
+        if (peerConnectionCount < minPeerConnectionCount ||
+            (peerConnectionCount == minPeerConnectionCount && busyTime < minBusyTime)) {
+            pEventLoop = pCurEventLoop;
+            minPeerConnectionCount = peerConnectionCount;
+            minBusyTime = busyTime;
+        }
+    }
+
+    if (pEventLoop != NULL) {
+        MUTEX_LOCK(pEventLoop->lock);
+        pEventLoop->metrics.peerConnectionCount++;
+        MUTEX_UNLOCK(pEventLoop->lock);
+    }
+
+    MUTEX_UNLOCK(pEventLoopPool->lock);
+
+    return pEventLoop;
+}
+
+VOID connectionListenerReleaseEventLoop(PConnectionListenerEventLoop pEventLoop)
+{
+    if (pEventLoop == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(pEventLoop->lock);
+    pEventLoop->metrics.peerConnectionCount--;
+    MUTEX_UNLOCK(pEventLoop->lock);
+}
+
+STATUS connectionListenerGetEventLoopMetrics(PIoWorkerMetrics pMetrics, PUINT32 pCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoopPool pEventLoopPool = gConnectionListenerEventLoopPool;
+    UINT32 i, eventLoopCount;
+
+    CHK(pCount != NULL, STATUS_NULL_ARG);
+
+    eventLoopCount = pEventLoopPool == NULL ? 0 : pEventLoopPool->eventLoopCount;
+    if (pMetrics != NULL) {
+        CHK(*pCount >= eventLoopCount, STATUS_BUFFER_TOO_SMALL);
+        for (i = 0; i < eventLoopCount; i++) {
+            MUTEX_LOCK(pEventLoopPool->eventLoops[i]->lock);
+            pMetrics[i] = pEventLoopPool->eventLoops[i]->metrics;
+            MUTEX_UNLOCK(pEventLoopPool->eventLoops[i]->lock);
+        }
+    }
+
+CleanUp:
+
+    if (pCount != NULL) {
+        *pCount = eventLoopCount;
+    }
+
+    return retStatus;
+}
+
+STATUS createConnectionListenerEventLoop(UINT32 index, PConnectionListenerEventLoop* ppEventLoop)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoop pEventLoop = NULL;
+
+    CHK(ppEventLoop != NULL, STATUS_NULL_ARG);
+
+#if defined(__linux__)
+    struct epoll_event event;
+
+    pEventLoop = (PConnectionListenerEventLoop) MEMCALLOC(1, SIZEOF(ConnectionListenerEventLoop));
+    CHK(pEventLoop != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    ATOMIC_STORE_BOOL(&pEventLoop->terminate, FALSE);
+    pEventLoop->index = index;
+    pEventLoop->epollFd = -1;
+    pEventLoop->wakeupFd = -1;
+    pEventLoop->eventLoopRoutine = INVALID_TID_VALUE;
+    pEventLoop->lock = MUTEX_CREATE(FALSE);
+    pEventLoop->dispatchComplete = CVAR_CREATE();
+
+    CHK_STATUS(hashTableCreateWithParams(CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION,
+                                         CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION / 8,
+                                         &pEventLoop->registrations));
+
+    pEventLoop->pBuffer = (PBYTE) MEMALLOC(CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE * MAX_UDP_PACKET_SIZE);
+    CHK(pEventLoop->pBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pEventLoop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    CHK_ERR(pEventLoop->epollFd >= 0, STATUS_CREATE_EVENT_LOOP_FAILED, "epoll_create1() failed with errno %s", strerror(errno));
+
+    pEventLoop->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    CHK_ERR(pEventLoop->wakeupFd >= 0, STATUS_CREATE_EVENT_LOOP_FAILED, "eventfd() failed with errno %s", strerror(errno));
+
+    MEMSET(&event, 0x00, SIZEOF(struct epoll_event));
+    event.events = EPOLLIN;
+    event.data.fd = pEventLoop->wakeupFd;
+    CHK_ERR(epoll_ctl(pEventLoop->epollFd, EPOLL_CTL_ADD, pEventLoop->wakeupFd, &event) == 0, STATUS_CREATE_EVENT_LOOP_FAILED,
+            "epoll_ctl() failed with errno %s", strerror(errno));
+#endif
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pEventLoop != NULL) {
+        freeConnectionListenerEventLoop(&pEventLoop);
+    }
+
+    if (ppEventLoop != NULL) {
+        *ppEventLoop = pEventLoop;
+    }
+
+    return retStatus;
+}
+
+STATUS freeConnectionListenerEventLoopRegistration(UINT64 customData, PHashEntry pHashEntry)
+{
+    UNUSED_PARAM(customData);
+    PConnectionListenerRegistration pRegistration = (PConnectionListenerRegistration) pHashEntry->value;
+
+    SAFE_MEMFREE(pRegistration);
+
+    return STATUS_SUCCESS;
+}
+
+STATUS freeConnectionListenerEventLoop(PConnectionListenerEventLoop* ppEventLoop)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoop pEventLoop = NULL;
+    UINT32 registrationCount = 0;
+
+    CHK(ppEventLoop != NULL, STATUS_NULL_ARG);
+    CHK(*ppEventLoop != NULL, retStatus);
+
+    pEventLoop = *ppEventLoop;
+
+#if defined(__linux__)
+    UINT64 wakeup = 1;
+
+    ATOMIC_STORE_BOOL(&pEventLoop->terminate, TRUE);
+
+    if (IS_VALID_TID_VALUE(pEventLoop->eventLoopRoutine)) {
+        if (write(pEventLoop->wakeupFd, &wakeup, SIZEOF(UINT64)) < 0) {
+            DLOGW("Failed to wake up the event loop with errno %s", strerror(errno));
+        }
+
+        THREAD_JOIN(pEventLoop->eventLoopRoutine, NULL);
+        pEventLoop->eventLoopRoutine = INVALID_TID_VALUE;
+    }
+
+    if (pEventLoop->registrations != NULL) {
+        CHK_LOG_ERR(hashTableGetCount(pEventLoop->registrations, &registrationCount));
+        if (registrationCount != 0) {
+            DLOGW("%u sockets are still registered with the event loop", registrationCount);
+        }
+
+        CHK_LOG_ERR(hashTableIterateEntries(pEventLoop->registrations, 0, freeConnectionListenerEventLoopRegistration));
+        CHK_LOG_ERR(hashTableFree(pEventLoop->registrations));
+    }
+
+    if (pEventLoop->wakeupFd >= 0) {
+        close(pEventLoop->wakeupFd);
+    }
+
+    if (pEventLoop->epollFd >= 0) {
+        close(pEventLoop->epollFd);
+    }
+
+    if (pEventLoop->lock != INVALID_MUTEX_VALUE) {
+        MUTEX_FREE(pEventLoop->lock);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pEventLoop->dispatchComplete)) {
+        CVAR_FREE(pEventLoop->dispatchComplete);
+    }
+
+    SAFE_MEMFREE(pEventLoop->pBuffer);
+#else
+    UNUSED_PARAM(registrationCount);
+#endif
+
+    MEMFREE(pEventLoop);
+
+    *ppEventLoop = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+/*
+ * The loop thread is only created once the first listener starts so that processes which never open a peer connection
+ * do not pay for it.
+ */
+STATUS connectionListenerEventLoopStart(PConnectionListenerEventLoop pEventLoop)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pEventLoop != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pEventLoop->lock);
+    locked = TRUE;
+
+    CHK(!IS_VALID_TID_VALUE(pEventLoop->eventLoopRoutine), retStatus);
+    CHK_STATUS(THREAD_CREATE(&pEventLoop->eventLoopRoutine, connectionListenerEventLoopRoutine, (PVOID) pEventLoop));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pEventLoop->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS connectionListenerEventLoopRegister(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoop pEventLoop = NULL;
+    PConnectionListenerRegistration pRegistration = NULL, pStaleRegistration = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+    pEventLoop = pConnectionListener->pEventLoop;
+    CHK(pEventLoop != NULL, STATUS_INVALID_OPERATION);
+
+#if defined(__linux__)
+    struct epoll_event event;
+    UINT64 data;
+
+    pRegistration = (PConnectionListenerRegistration) MEMALLOC(SIZEOF(ConnectionListenerRegistration));
+    CHK(pRegistration != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pRegistration->pSocketConnection = pSocketConnection;
+    pRegistration->pConnectionListener = pConnectionListener;
+
+    MEMSET(&event, 0x00, SIZEOF(struct epoll_event));
+    // Edge triggered: the loop drains the socket completely on every readiness change
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = pSocketConnection->localSocket;
+
+    MUTEX_LOCK(pEventLoop->lock);
+    locked = TRUE;
+
+    // A stale entry is left behind when a socket was freed without being removed and its fd got reused
+    if (STATUS_SUCCEEDED(hashTableGet(pEventLoop->registrations, (UINT64) pSocketConnection->localSocket, &data))) {
+        pStaleRegistration = (PConnectionListenerRegistration) data;
+        SAFE_MEMFREE(pStaleRegistration);
+        pEventLoop->metrics.socketCount--;
+    }
+
+    if (epoll_ctl(pEventLoop->epollFd, EPOLL_CTL_ADD, pSocketConnection->localSocket, &event) != 0) {
+        CHK_ERR(errno == EEXIST && epoll_ctl(pEventLoop->epollFd, EPOLL_CTL_MOD, pSocketConnection->localSocket, &event) == 0,
+                STATUS_EVENT_LOOP_REGISTER_SOCKET_FAILED, "epoll_ctl() failed with errno %s for socket %d", strerror(errno),
+                pSocketConnection->localSocket);
+    }
+
+    CHK_STATUS(hashTableUpsert(pEventLoop->registrations, (UINT64) pSocketConnection->localSocket, (UINT64) pRegistration));
+    pRegistration = NULL;
+    pEventLoop->metrics.socketCount++;
+#else
+    UNUSED_PARAM(pStaleRegistration);
+#endif
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pEventLoop->lock);
+    }
+
+    SAFE_MEMFREE(pRegistration);
+
+    return retStatus;
+}
+
+/*
+ * Once this returns the event loop does not touch pSocketConnection anymore so the caller is free to release it.
+ * Called from the event loop itself (e.g. in a data callback) it returns right away as no dispatch can be in flight.
+ */
+STATUS connectionListenerEventLoopUnregister(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS, cvarWaitStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoop pEventLoop = NULL;
+    PConnectionListenerRegistration pRegistration = NULL;
+    BOOL locked = FALSE;
+    UINT64 data;
+
+    CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+    pEventLoop = pConnectionListener->pEventLoop;
+    CHK(pEventLoop != NULL, retStatus);
+
+#if defined(__linux__)
+    MUTEX_LOCK(pEventLoop->lock);
+    locked = TRUE;
+
+    if (STATUS_SUCCEEDED(hashTableGet(pEventLoop->registrations, (UINT64) pSocketConnection->localSocket, &data))) {
+        pRegistration = (PConnectionListenerRegistration) data;
+        if (pRegistration->pSocketConnection == pSocketConnection) {
+            CHK_STATUS(hashTableRemove(pEventLoop->registrations, (UINT64) pSocketConnection->localSocket));
+            // fails harmlessly if the socket is already closed as that drops it from the epoll set
+            epoll_ctl(pEventLoop->epollFd, EPOLL_CTL_DEL, pSocketConnection->localSocket, NULL);
+            SAFE_MEMFREE(pRegistration);
+            pEventLoop->metrics.socketCount--;
+        }
+    }
+
+    // Only a dispatch to this very socket can still be using it, the other sockets of the loop are not waited for
+    if (pEventLoop->eventLoopRoutine != GETTID()) {
+        while (pEventLoop->pDispatchingSocket == pSocketConnection && STATUS_SUCCEEDED(cvarWaitStatus)) {
+            cvarWaitStatus = CVAR_WAIT(pEventLoop->dispatchComplete, pEventLoop->lock, CONNECTION_AWAIT_CONNECTION_REMOVAL_TIMEOUT);
+            /* CVAR_WAIT should never time out */
+            if (STATUS_FAILED(cvarWaitStatus)) {
+                DLOGW("CVAR_WAIT() failed with 0x%08x", cvarWaitStatus);
+            }
+        }
+    }
+#else
+    UNUSED_PARAM(pRegistration);
+    UNUSED_PARAM(data);
+    UNUSED_PARAM(cvarWaitStatus);
+#endif
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pEventLoop->lock);
+    }
+
+    return retStatus;
+}
+
+PVOID connectionListenerEventLoopRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerEventLoop pEventLoop = (PConnectionListenerEventLoop) arg;
+
+    CHK(pEventLoop != NULL, STATUS_NULL_ARG);
+
+#if defined(__linux__)
+    struct epoll_event events[CONNECTION_LISTENER_EVENT_LOOP_MAX_EVENTS];
+    ConnectionListenerRegistration registration;
+    PSocketConnection pSocketConnection;
+    IoWorkerMetrics dispatchMetrics;
+    INT32 eventCount, i;
+    UINT64 data, wakeup, dispatchStartTime;
+    BOOL found;
+
+    while (!ATOMIC_LOAD_BOOL(&pEventLoop->terminate)) {
+        // blocking call, deinit wakes us up through the eventfd
+        eventCount = epoll_wait(pEventLoop->epollFd, events, ARRAY_SIZE(events), -1);
+        if (eventCount < 0) {
+            if (errno != EINTR) {
+                DLOGE("epoll_wait() failed with errno %s", strerror(errno));
+            }
+
+            continue;
+        }
+
+        MEMSET(&dispatchMetrics, 0x00, SIZEOF(IoWorkerMetrics));
+        dispatchStartTime = GETTIME_MONOTONIC();
+
+        for (i = 0; i < eventCount; i++) {
+            if (events[i].data.fd == pEventLoop->wakeupFd) {
+                if (read(pEventLoop->wakeupFd, &wakeup, SIZEOF(UINT64)) < 0) {
+                    DLOGW("Failed to reset the event loop wakeup with errno %s", strerror(errno));
+                }
+
+                continue;
+            }
+
+            // Copy the registration out as it can be unregistered while the socket is being drained. Unregistering
+            // the socket waits for this dispatch to complete so the socket and its listener stay valid until then.
+            MUTEX_LOCK(pEventLoop->lock);
+            found = STATUS_SUCCEEDED(hashTableGet(pEventLoop->registrations, (UINT64) events[i].data.fd, &data));
+            if (found) {
+                registration = *(PConnectionListenerRegistration) data;
+                pEventLoop->pDispatchingSocket = registration.pSocketConnection;
+            }
+            MUTEX_UNLOCK(pEventLoop->lock);
+
+            if (!found) {
+                continue;
+            }
+
+            pSocketConnection = registration.pSocketConnection;
+            if (socketConnectionIsClosed(pSocketConnection)) {
+                // Nothing is read from closed sockets, stop waking up for them
+                CHK_LOG_ERR(connectionListenerEventLoopUnregister(registration.pConnectionListener, pSocketConnection));
+            } else if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP && registration.pConnectionListener->receiveBatchSize > 1) {
+                CHK_LOG_ERR(connectionListenerReceiveBatch(pSocketConnection, pEventLoop->pBuffer, MAX_UDP_PACKET_SIZE,
+                                                           registration.pConnectionListener->receiveBatchSize, &dispatchMetrics));
+            } else {
+                CHK_LOG_ERR(connectionListenerReceiveData(pSocketConnection, pEventLoop->pBuffer, MAX_UDP_PACKET_SIZE, &dispatchMetrics));
+            }
+
+            MUTEX_LOCK(pEventLoop->lock);
+            pEventLoop->pDispatchingSocket = NULL;
+            CVAR_BROADCAST(pEventLoop->dispatchComplete);
+            MUTEX_UNLOCK(pEventLoop->lock);
+        }
+
+        MUTEX_LOCK(pEventLoop->lock);
+        pEventLoop->metrics.packetsReceived += dispatchMetrics.packetsReceived;
+        pEventLoop->metrics.bytesReceived += dispatchMetrics.bytesReceived;
+        pEventLoop->metrics.busyTime += GETTIME_MONOTONIC() - dispatchStartTime;
+        MUTEX_UNLOCK(pEventLoop->lock);
+    }
+#endif
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
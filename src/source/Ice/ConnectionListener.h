@@ -14,8 +14,50 @@ extern "C" {
 #define SOCKET_WAIT_FOR_DATA_TIMEOUT_SECONDS                        1
 #define CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION        64
 
+// Number of datagrams drained from a UDP socket per recvmmsg call. 1 disables batching
+#define CONNECTION_LISTENER_DEFAULT_RECEIVE_BATCH_SIZE              16
+#define CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE                  64
+
 #define CONNECTION_AWAIT_CONNECTION_REMOVAL_TIMEOUT                 5 * HUNDREDS_OF_NANOS_IN_A_SECOND
 
+// Max number of ready sockets picked up by one epoll_wait of the event loop
+#define CONNECTION_LISTENER_EVENT_LOOP_MAX_EVENTS                   64
+
+/*
+ * Edge triggered epoll reactor serving the sockets of the connection listeners assigned to it, one per I/O worker so
+ * that the number of receive threads does not grow with the number of peer connections. Sockets are looked up by fd
+ * in registrations on every event, removal waits for an in flight dispatch to that socket to finish so the socket can
+ * be freed as soon as removal returns, without waiting on the callbacks of the other sockets of the loop. The eventfd wakes the loop up on shutdown.
+ */
+typedef struct {
+    volatile ATOMIC_BOOL terminate;
+    UINT32 index;
+    INT32 epollFd;
+    INT32 wakeupFd;
+    TID eventLoopRoutine;
+    MUTEX lock;
+    // Broadcast whenever the loop is done draining a socket
+    CVAR dispatchComplete;
+    // Socket being drained outside of the lock, removing it waits for the drain to finish
+    PSocketConnection pDispatchingSocket;
+    // fd to PConnectionListenerRegistration
+    PHashTable registrations;
+    // CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE receive buffers of MAX_UDP_PACKET_SIZE bytes
+    PBYTE pBuffer;
+    // Load of the worker, protected by lock
+    IoWorkerMetrics metrics;
+} ConnectionListenerEventLoop, *PConnectionListenerEventLoop;
+
+/*
+ * Fixed set of event loops, one thread each, shared by all connection listeners of the process. A listener is bound
+ * to one loop for its lifetime so the data of a peer connection is always handled in order by the same thread.
+ */
+typedef struct {
+    MUTEX lock;
+    UINT32 eventLoopCount;
+    PConnectionListenerEventLoop eventLoops[MAX_IO_WORKER_COUNT];
+} ConnectionListenerEventLoopPool, *PConnectionListenerEventLoopPool;
+
 typedef struct {
     volatile ATOMIC_BOOL terminate;
     volatile ATOMIC_BOOL listenerRoutineStarted;
@@ -23,11 +65,20 @@ typedef struct {
     PDoubleList connectionList;
     MUTEX lock;
     TID receiveDataRoutine;
+    // receiveBatchSize consecutive receive buffers of bufferLen bytes each, starting at pBuffer
     PBYTE pBuffer;
     UINT64 bufferLen;
+    UINT32 receiveBatchSize;
     CVAR removeConnectionComplete;
+    // Event loop serving the sockets instead of a receiveDataRoutine of our own. NULL when no event loop is available
+    PConnectionListenerEventLoop pEventLoop;
 } ConnectionListener, *PConnectionListener;
 
+typedef struct {
+    PSocketConnection pSocketConnection;
+    PConnectionListener pConnectionListener;
+} ConnectionListenerRegistration, *PConnectionListenerRegistration;
+
 /**
  * allocate the ConnectionListener struct
  *
@@ -37,6 +88,16 @@ typedef struct {
  */
 STATUS createConnectionListener(PConnectionListener*);
 
+/**
+ * allocate the ConnectionListener struct with a given UDP receive batch depth
+ *
+ * @param - UINT32 - IN - max number of datagrams received per UDP socket read. Use default if 0.
+ * @param - PConnectionListener* - IN/OUT - pointer to PConnectionListener being allocated
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createConnectionListenerWithReceiveBatchSize(UINT32, PConnectionListener*);
+
 /**
  * free the ConnectionListener struct and all its resources
  *
@@ -85,10 +146,50 @@ STATUS connectionListenerRemoveAllConnection(PConnectionListener);
  */
 STATUS connectionListenerStart(PConnectionListener);
 
+/**
+ * Create the process wide event loops, called from initKvsWebRtc. The thread of a loop is started by the first
+ * listener on it that starts. Listeners created while there are no event loops run their own receive thread.
+ *
+ * @param - UINT32 - IN - Number of event loops, 0 for one per online CPU core
+ *
+ * @return - STATUS status of execution
+ */
+STATUS initConnectionListenerEventLoop(UINT32);
+
+/**
+ * Stop and free the process wide event loops, called from deinitKvsWebRtc. All listeners must have been freed.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS deinitConnectionListenerEventLoop();
+
+/**
+ * Copy the load of every event loop
+ *
+ * @param - PIoWorkerMetrics - OUT/OPT - one entry per event loop
+ * @param - PUINT32 - IN/OUT - capacity of the array in, number of event loops out
+ *
+ * @return - STATUS status of execution
+ */
+STATUS connectionListenerGetEventLoopMetrics(PIoWorkerMetrics, PUINT32);
+
 ////////////////////////////////////////////
 // internal functionalities
 ////////////////////////////////////////////
 PVOID connectionListenerReceiveDataRoutine(PVOID arg);
+STATUS createConnectionListenerEventLoop(UINT32, PConnectionListenerEventLoop*);
+STATUS freeConnectionListenerEventLoop(PConnectionListenerEventLoop*);
+STATUS freeConnectionListenerEventLoopRegistration(UINT64, PHashEntry);
+STATUS connectionListenerEventLoopStart(PConnectionListenerEventLoop);
+PConnectionListenerEventLoop connectionListenerAcquireEventLoop();
+VOID connectionListenerReleaseEventLoop(PConnectionListenerEventLoop);
+PVOID connectionListenerEventLoopRoutine(PVOID arg);
+STATUS connectionListenerEventLoopRegister(PConnectionListener, PSocketConnection);
+STATUS connectionListenerEventLoopUnregister(PConnectionListener, PSocketConnection);
+STATUS connectionListenerDetachAllConnection(PConnectionListener, BOOL);
+STATUS connectionListenerReceiveData(PSocketConnection, PBYTE, UINT64, PIoWorkerMetrics);
+STATUS connectionListenerReceiveBatch(PSocketConnection, PBYTE, UINT64, UINT32, PIoWorkerMetrics);
+VOID connectionListenerGetSrcAddr(struct sockaddr_storage*, PKvsIpAddress);
 
 #ifdef  __cplusplus
 }
@@ -33,6 +33,7 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     ATOMIC_STORE_BOOL(&pIceAgent->restart, FALSE);
     ATOMIC_STORE_BOOL(&pIceAgent->processStun, TRUE);
     pIceAgent->isControlling = FALSE;
+    pIceAgent->candidateReportsHeld = FALSE;
     pIceAgent->tieBreaker = (UINT64) RAND();
     pIceAgent->iceTransportPolicy = pRtcConfiguration->iceTransportPolicy;
     pIceAgent->kvsRtcConfiguration = pRtcConfiguration->kvsRtcConfiguration;
@@ -554,6 +555,74 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceAgentHoldCandidateReports(PIceAgent pIceAgent, BOOL hold)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    IceCandidate newLocalCandidates[KVS_ICE_MAX_NEW_LOCAL_CANDIDATES_TO_REPORT_AT_ONCE];
+    UINT32 newLocalCandidateCount = ARRAY_SIZE(newLocalCandidates), i;
+    BOOL locked = FALSE, gatheringFinished = FALSE;
+    PDoubleListNode pCurNode = NULL;
+    UINT64 data;
+    PIceCandidate pIceCandidate = NULL;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pIceAgent->lock);
+    locked = TRUE;
+
+    /* The gathering timer reports everything on its next run, unless it already stopped while the reports were held.
+     * Both sides decide under the lock so the end of gathering is reported exactly once. */
+    gatheringFinished = pIceAgent->candidateReportsHeld && !hold && ATOMIC_LOAD_BOOL(&pIceAgent->agentStartGathering) &&
+        !ATOMIC_LOAD_BOOL(&pIceAgent->shutdown) && pIceAgent->iceCandidateGatheringTimerTask == UINT32_MAX;
+    pIceAgent->candidateReportsHeld = hold;
+
+    MUTEX_UNLOCK(pIceAgent->lock);
+    locked = FALSE;
+
+    CHK(gatheringFinished, retStatus);
+
+    while (newLocalCandidateCount == ARRAY_SIZE(newLocalCandidates)) {
+        newLocalCandidateCount = 0;
+
+        MUTEX_LOCK(pIceAgent->lock);
+        locked = TRUE;
+
+        CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
+        while (pCurNode != NULL && newLocalCandidateCount < ARRAY_SIZE(newLocalCandidates)) {
+            CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
+            pCurNode = pCurNode->pNext;
+            pIceCandidate = (PIceCandidate) data;
+
+            if (pIceCandidate->state == ICE_CANDIDATE_STATE_VALID && !pIceCandidate->reported) {
+                newLocalCandidates[newLocalCandidateCount++] = *pIceCandidate;
+                pIceCandidate->reported = TRUE;
+            }
+        }
+
+        MUTEX_UNLOCK(pIceAgent->lock);
+        locked = FALSE;
+
+        for (i = 0; i < newLocalCandidateCount; ++i) {
+            CHK_STATUS(iceAgentReportNewLocalCandidate(pIceAgent, &newLocalCandidates[i]));
+        }
+    }
+
+    ATOMIC_STORE_BOOL(&pIceAgent->candidateGatheringFinished, TRUE);
+    if (pIceAgent->iceAgentCallbacks.newLocalCandidateFn != NULL) {
+        pIceAgent->iceAgentCallbacks.newLocalCandidateFn(pIceAgent->iceAgentCallbacks.customData, NULL);
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (locked) {
+        MUTEX_UNLOCK(pIceAgent->lock);
+    }
+
+    return retStatus;
+}
+
 STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -590,7 +659,12 @@ STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
                                  pTurnConnection,
                                  isRelay);
 
-    if (STATUS_FAILED(retStatus)) {
+    if (STATUS_SUCCEEDED(retStatus)) {
+        ATOMIC_INCREMENT(&pIceAgent->packetsSent);
+        ATOMIC_ADD(&pIceAgent->bytesSent, bufferLen);
+    } else {
+        ATOMIC_INCREMENT(&pIceAgent->packetsDiscardedOnSend);
+        ATOMIC_ADD(&pIceAgent->bytesDiscardedOnSend, bufferLen);
         DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
 
         if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
@@ -610,6 +684,72 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceAgentSendPacketBatch(PIceAgent pIceAgent, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, isRelay = FALSE;
+    PTurnConnection pTurnConnection = NULL;
+    UINT32 i, batchLen = 0;
+
+    CHK(pIceAgent != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(count != 0, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pIceAgent->lock);
+    locked = TRUE;
+
+    /* Do not proceed if ice is shutting down */
+    CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
+
+    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair != NULL, retStatus, "No valid ice candidate pair available to send data");
+    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED,
+             retStatus, "Invalid state for data sending candidate pair.");
+
+    pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime = GETTIME();
+
+    isRelay = IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceAgent->pDataSendingIceCandidatePair);
+    if (isRelay) {
+        CHK_ERR(pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection != NULL,
+                STATUS_NULL_ARG, "Candidate is relay but pTurnConnection is NULL");
+        pTurnConnection = pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection;
+    }
+
+    retStatus = iceUtilsSendDataBatch(ppBuffers,
+                                      pBufferLens,
+                                      count,
+                                      &pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress,
+                                      pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection,
+                                      pTurnConnection,
+                                      isRelay);
+
+    for (i = 0; i < count; i++) {
+        batchLen += pBufferLens[i];
+    }
+
+    if (STATUS_SUCCEEDED(retStatus)) {
+        ATOMIC_ADD(&pIceAgent->packetsSent, count);
+        ATOMIC_ADD(&pIceAgent->bytesSent, batchLen);
+    } else {
+        ATOMIC_ADD(&pIceAgent->packetsDiscardedOnSend, count);
+        ATOMIC_ADD(&pIceAgent->bytesDiscardedOnSend, batchLen);
+        DLOGW("iceUtilsSendDataBatch failed with 0x%08x", retStatus);
+
+        if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
+            DLOGW("IceAgent connection closed unexpectedly");
+            pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
+            pIceAgent->pDataSendingIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+        }
+        retStatus = STATUS_SUCCESS;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pIceAgent->lock);
+    }
+
+    return retStatus;
+}
+
 STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent pIceAgent, PSdpMediaDescription pSdpMediaDescription, UINT32 attrBufferLen, PUINT32 pIndex)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -1413,7 +1553,7 @@ STATUS iceAgentGatherCandidateTimerCallback(UINT32 timerId, UINT64 currentTime,
     IceCandidate newLocalCandidates[KVS_ICE_MAX_NEW_LOCAL_CANDIDATES_TO_REPORT_AT_ONCE];
     UINT32 newLocalCandidateCount = 0;
     PIceAgent pIceAgent = (PIceAgent) customData;
-    BOOL locked = FALSE, stopScheduling = FALSE;
+    BOOL locked = FALSE, stopScheduling = FALSE, reportsHeld = FALSE;
     PDoubleListNode pCurNode = NULL;
     UINT64 data;
     PIceCandidate pIceCandidate = NULL;
@@ -1427,6 +1567,9 @@ STATUS iceAgentGatherCandidateTimerCallback(UINT32 timerId, UINT64 currentTime,
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
+    // Held candidates stay unreported, iceAgentHoldCandidateReports reports them if gathering is over by then
+    reportsHeld = pIceAgent->candidateReportsHeld;
+
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
     while (pCurNode != NULL) {
         CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
@@ -1461,7 +1604,7 @@ STATUS iceAgentGatherCandidateTimerCallback(UINT32 timerId, UINT64 currentTime,
     }
 
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
-    while (pCurNode != NULL && newLocalCandidateCount < ARRAY_SIZE(newLocalCandidates)) {
+    while (!reportsHeld && pCurNode != NULL && newLocalCandidateCount < ARRAY_SIZE(newLocalCandidates)) {
         CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
         pCurNode = pCurNode->pNext;
         pIceCandidate = (PIceCandidate) data;
@@ -1481,7 +1624,7 @@ STATUS iceAgentGatherCandidateTimerCallback(UINT32 timerId, UINT64 currentTime,
         CHK_STATUS(iceAgentReportNewLocalCandidate(pIceAgent, &newLocalCandidates[i]));
     }
 
-    if (stopScheduling) {
+    if (stopScheduling && !reportsHeld) {
         ATOMIC_STORE_BOOL(&pIceAgent->candidateGatheringFinished, TRUE);
         /* notify that candidate gathering is finished. */
         if (pIceAgent->iceAgentCallbacks.newLocalCandidateFn != NULL) {
@@ -1875,6 +2018,8 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
 
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
             pIceAgent->pDataSendingIceCandidatePair = pIceCandidatePair;
+            ATOMIC_INCREMENT(&pIceAgent->selectedCandidatePairChanges);
+            ATOMIC_STORE(&pIceAgent->selectedCandidatePairRoundTripTime, (SIZE_T) pIceCandidatePair->roundTripTime);
             break;
         }
     }
@@ -1977,7 +2122,11 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
 
     CHK(pNominatedAndValidCandidatePair != NULL, STATUS_ICE_NO_NOMINATED_VALID_CANDIDATE_PAIR_AVAILABLE);
 
-    pIceAgent->pDataSendingIceCandidatePair = pNominatedAndValidCandidatePair;
+    if (pIceAgent->pDataSendingIceCandidatePair != pNominatedAndValidCandidatePair) {
+        pIceAgent->pDataSendingIceCandidatePair = pNominatedAndValidCandidatePair;
+        ATOMIC_INCREMENT(&pIceAgent->selectedCandidatePairChanges);
+    }
+    ATOMIC_STORE(&pIceAgent->selectedCandidatePairRoundTripTime, (SIZE_T) pNominatedAndValidCandidatePair->roundTripTime);
     CHK_STATUS(getIpAddrStr(&pIceAgent->pDataSendingIceCandidatePair->local->ipAddress,
                             ipAddrStr,
                             ARRAY_SIZE(ipAddrStr)));
@@ -2157,6 +2306,8 @@ STATUS incomingDataHandler(UINT64 customData, PSocketConnection pSocketConnectio
         // release lock early
         MUTEX_UNLOCK(pIceAgent->lock);
         locked = FALSE;
+        ATOMIC_INCREMENT(&pIceAgent->packetsReceived);
+        ATOMIC_ADD(&pIceAgent->bytesReceived, bufferLen);
         pIceAgent->iceAgentCallbacks.inboundPacketFn(pIceAgent->iceAgentCallbacks.customData, pBuffer, bufferLen);
     } else {
         if (ATOMIC_LOAD_BOOL(&pIceAgent->processStun)) {
@@ -152,6 +152,9 @@ struct __IceAgent {
 
     MUTEX lock;
 
+    // Gathered candidates are not reported while the agent of a pre-warmed peer connection waits in a pool. Protected by lock
+    BOOL candidateReportsHeld;
+
     // timer tasks
     UINT32 iceAgentStateTimerTask;
     UINT32 keepAliveTimerTask;
@@ -166,6 +169,17 @@ struct __IceAgent {
     UINT64 candidateGatheringEndTime;
     PIceCandidatePair pDataSendingIceCandidatePair;
 
+    // Data packets, STUN excluded. Updated with atomics so that collecting stats does not take the agent lock
+    volatile SIZE_T packetsSent;
+    volatile SIZE_T bytesSent;
+    volatile SIZE_T packetsDiscardedOnSend;
+    volatile SIZE_T bytesDiscardedOnSend;
+    volatile SIZE_T packetsReceived;
+    volatile SIZE_T bytesReceived;
+    volatile SIZE_T selectedCandidatePairChanges;
+    // Round trip time of pDataSendingIceCandidatePair when it was selected
+    volatile SIZE_T selectedCandidatePairRoundTripTime;
+
     IceAgentCallbacks iceAgentCallbacks;
 
     IceServer iceServers[KVS_ICE_MAX_ICE_SERVERS];
@@ -251,6 +265,17 @@ STATUS iceAgentStartAgent(PIceAgent, PCHAR, PCHAR, BOOL);
  */
 STATUS iceAgentStartGathering(PIceAgent);
 
+/**
+ * Hold back or resume reporting gathered candidates through newLocalCandidateFn. Gathering itself goes on while reports
+ * are held. On resume every candidate gathered meanwhile is reported, followed by the end of gathering if it is over.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - BOOL - IN - Whether to hold the reports
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentHoldCandidateReports(PIceAgent, BOOL);
+
 /**
  * Serialize a candidate for Trickle ICE or exchange via SDP
  *
@@ -273,6 +298,19 @@ STATUS iceCandidateSerialize(PIceCandidate, PCHAR, PUINT32);
  */
 STATUS iceAgentSendPacket(PIceAgent, PBYTE, UINT32);
 
+/**
+ * Send a batch of packets through selected connection taking the agent lock once. Packets are batched down to the
+ * socket for direct pairs and sent one by one for relayed pairs.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - PBYTE* - IN - buffers storing the data to be sent
+ * @param - PUINT32 - IN - length of each buffer
+ * @param - UINT32 - IN - number of buffers
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentSendPacketBatch(PIceAgent, PBYTE*, PUINT32, UINT32);
+
 /**
  * gather local ip addresses and create a udp port. If port creation succeeded then create a new candidate
  * and store it in localCandidates. Ips that are already a local candidate will not be added again.
@@ -185,6 +185,36 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceUtilsSendDataBatch(PBYTE* ppBuffers, PUINT32 pSizes, UINT32 count,
+                             PKvsIpAddress pDest, PSocketConnection pSocketConnection, PTurnConnection pTurnConnection,
+                             BOOL useTurn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i;
+
+    CHK(ppBuffers != NULL && pSizes != NULL, STATUS_NULL_ARG);
+    CHK((pSocketConnection != NULL && !useTurn) || (pTurnConnection != NULL && useTurn), STATUS_INVALID_ARG);
+
+    if (useTurn) {
+        // Every packet is wrapped in its own channel data message, so relayed packets are sent one by one
+        for (i = 0; i < count && STATUS_SUCCEEDED(retStatus); i++) {
+            retStatus = turnConnectionSendData(pTurnConnection, ppBuffers[i], pSizes[i], pDest);
+        }
+    } else {
+        retStatus = socketConnectionSendDataBatch(pSocketConnection, ppBuffers, pSizes, count, pDest);
+    }
+
+    // Fix-up the not-yet-ready socket
+    CHK(STATUS_SUCCEEDED(retStatus) || retStatus == STATUS_SOCKET_CONNECTION_NOT_READY_TO_SEND, retStatus);
+    retStatus = STATUS_SUCCESS;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
 STATUS parseIceServer(PIceServer pIceServer, PCHAR url, PCHAR username, PCHAR credential)
 {
     ENTERS();
@@ -2,6 +2,12 @@
  * Kinesis Video Tcp
  */
 #define LOG_CLASS "SocketConnection"
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// sendmmsg is a GNU extension
+#define _GNU_SOURCE
+#endif
+
 #include "../Include_i.h"
 
 STATUS createSocketConnection(PKvsIpAddress pHostIpAddr, PKvsIpAddress pPeerIpAddr, KVS_SOCKET_PROTOCOL protocol,
@@ -35,6 +41,9 @@ STATUS createSocketConnection(PKvsIpAddress pHostIpAddr, PKvsIpAddress pPeerIpAd
     pSocketConnection->dataAvailableCallbackCustomData = customData;
     pSocketConnection->dataAvailableCallbackFn = dataAvailableFn;
     pSocketConnection->tlsHandshakeStartTime = INVALID_TIMESTAMP_VALUE;
+#if defined(__linux__)
+    pSocketConnection->gsoEnabled = (protocol == KVS_SOCKET_PROTOCOL_UDP);
+#endif
 
 CleanUp:
 
@@ -231,6 +240,46 @@ CleanUp:
     return retStatus;
 }
 
+STATUS socketConnectionSendDataBatch(PSocketConnection pSocketConnection, PBYTE* ppBufs, PUINT32 pBufLens, UINT32 bufCount, PKvsIpAddress pDestIp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL, STATUS_NULL_ARG);
+    CHK(bufCount > 0, STATUS_INVALID_ARG);
+
+    // Only plain UDP datagrams can be batched, TCP goes through the regular path which also handles TLS
+    if (pSocketConnection->protocol != KVS_SOCKET_PROTOCOL_UDP) {
+        for (i = 0; i < bufCount; i++) {
+            CHK_STATUS(socketConnectionSendData(pSocketConnection, ppBufs[i], pBufLens[i], pDestIp));
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
+    CHK(pDestIp != NULL, STATUS_INVALID_ARG);
+
+    // Using a single CHK_WARN might output too much spew in bad network conditions
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->connectionClosed)) {
+        DLOGD("Warning: Failed to send data. Socket closed already");
+        CHK(FALSE, STATUS_SOCKET_CONNECTION_CLOSED_ALREADY);
+    }
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    locked = TRUE;
+
+    CHK_STATUS(socketSendDataBatchWithRetry(pSocketConnection, ppBufs, pBufLens, bufCount, pDestIp, NULL));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    return retStatus;
+}
+
 STATUS socketConnectionReadData(PSocketConnection pSocketConnection, PBYTE pBuf, UINT32 bufferLen, PUINT32 pDataLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -449,3 +498,158 @@ CleanUp:
 
     return retStatus;
 }
+
+STATUS socketSendDataBatchWithRetry(PSocketConnection pSocketConnection, PBYTE* ppBufs, PUINT32 pBufLens, UINT32 bufCount,
+                                    PKvsIpAddress pDestIp, PUINT32 pPacketsWritten)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetsWritten = 0;
+
+#if defined(__linux__)
+    INT32 socketWriteAttempt = 0, result = 0;
+    UINT32 i, index, messageCount, iovCount, runLength, segmentSize;
+    BOOL usedGso = FALSE, shorterSegment;
+    struct mmsghdr messages[SOCKET_SEND_BATCH_MAX_PACKETS];
+    struct iovec iovs[SOCKET_SEND_BATCH_MAX_PACKETS];
+    union {
+        CHAR buffer[CMSG_SPACE(SIZEOF(UINT16))];
+        struct cmsghdr align;
+    } controls[SOCKET_SEND_BATCH_MAX_PACKETS];
+    struct cmsghdr* pCmsg;
+    fd_set wfds;
+    struct timeval tv;
+    socklen_t addrLen = 0;
+    struct sockaddr *destAddr = NULL;
+    struct sockaddr_in ipv4Addr;
+    struct sockaddr_in6 ipv6Addr;
+
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL && pDestIp != NULL, STATUS_NULL_ARG);
+
+    if (IS_IPV4_ADDR(pDestIp)) {
+        addrLen = SIZEOF(ipv4Addr);
+        MEMSET(&ipv4Addr, 0x00, SIZEOF(ipv4Addr));
+        ipv4Addr.sin_family = AF_INET;
+        ipv4Addr.sin_port = pDestIp->port;
+        MEMCPY(&ipv4Addr.sin_addr, pDestIp->address, IPV4_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr *) &ipv4Addr;
+
+    } else {
+        addrLen = SIZEOF(ipv6Addr);
+        MEMSET(&ipv6Addr, 0x00, SIZEOF(ipv6Addr));
+        ipv6Addr.sin6_family = AF_INET6;
+        ipv6Addr.sin6_port = pDestIp->port;
+        MEMCPY(&ipv6Addr.sin6_addr, pDestIp->address, IPV6_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr *) &ipv6Addr;
+    }
+
+    while (socketWriteAttempt < MAX_SOCKET_WRITE_RETRY && packetsWritten < bufCount) {
+        MEMSET(messages, 0x00, SIZEOF(messages));
+        messageCount = 0;
+        iovCount = 0;
+        usedGso = FALSE;
+
+        for (index = packetsWritten; index < bufCount && iovCount < SOCKET_SEND_BATCH_MAX_PACKETS; index += runLength) {
+            // With GSO a run of same sized packets, optionally ending with a shorter one, goes out as a single message
+            // which the kernel splits back into datagrams at the segment size
+            segmentSize = pBufLens[index];
+            runLength = 1;
+            shorterSegment = FALSE;
+            while (pSocketConnection->gsoEnabled && !shorterSegment && index + runLength < bufCount &&
+                   iovCount + runLength < SOCKET_SEND_BATCH_MAX_PACKETS && runLength < SOCKET_GSO_MAX_SEGMENTS &&
+                   (runLength + 1) * segmentSize <= SOCKET_GSO_MAX_PAYLOAD_SIZE && pBufLens[index + runLength] <= segmentSize) {
+                shorterSegment = pBufLens[index + runLength] < segmentSize;
+                runLength++;
+            }
+
+            for (i = 0; i < runLength; i++) {
+                iovs[iovCount + i].iov_base = ppBufs[index + i];
+                iovs[iovCount + i].iov_len = pBufLens[index + i];
+            }
+
+            messages[messageCount].msg_hdr.msg_name = destAddr;
+            messages[messageCount].msg_hdr.msg_namelen = addrLen;
+            messages[messageCount].msg_hdr.msg_iov = iovs + iovCount;
+            messages[messageCount].msg_hdr.msg_iovlen = runLength;
+
+            if (runLength > 1) {
+                messages[messageCount].msg_hdr.msg_control = controls[messageCount].buffer;
+                messages[messageCount].msg_hdr.msg_controllen = SIZEOF(controls[messageCount].buffer);
+                pCmsg = CMSG_FIRSTHDR(&messages[messageCount].msg_hdr);
+                pCmsg->cmsg_level = IPPROTO_UDP;
+                pCmsg->cmsg_type = UDP_SEGMENT;
+                pCmsg->cmsg_len = CMSG_LEN(SIZEOF(UINT16));
+                *((PUINT16) CMSG_DATA(pCmsg)) = (UINT16) segmentSize;
+                usedGso = TRUE;
+            }
+
+            messageCount++;
+            iovCount += runLength;
+        }
+
+        result = sendmmsg(pSocketConnection->localSocket, messages, messageCount, NO_SIGNAL);
+        if (result < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                FD_ZERO(&wfds);
+                FD_SET(pSocketConnection->localSocket, &wfds);
+                tv.tv_sec = 0;
+                tv.tv_usec = SOCKET_SEND_RETRY_TIMEOUT_MICRO_SECOND;
+                result = select(pSocketConnection->localSocket + 1, NULL, &wfds, NULL, &tv);
+
+                if (result == 0) {
+                    /* loop back and try again */
+                    DLOGD("select() timed out");
+                } else if (result < 0) {
+                    DLOGD("select() failed with errno %s", strerror(errno));
+                    break;
+                }
+            } else if (errno == EINTR) {
+                /* nothing need to be done, just retry */
+            } else if (usedGso && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP)) {
+                /* kernel or device without UDP GSO support, resend the same packets as separate messages */
+                DLOGD("UDP GSO not available (errno %s), falling back to plain sendmmsg", strerror(errno));
+                pSocketConnection->gsoEnabled = FALSE;
+                continue;
+            } else {
+                /* fatal error from send() */
+                DLOGD("sendmmsg() failed with errno %s", strerror(errno));
+                break;
+            }
+
+            socketWriteAttempt++;
+        } else {
+            // sendmmsg returns the number of messages that went out, each of them carrying msg_iovlen packets
+            for (i = 0; i < (UINT32) result; i++) {
+                packetsWritten += (UINT32) messages[i].msg_hdr.msg_iovlen;
+            }
+        }
+    }
+
+    if (result < 0) {
+        CLOSE_SOCKET_IF_CANT_RETRY(errno, pSocketConnection);
+    }
+#else
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL && pDestIp != NULL, STATUS_NULL_ARG);
+
+    for (; packetsWritten < bufCount; packetsWritten++) {
+        CHK_STATUS(socketSendDataWithRetry(pSocketConnection, ppBufs[packetsWritten], pBufLens[packetsWritten], pDestIp, NULL));
+    }
+#endif
+
+    if (packetsWritten < bufCount) {
+        DLOGD("Failed to send data. Packets sent %u. Packet count %u", packetsWritten, bufCount);
+        retStatus = STATUS_SEND_DATA_FAILED;
+    }
+
+CleanUp:
+
+    if (pPacketsWritten != NULL) {
+        *pPacketsWritten = packetsWritten;
+    }
+
+    // CHK_LOG_ERR might be too verbose in this case
+    if (STATUS_FAILED(retStatus)) {
+        DLOGD("Warning: Send data failed with 0x%08x", retStatus);
+    }
+
+    return retStatus;
+}
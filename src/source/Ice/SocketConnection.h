@@ -13,6 +13,17 @@ extern "C" {
 #define SOCKET_SEND_RETRY_TIMEOUT_MICRO_SECOND      500000
 #define MAX_SOCKET_WRITE_RETRY                      3
 
+// Max number of packets handed to the kernel in a single sendmmsg call
+#define SOCKET_SEND_BATCH_MAX_PACKETS               64
+
+// Segment count limit of UDP GSO (UDP_MAX_SEGMENTS) and a payload limit that stays clear of the 64K datagram size
+#define SOCKET_GSO_MAX_SEGMENTS                     64
+#define SOCKET_GSO_MAX_PAYLOAD_SIZE                 65000
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT                                 103
+#endif
+
 #define CLOSE_SOCKET_IF_CANT_RETRY(e,ps)             if ((e) != EAGAIN && \
                                                         (e) != EWOULDBLOCK && \
                                                         (e) != EINTR && \
@@ -46,6 +57,9 @@ struct __SocketConnection {
 
     BOOL freeBios;
 
+    /* Whether UDP generic segmentation offload is tried when sending batches. Cleared once the kernel rejects it */
+    BOOL gsoEnabled;
+
     ConnectionDataAvailableFunc dataAvailableCallbackFn;
     UINT64 dataAvailableCallbackCustomData;
     UINT64 tlsHandshakeStartTime;
@@ -103,6 +117,21 @@ STATUS socketConnectionInitSecureConnection(PSocketConnection, BOOL);
  */
 STATUS socketConnectionSendData(PSocketConnection, PBYTE, UINT32, PKvsIpAddress);
 
+/**
+ * Send a batch of datagrams to the same destination. For UDP sockets the batch is handed to the kernel with as few
+ * sendmmsg calls as possible, consecutive packets of the same size are coalesced with UDP GSO where the kernel supports
+ * it. Other socket types and platforms fall back to sending the buffers one at a time with socketConnectionSendData.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - PBYTE* - IN - buffers containing the data
+ * @param - PUINT32 - IN - length of each buffer
+ * @param - UINT32 - IN - number of buffers
+ * @param - PKvsIpAddress - IN - destination address. Required only if socket type is UDP.
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionSendDataBatch(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress);
+
 /**
  * If PSocketConnection is not secure then nothing happens, otherwise assuming the bytes passed in are encrypted, and
  * the encryted data will be replaced with unencrypted data at function return.
@@ -148,6 +177,7 @@ BOOL socketConnectionIsConnected(PSocketConnection);
 STATUS createConnectionCertificateAndKey(X509 **, EVP_PKEY **);
 INT32 certificateVerifyCallback(INT32 preverify_ok, X509_STORE_CTX *ctx);
 STATUS socketSendDataWithRetry(PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PUINT32);
+STATUS socketSendDataBatchWithRetry(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, PUINT32);
 
 #ifdef  __cplusplus
 }
@@ -54,6 +54,19 @@ extern "C" {
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <netinet/udp.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+// Vector extensions used by the Annex-B start code scanner, selected at compile time
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
 #endif
 
 // Max uFrag and uPwd length as documented in https://tools.ietf.org/html/rfc5245#section-15.4
@@ -112,6 +125,7 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Ice/IceUtils.h"
 #include "Sdp/Sdp.h"
 #include "Dtls/Dtls.h"
+#include "Dtls/DtlsCertificatePool.h"
 #include "Ice/IceAgent.h"
 #include "Ice/TurnConnection.h"
 #include "Ice/IceAgentStateMachine.h"
@@ -122,11 +136,17 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Rtcp/RollingBuffer.h"
 #include "Rtcp/RtpRollingBuffer.h"
 #include "PeerConnection/JitterBuffer.h"
+#include "PeerConnection/InboundPacketQueue.h"
+#include "PeerConnection/SendWorkerPool.h"
+#include "PeerConnection/Twcc.h"
 #include "PeerConnection/PeerConnection.h"
+#include "PeerConnection/PeerConnectionPool.h"
 #include "PeerConnection/Retransmitter.h"
 #include "PeerConnection/SessionDescription.h"
 #include "PeerConnection/Rtp.h"
 #include "PeerConnection/Rtcp.h"
+#include "PeerConnection/BroadcastGroup.h"
+#include "PeerConnection/Metrics.h"
 #include "PeerConnection/DataChannel.h"
 #include "Rtp/Codecs/RtpVP8Payloader.h"
 #include "Rtp/Codecs/RtpH264Payloader.h"
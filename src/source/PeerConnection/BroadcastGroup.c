@@ -0,0 +1,462 @@
+#define LOG_CLASS "BroadcastGroup"
+
+#include "../Include_i.h"
+
+STATUS createBroadcastGroup(RTC_CODEC codec, PBROADCAST_GROUP_HANDLE pGroupHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBroadcastGroup pBroadcastGroup = NULL;
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+
+    CHK(pGroupHandle != NULL, STATUS_NULL_ARG);
+
+    pBroadcastGroup = (PBroadcastGroup) MEMCALLOC(1, SIZEOF(BroadcastGroup));
+    CHK(pBroadcastGroup != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pBroadcastGroup->lock = MUTEX_CREATE(FALSE);
+    pBroadcastGroup->writersDoneCvar = CVAR_CREATE();
+    pBroadcastGroup->codec = codec;
+    groupHandle = TO_BROADCAST_GROUP_HANDLE(pBroadcastGroup);
+
+    switch (codec) {
+        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
+            // Packetized in a single pass by the packet ring, see broadcastGroupCreatePackets
+            pBroadcastGroup->clockRate = VIDEO_CLOCKRATE;
+            break;
+
+        case RTC_CODEC_OPUS:
+            pBroadcastGroup->rtpPayloadFunc = createPayloadForOpus;
+            pBroadcastGroup->clockRate = OPUS_CLOCKRATE;
+            break;
+
+        case RTC_CODEC_MULAW:
+        case RTC_CODEC_ALAW:
+            pBroadcastGroup->rtpPayloadFunc = createPayloadForG711;
+            pBroadcastGroup->clockRate = PCM_CLOCKRATE;
+            break;
+
+        case RTC_CODEC_VP8:
+            pBroadcastGroup->rtpPayloadFunc = createPayloadForVP8;
+            pBroadcastGroup->clockRate = VIDEO_CLOCKRATE;
+            break;
+
+        default:
+            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
+    }
+
+    CHK_STATUS(createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, DEFAULT_RTP_PACKET_POOL_CAPACITY, &pBroadcastGroup->pRtpPacketPool));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeBroadcastGroup(&groupHandle);
+    }
+
+    if (pGroupHandle != NULL) {
+        *pGroupHandle = groupHandle;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeBroadcastGroup(PBROADCAST_GROUP_HANDLE pGroupHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBroadcastGroup pBroadcastGroup;
+    PSendQueue pSendQueue;
+    UINT32 i;
+
+    CHK(pGroupHandle != NULL, STATUS_NULL_ARG);
+
+    pBroadcastGroup = FROM_BROADCAST_GROUP_HANDLE(*pGroupHandle);
+    CHK(pBroadcastGroup != NULL, retStatus);
+
+    // Queued frames hold packets of the pool
+    for (i = 0; i < pBroadcastGroup->transceiverCount; i++) {
+        pSendQueue = pBroadcastGroup->transceivers[i]->pKvsPeerConnection->pSendQueue;
+        if (pSendQueue != NULL) {
+            CHK_LOG_ERR(sendQueueDiscard(pSendQueue, (UINT64) pBroadcastGroup->transceivers[i]));
+        }
+    }
+
+    if (pBroadcastGroup->pRtpPacketPool != NULL) {
+        CHK_LOG_ERR(freeRtpPacketPool(&pBroadcastGroup->pRtpPacketPool));
+    }
+
+    SAFE_MEMFREE(pBroadcastGroup->payloadArray.payloadBuffer);
+    SAFE_MEMFREE(pBroadcastGroup->payloadArray.payloadSubLength);
+    SAFE_MEMFREE(pBroadcastGroup->pPackets);
+
+    if (IS_VALID_CVAR_VALUE(pBroadcastGroup->writersDoneCvar)) {
+        CVAR_FREE(pBroadcastGroup->writersDoneCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pBroadcastGroup->lock)) {
+        MUTEX_FREE(pBroadcastGroup->lock);
+    }
+
+    MEMFREE(pBroadcastGroup);
+
+    *pGroupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupAddTransceiver(BROADCAST_GROUP_HANDLE groupHandle, PRtcRtpTransceiver pRtcRtpTransceiver)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBroadcastGroup pBroadcastGroup = FROM_BROADCAST_GROUP_HANDLE(groupHandle);
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pBroadcastGroup != NULL && pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+    CHK(pKvsRtpTransceiver->sender.track.codec == pBroadcastGroup->codec, STATUS_INVALID_ARG);
+    // Packets of the group are created in pooled buffers, the header and transport wide sequence number have to fit
+    // along with a payload of the size of the MTU
+    CHK(pKvsRtpTransceiver->pKvsPeerConnection->MTU + MIN_HEADER_LENGTH + TWCC_HEADER_EXTENSION_OVERHEAD <=
+            pBroadcastGroup->pRtpPacketPool->bufferSize,
+        STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pBroadcastGroup->transceiverCount; i++) {
+        CHK(pBroadcastGroup->transceivers[i] != pKvsRtpTransceiver, retStatus);
+    }
+
+    CHK(pBroadcastGroup->transceiverCount < MAX_BROADCAST_GROUP_TRANSCEIVER_COUNT, STATUS_INVALID_OPERATION);
+    pBroadcastGroup->transceivers[pBroadcastGroup->transceiverCount++] = pKvsRtpTransceiver;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupRemoveTransceiver(BROADCAST_GROUP_HANDLE groupHandle, PRtcRtpTransceiver pRtcRtpTransceiver)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBroadcastGroup pBroadcastGroup = FROM_BROADCAST_GROUP_HANDLE(groupHandle);
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    BOOL locked = FALSE;
+    UINT32 i;
+    UINT64 generation;
+
+    CHK(pBroadcastGroup != NULL && pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pBroadcastGroup->transceiverCount; i++) {
+        if (pBroadcastGroup->transceivers[i] == pKvsRtpTransceiver) {
+            // Order does not matter, so the last one takes its place
+            pBroadcastGroup->transceivers[i] = pBroadcastGroup->transceivers[--pBroadcastGroup->transceiverCount];
+            pBroadcastGroup->transceivers[pBroadcastGroup->transceiverCount] = NULL;
+
+            // Writers that took the transceiver before it was removed may still be sending to it or queueing for it.
+            // Writers starting from now on join a new generation and can not hold the removal back. The generation
+            // before the current one has to be done first so that none of them join the one waited for.
+            while (pBroadcastGroup->writerCounts[(pBroadcastGroup->writerGeneration + 1) % ARRAY_SIZE(pBroadcastGroup->writerCounts)] > 0) {
+                CVAR_WAIT(pBroadcastGroup->writersDoneCvar, pBroadcastGroup->lock, INFINITE_TIME_VALUE);
+            }
+
+            generation = pBroadcastGroup->writerGeneration++;
+            while (pBroadcastGroup->writerCounts[generation % ARRAY_SIZE(pBroadcastGroup->writerCounts)] > 0) {
+                CVAR_WAIT(pBroadcastGroup->writersDoneCvar, pBroadcastGroup->lock, INFINITE_TIME_VALUE);
+            }
+
+            if (pKvsRtpTransceiver->pKvsPeerConnection->pSendQueue != NULL) {
+                CHK_STATUS(sendQueueDiscard(pKvsRtpTransceiver->pKvsPeerConnection->pSendQueue, (UINT64) pKvsRtpTransceiver));
+            }
+            break;
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupWriteFrame(BROADCAST_GROUP_HANDLE groupHandle, PFrame pFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus;
+    PBroadcastGroup pBroadcastGroup = FROM_BROADCAST_GROUP_HANDLE(groupHandle);
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PKvsRtpTransceiver transceivers[MAX_BROADCAST_GROUP_TRANSCEIVER_COUNT];
+    PSendFrame pSendFrame = NULL;
+    BOOL locked = FALSE, writing = FALSE;
+    UINT32 i, packetCount = 0, transceiverCount = 0, rtpTimestamp;
+    UINT64 generation = 0;
+
+    CHK(pBroadcastGroup != NULL && pFrame != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    locked = TRUE;
+    CHK(pBroadcastGroup->transceiverCount > 0, retStatus);
+
+    rtpTimestamp = (UINT32) convertTimestampToRTP(pBroadcastGroup->clockRate, pFrame->presentationTs);
+    CHK_STATUS(broadcastGroupCreatePackets(pBroadcastGroup, pFrame, rtpTimestamp, &packetCount));
+    CHK(packetCount > 0, retStatus);
+
+    // The frame takes its own reference on the packets, which frees the packets and scratch memory of the group for the
+    // next writer. Sending and queueing, which can wait for room in a full queue, are done without the lock on a copy of
+    // the transceivers. Removing one of them waits for the writers to be done.
+    CHK_STATUS(createSendFrame(pBroadcastGroup->pPackets, packetCount, rtpTimestamp, &pSendFrame));
+    for (i = 0; i < packetCount; i++) {
+        freeRtpPacketAndRawPacket(&pBroadcastGroup->pPackets[i]);
+    }
+    packetCount = 0;
+
+    transceiverCount = pBroadcastGroup->transceiverCount;
+    MEMCPY(transceivers, pBroadcastGroup->transceivers, transceiverCount * SIZEOF(PKvsRtpTransceiver));
+    generation = pBroadcastGroup->writerGeneration;
+    pBroadcastGroup->writerCounts[generation % ARRAY_SIZE(pBroadcastGroup->writerCounts)]++;
+    writing = TRUE;
+    pBroadcastGroup->framesWritten++;
+
+    MUTEX_UNLOCK(pBroadcastGroup->lock);
+    locked = FALSE;
+
+    for (i = 0; i < transceiverCount; i++) {
+        pKvsRtpTransceiver = transceivers[i];
+        if (pKvsRtpTransceiver->pKvsPeerConnection->pSendQueue == NULL) {
+            sendStatus = writeSharedRtpPackets(pKvsRtpTransceiver, pSendFrame->pPackets, pSendFrame->packetCount, rtpTimestamp);
+        } else {
+            // The send worker of the peer connection rewrites, encrypts and sends its own copy
+            sendStatus = sendQueueEnqueue(pKvsRtpTransceiver->pKvsPeerConnection->pSendQueue, (UINT64) pKvsRtpTransceiver, pSendFrame);
+        }
+
+        if (STATUS_FAILED(sendStatus)) {
+            // One viewer going away must not hold the frame back from the others
+            DLOGW("Failed to send frame through transceiver %u of %u with status 0x%08x", i, transceiverCount, sendStatus);
+            if (STATUS_SUCCEEDED(retStatus)) {
+                retStatus = sendStatus;
+            }
+        }
+    }
+
+CleanUp:
+
+    releaseSendFrame(&pSendFrame);
+
+    if (pBroadcastGroup != NULL) {
+        if (!locked) {
+            MUTEX_LOCK(pBroadcastGroup->lock);
+            locked = TRUE;
+        }
+
+        // Packets of a frame that failed before the send frame took them
+        for (i = 0; i < packetCount; i++) {
+            freeRtpPacketAndRawPacket(&pBroadcastGroup->pPackets[i]);
+        }
+
+        if (writing && --pBroadcastGroup->writerCounts[generation % ARRAY_SIZE(pBroadcastGroup->writerCounts)] == 0) {
+            CVAR_BROADCAST(pBroadcastGroup->writersDoneCvar);
+        }
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS broadcastGroupGetStats(BROADCAST_GROUP_HANDLE groupHandle, PBroadcastGroupStats pStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBroadcastGroup pBroadcastGroup = FROM_BROADCAST_GROUP_HANDLE(groupHandle);
+    BOOL locked = FALSE;
+
+    CHK(pBroadcastGroup != NULL && pStats != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    locked = TRUE;
+
+    pStats->framesWritten = pBroadcastGroup->framesWritten;
+    pStats->packetsCreated = pBroadcastGroup->packetsCreated;
+    // Pooled packets are allocated by the pool
+    pStats->allocationCount = ATOMIC_LOAD(&pBroadcastGroup->allocationCount) + ATOMIC_LOAD(&pBroadcastGroup->pRtpPacketPool->allocationCount);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+    }
+
+    return retStatus;
+}
+
+// Packetizes and serializes a frame into the pooled packets of the group. Packets created before a failure are still
+// counted so that the caller releases them. Caller holds the group lock.
+STATUS broadcastGroupCreatePackets(PBroadcastGroup pBroadcastGroup, PFrame pFrame, UINT32 rtpTimestamp, PUINT32 pPacketCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPayloadArray pPayloadArray = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PRtpPacket pRtpPacket;
+    PBYTE curPtrInPayload;
+    RtpPacketRing packetRing;
+    UINT32 i, mtu, packetLen, extensionLength = 0, bufferSize;
+    BOOL twcc = FALSE;
+    // Element of the transport wide sequence number without an id yet, see writeSharedRtpPackets
+    BYTE twccExtension[TWCC_HEADER_EXTENSION_LENGTH] = {(BYTE) (SIZEOF(UINT16) - 1), 0x00, 0x00, 0x00};
+
+    CHK(pBroadcastGroup != NULL && pFrame != NULL && pPacketCount != NULL, STATUS_NULL_ARG);
+    pBroadcastGroup->packetCount = 0;
+    pPayloadArray = &pBroadcastGroup->payloadArray;
+    bufferSize = pBroadcastGroup->pRtpPacketPool->bufferSize;
+
+    // Packets have to fit the smallest MTU of the group, any of which fits the pooled buffers, see broadcastGroupAddTransceiver
+    mtu = MAX_UINT32;
+    for (i = 0; i < pBroadcastGroup->transceiverCount; i++) {
+        pKvsPeerConnection = pBroadcastGroup->transceivers[i]->pKvsPeerConnection;
+        mtu = MIN(mtu, pKvsPeerConnection->MTU);
+        twcc = twcc || pKvsPeerConnection->pTwccManager != NULL;
+    }
+
+    if (twcc) {
+        extensionLength = SIZEOF(twccExtension);
+    }
+
+    if (pBroadcastGroup->rtpPayloadFunc == NULL) {
+        // Same single pass H264 packetization as writeFrame, right into pooled packets
+        MEMSET(&packetRing, 0x00, SIZEOF(RtpPacketRing));
+        packetRing.timestamp = rtpTimestamp;
+        if (extensionLength > 0) {
+            packetRing.extensionProfile = RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE;
+            packetRing.extensionLength = extensionLength;
+            packetRing.extensionPayload = twccExtension;
+        }
+
+        CHK_STATUS(broadcastGroupCreateH264Packets(pBroadcastGroup, mtu, pFrame, &packetRing));
+        CHK(FALSE, retStatus);
+    }
+
+    CHK_STATUS(createRtpPayloads(pBroadcastGroup->rtpPayloadFunc, mtu, pFrame, pPayloadArray, &pBroadcastGroup->allocationCount));
+    CHK_STATUS(broadcastGroupReservePackets(pBroadcastGroup, pPayloadArray->payloadSubLenSize));
+
+    curPtrInPayload = pPayloadArray->payloadBuffer;
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        CHK_STATUS(rtpPacketPoolGet(pBroadcastGroup->pRtpPacketPool, &pBroadcastGroup->pPackets[i]));
+        pBroadcastGroup->packetCount++;
+        pRtpPacket = pBroadcastGroup->pPackets[i];
+
+        CHK_STATUS(setRtpPacket(2, FALSE, extensionLength > 0, 0, i == pPayloadArray->payloadSubLenSize - 1, 0, 0, rtpTimestamp, 0, NULL,
+                                RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE, extensionLength, extensionLength > 0 ? twccExtension : NULL,
+                                curPtrInPayload, pPayloadArray->payloadSubLength[i], pRtpPacket));
+
+        packetLen = bufferSize;
+        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &packetLen));
+        pRtpPacket->rawPacketLength = packetLen;
+        pRtpPacket->payload = pRtpPacket->pRawPacket + packetLen - pRtpPacket->payloadLength;
+        pRtpPacket->header.extensionPayload = NULL;
+
+        curPtrInPayload += pPayloadArray->payloadSubLength[i];
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (pBroadcastGroup != NULL && pPacketCount != NULL) {
+        *pPacketCount = pBroadcastGroup->packetCount;
+        if (STATUS_SUCCEEDED(retStatus)) {
+            pBroadcastGroup->packetsCreated += pBroadcastGroup->packetCount;
+        }
+    }
+
+    return retStatus;
+}
+
+// Makes room for packetCount packets in pPackets, keeping the ones of the frame being written
+STATUS broadcastGroupReservePackets(PBroadcastGroup pBroadcastGroup, UINT32 packetCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket* pPackets = NULL;
+    UINT32 packetCapacity;
+
+    CHK(pBroadcastGroup != NULL, STATUS_NULL_ARG);
+    CHK(packetCount > pBroadcastGroup->packetCapacity, retStatus);
+
+    packetCapacity = (UINT32) (packetCount * RTP_PACKET_ARENA_GROWTH_FACTOR);
+    pPackets = (PRtpPacket*) MEMCALLOC(packetCapacity, SIZEOF(PRtpPacket));
+    CHK(pPackets != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    if (pBroadcastGroup->packetCount > 0) {
+        MEMCPY(pPackets, pBroadcastGroup->pPackets, pBroadcastGroup->packetCount * SIZEOF(PRtpPacket));
+    }
+
+    SAFE_MEMFREE(pBroadcastGroup->pPackets);
+    pBroadcastGroup->pPackets = pPackets;
+    pBroadcastGroup->packetCapacity = packetCapacity;
+    ATOMIC_INCREMENT(&pBroadcastGroup->allocationCount);
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Packetizes an H264 frame through the packet ring with pooled packets as its slots, retrying with more of them while the
+// frame does not fit. The packets are used as they are and the ones left over go back to the pool. Caller holds the group lock.
+STATUS broadcastGroupCreateH264Packets(PBroadcastGroup pBroadcastGroup, UINT32 mtu, PFrame pFrame, PRtpPacketRing pRing)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 slotCount;
+    UINT16 sequenceNumber;
+
+    CHK(pBroadcastGroup != NULL && pFrame != NULL && pRing != NULL, STATUS_NULL_ARG);
+    CHK(mtu > FU_A_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+    CHK(mtu + RTP_PACKET_RING_HEADER_LENGTH(pRing) <= pBroadcastGroup->pRtpPacketPool->bufferSize, STATUS_INVALID_ARG);
+
+    sequenceNumber = pRing->sequenceNumber;
+    slotCount = pFrame->size / (mtu - FU_A_HEADER_SIZE) + RTP_PACKET_RING_EXTRA_SLOT_COUNT;
+
+    do {
+        // Packets of an attempt that ran out of slots are reused by the next one
+        CHK_STATUS(broadcastGroupReservePackets(pBroadcastGroup, slotCount));
+        while (pBroadcastGroup->packetCount < slotCount) {
+            CHK_STATUS(rtpPacketPoolGet(pBroadcastGroup->pRtpPacketPool, &pBroadcastGroup->pPackets[pBroadcastGroup->packetCount]));
+            pBroadcastGroup->packetCount++;
+        }
+
+        pRing->ppPackets = pBroadcastGroup->pPackets;
+        pRing->slotSize = mtu + RTP_PACKET_RING_HEADER_LENGTH(pRing);
+        pRing->slotCount = slotCount;
+        // Transceivers encrypt their own copy, see writeSharedRtpPackets
+        pRing->slotTailroom = 0;
+        pRing->sequenceNumber = sequenceNumber;
+        pRing->packetCount = 0;
+
+        retStatus = createRtpPacketsForH264(mtu, (PBYTE) pFrame->frameData, pFrame->size, pRing);
+        slotCount *= 2;
+    } while (retStatus == STATUS_BUFFER_TOO_SMALL && pRing->packetCount == pRing->slotCount);
+
+    CHK_STATUS(retStatus);
+
+    while (pBroadcastGroup->packetCount > pRing->packetCount) {
+        freeRtpPacketAndRawPacket(&pBroadcastGroup->pPackets[--pBroadcastGroup->packetCount]);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,59 @@
+/*******************************************
+Broadcast group internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_BROADCASTGROUP__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_BROADCASTGROUP__
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define TO_BROADCAST_GROUP_HANDLE(p) ((BROADCAST_GROUP_HANDLE) (p))
+#define FROM_BROADCAST_GROUP_HANDLE(h) (IS_VALID_BROADCAST_GROUP_HANDLE(h) ? (PBroadcastGroup) (h) : NULL)
+
+/*
+ * Frames written to the group are packetized into pooled packets carrying placeholder payload type, ssrc and sequence
+ * numbers, and a transport wide sequence number element without an id when any transceiver negotiated it. Each
+ * transceiver copies them into its packet arena and fills those in before encrypting. H264 goes through the same single
+ * pass packet ring as writeFrame, with pooled packets as its slots so that they are used as they are.
+ * Transceivers whose MTU does not fit the pooled buffers are rejected when added.
+ */
+typedef struct {
+    MUTEX lock;
+    RTC_CODEC codec;
+    RtpPayloadFunc rtpPayloadFunc;
+    UINT32 clockRate;
+
+    PKvsRtpTransceiver transceivers[MAX_BROADCAST_GROUP_TRANSCEIVER_COUNT];
+    UINT32 transceiverCount;
+
+    // Writers sending a frame outside of the lock, counted per generation. Removing a transceiver starts a new
+    // generation and only waits for the writers of the previous one, which may still hold the removed transceiver
+    UINT64 writerGeneration;
+    UINT32 writerCounts[2];
+    CVAR writersDoneCvar;
+
+    // Scratch memory of broadcastGroupWriteFrame, reused across frames
+    PayloadArray payloadArray;
+    PRtpPacket* pPackets;
+    UINT32 packetCapacity;
+    // Number of packets of the frame being written in pPackets
+    UINT32 packetCount;
+    PRtpPacketPool pRtpPacketPool;
+    volatile SIZE_T allocationCount;
+
+    UINT64 framesWritten;
+    // Packets created by the group, once per frame no matter how many transceivers it is sent through
+    UINT64 packetsCreated;
+} BroadcastGroup, *PBroadcastGroup;
+
+STATUS broadcastGroupCreatePackets(PBroadcastGroup, PFrame, UINT32, PUINT32);
+STATUS broadcastGroupReservePackets(PBroadcastGroup, UINT32);
+STATUS broadcastGroupCreateH264Packets(PBroadcastGroup, UINT32, PFrame, PRtpPacketRing);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  //__KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_BROADCASTGROUP__
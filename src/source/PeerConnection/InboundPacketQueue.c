@@ -0,0 +1,220 @@
+#define LOG_CLASS "InboundPacketQueue"
+
+#include "../Include_i.h"
+
+STATUS createInboundPacketQueue(UINT32 slotCount, PRtpPacketPool pRtpPacketPool, InboundPacketHandlerFunc handlerFn, UINT64 customData,
+                                PInboundPacketQueue* ppInboundPacketQueue)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    UINT32 roundedSlotCount = 1;
+
+    CHK(ppInboundPacketQueue != NULL && pRtpPacketPool != NULL && handlerFn != NULL, STATUS_NULL_ARG);
+    CHK(slotCount > 0 && slotCount <= INBOUND_PACKET_QUEUE_MAX_SLOT_COUNT, STATUS_INVALID_ARG);
+
+    // Power of 2 so that the free running indexes can be mapped to slots with a mask
+    while (roundedSlotCount < slotCount) {
+        roundedSlotCount <<= 1;
+    }
+
+    pInboundPacketQueue = (PInboundPacketQueue) MEMCALLOC(1, SIZEOF(InboundPacketQueue));
+    CHK(pInboundPacketQueue != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    ATOMIC_STORE(&pInboundPacketQueue->tail, 0);
+    ATOMIC_STORE(&pInboundPacketQueue->head, 0);
+    ATOMIC_STORE_BOOL(&pInboundPacketQueue->consumerWaiting, FALSE);
+    ATOMIC_STORE_BOOL(&pInboundPacketQueue->terminate, FALSE);
+    pInboundPacketQueue->consumerRoutine = INVALID_TID_VALUE;
+    pInboundPacketQueue->lock = MUTEX_CREATE(FALSE);
+    pInboundPacketQueue->dataAvailable = CVAR_CREATE();
+    pInboundPacketQueue->slotCount = roundedSlotCount;
+    pInboundPacketQueue->pRtpPacketPool = pRtpPacketPool;
+    pInboundPacketQueue->handlerFn = handlerFn;
+    pInboundPacketQueue->customData = customData;
+
+    pInboundPacketQueue->pSlots = (PRtpPacket*) MEMALLOC(roundedSlotCount * SIZEOF(PRtpPacket));
+    CHK(pInboundPacketQueue->pSlots != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    CHK_STATUS(THREAD_CREATE(&pInboundPacketQueue->consumerRoutine, inboundPacketQueueConsumerRoutine, (PVOID) pInboundPacketQueue));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeInboundPacketQueue(&pInboundPacketQueue);
+    }
+
+    if (ppInboundPacketQueue != NULL) {
+        *ppInboundPacketQueue = pInboundPacketQueue;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeInboundPacketQueue(PInboundPacketQueue* ppInboundPacketQueue)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    SIZE_T head, tail;
+
+    CHK(ppInboundPacketQueue != NULL, STATUS_NULL_ARG);
+    CHK(*ppInboundPacketQueue != NULL, retStatus);
+
+    pInboundPacketQueue = *ppInboundPacketQueue;
+
+    ATOMIC_STORE_BOOL(&pInboundPacketQueue->terminate, TRUE);
+
+    if (IS_VALID_TID_VALUE(pInboundPacketQueue->consumerRoutine)) {
+        MUTEX_LOCK(pInboundPacketQueue->lock);
+        CVAR_SIGNAL(pInboundPacketQueue->dataAvailable);
+        MUTEX_UNLOCK(pInboundPacketQueue->lock);
+
+        THREAD_JOIN(pInboundPacketQueue->consumerRoutine, NULL);
+        pInboundPacketQueue->consumerRoutine = INVALID_TID_VALUE;
+    }
+
+    // Hand the packets that were never consumed back to the pool
+    if (pInboundPacketQueue->pSlots != NULL) {
+        tail = ATOMIC_LOAD(&pInboundPacketQueue->tail);
+        for (head = ATOMIC_LOAD(&pInboundPacketQueue->head); head != tail; head++) {
+            freeRtpPacketAndRawPacket(&pInboundPacketQueue->pSlots[head & (pInboundPacketQueue->slotCount - 1)]);
+        }
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pInboundPacketQueue->lock)) {
+        MUTEX_FREE(pInboundPacketQueue->lock);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pInboundPacketQueue->dataAvailable)) {
+        CVAR_FREE(pInboundPacketQueue->dataAvailable);
+    }
+
+    SAFE_MEMFREE(pInboundPacketQueue->pSlots);
+    SAFE_MEMFREE(*ppInboundPacketQueue);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS inboundPacketQueuePush(PInboundPacketQueue pInboundPacketQueue, PBYTE pPacket, UINT32 packetLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SIZE_T head, tail, queueDepth;
+    PRtpPacket pRtpPacket = NULL;
+
+    CHK(pInboundPacketQueue != NULL && pPacket != NULL, STATUS_NULL_ARG);
+
+    // The producer is the only writer of tail so it can be read without synchronization
+    tail = pInboundPacketQueue->tail;
+    head = ATOMIC_LOAD(&pInboundPacketQueue->head);
+    queueDepth = tail - head;
+
+    if (queueDepth >= pInboundPacketQueue->slotCount) {
+        ATOMIC_INCREMENT(&pInboundPacketQueue->packetsDropped);
+        if (!pInboundPacketQueue->overflowing) {
+            // Only log once per overflow, the consumer is likely stuck in application code
+            DLOGW("Inbound packet queue of %u packets is full, dropping packets", pInboundPacketQueue->slotCount);
+            ATOMIC_INCREMENT(&pInboundPacketQueue->overflowCount);
+            pInboundPacketQueue->overflowing = TRUE;
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
+    pInboundPacketQueue->overflowing = FALSE;
+
+    // This is the only copy of the packet, it is decrypted and parsed in place from here on. Datagrams larger than the
+    // pool buffers are rare, they get a packet of their own rather than being dropped
+    CHK_STATUS(rtpPacketPoolGetWithSize(pInboundPacketQueue->pRtpPacketPool, packetLen, &pRtpPacket));
+    MEMCPY(pRtpPacket->pRawPacket, pPacket, packetLen);
+    pRtpPacket->rawPacketLength = packetLen;
+    pRtpPacket->receivedTime = GETTIME();
+    pInboundPacketQueue->pSlots[tail & (pInboundPacketQueue->slotCount - 1)] = pRtpPacket;
+
+    // Publish the slot to the consumer
+    ATOMIC_STORE(&pInboundPacketQueue->tail, tail + 1);
+
+    ATOMIC_INCREMENT(&pInboundPacketQueue->packetsQueued);
+    if (queueDepth + 1 > pInboundPacketQueue->maxQueueDepth) {
+        ATOMIC_STORE(&pInboundPacketQueue->maxQueueDepth, queueDepth + 1);
+    }
+
+    // Only pay for the lock when the consumer is asleep
+    if (ATOMIC_LOAD_BOOL(&pInboundPacketQueue->consumerWaiting)) {
+        MUTEX_LOCK(pInboundPacketQueue->lock);
+        CVAR_SIGNAL(pInboundPacketQueue->dataAvailable);
+        MUTEX_UNLOCK(pInboundPacketQueue->lock);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS inboundPacketQueueGetStats(PInboundPacketQueue pInboundPacketQueue, PInboundPacketQueueStats pInboundPacketQueueStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pInboundPacketQueue != NULL && pInboundPacketQueueStats != NULL, STATUS_NULL_ARG);
+
+    pInboundPacketQueueStats->packetsQueued = ATOMIC_LOAD(&pInboundPacketQueue->packetsQueued);
+    pInboundPacketQueueStats->packetsDropped = ATOMIC_LOAD(&pInboundPacketQueue->packetsDropped);
+    pInboundPacketQueueStats->overflowCount = ATOMIC_LOAD(&pInboundPacketQueue->overflowCount);
+    pInboundPacketQueueStats->maxQueueDepth = (UINT32) ATOMIC_LOAD(&pInboundPacketQueue->maxQueueDepth);
+
+CleanUp:
+
+    return retStatus;
+}
+
+PVOID inboundPacketQueueConsumerRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PInboundPacketQueue pInboundPacketQueue = (PInboundPacketQueue) arg;
+    SIZE_T head, tail;
+    PRtpPacket* ppRtpPacket;
+
+    CHK(pInboundPacketQueue != NULL, STATUS_NULL_ARG);
+
+    // The consumer is the only writer of head so it can be read without synchronization
+    head = pInboundPacketQueue->head;
+
+    while (!ATOMIC_LOAD_BOOL(&pInboundPacketQueue->terminate)) {
+        tail = ATOMIC_LOAD(&pInboundPacketQueue->tail);
+
+        if (head == tail) {
+            /* Announce that we are going to sleep before checking the queue one last time. A producer that publishes
+             * after the check sees the flag and signals under the lock, which cannot happen before CVAR_WAIT released it. */
+            MUTEX_LOCK(pInboundPacketQueue->lock);
+            ATOMIC_STORE_BOOL(&pInboundPacketQueue->consumerWaiting, TRUE);
+            if (ATOMIC_LOAD(&pInboundPacketQueue->tail) == head && !ATOMIC_LOAD_BOOL(&pInboundPacketQueue->terminate)) {
+                CVAR_WAIT(pInboundPacketQueue->dataAvailable, pInboundPacketQueue->lock, INBOUND_PACKET_QUEUE_WAIT_TIMEOUT);
+            }
+            ATOMIC_STORE_BOOL(&pInboundPacketQueue->consumerWaiting, FALSE);
+            MUTEX_UNLOCK(pInboundPacketQueue->lock);
+            continue;
+        }
+
+        while (head != tail && !ATOMIC_LOAD_BOOL(&pInboundPacketQueue->terminate)) {
+            ppRtpPacket = &pInboundPacketQueue->pSlots[head & (pInboundPacketQueue->slotCount - 1)];
+            pInboundPacketQueue->handlerFn(pInboundPacketQueue->customData, *ppRtpPacket);
+            freeRtpPacketAndRawPacket(ppRtpPacket);
+
+            // Hand the slot back to the producer as soon as it is consumed
+            head++;
+            ATOMIC_STORE(&pInboundPacketQueue->head, head);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
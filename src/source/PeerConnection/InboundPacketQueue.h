@@ -0,0 +1,112 @@
+/*******************************************
+InboundPacketQueue internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT__INBOUND_PACKET_QUEUE_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT__INBOUND_PACKET_QUEUE_H
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define INBOUND_PACKET_QUEUE_MAX_SLOT_COUNT                         65536
+
+// The consumer rechecks the queue at least this often even if no wake up is received
+#define INBOUND_PACKET_QUEUE_WAIT_TIMEOUT                           (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Keeps the producer and the consumer indexes on different cache lines
+#define INBOUND_PACKET_QUEUE_CACHE_LINE_SIZE                        64
+
+typedef VOID (*InboundPacketHandlerFunc)(UINT64, PRtpPacket);
+
+/*
+ * Single producer single consumer ring of pooled packets. The socket receive thread copies packets into packets of the
+ * pool with inboundPacketQueuePush without ever waiting, while the consumer thread of the queue hands them to handlerFn
+ * in order. When the queue is full, packets are dropped instead of stalling reception.
+ */
+typedef struct {
+    // Index of the next slot to fill, only written by the producer
+    volatile SIZE_T tail;
+    BYTE tailPadding[INBOUND_PACKET_QUEUE_CACHE_LINE_SIZE - SIZEOF(SIZE_T)];
+    // Index of the next slot to consume, only written by the consumer
+    volatile SIZE_T head;
+    BYTE headPadding[INBOUND_PACKET_QUEUE_CACHE_LINE_SIZE - SIZEOF(SIZE_T)];
+
+    // Set by the consumer before it goes to sleep on an empty queue
+    volatile ATOMIC_BOOL consumerWaiting;
+    volatile ATOMIC_BOOL terminate;
+    MUTEX lock;
+    CVAR dataAvailable;
+    TID consumerRoutine;
+
+    UINT32 slotCount;
+    // Every published slot holds a reference on its packet, dropped by the consumer once handlerFn returns
+    PRtpPacket* pSlots;
+    PRtpPacketPool pRtpPacketPool;
+
+    InboundPacketHandlerFunc handlerFn;
+    UINT64 customData;
+
+    // Counters, only written by the producer
+    BOOL overflowing;
+    volatile SIZE_T packetsQueued;
+    volatile SIZE_T packetsDropped;
+    volatile SIZE_T overflowCount;
+    volatile SIZE_T maxQueueDepth;
+} InboundPacketQueue, *PInboundPacketQueue;
+
+/**
+ * Create the queue and start its consumer thread
+ *
+ * @param - UINT32 - IN - Number of packets the queue can hold, rounded up to a power of 2
+ * @param - PRtpPacketPool - IN - Pool the packets are copied into, must outlive the queue
+ * @param - InboundPacketHandlerFunc - IN - Called on the consumer thread for every packet in order. The packet holds
+ *                                          the raw bytes only and handlerFn takes a reference of its own to keep it
+ * @param - UINT64 - IN - Custom data passed to the handler
+ * @param - PInboundPacketQueue* - OUT - Created queue
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createInboundPacketQueue(UINT32, PRtpPacketPool, InboundPacketHandlerFunc, UINT64, PInboundPacketQueue*);
+
+/**
+ * Stop the consumer thread and free the queue. Packets still queued are discarded.
+ *
+ * @param - PInboundPacketQueue* - IN/OUT - Queue to free
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeInboundPacketQueue(PInboundPacketQueue*);
+
+/**
+ * Copy a packet into the queue. Must only be called from a single thread at a time. Never blocks, the packet is
+ * dropped and counted if the queue is full.
+ *
+ * @param - PInboundPacketQueue - IN - Queue
+ * @param - PBYTE - IN - Packet
+ * @param - UINT32 - IN - Packet length
+ *
+ * @return - STATUS status of execution
+ */
+STATUS inboundPacketQueuePush(PInboundPacketQueue, PBYTE, UINT32);
+
+/**
+ * Snapshot of the queue counters
+ *
+ * @param - PInboundPacketQueue - IN - Queue
+ * @param - PInboundPacketQueueStats - OUT - Counters
+ *
+ * @return - STATUS status of execution
+ */
+STATUS inboundPacketQueueGetStats(PInboundPacketQueue, PInboundPacketQueueStats);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+PVOID inboundPacketQueueConsumerRoutine(PVOID);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  /* __KINESIS_VIDEO_WEBRTC_CLIENT__INBOUND_PACKET_QUEUE_H */
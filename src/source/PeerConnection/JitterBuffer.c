@@ -9,11 +9,12 @@ STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFr
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PJitterBuffer pJitterBuffer = NULL;
+    UINT32 packetRate, packetCount;
 
     CHK(ppJitterBuffer != NULL && onFrameReadyFunc != NULL && onFrameDroppedFunc != NULL && depayRtpPayloadFunc != NULL, STATUS_NULL_ARG);
     CHK(clockRate != 0, STATUS_INVALID_ARG);
 
-    pJitterBuffer = (PJitterBuffer) MEMALLOC(SIZEOF(JitterBuffer));
+    pJitterBuffer = (PJitterBuffer) MEMCALLOC(1, SIZEOF(JitterBuffer));
     CHK(pJitterBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
     pJitterBuffer->onFrameReadyFn = onFrameReadyFunc;
@@ -21,18 +22,33 @@ STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFr
     pJitterBuffer->depayPayloadFn = depayRtpPayloadFunc;
     pJitterBuffer->clockRate = clockRate;
 
-    MEMSET(pJitterBuffer->pktBuffer, 0, SIZEOF(pJitterBuffer->pktBuffer));
-
     pJitterBuffer->maxLatency = maxLatency;
     if (pJitterBuffer->maxLatency == 0) {
         pJitterBuffer->maxLatency = DEFAULT_JITTER_BUFFER_MAX_LATENCY;
     }
     pJitterBuffer->maxLatency = pJitterBuffer->maxLatency * pJitterBuffer->clockRate / HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pJitterBuffer->minLatency = pJitterBuffer->maxLatency;
+    pJitterBuffer->latency = pJitterBuffer->maxLatency;
+    pJitterBuffer->adaptiveLatency = FALSE;
+
+    // Start with room for the packets of the whole latency and grow if the stream turns out to be denser
+    packetRate = clockRate == VIDEO_CLOCKRATE ? JITTER_BUFFER_VIDEO_PACKET_RATE : JITTER_BUFFER_AUDIO_PACKET_RATE;
+    packetCount = (UINT32) (pJitterBuffer->maxLatency * packetRate / clockRate);
+    pJitterBuffer->packetRingSize = JITTER_BUFFER_MIN_PACKET_RING_SIZE;
+    while (pJitterBuffer->packetRingSize < packetCount && pJitterBuffer->packetRingSize < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET) {
+        pJitterBuffer->packetRingSize <<= 1;
+    }
+
+    pJitterBuffer->pPacketRing = (PRtpPacket*) MEMCALLOC(pJitterBuffer->packetRingSize, SIZEOF(PRtpPacket));
+    CHK(pJitterBuffer->pPacketRing != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pJitterBuffer->headFrameIndex = 0;
+    pJitterBuffer->frameCount = 0;
 
     pJitterBuffer->lastPushTimestamp = 0;
-    pJitterBuffer->lastPopTimestamp = MAX_UINT32;
     pJitterBuffer->lastRemovedSequenceNumber = MAX_SEQUENCE_NUM;
     pJitterBuffer->started = FALSE;
+    pJitterBuffer->framePopped = FALSE;
 
     pJitterBuffer->customData = customData;
 
@@ -63,9 +79,12 @@ STATUS freeJitterBuffer(PJitterBuffer* ppJitterBuffer)
 
     pJitterBuffer = *ppJitterBuffer;
 
-    jitterBufferPop(pJitterBuffer, TRUE);
-    jitterBufferDropBufferData(pJitterBuffer, 0, MAX_SEQUENCE_NUM, 0);
+    if (pJitterBuffer->pPacketRing != NULL) {
+        jitterBufferPop(pJitterBuffer, TRUE);
+        jitterBufferDropBufferData(pJitterBuffer, 0, MAX_SEQUENCE_NUM, 0);
+    }
 
+    SAFE_MEMFREE(pJitterBuffer->pPacketRing);
     MEMFREE(*ppJitterBuffer);
 
 CleanUp:
@@ -79,39 +98,82 @@ STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PRtpPacket pCurPacket = NULL;
+    PJitterBufferFrame pLastFrame = NULL;
+    PRtpPacket* pSlot;
+    UINT16 seqNum, offset;
+    UINT32 partialFrameSize = 0, requiredRingSize = 0;
+    BOOL isStart = FALSE, stored = FALSE, popped;
+
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
-    CHK(pJitterBuffer != NULL && pJitterBuffer->pktBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+    seqNum = pRtpPacket->header.sequenceNumber;
+    if (pRtpPacket->receivedTime == 0) {
+        pRtpPacket->receivedTime = GETTIME();
+    }
 
-    if (!pJitterBuffer->started || (pJitterBuffer->lastPopTimestamp == pRtpPacket->header.sequenceNumber
-        && pJitterBuffer->lastRemovedSequenceNumber >= pRtpPacket->header.sequenceNumber)) {
+    if (!pJitterBuffer->started) {
         // Set to started and initialize the sequence number
         pJitterBuffer->started = TRUE;
-        pJitterBuffer->lastRemovedSequenceNumber = UINT16_DEC(pRtpPacket->header.sequenceNumber);
+        pJitterBuffer->lastRemovedSequenceNumber = UINT16_DEC(seqNum);
+        pJitterBuffer->highestSequenceNumber = UINT16_DEC(seqNum);
     }
 
     if (pJitterBuffer->lastPushTimestamp < pRtpPacket->header.timestamp) {
         pJitterBuffer->lastPushTimestamp = pRtpPacket->header.timestamp;
     }
 
+    // Make room for a new frame before the packet is stored, forcing out the oldest frame may make the packet late
+    if (pJitterBuffer->frameCount == JITTER_BUFFER_MAX_FRAME_COUNT) {
+        DLOGW("Jitter buffer is assembling %u frames, forcing the oldest one out", pJitterBuffer->frameCount);
+        CHK_STATUS(jitterBufferPopHeadFrame(pJitterBuffer, TRUE, &popped));
+    }
+
     if ((pRtpPacket->header.timestamp < pJitterBuffer->maxLatency && pJitterBuffer->lastPushTimestamp <= pJitterBuffer->maxLatency)
         || pRtpPacket->header.timestamp >= pJitterBuffer->lastPushTimestamp - pJitterBuffer->maxLatency) {
-        pCurPacket = pJitterBuffer->pktBuffer[pRtpPacket->header.sequenceNumber];
-        if (pCurPacket != NULL) {
-            freeRtpPacketAndRawPacket(&pCurPacket);
-            pJitterBuffer->pktBuffer[pRtpPacket->header.sequenceNumber] = NULL;
+        if (JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, seqNum) >= JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET && !pJitterBuffer->framePopped) {
+            // Nothing left the buffer yet, so a packet reordered ahead of the first received one moves the start back
+            pLastFrame = pJitterBuffer->frameCount == 0 ? NULL : JITTER_BUFFER_FRAME(pJitterBuffer, pJitterBuffer->frameCount - 1);
+            if (pLastFrame == NULL || (UINT16) (pLastFrame->lastSequenceNumber - seqNum) < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET) {
+                pJitterBuffer->lastRemovedSequenceNumber = UINT16_DEC(seqNum);
+                if (pLastFrame != NULL) {
+                    // The packets already buffered are now further away from the start
+                    requiredRingSize = (UINT32) JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pLastFrame->lastSequenceNumber) + 1;
+                }
+            }
+        }
+
+        // Packets of frames that already left the buffer and retransmitted duplicates are not kept
+        offset = JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, seqNum);
+        if (offset < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET && jitterBufferGetPacket(pJitterBuffer, seqNum) == NULL) {
+            // The only time the depayloader looks at the packet before the frame is filled
+            CHK_STATUS(pJitterBuffer->depayPayloadFn(pRtpPacket->payload, pRtpPacket->payloadLength, NULL, &partialFrameSize, &isStart));
+            CHK_STATUS(jitterBufferGrowPacketRing(pJitterBuffer, MAX(requiredRingSize, (UINT32) offset + 1)));
+
+            // Only a packet left behind the window by jitterBufferDropBufferData can still hold the slot
+            pSlot = JITTER_BUFFER_PACKET_SLOT(pJitterBuffer, seqNum);
+            if (*pSlot != NULL) {
+                freeRtpPacketAndRawPacket(pSlot);
+            }
+
+            *pSlot = pRtpPacket;
+            stored = TRUE;
+            CHK_STATUS(jitterBufferAddToFrame(pJitterBuffer, pRtpPacket, partialFrameSize, isStart));
+            if (pJitterBuffer->nackEnabled) {
+                jitterBufferUpdateMissingPackets(pJitterBuffer, pRtpPacket);
+            }
+            DLOGS("jitterBufferPush get packet timestamp %lu seqNum %lu", pRtpPacket->header.timestamp, seqNum);
         }
-        pJitterBuffer->pktBuffer[pRtpPacket->header.sequenceNumber] = pRtpPacket;
-        pJitterBuffer->lastPopTimestamp = MIN(pJitterBuffer->lastPopTimestamp, pRtpPacket->header.timestamp);
-        DLOGS("jitterBufferPush get packet timestamp %lu seqNum %lu", pRtpPacket->header.timestamp, pRtpPacket->header.sequenceNumber);
-    } else {
-        // Free the packet if it is out of range, jitter buffer need to own the packet and do free
-        freeRtpPacketAndRawPacket(&pRtpPacket);
     }
 
+    jitterBufferUpdateLatency(pJitterBuffer, pRtpPacket);
+
     CHK_STATUS(jitterBufferPop(pJitterBuffer, FALSE));
 
 CleanUp:
+    // Free the packet if it is out of range, jitter buffer need to own the packet and do free
+    if (!stored && pRtpPacket != NULL) {
+        freeRtpPacketAndRawPacket(&pRtpPacket);
+    }
 
     CHK_LOG_ERR(retStatus);
 
@@ -123,98 +185,22 @@ STATUS jitterBufferPop(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT16 index;
-    UINT16 lastIndex;
     UINT32 earliestTimestamp = 0;
-    BOOL isFrameDataContinuous = TRUE;
-    UINT32 curTimestamp = 0;
-    UINT16 startDropIndex = 0;
-    UINT32 curFrameSize = 0;
-    UINT32 partialFrameSize = 0;
-    BOOL isStart = FALSE, containStartForEarliestFrame = FALSE;
-    UINT16 lastNonNullIndex = 0;
+    BOOL force, popped = TRUE;
 
-    CHK(pJitterBuffer != NULL && pJitterBuffer->pktBuffer != NULL && pJitterBuffer->onFrameDroppedFn != NULL && pJitterBuffer->onFrameReadyFn != NULL, STATUS_NULL_ARG);
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL && pJitterBuffer->onFrameDroppedFn != NULL && pJitterBuffer->onFrameReadyFn != NULL, STATUS_NULL_ARG);
     CHK(pJitterBuffer->lastPushTimestamp != 0, retStatus);
 
-    if (pJitterBuffer->lastPushTimestamp > pJitterBuffer->maxLatency) {
-        earliestTimestamp = pJitterBuffer->lastPushTimestamp - pJitterBuffer->maxLatency;
-    }
-
-    lastIndex = pJitterBuffer->lastRemovedSequenceNumber;
-    index = pJitterBuffer->lastRemovedSequenceNumber + 1;
-    startDropIndex = index;
-    for (; index != lastIndex; index++) {
-        if (pJitterBuffer->pktBuffer[index] == NULL) {
-            isFrameDataContinuous = FALSE;
-            CHK(pJitterBuffer->lastPopTimestamp < earliestTimestamp || bufferClosed, retStatus);
-        } else {
-            lastNonNullIndex = index;
-            curTimestamp = pJitterBuffer->pktBuffer[index]->header.timestamp;
-            if (curTimestamp != pJitterBuffer->lastPopTimestamp) {
-                if (pJitterBuffer->lastPopTimestamp < earliestTimestamp || bufferClosed) {
-                    if (containStartForEarliestFrame && isFrameDataContinuous) {
-                        // TODO: if switch to curBuffer, need to carefully calculate ptr of UINT16_DEC(index) as it is a circulate buffer
-                        CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, startDropIndex,
-                                                                 UINT16_DEC(index), curFrameSize));
-                        CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, UINT16_DEC(index),
-                                                              curTimestamp));
-                        curFrameSize = 0;
-                        containStartForEarliestFrame = FALSE;
-                    } else {
-                        CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData,
-                                                                   pJitterBuffer->lastPopTimestamp));
-                        CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, UINT16_DEC(index),
-                                                              curTimestamp));
-                        curFrameSize = 0;
-                        isFrameDataContinuous = TRUE;
-                    }
-                    startDropIndex = index;
-                } else {
-                    if (containStartForEarliestFrame) {
-                        CHK(!bufferClosed, retStatus);
-                        if (isFrameDataContinuous) {
-                            // TODO: if switch to curBuffer, need to carefully calculate ptr of UINT16_DEC(index) as it is a circulate buffer
-                            CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, startDropIndex,
-                                                                     UINT16_DEC(index), curFrameSize));
-                            CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, UINT16_DEC(index),
-                                                                  curTimestamp));
-                            startDropIndex = index;
-                            curFrameSize = 0;
-                        }
-                        containStartForEarliestFrame = FALSE;
-                    }
-                }
-            }
-
-            CHK_STATUS(pJitterBuffer->depayPayloadFn(pJitterBuffer->pktBuffer[index]->payload,
-                                                     pJitterBuffer->pktBuffer[index]->payloadLength, NULL,
-                                                     &partialFrameSize, &isStart));
-            curFrameSize += partialFrameSize;
-            if (isStart && pJitterBuffer->lastPopTimestamp == curTimestamp) {
-                containStartForEarliestFrame = TRUE;
-            }
-        }
+    if (pJitterBuffer->lastPushTimestamp > pJitterBuffer->latency) {
+        earliestTimestamp = pJitterBuffer->lastPushTimestamp - pJitterBuffer->latency;
     }
 
-    // Deal with last frame
-    if (bufferClosed && curFrameSize > 0) {
-        curFrameSize = 0;
-        for (index = startDropIndex; UINT16_DEC(index) != lastNonNullIndex && pJitterBuffer->pktBuffer[index] != NULL; index++) {
-            CHK_STATUS(pJitterBuffer->depayPayloadFn(pJitterBuffer->pktBuffer[index]->payload,
-                    pJitterBuffer->pktBuffer[index]->payloadLength, NULL,
-                    &partialFrameSize, NULL));
-            curFrameSize += partialFrameSize;
-        }
-
-        // There is no NULL between startIndex and lastNonNullIndex
-        if (UINT16_DEC(index) == lastNonNullIndex) {
-            CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, startDropIndex, lastNonNullIndex, curFrameSize));
-            CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, lastNonNullIndex, pJitterBuffer->lastPopTimestamp));
-        } else {
-            CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData, pJitterBuffer->lastPopTimestamp));
-            CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, lastNonNullIndex, pJitterBuffer->lastPopTimestamp));
-        }
+    // Only the oldest frame is ever looked at, every frame that leaves uncovers the next one
+    while (popped && pJitterBuffer->frameCount > 0) {
+        // An expired frame stops waiting for missing packets once a later frame shows where it ends
+        force = bufferClosed ||
+            (pJitterBuffer->frameCount > 1 && JITTER_BUFFER_FRAME(pJitterBuffer, 0)->timestamp < earliestTimestamp);
+        CHK_STATUS(jitterBufferPopHeadFrame(pJitterBuffer, force, &popped));
     }
 
 CleanUp:
@@ -228,19 +214,16 @@ STATUS jitterBufferDropBufferData(PJitterBuffer pJitterBuffer, UINT16 startIndex
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT16 index = startIndex;
-    PRtpPacket pCurPacket = NULL;
 
-    CHK(pJitterBuffer != NULL && pJitterBuffer->pktBuffer != NULL, STATUS_NULL_ARG);
-    for (; UINT16_DEC(index) != endIndex; index++) {
-        pCurPacket = pJitterBuffer->pktBuffer[index];
-        if (pCurPacket != NULL) {
-            freeRtpPacketAndRawPacket(&pCurPacket);
-            pJitterBuffer->pktBuffer[index] = NULL;
-        }
-    }
-    pJitterBuffer->lastPopTimestamp = nextTimestamp;
+    // The next frame is tracked by the frames themselves
+    UNUSED_PARAM(nextTimestamp);
+
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL, STATUS_NULL_ARG);
+    jitterBufferFreePackets(pJitterBuffer, startIndex, endIndex);
     pJitterBuffer->lastRemovedSequenceNumber = endIndex;
+    pJitterBuffer->framePopped = TRUE;
+
+    CHK_STATUS(jitterBufferRebuildFrames(pJitterBuffer));
 
 CleanUp:
     CHK_LOG_ERR(retStatus);
@@ -259,9 +242,9 @@ STATUS jitterBufferFillFrameData(PJitterBuffer pJitterBuffer, PBYTE pFrame, UINT
     UINT32 remainingFrameSize = frameSize;
     UINT32 partialFrameSize = 0;
 
-    CHK(pJitterBuffer != NULL && pJitterBuffer->pktBuffer != NULL && pFrame != NULL && pFilledSize != NULL, STATUS_NULL_ARG);
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL && pFrame != NULL && pFilledSize != NULL, STATUS_NULL_ARG);
     for (; UINT16_DEC(index) != endIndex; index++) {
-        pCurPacket = pJitterBuffer->pktBuffer[index];
+        pCurPacket = jitterBufferGetPacket(pJitterBuffer, index);
         CHK(pCurPacket != NULL, STATUS_NULL_ARG);
         partialFrameSize = remainingFrameSize;
         CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, pCurPtrInFrame, &partialFrameSize, NULL));
@@ -278,3 +261,527 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS jitterBufferFillFrameSegments(PJitterBuffer pJitterBuffer, PRtcFrameSegment pSegments, PUINT32 pSegmentCount, UINT16 startIndex,
+                                     UINT16 endIndex)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 index = startIndex;
+    PRtpPacket pCurPacket = NULL;
+    UINT32 segmentCount = 0, maxSegmentCount = 0, partialSegmentCount, partialFrameSize;
+
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL && pSegmentCount != NULL, STATUS_NULL_ARG);
+    maxSegmentCount = *pSegmentCount;
+
+    for (; UINT16_DEC(index) != endIndex; index++) {
+        pCurPacket = jitterBufferGetPacket(pJitterBuffer, index);
+        CHK(pCurPacket != NULL, STATUS_NULL_ARG);
+        if (pJitterBuffer->depayPayloadSegmentsFn != NULL) {
+            partialSegmentCount = maxSegmentCount - segmentCount;
+            CHK_STATUS(pJitterBuffer->depayPayloadSegmentsFn(pCurPacket->payload, pCurPacket->payloadLength,
+                                                             pSegments == NULL ? NULL : pSegments + segmentCount, &partialSegmentCount));
+            segmentCount += partialSegmentCount;
+        } else {
+            // Only the size is needed, the depayloaded data ends where the payload ends
+            CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, NULL));
+            CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount,
+                                          pCurPacket->payload + pCurPacket->payloadLength - partialFrameSize, partialFrameSize));
+        }
+    }
+
+CleanUp:
+    if (pSegmentCount != NULL) {
+        *pSegmentCount = segmentCount;
+    }
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS jitterBufferSetDepayPayloadSegmentsFunc(PJitterBuffer pJitterBuffer, DepayRtpPayloadSegmentsFunc depayPayloadSegmentsFn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    pJitterBuffer->depayPayloadSegmentsFn = depayPayloadSegmentsFn;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferSetMaxLatency(PJitterBuffer pJitterBuffer, UINT64 maxLatency)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+    CHK(maxLatency != 0, STATUS_INVALID_ARG);
+
+    pJitterBuffer->maxLatency = maxLatency * pJitterBuffer->clockRate / HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pJitterBuffer->minLatency = pJitterBuffer->maxLatency;
+    pJitterBuffer->latency = pJitterBuffer->maxLatency;
+    pJitterBuffer->adaptiveLatency = FALSE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferSetAdaptiveLatency(PJitterBuffer pJitterBuffer, UINT64 minLatency, UINT64 maxLatency)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+    CHK(maxLatency != 0 && minLatency <= maxLatency, STATUS_INVALID_ARG);
+
+    pJitterBuffer->minLatency = minLatency * pJitterBuffer->clockRate / HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pJitterBuffer->maxLatency = maxLatency * pJitterBuffer->clockRate / HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pJitterBuffer->latency = pJitterBuffer->maxLatency;
+    pJitterBuffer->adaptiveLatency = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferSetReleaseOnMarker(PJitterBuffer pJitterBuffer, BOOL releaseOnMarker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    pJitterBuffer->releaseOnMarker = releaseOnMarker;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferSetNackEnabled(PJitterBuffer pJitterBuffer, BOOL nackEnabled)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    pJitterBuffer->nackEnabled = nackEnabled;
+    pJitterBuffer->missingPacketCount = 0;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferGetNackList(PJitterBuffer pJitterBuffer, UINT64 currentTime, UINT64 roundTripTime, PUINT16 pSequenceNumberList,
+                               PUINT32 pSequenceNumberListLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PJitterBufferMissingPacket pMissingPacket;
+    UINT64 maxLatencyTime, nackInterval;
+    UINT32 maxSequenceNumberCount, sequenceNumberCount = 0, missingPacketCount = 0, i;
+
+    CHK(pJitterBuffer != NULL && pSequenceNumberList != NULL && pSequenceNumberListLen != NULL, STATUS_NULL_ARG);
+    maxSequenceNumberCount = *pSequenceNumberListLen;
+
+    if (roundTripTime == 0) {
+        roundTripTime = JITTER_BUFFER_DEFAULT_ROUND_TRIP_TIME;
+    }
+
+    // An adaptive latency grows when retransmissions arrive late, so they are asked for as long as the max latency allows
+    maxLatencyTime = pJitterBuffer->maxLatency * HUNDREDS_OF_NANOS_IN_A_SECOND / pJitterBuffer->clockRate;
+    nackInterval = MAX(roundTripTime, JITTER_BUFFER_MIN_NACK_INTERVAL);
+
+    // The missing packets that are given up on are compacted away on the way
+    for (i = 0; i < pJitterBuffer->missingPacketCount; i++) {
+        pMissingPacket = &pJitterBuffer->missingPackets[i];
+        if (JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pMissingPacket->sequenceNumber) >= JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET ||
+            pMissingPacket->nackCount >= JITTER_BUFFER_MAX_NACK_RETRY_COUNT ||
+            currentTime + roundTripTime > pMissingPacket->detectedTime + maxLatencyTime) {
+            continue;
+        }
+
+        if (sequenceNumberCount < maxSequenceNumberCount &&
+            (pMissingPacket->nackCount == 0 || currentTime >= pMissingPacket->lastNackTime + nackInterval)) {
+            pSequenceNumberList[sequenceNumberCount++] = pMissingPacket->sequenceNumber;
+            pMissingPacket->nackCount++;
+            pMissingPacket->lastNackTime = currentTime;
+            ATOMIC_INCREMENT(&pJitterBuffer->packetsNacked);
+        }
+
+        pJitterBuffer->missingPackets[missingPacketCount++] = *pMissingPacket;
+    }
+
+    pJitterBuffer->missingPacketCount = missingPacketCount;
+
+CleanUp:
+    if (pSequenceNumberListLen != NULL) {
+        *pSequenceNumberListLen = sequenceNumberCount;
+    }
+
+    return retStatus;
+}
+
+PRtpPacket jitterBufferGetPacket(PJitterBuffer pJitterBuffer, UINT16 seqNum)
+{
+    PRtpPacket pRtpPacket = NULL;
+
+    if (pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL) {
+        pRtpPacket = *JITTER_BUFFER_PACKET_SLOT(pJitterBuffer, seqNum);
+        // The slot is shared by every sequence number that is a multiple of the ring size apart
+        if (pRtpPacket != NULL && pRtpPacket->header.sequenceNumber != seqNum) {
+            pRtpPacket = NULL;
+        }
+    }
+
+    return pRtpPacket;
+}
+
+STATUS jitterBufferAddToFrame(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, UINT32 partialFrameSize, BOOL isStart)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PJitterBufferFrame pFrame = NULL, pCurFrame;
+    UINT16 seqNum, offset;
+    UINT32 position, i;
+
+    CHK(pJitterBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+
+    seqNum = pRtpPacket->header.sequenceNumber;
+    offset = JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, seqNum);
+
+    // Packets mostly arrive in order, so the search from the newest frame ends right away
+    for (position = pJitterBuffer->frameCount; position > 0; position--) {
+        pCurFrame = JITTER_BUFFER_FRAME(pJitterBuffer, position - 1);
+        if (pCurFrame->timestamp == pRtpPacket->header.timestamp) {
+            pFrame = pCurFrame;
+            break;
+        }
+
+        if (JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pCurFrame->lastSequenceNumber) < offset) {
+            break;
+        }
+    }
+
+    if (pFrame == NULL) {
+        // Start a new frame right after the last one that precedes the packet
+        CHK(pJitterBuffer->frameCount < JITTER_BUFFER_MAX_FRAME_COUNT, STATUS_INVALID_OPERATION);
+        for (i = pJitterBuffer->frameCount; i > position; i--) {
+            *JITTER_BUFFER_FRAME(pJitterBuffer, i) = *JITTER_BUFFER_FRAME(pJitterBuffer, i - 1);
+        }
+
+        pJitterBuffer->frameCount++;
+        pFrame = JITTER_BUFFER_FRAME(pJitterBuffer, position);
+        MEMSET(pFrame, 0x00, SIZEOF(JitterBufferFrame));
+        pFrame->timestamp = pRtpPacket->header.timestamp;
+        pFrame->firstSequenceNumber = seqNum;
+        pFrame->lastSequenceNumber = seqNum;
+    }
+
+    if (offset < JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pFrame->firstSequenceNumber)) {
+        pFrame->firstSequenceNumber = seqNum;
+    }
+
+    if (offset > JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pFrame->lastSequenceNumber)) {
+        pFrame->lastSequenceNumber = seqNum;
+    }
+
+    pFrame->packetCount++;
+    pFrame->frameSize += partialFrameSize;
+    pFrame->containStart = pFrame->containStart || isStart;
+    pFrame->containEnd = pFrame->containEnd || pRtpPacket->header.marker;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS jitterBufferPopHeadFrame(PJitterBuffer pJitterBuffer, BOOL force, PBOOL pPopped)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PJitterBufferFrame pFrame = NULL;
+    BOOL isFrameDataContinuous, popped = FALSE;
+
+    CHK(pJitterBuffer != NULL && pPopped != NULL, STATUS_NULL_ARG);
+    CHK(pJitterBuffer->frameCount > 0, retStatus);
+
+    pFrame = JITTER_BUFFER_FRAME(pJitterBuffer, 0);
+
+    // No packet is missing from the end of the previous frame to the last received packet of this one
+    isFrameDataContinuous = pFrame->firstSequenceNumber == (UINT16) (pJitterBuffer->lastRemovedSequenceNumber + 1) &&
+        pFrame->packetCount == (UINT32) (UINT16) (pFrame->lastSequenceNumber - pFrame->firstSequenceNumber) + 1;
+
+    /* The frame is known to be over once its marker packet is there, when the marker bit can be trusted, or else once
+     * the packet right after it is there and belongs to the next frame */
+    if (isFrameDataContinuous && pFrame->containStart &&
+        ((pJitterBuffer->releaseOnMarker && pFrame->containEnd) ||
+         (pJitterBuffer->frameCount > 1 && jitterBufferGetPacket(pJitterBuffer, pFrame->lastSequenceNumber + 1) != NULL))) {
+        CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, pFrame->firstSequenceNumber, pFrame->lastSequenceNumber,
+                                                 pFrame->frameSize));
+        jitterBufferRemovePackets(pJitterBuffer, pFrame->lastSequenceNumber);
+    } else if (pJitterBuffer->frameCount > 1) {
+        CHK(force, retStatus);
+        CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData, pFrame->timestamp));
+        // Whatever is missing up to the next frame is given up on along with the frame
+        jitterBufferRemovePackets(pJitterBuffer, UINT16_DEC(JITTER_BUFFER_FRAME(pJitterBuffer, 1)->firstSequenceNumber));
+    } else {
+        // Nothing tells where the last frame ends, it only leaves the buffer when forced out
+        CHK(force, retStatus);
+        if (isFrameDataContinuous) {
+            CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, pFrame->firstSequenceNumber, pFrame->lastSequenceNumber,
+                                                     pFrame->frameSize));
+        } else {
+            CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData, pFrame->timestamp));
+        }
+
+        jitterBufferRemovePackets(pJitterBuffer, pFrame->lastSequenceNumber);
+    }
+
+    pJitterBuffer->headFrameIndex = (pJitterBuffer->headFrameIndex + 1) % JITTER_BUFFER_MAX_FRAME_COUNT;
+    pJitterBuffer->frameCount--;
+    popped = TRUE;
+
+CleanUp:
+    if (pPopped != NULL) {
+        *pPopped = popped;
+    }
+
+    return retStatus;
+}
+
+VOID jitterBufferUpdateLatency(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
+{
+    INT64 transitDelta;
+    UINT64 holeFillDelay;
+
+    if (pJitterBuffer->lastReceivedTime != 0) {
+        // Difference of the relative transit times of two consecutively received packets, RFC 3550 6.4.1
+        transitDelta = (INT64) (pRtpPacket->receivedTime - pJitterBuffer->lastReceivedTime) * pJitterBuffer->clockRate / HUNDREDS_OF_NANOS_IN_A_SECOND -
+            (INT32) (pRtpPacket->header.timestamp - pJitterBuffer->lastReceivedTimestamp);
+        if (transitDelta < 0) {
+            transitDelta = -transitDelta;
+        }
+
+        pJitterBuffer->scaledJitter = pJitterBuffer->scaledJitter + (UINT64) transitDelta -
+            ((pJitterBuffer->scaledJitter + (1 << (JITTER_BUFFER_JITTER_SCALE_SHIFT - 1))) >> JITTER_BUFFER_JITTER_SCALE_SHIFT);
+    }
+
+    pJitterBuffer->lastReceivedTime = pRtpPacket->receivedTime;
+    pJitterBuffer->lastReceivedTimestamp = pRtpPacket->header.timestamp;
+
+    /* A packet older than the newest frame fills a hole left by reordering or loss, late ones included. How far behind
+     * it arrived is the wait that would have kept its frame, whether it was reordered or retransmitted after a NACK. */
+    if (pRtpPacket->header.timestamp < pJitterBuffer->lastPushTimestamp) {
+        holeFillDelay = MIN(pJitterBuffer->lastPushTimestamp - pRtpPacket->header.timestamp, pJitterBuffer->maxLatency);
+        // Holes only show up with loss, so the estimate is kept until the next one rather than decayed over time
+        if (holeFillDelay >= pJitterBuffer->holeFillDelay) {
+            pJitterBuffer->holeFillDelay = holeFillDelay;
+        } else {
+            pJitterBuffer->holeFillDelay -= (pJitterBuffer->holeFillDelay - holeFillDelay) >> JITTER_BUFFER_HOLE_FILL_DELAY_DECAY_SHIFT;
+        }
+    }
+
+    if (pJitterBuffer->adaptiveLatency) {
+        pJitterBuffer->latency = JITTER_BUFFER_JITTER_MULTIPLIER * (pJitterBuffer->scaledJitter >> JITTER_BUFFER_JITTER_SCALE_SHIFT) +
+            pJitterBuffer->holeFillDelay;
+        pJitterBuffer->latency = MIN(MAX(pJitterBuffer->latency, pJitterBuffer->minLatency), pJitterBuffer->maxLatency);
+    }
+}
+
+VOID jitterBufferUpdateMissingPackets(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
+{
+    PJitterBufferMissingPacket pMissingPacket;
+    UINT16 seqNum = pRtpPacket->header.sequenceNumber, offset, nextOffset;
+    UINT32 gapLength, dropCount, i;
+
+    offset = JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, seqNum);
+    nextOffset = JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pJitterBuffer->highestSequenceNumber + 1);
+    if (nextOffset >= JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET) {
+        // The highest received packet already left the buffer
+        nextOffset = 0;
+    }
+
+    if (offset < nextOffset) {
+        // Fills a gap, which is a recovery if the packet was NACKed rather than only reordered
+        for (i = 0; i < pJitterBuffer->missingPacketCount; i++) {
+            if (pJitterBuffer->missingPackets[i].sequenceNumber == seqNum) {
+                if (pJitterBuffer->missingPackets[i].nackCount > 0) {
+                    ATOMIC_INCREMENT(&pJitterBuffer->packetsRecovered);
+                }
+
+                pJitterBuffer->missingPacketCount--;
+                MEMMOVE(&pJitterBuffer->missingPackets[i], &pJitterBuffer->missingPackets[i + 1],
+                        (pJitterBuffer->missingPacketCount - i) * SIZEOF(JitterBufferMissingPacket));
+                break;
+            }
+        }
+
+        return;
+    }
+
+    pJitterBuffer->highestSequenceNumber = seqNum;
+
+    // Only the newest packets of a long burst of loss are worth asking for
+    gapLength = MIN((UINT32) (offset - nextOffset), JITTER_BUFFER_MAX_NACK_PACKET_COUNT);
+    if (pJitterBuffer->missingPacketCount + gapLength > JITTER_BUFFER_MAX_NACK_PACKET_COUNT) {
+        dropCount = pJitterBuffer->missingPacketCount + gapLength - JITTER_BUFFER_MAX_NACK_PACKET_COUNT;
+        pJitterBuffer->missingPacketCount -= dropCount;
+        MEMMOVE(pJitterBuffer->missingPackets, &pJitterBuffer->missingPackets[dropCount],
+                pJitterBuffer->missingPacketCount * SIZEOF(JitterBufferMissingPacket));
+    }
+
+    for (i = 0; i < gapLength; i++) {
+        pMissingPacket = &pJitterBuffer->missingPackets[pJitterBuffer->missingPacketCount++];
+        pMissingPacket->sequenceNumber = (UINT16) (seqNum - gapLength + i);
+        pMissingPacket->nackCount = 0;
+        pMissingPacket->lastNackTime = 0;
+        pMissingPacket->detectedTime = pRtpPacket->receivedTime;
+    }
+}
+
+STATUS jitterBufferGrowPacketRing(PJitterBuffer pJitterBuffer, UINT32 requiredSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket* pPacketRing = NULL;
+    PRtpPacket* pSlot;
+    PRtpPacket pRtpPacket;
+    UINT32 packetRingSize, i;
+
+    CHK(pJitterBuffer != NULL && pJitterBuffer->pPacketRing != NULL, STATUS_NULL_ARG);
+    CHK(requiredSize > pJitterBuffer->packetRingSize, retStatus);
+
+    packetRingSize = pJitterBuffer->packetRingSize;
+    while (packetRingSize < requiredSize) {
+        packetRingSize <<= 1;
+    }
+
+    pPacketRing = (PRtpPacket*) MEMCALLOC(packetRingSize, SIZEOF(PRtpPacket));
+    CHK(pPacketRing != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    for (i = 0; i < pJitterBuffer->packetRingSize; i++) {
+        pRtpPacket = pJitterBuffer->pPacketRing[i];
+        if (pRtpPacket == NULL) {
+            continue;
+        }
+
+        // Packets in the window never collide, whatever else collides was left behind it and is freed
+        pSlot = &pPacketRing[pRtpPacket->header.sequenceNumber & (packetRingSize - 1)];
+        if (*pSlot != NULL &&
+            JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, pRtpPacket->header.sequenceNumber) >
+                JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, (*pSlot)->header.sequenceNumber)) {
+            freeRtpPacketAndRawPacket(&pRtpPacket);
+            continue;
+        }
+
+        if (*pSlot != NULL) {
+            freeRtpPacketAndRawPacket(pSlot);
+        }
+
+        *pSlot = pRtpPacket;
+    }
+
+    DLOGD("Jitter buffer packet ring grown from %u to %u packets", pJitterBuffer->packetRingSize, packetRingSize);
+    MEMFREE(pJitterBuffer->pPacketRing);
+    pJitterBuffer->pPacketRing = pPacketRing;
+    pJitterBuffer->packetRingSize = packetRingSize;
+    pPacketRing = NULL;
+
+CleanUp:
+    SAFE_MEMFREE(pPacketRing);
+
+    return retStatus;
+}
+
+VOID jitterBufferFreePackets(PJitterBuffer pJitterBuffer, UINT16 startIndex, UINT16 endIndex)
+{
+    UINT32 rangeLength = (UINT32) (UINT16) (endIndex - startIndex) + 1, i;
+    UINT16 index = startIndex;
+    PRtpPacket* pSlot;
+
+    if (rangeLength >= pJitterBuffer->packetRingSize) {
+        // Going over the ring once is cheaper than looking up every sequence number of the range
+        for (i = 0; i < pJitterBuffer->packetRingSize; i++) {
+            pSlot = &pJitterBuffer->pPacketRing[i];
+            if (*pSlot != NULL && (UINT32) (UINT16) ((*pSlot)->header.sequenceNumber - startIndex) < rangeLength) {
+                freeRtpPacketAndRawPacket(pSlot);
+            }
+        }
+    } else {
+        for (; UINT16_DEC(index) != endIndex; index++) {
+            pSlot = JITTER_BUFFER_PACKET_SLOT(pJitterBuffer, index);
+            if (*pSlot != NULL && (*pSlot)->header.sequenceNumber == index) {
+                freeRtpPacketAndRawPacket(pSlot);
+            }
+        }
+    }
+}
+
+VOID jitterBufferRemovePackets(PJitterBuffer pJitterBuffer, UINT16 endIndex)
+{
+    jitterBufferFreePackets(pJitterBuffer, pJitterBuffer->lastRemovedSequenceNumber + 1, endIndex);
+    pJitterBuffer->lastRemovedSequenceNumber = endIndex;
+    pJitterBuffer->framePopped = TRUE;
+}
+
+STATUS jitterBufferRebuildFrames(PJitterBuffer pJitterBuffer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    JitterBufferFrame frame;
+    PRtpPacket pCurPacket;
+    UINT32 frameCount, partialFrameSize, i, position;
+    UINT16 index, lastIndex;
+    BOOL isStart;
+
+    CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    // Frames are compacted in place, a frame is always copied out before its slot can be written to
+    frameCount = pJitterBuffer->frameCount;
+    pJitterBuffer->frameCount = 0;
+    for (i = 0; i < frameCount; i++) {
+        frame = *JITTER_BUFFER_FRAME(pJitterBuffer, i);
+        lastIndex = frame.lastSequenceNumber;
+        index = frame.firstSequenceNumber;
+        frame.packetCount = 0;
+        frame.frameSize = 0;
+        frame.containStart = FALSE;
+        frame.containEnd = FALSE;
+        for (; UINT16_DEC(index) != lastIndex; index++) {
+            pCurPacket = jitterBufferGetPacket(pJitterBuffer, index);
+            if (pCurPacket == NULL || pCurPacket->header.timestamp != frame.timestamp) {
+                continue;
+            }
+
+            isStart = FALSE;
+            CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, &isStart));
+            if (frame.packetCount == 0) {
+                frame.firstSequenceNumber = index;
+            }
+
+            frame.lastSequenceNumber = index;
+            frame.packetCount++;
+            frame.frameSize += partialFrameSize;
+            frame.containStart = frame.containStart || isStart;
+            frame.containEnd = frame.containEnd || pCurPacket->header.marker;
+        }
+
+        if (frame.packetCount == 0) {
+            continue;
+        }
+
+        // The next expected sequence number moved, so the order of the frames may have changed
+        for (position = pJitterBuffer->frameCount;
+             position > 0 &&
+             JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, JITTER_BUFFER_FRAME(pJitterBuffer, position - 1)->firstSequenceNumber) >
+                 JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, frame.firstSequenceNumber);
+             position--) {
+            *JITTER_BUFFER_FRAME(pJitterBuffer, position) = *JITTER_BUFFER_FRAME(pJitterBuffer, position - 1);
+        }
+
+        *JITTER_BUFFER_FRAME(pJitterBuffer, position) = frame;
+        pJitterBuffer->frameCount++;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
@@ -14,22 +14,116 @@ typedef STATUS (*FrameReadyFunc)(UINT64, UINT16, UINT16, UINT32);
 typedef STATUS (*FrameDroppedFunc)(UINT64, UINT32);
 #define UINT16_DEC(a) ((UINT16) ((a) - 1))
 
+// Number of frames that can be assembled at once, the oldest one is forced out when a new frame does not fit
+#define JITTER_BUFFER_MAX_FRAME_COUNT 512
+
+// Packets expected per second of latency when sizing the packet ring, it grows when more packets need to be buffered
+#define JITTER_BUFFER_VIDEO_PACKET_RATE 250
+#define JITTER_BUFFER_AUDIO_PACKET_RATE 50
+#define JITTER_BUFFER_MIN_PACKET_RING_SIZE 64
+
+// Interarrival jitter is kept scaled by 16 as in RFC 3550 A.8
+#define JITTER_BUFFER_JITTER_SCALE_SHIFT 4
+// Adaptive latency leaves room for this many times the interarrival jitter on top of the time holes take to fill
+#define JITTER_BUFFER_JITTER_MULTIPLIER 4
+// A shorter hole fill delay sample only moves the estimate by 1/16th of the difference, a longer one replaces it
+#define JITTER_BUFFER_HOLE_FILL_DELAY_DECAY_SHIFT 4
+
+// Missing packets tracked for NACKs at once, the oldest ones are given up on when a burst of loss goes beyond it
+#define JITTER_BUFFER_MAX_NACK_PACKET_COUNT 128
+// A missing packet is NACKed at most this many times
+#define JITTER_BUFFER_MAX_NACK_RETRY_COUNT 10
+// NACKs for the same packet are one round trip apart, but never closer than this
+#define JITTER_BUFFER_MIN_NACK_INTERVAL (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+// Round trip time assumed when none was measured
+#define JITTER_BUFFER_DEFAULT_ROUND_TRIP_TIME (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Packets further than this behind the next expected sequence number are late rather than ahead
+#define JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET ((UINT16) 0x8000)
+
+/*
+ * Assembly state of the packets of one timestamp, updated as they are pushed so that pop never has to look at the
+ * packets themselves
+ */
+typedef struct {
+    UINT32 timestamp;
+    // Lowest and highest received sequence numbers, the frame has no gap when packetCount covers the whole range
+    UINT16 firstSequenceNumber;
+    UINT16 lastSequenceNumber;
+    UINT32 packetCount;
+    // Sum of the depayloaded sizes of the received packets
+    UINT32 frameSize;
+    // Whether the depayloader reported a start packet and whether a packet carried the marker bit
+    BOOL containStart;
+    BOOL containEnd;
+} JitterBufferFrame, *PJitterBufferFrame;
+
+/*
+ * Packet missing between the next expected sequence number and the highest received one
+ */
+typedef struct {
+    UINT16 sequenceNumber;
+    // Number of NACKs sent for it and when the last one was sent
+    UINT32 nackCount;
+    UINT64 lastNackTime;
+    // When the gap was seen, a retransmission is only worth asking for while its frame can still wait for it
+    UINT64 detectedTime;
+} JitterBufferMissingPacket, *PJitterBufferMissingPacket;
+
 typedef struct {
-    PRtpPacket pktBuffer[MAX_SEQUENCE_NUM + 1];
+    // Packets keyed by sequence number modulo the ring size, which is a power of 2 covering the buffered sequence numbers
+    PRtpPacket* pPacketRing;
+    UINT32 packetRingSize;
     FrameReadyFunc onFrameReadyFn;
     FrameDroppedFunc onFrameDroppedFn;
     DepayRtpPayloadFunc depayPayloadFn;
+    // NULL when the depayloaded data is the tail of the payload
+    DepayRtpPayloadSegmentsFunc depayPayloadSegmentsFn;
+
+    // Frames being assembled ordered by sequence number, the oldest one is at headFrameIndex
+    JitterBufferFrame frames[JITTER_BUFFER_MAX_FRAME_COUNT];
+    UINT32 headFrameIndex;
+    UINT32 frameCount;
 
     UINT32 lastPushTimestamp;
     UINT16 lastRemovedSequenceNumber;
-    UINT16 lastPopSequenceNumber;
-    UINT32 lastPopTimestamp;
+    // How long frames wait for missing packets, in clock units. latency stays at maxLatency unless it is adaptive
     UINT64 maxLatency;
+    UINT64 minLatency;
+    UINT64 latency;
+    BOOL adaptiveLatency;
+    // RFC 3550 interarrival jitter in clock units scaled by 16, from the arrival time and timestamp of the previous packet
+    UINT64 scaledJitter;
+    UINT64 lastReceivedTime;
+    UINT32 lastReceivedTimestamp;
+    // How far behind the newest timestamp retransmitted and reordered packets arrive, in clock units
+    UINT64 holeFillDelay;
     UINT64 customData;
     UINT32 clockRate;
     BOOL started;
+    // Until the first frame leaves the buffer, packets reordered ahead of the first received one are still accepted
+    BOOL framePopped;
+    // Whether the marker bit reliably ends a frame, so a complete frame leaves without waiting for the next one to start
+    BOOL releaseOnMarker;
+
+    // Whether gaps in the received sequence numbers are tracked for NACKs
+    BOOL nackEnabled;
+    UINT16 highestSequenceNumber;
+    // Packets missing behind highestSequenceNumber in sequence number order
+    JitterBufferMissingPacket missingPackets[JITTER_BUFFER_MAX_NACK_PACKET_COUNT];
+    UINT32 missingPacketCount;
+    // Counters, only written by the thread pushing packets
+    volatile SIZE_T packetsNacked;
+    volatile SIZE_T packetsRecovered;
 } JitterBuffer, *PJitterBuffer;
 
+#define JITTER_BUFFER_PACKET_SLOT(pJitterBuffer, seqNum) (&(pJitterBuffer)->pPacketRing[(seqNum) & ((pJitterBuffer)->packetRingSize - 1)])
+
+#define JITTER_BUFFER_FRAME(pJitterBuffer, i) (&(pJitterBuffer)->frames[((pJitterBuffer)->headFrameIndex + (i)) % JITTER_BUFFER_MAX_FRAME_COUNT])
+
+// Distance of a sequence number from the next one expected out of the buffer
+#define JITTER_BUFFER_SEQUENCE_NUMBER_OFFSET(pJitterBuffer, seqNum) ((UINT16) ((seqNum) - (pJitterBuffer)->lastRemovedSequenceNumber - 1))
+
 STATUS createJitterBuffer(FrameReadyFunc, FrameDroppedFunc, DepayRtpPayloadFunc, UINT32, UINT32, UINT64, PJitterBuffer*);
 STATUS freeJitterBuffer(PJitterBuffer*);
 STATUS jitterBufferPush(PJitterBuffer, PRtpPacket);
@@ -37,6 +131,176 @@ STATUS jitterBufferPop(PJitterBuffer, BOOL);
 STATUS jitterBufferDropBufferData(PJitterBuffer, UINT16, UINT16, UINT32);
 STATUS jitterBufferFillFrameData(PJitterBuffer, PBYTE, UINT32, PUINT32, UINT16, UINT16);
 
+/**
+ * Describe the depayloaded data of a frame as segments pointing into its packets instead of copying it
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - PRtcFrameSegment - OUT - Segments, NULL to only count them
+ * @param - PUINT32 - IN/OUT - Number of segments that fit, set to the number of segments of the frame
+ * @param - UINT16 - IN - First sequence number of the frame
+ * @param - UINT16 - IN - Last sequence number of the frame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferFillFrameSegments(PJitterBuffer, PRtcFrameSegment, PUINT32, UINT16, UINT16);
+
+/**
+ * Set how the segments of a frame are found in its payloads, for depayloaders that do more than strip a header
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - DepayRtpPayloadSegmentsFunc - IN - Segments depayloader, NULL when the depayloaded data is the tail of the payload
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferSetDepayPayloadSegmentsFunc(PJitterBuffer, DepayRtpPayloadSegmentsFunc);
+
+/**
+ * Always wait the given time for missing packets
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT64 - IN - Wait in 100ns, replaces the max latency the jitter buffer was created with
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferSetMaxLatency(PJitterBuffer, UINT64);
+
+/**
+ * Size the wait for missing packets from the measured interarrival jitter and hole fill delay instead of always
+ * waiting the max latency
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT64 - IN - Shortest wait in 100ns
+ * @param - UINT64 - IN - Longest wait in 100ns, replaces the max latency the jitter buffer was created with
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferSetAdaptiveLatency(PJitterBuffer, UINT64, UINT64);
+
+/**
+ * Release a frame as soon as it is complete from a start packet up to the packet carrying the marker bit instead of
+ * once the first packet of the next frame is received. Only for payloads whose marker bit ends every frame.
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - BOOL - IN - Whether the marker bit ends frames
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferSetReleaseOnMarker(PJitterBuffer, BOOL);
+
+/**
+ * Track the packets missing from the received sequence numbers so that they can be NACKed
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - BOOL - IN - Whether missing packets are NACKed
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferSetNackEnabled(PJitterBuffer, BOOL);
+
+/**
+ * Sequence numbers of the missing packets due for a NACK, in sequence number order. A packet is NACKed again one round
+ * trip after the previous NACK, and given up on after JITTER_BUFFER_MAX_NACK_RETRY_COUNT NACKs or once a retransmission
+ * could no longer arrive before its frame stops waiting.
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT64 - IN - Current time in 100ns
+ * @param - UINT64 - IN - Round trip time in 100ns, 0 if unknown
+ * @param - PUINT16 - OUT - Sequence numbers
+ * @param - PUINT32 - IN/OUT - Number of sequence numbers that fit, set to the number of sequence numbers due
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferGetNackList(PJitterBuffer, UINT64, UINT64, PUINT16, PUINT32);
+
+/**
+ * Buffered packet with the given sequence number
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT16 - IN - Sequence number
+ *
+ * @return - PRtpPacket the packet or NULL if it is not buffered
+ */
+PRtpPacket jitterBufferGetPacket(PJitterBuffer, UINT16);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+
+/**
+ * Account a stored packet in the frame of its timestamp, creating the frame if it is the first packet of it
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - PRtpPacket - IN - Packet that was just stored
+ * @param - UINT32 - IN - Depayloaded size of the packet
+ * @param - BOOL - IN - Whether the depayloader reported the packet as the start of a frame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferAddToFrame(PJitterBuffer, PRtpPacket, UINT32, BOOL);
+
+/**
+ * Release the oldest frame if it is complete, or drop it if it is incomplete and can no longer wait
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - BOOL - IN - Whether the frame can no longer wait because it expired or the buffer is closing
+ * @param - PBOOL - OUT - Whether the frame left the buffer
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferPopHeadFrame(PJitterBuffer, BOOL, PBOOL);
+
+/**
+ * Account the arrival of a packet in the interarrival jitter and hole fill delay and resize an adaptive latency
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - PRtpPacket - IN - Packet that was just pushed, stamped with its received time
+ */
+VOID jitterBufferUpdateLatency(PJitterBuffer, PRtpPacket);
+
+/**
+ * Account a stored packet in the missing packets, it either fills a gap or opens one behind it
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - PRtpPacket - IN - Packet that was just stored, stamped with its received time
+ */
+VOID jitterBufferUpdateMissingPackets(PJitterBuffer, PRtpPacket);
+
+/**
+ * Grow the packet ring so that it covers at least the given number of sequence numbers from the next expected one
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT32 - IN - Number of sequence numbers to cover
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferGrowPacketRing(PJitterBuffer, UINT32);
+
+/**
+ * Free the buffered packets in a range of sequence numbers
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT16 - IN - First sequence number to free
+ * @param - UINT16 - IN - Last sequence number to free
+ */
+VOID jitterBufferFreePackets(PJitterBuffer, UINT16, UINT16);
+
+/**
+ * Free the packets from the next expected sequence number up to and including the given one
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ * @param - UINT16 - IN - Last sequence number to free
+ */
+VOID jitterBufferRemovePackets(PJitterBuffer, UINT16);
+
+/**
+ * Assemble the frames again from the packets left after packets were removed outside of the frame boundaries
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer
+ *
+ * @return - STATUS status of execution
+ */
+STATUS jitterBufferRebuildFrames(PJitterBuffer);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -0,0 +1,200 @@
+#define LOG_CLASS "Metrics"
+
+#include "../Include_i.h"
+
+STATUS getIceCandidatePairStats(PKvsPeerConnection pKvsPeerConnection, PRtcIceCandidatePairStats pRtcIceCandidatePairStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceAgent pIceAgent = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pKvsPeerConnection->pIceAgent != NULL && pRtcIceCandidatePairStats != NULL, STATUS_NULL_ARG);
+    pIceAgent = pKvsPeerConnection->pIceAgent;
+
+    MEMSET(pRtcIceCandidatePairStats, 0x00, SIZEOF(RtcIceCandidatePairStats));
+    pRtcIceCandidatePairStats->packetsSent = ATOMIC_LOAD(&pIceAgent->packetsSent);
+    pRtcIceCandidatePairStats->bytesSent = ATOMIC_LOAD(&pIceAgent->bytesSent);
+    pRtcIceCandidatePairStats->packetsReceived = ATOMIC_LOAD(&pIceAgent->packetsReceived);
+    pRtcIceCandidatePairStats->bytesReceived = ATOMIC_LOAD(&pIceAgent->bytesReceived);
+    pRtcIceCandidatePairStats->packetsDiscardedOnSend = (UINT32) ATOMIC_LOAD(&pIceAgent->packetsDiscardedOnSend);
+    pRtcIceCandidatePairStats->bytesDiscardedOnSend = ATOMIC_LOAD(&pIceAgent->bytesDiscardedOnSend);
+    pRtcIceCandidatePairStats->currentRoundTripTime =
+        (DOUBLE) ATOMIC_LOAD(&pIceAgent->selectedCandidatePairRoundTripTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getTransportStats(PKvsPeerConnection pKvsPeerConnection, PRtcTransportStats pRtcTransportStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceAgent pIceAgent = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pKvsPeerConnection->pIceAgent != NULL && pRtcTransportStats != NULL, STATUS_NULL_ARG);
+    pIceAgent = pKvsPeerConnection->pIceAgent;
+
+    MEMSET(pRtcTransportStats, 0x00, SIZEOF(RtcTransportStats));
+    pRtcTransportStats->packetsSent = ATOMIC_LOAD(&pIceAgent->packetsSent);
+    pRtcTransportStats->bytesSent = ATOMIC_LOAD(&pIceAgent->bytesSent);
+    pRtcTransportStats->packetsReceived = ATOMIC_LOAD(&pIceAgent->packetsReceived);
+    pRtcTransportStats->bytesReceived = ATOMIC_LOAD(&pIceAgent->bytesReceived);
+    pRtcTransportStats->selectedCandidatePairChanges = (UINT32) ATOMIC_LOAD(&pIceAgent->selectedCandidatePairChanges);
+    pRtcTransportStats->iceRole = pIceAgent->isControlling ? RTC_ICE_ROLE_CONTROLLING : RTC_ICE_ROLE_CONTROLLED;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getOutboundRtpStreamStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcOutboundRtpStreamStats pRtcOutboundRtpStreamStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtcRtpSender pSender = NULL;
+    PRtpRollingBuffer pPacketBuffer = NULL;
+
+    CHK(pKvsRtpTransceiver != NULL && pRtcOutboundRtpStreamStats != NULL, STATUS_NULL_ARG);
+    pSender = &pKvsRtpTransceiver->sender;
+
+    MEMSET(pRtcOutboundRtpStreamStats, 0x00, SIZEOF(RtcOutboundRtpStreamStats));
+    pRtcOutboundRtpStreamStats->packetsSent = ATOMIC_LOAD(&pSender->packetsSent);
+    pRtcOutboundRtpStreamStats->bytesSent = ATOMIC_LOAD(&pSender->bytesSent);
+    pRtcOutboundRtpStreamStats->headerBytesSent = ATOMIC_LOAD(&pSender->headerBytesSent);
+    pRtcOutboundRtpStreamStats->framesSent = (UINT32) ATOMIC_LOAD(&pSender->framesSent);
+    pRtcOutboundRtpStreamStats->retransmittedPacketsSent = ATOMIC_LOAD(&pSender->retransmittedPacketsSent);
+    pRtcOutboundRtpStreamStats->retransmittedBytesSent = ATOMIC_LOAD(&pSender->retransmittedBytesSent);
+    pRtcOutboundRtpStreamStats->nackCount = (UINT32) ATOMIC_LOAD(&pSender->nackCount);
+    pRtcOutboundRtpStreamStats->pliCount = (UINT32) ATOMIC_LOAD(&pSender->pliCount);
+    pRtcOutboundRtpStreamStats->firCount = (UINT32) ATOMIC_LOAD(&pSender->firCount);
+    pRtcOutboundRtpStreamStats->sendBufferAllocations = ATOMIC_LOAD(&pSender->packetArena.allocationCount);
+
+    // The retransmission buffer is created once the remote description is set
+    pPacketBuffer = pSender->packetBuffer;
+    if (pPacketBuffer != NULL) {
+        pRtcOutboundRtpStreamStats->retransmissionBufferAllocations = ATOMIC_LOAD(&pPacketBuffer->allocationCount);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getInboundRtpStreamStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcInboundRtpStreamStats pRtcInboundRtpStreamStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKvsRtpTransceiver != NULL && pRtcInboundRtpStreamStats != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pRtcInboundRtpStreamStats, 0x00, SIZEOF(RtcInboundRtpStreamStats));
+    pRtcInboundRtpStreamStats->packetsReceived = ATOMIC_LOAD(&pKvsRtpTransceiver->packetsReceived);
+    pRtcInboundRtpStreamStats->bytesReceived = ATOMIC_LOAD(&pKvsRtpTransceiver->bytesReceived);
+    pRtcInboundRtpStreamStats->packetsLost = (SSIZE_T) ATOMIC_LOAD(&pKvsRtpTransceiver->packetsLost);
+    pRtcInboundRtpStreamStats->jitter = ATOMIC_LOAD(&pKvsRtpTransceiver->jitter);
+    pRtcInboundRtpStreamStats->framesReceived = ATOMIC_LOAD(&pKvsRtpTransceiver->framesReceived);
+    pRtcInboundRtpStreamStats->framesDropped = ATOMIC_LOAD(&pKvsRtpTransceiver->framesDropped);
+    pRtcInboundRtpStreamStats->nackCount = ATOMIC_LOAD(&pKvsRtpTransceiver->nackPacketsSent);
+    pRtcInboundRtpStreamStats->pliCount = ATOMIC_LOAD(&pKvsRtpTransceiver->pliPacketsSent);
+    pRtcInboundRtpStreamStats->firCount = ATOMIC_LOAD(&pKvsRtpTransceiver->firPacketsSent);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getRemoteInboundRtpStreamStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcRemoteInboundRtpStreamStats pRtcRemoteInboundRtpStreamStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKvsRtpTransceiver != NULL && pRtcRemoteInboundRtpStreamStats != NULL, STATUS_NULL_ARG);
+
+    // Only held while RTCP reports are parsed, never while media is sent or received
+    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+    *pRtcRemoteInboundRtpStreamStats = pKvsRtpTransceiver->remoteInboundRtpStreamStats;
+    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getRemoteOutboundRtpStreamStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcOutboundRtpStreamStats pRtcOutboundRtpStreamStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKvsRtpTransceiver != NULL && pRtcOutboundRtpStreamStats != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+    *pRtcOutboundRtpStreamStats = pKvsRtpTransceiver->remoteOutboundRtpStreamStats;
+    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS RtcPeerConnectionGetMetrics(PRtcPeerConnection pRtcPeerConnection, PRtcStats pRtcStats)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    PRtcStatsObject pRtcStatsObject = NULL;
+    BOOL all = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pRtcStats != NULL, STATUS_NULL_ARG);
+
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcStats->pRtcRtpTransceiver;
+    pRtcStatsObject = &pRtcStats->rtcStatsObject;
+    all = pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_RTC_ALL;
+    CHK(pKvsRtpTransceiver == NULL || pKvsRtpTransceiver->pKvsPeerConnection == pKvsPeerConnection, STATUS_INVALID_ARG);
+
+    switch (pRtcStats->requestedTypeOfStats) {
+        case RTC_STATS_TYPE_CANDIDATE_PAIR:
+        case RTC_STATS_TYPE_TRANSPORT:
+        case RTC_STATS_TYPE_RTC_ALL:
+            break;
+
+        case RTC_STATS_TYPE_OUTBOUND_RTP:
+        case RTC_STATS_TYPE_INBOUND_RTP:
+        case RTC_STATS_TYPE_REMOTE_INBOUND_RTP:
+        case RTC_STATS_TYPE_REMOTE_OUTBOUND_RTP:
+            CHK(pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+            break;
+
+        default:
+            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
+    }
+
+    pRtcStats->timestamp = GETTIME();
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_CANDIDATE_PAIR) {
+        CHK_STATUS(getIceCandidatePairStats(pKvsPeerConnection, &pRtcStatsObject->iceCandidatePairStats));
+    }
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_TRANSPORT) {
+        CHK_STATUS(getTransportStats(pKvsPeerConnection, &pRtcStatsObject->transportStats));
+    }
+
+    // Without a transceiver there are no RTP streams to report
+    CHK(pKvsRtpTransceiver != NULL, retStatus);
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_OUTBOUND_RTP) {
+        CHK_STATUS(getOutboundRtpStreamStats(pKvsRtpTransceiver, &pRtcStatsObject->outboundRtpStreamStats));
+    }
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_INBOUND_RTP) {
+        CHK_STATUS(getInboundRtpStreamStats(pKvsRtpTransceiver, &pRtcStatsObject->inboundRtpStreamStats));
+    }
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_REMOTE_INBOUND_RTP) {
+        CHK_STATUS(getRemoteInboundRtpStreamStats(pKvsRtpTransceiver, &pRtcStatsObject->remoteInboundRtpStreamStats));
+    }
+
+    if (all || pRtcStats->requestedTypeOfStats == RTC_STATS_TYPE_REMOTE_OUTBOUND_RTP) {
+        CHK_STATUS(getRemoteOutboundRtpStreamStats(pKvsRtpTransceiver, &pRtcStatsObject->remoteOutboundRtpStreamStats));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
@@ -0,0 +1,81 @@
+/*******************************************
+Metrics internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT__METRICS_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT__METRICS_H
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stats are read from counters the send and receive paths update with atomics, so that collecting them never waits
+ * for the SRTP session lock or the ICE agent lock held while media is being sent or received.
+ */
+
+/**
+ * Fill the stats of the candidate pair media is sent on
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PRtcIceCandidatePairStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getIceCandidatePairStats(PKvsPeerConnection, PRtcIceCandidatePairStats);
+
+/**
+ * Fill the stats of the transport of a peer connection
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PRtcTransportStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getTransportStats(PKvsPeerConnection, PRtcTransportStats);
+
+/**
+ * Fill the stats of the stream a transceiver sends
+ *
+ * @param - PKvsRtpTransceiver - IN - Transceiver
+ * @param - PRtcOutboundRtpStreamStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getOutboundRtpStreamStats(PKvsRtpTransceiver, PRtcOutboundRtpStreamStats);
+
+/**
+ * Fill the stats of the stream a transceiver receives
+ *
+ * @param - PKvsRtpTransceiver - IN - Transceiver
+ * @param - PRtcInboundRtpStreamStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getInboundRtpStreamStats(PKvsRtpTransceiver, PRtcInboundRtpStreamStats);
+
+/**
+ * Fill what the receiver reports of the remote peer tell about the stream a transceiver sends
+ *
+ * @param - PKvsRtpTransceiver - IN - Transceiver
+ * @param - PRtcRemoteInboundRtpStreamStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getRemoteInboundRtpStreamStats(PKvsRtpTransceiver, PRtcRemoteInboundRtpStreamStats);
+
+/**
+ * Fill what the sender reports of the remote peer tell about the stream a transceiver receives
+ *
+ * @param - PKvsRtpTransceiver - IN - Transceiver
+ * @param - PRtcOutboundRtpStreamStats - OUT - Stats
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getRemoteOutboundRtpStreamStats(PKvsRtpTransceiver, PRtcOutboundRtpStreamStats);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  /* __KINESIS_VIDEO_WEBRTC_CLIENT__METRICS_H */
@@ -26,6 +26,12 @@ STATUS allocateSrtp(PKvsPeerConnection pKvsPeerConnection)
             &(pKvsPeerConnection->pSrtpSession)
     ));
 
+    // Feedback of the received streams goes out from the timer queue rather than from the thread receiving the packets
+    if (pKvsPeerConnection->rtcpFeedbackTimerId == MAX_UINT32) {
+        CHK_STATUS(timerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, RTCP_FEEDBACK_INTERVAL, RTCP_FEEDBACK_INTERVAL,
+                                      rtcpFeedbackTimerCallback, (UINT64) pKvsPeerConnection, &pKvsPeerConnection->rtcpFeedbackTimerId));
+    }
+
 CleanUp:
     if (locked) {
         MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
@@ -105,6 +111,7 @@ VOID onInboundPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
     BOOL isDtlsConnected = FALSE;
     INT32 signedBuffLen = buffLen;
+    PRtpPacket pRtpPacket = NULL;
 
     CHK(signedBuffLen > 2 && pKvsPeerConnection != NULL, STATUS_SUCCESS);
 
@@ -138,68 +145,104 @@ VOID onInboundPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
         }
 
     } else if ((buff[0] > 127 && buff[0] < 192) && (pKvsPeerConnection->pSrtpSession != NULL)) {
-        if (buff[1] >= 192 && buff[1] <= 223) {
-            if (STATUS_FAILED(retStatus = decryptSrtcpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
-                DLOGW("decryptSrtcpPacket failed with 0x%08x", retStatus);
-                CHK(FALSE, STATUS_SUCCESS);
-            }
-
-            CHK_STATUS(onRtcpPacket(pKvsPeerConnection, buff, signedBuffLen));
+        if (pKvsPeerConnection->pInboundPacketQueue != NULL) {
+            // decrypted and processed on the queue thread so that application callbacks never block reception
+            CHK_STATUS(inboundPacketQueuePush(pKvsPeerConnection->pInboundPacketQueue, buff, buffLen));
         } else {
-            if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
-                DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
-                CHK(FALSE, STATUS_SUCCESS);
-            }
-
-            CHK_STATUS(sendPacketToRtpReceiver(pKvsPeerConnection, buff, signedBuffLen));
+            // The receive buffer is reused for the next datagram, so the packet is copied once into a pooled packet
+            // that the jitter buffer can keep without copying it again
+            CHK_STATUS(rtpPacketPoolGetWithSize(pKvsPeerConnection->pRtpPacketPool, buffLen, &pRtpPacket));
+            MEMCPY(pRtpPacket->pRawPacket, buff, buffLen);
+            pRtpPacket->rawPacketLength = buffLen;
+            pRtpPacket->receivedTime = GETTIME();
+            onInboundSrtpPacket(customData, pRtpPacket);
         }
     }
 
 CleanUp:
 
+    freeRtpPacketAndRawPacket(&pRtpPacket);
     CHK_LOG_ERR(retStatus);
 }
 
-STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuffer, UINT32 bufferLen)
+VOID onInboundSrtpPacket(UINT64 customData, PRtpPacket pRtpPacket)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    PDoubleListNode pCurNode = NULL;
-    PKvsRtpTransceiver pTransceiver;
-    UINT64 item;
-    UINT32 ssrc;
-    PRtpPacket pRtpPacket = NULL;
-    PBYTE pPayload = NULL;
-    BOOL ownedByJitterBuffer = FALSE;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PBYTE buff = NULL;
+    INT32 signedBuffLen = 0;
 
-    CHK(pKvsPeerConnection != NULL && pBuffer != NULL, STATUS_NULL_ARG);
-    CHK(bufferLen >= MIN_HEADER_LENGTH, STATUS_INVALID_ARG);
+    CHK(pRtpPacket != NULL && pKvsPeerConnection != NULL && pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS);
 
-    ssrc = getInt32(*(PUINT32) (pBuffer + SSRC_OFFSET));
+    // Decrypted in place, the packet is not copied again on the way to the jitter buffer
+    buff = pRtpPacket->pRawPacket;
+    signedBuffLen = pRtpPacket->rawPacketLength;
+    CHK(signedBuffLen > 2, STATUS_SUCCESS);
 
-    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
-    while(pCurNode != NULL) {
-        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
-        pTransceiver = (PKvsRtpTransceiver) item;
-
-        if (pTransceiver->jitterBufferSsrc == ssrc) {
-            CHK(NULL != (pPayload = (PBYTE) MEMALLOC(bufferLen)), STATUS_NOT_ENOUGH_MEMORY);
-            MEMCPY(pPayload, pBuffer, bufferLen);
-            CHK_STATUS(createRtpPacketFromBytes(pPayload, bufferLen, &pRtpPacket));
-            CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket));
-            ownedByJitterBuffer = TRUE;
+    if (buff[1] >= 192 && buff[1] <= 223) {
+        if (STATUS_FAILED(retStatus = decryptSrtcpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
+            DLOGW("decryptSrtcpPacket failed with 0x%08x", retStatus);
             CHK(FALSE, STATUS_SUCCESS);
         }
-        pCurNode = pCurNode->pNext;
+
+        CHK_STATUS(onRtcpPacket(pKvsPeerConnection, buff, signedBuffLen));
+    } else {
+        if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
+            DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
+            CHK(FALSE, STATUS_SUCCESS);
+        }
+
+        pRtpPacket->rawPacketLength = signedBuffLen;
+        CHK_STATUS(sendPacketToRtpReceiver(pKvsPeerConnection, pRtpPacket));
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+}
+
+STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pTransceiver = NULL;
+    UINT32 ssrc;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pRtpPacket != NULL && pRtpPacket->pRawPacket != NULL, STATUS_NULL_ARG);
+    CHK(pRtpPacket->rawPacketLength >= MIN_HEADER_LENGTH, STATUS_INVALID_ARG);
+
+    ssrc = getInt32(*(PUINT32) (pRtpPacket->pRawPacket + SSRC_OFFSET));
+
+    CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_REMOTE_SSRC_KEY(ssrc), &pTransceiver));
+    CHK_WARN(pTransceiver != NULL, STATUS_SUCCESS, "No transceiver to handle inbound ssrc %u", ssrc);
+
+    // Parsed in place, header fields and payload point into the raw packet
+    CHK_STATUS(setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
+
+    // Only the arrival is recorded here, the feedback that is due goes out from the timer queue
+    if (pKvsPeerConnection->pTwccManager != NULL) {
+        CHK_STATUS(sendRtcpTwccPacket(pKvsPeerConnection, pTransceiver, pRtpPacket));
     }
 
-    DLOGW("No transceiver to handle inbound ssrc %u", ssrc);
+    MUTEX_LOCK(pTransceiver->receiverLock);
+    locked = TRUE;
+
+    ATOMIC_INCREMENT(&pTransceiver->packetsReceived);
+    ATOMIC_ADD(&pTransceiver->bytesReceived, pRtpPacket->payloadLength);
+
+    // The jitter buffer adopts the packet with a reference of its own, the caller keeps its reference
+    CHK_STATUS(rtpPacketAddReference(pRtpPacket));
+    CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket));
+
+    CHK_STATUS(rtcpReceptionStatsUpdate(&pTransceiver->receptionStats, pRtpPacket->header.sequenceNumber));
 
 CleanUp:
-    if (!ownedByJitterBuffer) {
-        SAFE_MEMFREE(pPayload);
-        freeRtpPacket(&pRtpPacket);
-        CHK_LOG_ERR(retStatus);
+    if (locked) {
+        MUTEX_UNLOCK(pTransceiver->receiverLock);
     }
+
+    CHK_LOG_ERR(retStatus);
+
     return retStatus;
 }
 
@@ -240,14 +283,45 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
     STATUS retStatus = STATUS_SUCCESS;
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     PRtpPacket pPacket = NULL;
+    PRtcFrameSegments pFrameSegments = NULL;
     Frame frame;
     UINT32 filledSize = 0;
+    BOOL isKeyFrame = FALSE;
 
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
 
-    pPacket = pTransceiver->pJitterBuffer->pktBuffer[startIndex];
+    pPacket = jitterBufferGetPacket(pTransceiver->pJitterBuffer, startIndex);
     CHK(pPacket != NULL, STATUS_NULL_ARG);
 
+    // Checked before the payload could be rewritten into segments
+    if (pTransceiver->keyFrameRequired) {
+        switch (pTransceiver->transceiver.receiver.track.codec) {
+            case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
+                CHK_STATUS(isH264KeyFrameRtpPayload(pPacket->payload, pPacket->payloadLength, &isKeyFrame));
+                break;
+
+            case RTC_CODEC_VP8:
+                CHK_STATUS(isVP8KeyFrameRtpPayload(pPacket->payload, pPacket->payloadLength, &isKeyFrame));
+                break;
+
+            default:
+                // Audio frames do not depend on each other
+                isKeyFrame = TRUE;
+        }
+
+        pTransceiver->keyFrameRequired = !isKeyFrame;
+    }
+
+    ATOMIC_INCREMENT(&pTransceiver->framesReceived);
+
+    if (pTransceiver->onFrameSegments != NULL) {
+        CHK_STATUS(createFrameSegments(pTransceiver->pJitterBuffer, startIndex, endIndex, frameSize, &pFrameSegments));
+        pFrameSegments->presentationTs = pPacket->header.timestamp * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        // The application owns the frame from here on, nothing is copied
+        pTransceiver->onFrameSegments(pTransceiver->onFrameSegmentsCustomData, pFrameSegments);
+        CHK(FALSE, retStatus);
+    }
+
     if (frameSize > pTransceiver->peerFrameBufferSize) {
         MEMFREE(pTransceiver->peerFrameBuffer);
         pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
@@ -276,9 +350,27 @@ CleanUp:
 
 STATUS onFrameDroppedFunc(UINT64 customData, UINT32 timestamp)
 {
-    UNUSED_PARAM(customData);
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
+
+    CHK(pTransceiver != NULL, STATUS_NULL_ARG);
+
     DLOGW("Frame with timestamp %ld is dropped!", timestamp);
-    return STATUS_SUCCESS;
+    ATOMIC_INCREMENT(&pTransceiver->framesDropped);
+
+    // The next frames refer to the dropped one, the RTCP feedback timer asks the sender for a key frame
+    switch (pTransceiver->transceiver.receiver.track.codec) {
+        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
+        case RTC_CODEC_VP8:
+            pTransceiver->keyFrameRequired = TRUE;
+            break;
+
+        default:
+            break;
+    }
+
+CleanUp:
+    return retStatus;
 }
 
 VOID onIceConnectionStateChange(UINT64 customData, UINT64 connectionState)
@@ -483,7 +575,7 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     PKvsPeerConnection pKvsPeerConnection = NULL;
     IceAgentCallbacks iceAgentCallbacks;
     DtlsSessionCallbacks dtlsSessionCallbacks;
-    UINT32 logLevel = LOG_LEVEL_DEBUG;
+    UINT32 logLevel = LOG_LEVEL_DEBUG, inboundPacketQueueSize, ioWorkerCount = 0;
     PCHAR logLevelStr = NULL;
     PConnectionListener pConnectionListener = NULL;
 
@@ -506,12 +598,16 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
             pConfiguration->kvsRtcConfiguration.generatedCertificateBits,
 	    pConfiguration->kvsRtcConfiguration.generateRSACertificate,
             pConfiguration->certificates, &pKvsPeerConnection->pDtlsSession));
+    CHK_STATUS(dtlsSessionSetSrtpProfiles(pKvsPeerConnection->pDtlsSession, pConfiguration->kvsRtcConfiguration.srtpProfiles,
+                                          ARRAY_SIZE(pConfiguration->kvsRtcConfiguration.srtpProfiles)));
     CHK_STATUS(dtlsSessionOnOutBoundData(pKvsPeerConnection->pDtlsSession, (UINT64) pKvsPeerConnection, onDtlsOutboundPacket));
     CHK_STATUS(dtlsSessionOnStateChange(pKvsPeerConnection->pDtlsSession, (UINT64) pKvsPeerConnection, onDtlsStateChange));
 
     CHK_STATUS(hashTableCreateWithParams(CODEC_HASH_TABLE_BUCKET_COUNT, CODEC_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pCodecTable));
     CHK_STATUS(hashTableCreateWithParams(CODEC_HASH_TABLE_BUCKET_COUNT, CODEC_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pDataChannels));
     CHK_STATUS(hashTableCreateWithParams(RTX_HASH_TABLE_BUCKET_COUNT, RTX_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pRtxTable));
+    CHK_STATUS(hashTableCreateWithParams(TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT, TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH,
+                                         &pKvsPeerConnection->pTransceiverSsrcTable));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pTransceievers)));
 
     if ((logLevelStr = GETENV(DEBUG_LOG_LEVEL_ENV_VAR)) != NULL) {
@@ -523,14 +619,37 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
 
     pKvsPeerConnection->pSrtpSessionLock = MUTEX_CREATE(TRUE);
     pKvsPeerConnection->peerConnectionObjLock = MUTEX_CREATE(FALSE);
+    pKvsPeerConnection->twccFeedbackTimerId = MAX_UINT32;
+    pKvsPeerConnection->rtcpFeedbackTimerId = MAX_UINT32;
     pKvsPeerConnection->connectionState = RTC_PEER_CONNECTION_STATE_NONE;
     pKvsPeerConnection->MTU = pConfiguration->kvsRtcConfiguration.maximumTransmissionUnit == 0 ? DEFAULT_MTU_SIZE : pConfiguration->kvsRtcConfiguration.maximumTransmissionUnit;
 
+    // A receive callback blocking a shared I/O worker would hold back every peer connection on it, so each one queues
+    // its packets for a thread of its own unless told otherwise
+    inboundPacketQueueSize = pConfiguration->kvsRtcConfiguration.inboundPacketQueueSize;
+    if (inboundPacketQueueSize == 0) {
+        CHK_STATUS(connectionListenerGetEventLoopMetrics(NULL, &ioWorkerCount));
+        inboundPacketQueueSize = ioWorkerCount == 0 ? 0 : DEFAULT_INBOUND_PACKET_QUEUE_SIZE;
+    } else if (inboundPacketQueueSize == INBOUND_PACKET_QUEUE_SIZE_DISABLED) {
+        inboundPacketQueueSize = 0;
+    }
+
+    // Packets waiting in the inbound queue are pooled as well so the pool is sized to hold them on top of the jitter buffers
+    CHK_STATUS(createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, DEFAULT_RTP_PACKET_POOL_CAPACITY + inboundPacketQueueSize,
+                                   &pKvsPeerConnection->pRtpPacketPool));
+
+    if (inboundPacketQueueSize != 0) {
+        CHK_STATUS(createInboundPacketQueue(inboundPacketQueueSize, pKvsPeerConnection->pRtpPacketPool, onInboundSrtpPacket,
+                                            (UINT64) pKvsPeerConnection, &pKvsPeerConnection->pInboundPacketQueue));
+    }
+
+    CHK_STATUS(sendWorkerPoolAcquireQueue(&pKvsPeerConnection->pSendQueue));
+
     iceAgentCallbacks.customData = (UINT64) pKvsPeerConnection;
     iceAgentCallbacks.inboundPacketFn = onInboundPacket;
     iceAgentCallbacks.connectionStateChangedFn = onIceConnectionStateChange;
     iceAgentCallbacks.newLocalCandidateFn = onNewIceLocalCandidate;
-    CHK_STATUS(createConnectionListener(&pConnectionListener));
+    CHK_STATUS(createConnectionListenerWithReceiveBatchSize(pConfiguration->kvsRtcConfiguration.receiveBatchSize, &pConnectionListener));
     // IceAgent will own the lifecycle of pConnectionListener;
     CHK_STATUS(createIceAgent(pKvsPeerConnection->localIceUfrag, pKvsPeerConnection->localIcePwd, &iceAgentCallbacks, pConfiguration,
                               pKvsPeerConnection->timerQueueHandle, pConnectionListener, &pKvsPeerConnection->pIceAgent));
@@ -575,6 +694,9 @@ STATUS freePeerConnection(PRtcPeerConnection *ppPeerConnection)
 
     CHK(pKvsPeerConnection != NULL, retStatus);
 
+    // Queued frames go out through the SRTP session and the IceAgent, wait for the one being sent and drop the others
+    CHK_LOG_ERR(sendWorkerPoolReleaseQueue(&pKvsPeerConnection->pSendQueue));
+
     /* Shutdown IceAgent first so there is no more incoming packets which can cause
      * SCTP to be allocated again after SCTP is freed. */
     CHK_LOG_ERR(iceAgentShutdown(pKvsPeerConnection->pIceAgent));
@@ -589,6 +711,9 @@ STATUS freePeerConnection(PRtcPeerConnection *ppPeerConnection)
     CHK_LOG_ERR(freeSctpSession(&pKvsPeerConnection->pSctpSession));
     CHK_LOG_ERR(freeIceAgent(&pKvsPeerConnection->pIceAgent));
 
+    // No more packets come in now, stop processing the queued ones before the transceivers go away
+    CHK_LOG_ERR(freeInboundPacketQueue(&pKvsPeerConnection->pInboundPacketQueue));
+
     // free transceivers
     CHK_LOG_ERR(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
     while(pCurNode != NULL) {
@@ -603,11 +728,15 @@ STATUS freePeerConnection(PRtcPeerConnection *ppPeerConnection)
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pDataChannels));
 
     // free rest of structs
+    // All pooled packets have been released by the queue and the jitter buffers at this point
+    CHK_LOG_ERR(freeRtpPacketPool(&pKvsPeerConnection->pRtpPacketPool));
     CHK_LOG_ERR(freeSrtpSession(&pKvsPeerConnection->pSrtpSession));
+    CHK_LOG_ERR(freeTwccManager(&pKvsPeerConnection->pTwccManager));
     CHK_LOG_ERR(freeDtlsSession(&pKvsPeerConnection->pDtlsSession));
     CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pTransceievers));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pCodecTable));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pRtxTable));
+    CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pTransceiverSsrcTable));
     if (IS_VALID_MUTEX_VALUE(pKvsPeerConnection->pSrtpSessionLock)) {
         MUTEX_FREE(pKvsPeerConnection->pSrtpSessionLock);
     }
@@ -630,6 +759,40 @@ CleanUp:
     return retStatus;
 }
 
+STATUS peerConnectionGetInboundPacketQueueStats(PRtcPeerConnection pRtcPeerConnection, PInboundPacketQueueStats pInboundPacketQueueStats)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+    CHK(pKvsPeerConnection != NULL && pInboundPacketQueueStats != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->pInboundPacketQueue != NULL, STATUS_INVALID_OPERATION);
+
+    CHK_STATUS(inboundPacketQueueGetStats(pKvsPeerConnection->pInboundPacketQueue, pInboundPacketQueueStats));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS peerConnectionGetSendQueueStats(PRtcPeerConnection pRtcPeerConnection, PSendQueueStats pSendQueueStats)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+    CHK(pKvsPeerConnection != NULL && pSendQueueStats != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->pSendQueue != NULL, STATUS_INVALID_OPERATION);
+
+    CHK_STATUS(sendQueueGetStats(pKvsPeerConnection->pSendQueue, pSendQueueStats));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS peerConnectionOnIceCandidate(PRtcPeerConnection pRtcPeerConnection, UINT64 customData, RtcOnIceCandidate rtcOnIceCandidate)
 {
     ENTERS();
@@ -771,7 +934,8 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PCHAR remoteIceUfrag = NULL, remoteIcePwd = NULL;
-    UINT32 i, j;
+    UINT32 i, j, extensionId;
+    PCHAR pExtensionUrl;
 
     CHK(pPeerConnection != NULL, STATUS_NULL_ARG);
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
@@ -814,10 +978,33 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
             } else if (STRCMP(pSessionDescription->mediaDescriptions[i].sdpAttributes[j].attributeName, "ice-options") == 0 &&
                        STRCMP(pSessionDescription->mediaDescriptions[i].sdpAttributes[j].attributeValue, "trickle") == 0) {
                 NULLABLE_SET_VALUE(pKvsPeerConnection->canTrickleIce, TRUE);
+            } else if (STRCMP(pSessionDescription->mediaDescriptions[i].sdpAttributes[j].attributeName, "extmap") == 0 &&
+                       (pExtensionUrl = STRCHR(pSessionDescription->mediaDescriptions[i].sdpAttributes[j].attributeValue, ' ')) != NULL &&
+                       STRCMP(pExtensionUrl + 1, TWCC_EXT_URL) == 0 &&
+                       STATUS_SUCCEEDED(STRTOUI32(pSessionDescription->mediaDescriptions[i].sdpAttributes[j].attributeValue, pExtensionUrl, 10, &extensionId)) &&
+                       extensionId > 0 && extensionId <= TWCC_MAX_EXTENSION_ID) {
+                // Only one byte header elements are sent, a two byte only id leaves congestion control off
+                pKvsPeerConnection->twccExtensionId = (UINT8) extensionId;
             }
         }
     }
 
+    if (pKvsPeerConnection->twccExtensionId != 0) {
+        // Packets are stamped with transport wide sequence numbers and feedback is flushed under the session lock
+        MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+        if (pKvsPeerConnection->pTwccManager == NULL) {
+            retStatus = createTwccManager(&pKvsPeerConnection->pTwccManager);
+        }
+
+        // Feedback of the last packets received is sent even when no packet comes in after them
+        if (STATUS_SUCCEEDED(retStatus) && pKvsPeerConnection->twccFeedbackTimerId == MAX_UINT32) {
+            retStatus = timerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, TWCC_FEEDBACK_INTERVAL, TWCC_FEEDBACK_INTERVAL,
+                                           twccFeedbackTimerCallback, (UINT64) pKvsPeerConnection, &pKvsPeerConnection->twccFeedbackTimerId);
+        }
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+        CHK_STATUS(retStatus);
+    }
+
     CHK(remoteIceUfrag != NULL && remoteIcePwd != NULL, STATUS_SESSION_DESCRIPTION_MISSING_ICE_VALUES);
     CHK(pKvsPeerConnection->remoteCertificateFingerprint[0] != '\0', STATUS_SESSION_DESCRIPTION_MISSING_CERTIFICATE_FINGERPRINT);
 
@@ -846,7 +1033,7 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
         CHK_STATUS(setPayloadTypesFromOffer(pKvsPeerConnection->pCodecTable, pKvsPeerConnection->pRtxTable, pSessionDescription));
     }
     CHK_STATUS(setTransceiverPayloadTypes(pKvsPeerConnection->pCodecTable, pKvsPeerConnection->pRtxTable, pKvsPeerConnection->pTransceievers));
-    CHK_STATUS(setReceiversSsrc(pSessionDescription, pKvsPeerConnection->pTransceievers));
+    CHK_STATUS(setReceiversSsrc(pSessionDescription, pKvsPeerConnection));
 
     if (NULL != getenv(DEBUG_LOG_SDP)) {
         DLOGD("REMOTE_SDP:%s\n", pSessionDescriptionInit->sdp);
@@ -921,6 +1108,8 @@ STATUS setLocalDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescri
     CHK(pKvsPeerConnection != NULL && pSessionDescriptionInit != NULL, STATUS_NULL_ARG);
 
     CHK_STATUS(iceAgentStartGathering(pKvsPeerConnection->pIceAgent));
+    // A peer connection from a PeerConnectionPool has been gathering already, report what it found so far
+    CHK_STATUS(iceAgentHoldCandidateReports(pKvsPeerConnection->pIceAgent, FALSE));
 
     if (NULL != getenv(DEBUG_LOG_SDP)) {
         DLOGD("LOCAL_SDP:%s", pSessionDescriptionInit->sdp);
@@ -933,16 +1122,18 @@ CleanUp:
 
 STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack pRtcMediaStreamTrack, PRtcRtpTransceiverInit pRtcRtpTransceiverInit, PRtcRtpTransceiver *ppRtcRtpTransceiver)
 {
-    UNUSED_PARAM(pRtcRtpTransceiverInit);
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
     PJitterBuffer pJitterBuffer = NULL;
     DepayRtpPayloadFunc depayFunc;
+    DepayRtpPayloadSegmentsFunc depaySegmentsFunc = NULL;
     UINT32 clockRate = 0;
     UINT32 ssrc = (UINT32) RAND(), rtxSsrc = (UINT32) RAND();
+    BOOL ssrcInUse = FALSE, rtxSsrcInUse = FALSE, ssrcsMapped = FALSE;
     RTC_RTP_TRANSCEIVER_DIRECTION direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+    BOOL nackEnabled = TRUE;
     if(pRtcRtpTransceiverInit != NULL) {
         direction = pRtcRtpTransceiverInit->direction;
     }
@@ -950,19 +1141,23 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
 
     switch (pRtcMediaStreamTrack->codec) {
+        // A lost audio packet is concealed rather than worth a retransmission
         case RTC_CODEC_OPUS:
             depayFunc = depayOpusFromRtpPayload;
             clockRate = OPUS_CLOCKRATE;
+            nackEnabled = FALSE;
             break;
 
         case RTC_CODEC_MULAW:
         case RTC_CODEC_ALAW:
             depayFunc = depayG711FromRtpPayload;
             clockRate = PCM_CLOCKRATE;
+            nackEnabled = FALSE;
             break;
 
         case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
             depayFunc = depayH264FromRtpPayload;
+            depaySegmentsFunc = depayH264SegmentsFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
@@ -975,22 +1170,43 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
             CHK(FALSE, STATUS_NOT_IMPLEMENTED);
     }
 
-    //TODO: Add ssrc duplicate detection here not only relying on RAND()
+    // Pick ssrcs that no other transceiver of this connection uses so that inbound RTCP maps to a single transceiver
+    do {
+        if (ssrcInUse || ssrc == rtxSsrc) {
+            ssrc = (UINT32) RAND();
+        }
+        if (rtxSsrcInUse) {
+            rtxSsrc = (UINT32) RAND();
+        }
+        CHK_STATUS(hashTableContains(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(ssrc), &ssrcInUse));
+        CHK_STATUS(hashTableContains(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(rtxSsrc), &rtxSsrcInUse));
+    } while (ssrcInUse || rtxSsrcInUse || ssrc == rtxSsrc);
+
     CHK_STATUS(createKvsRtpTransceiver(direction, pKvsPeerConnection, ssrc,
                         rtxSsrc, pRtcMediaStreamTrack, NULL, pRtcMediaStreamTrack->codec, &pKvsRtpTransceiver));
     CHK_STATUS(createJitterBuffer(onFrameReadyFunc, onFrameDroppedFunc, depayFunc, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
                                   clockRate, (UINT64) pKvsRtpTransceiver, &pJitterBuffer));
+    CHK_STATUS(jitterBufferSetDepayPayloadSegmentsFunc(pJitterBuffer, depaySegmentsFunc));
+    CHK_STATUS(jitterBufferSetNackEnabled(pJitterBuffer, nackEnabled));
     CHK_STATUS(kvsRtpTransceiverSetJitterBuffer(pKvsRtpTransceiver, pJitterBuffer));
 
     // after pKvsRtpTransceiver is successfully created, jitterBuffer will be freed by pKvsRtpTransceiver.
     pJitterBuffer = NULL;
 
+    ssrcsMapped = TRUE;
+    CHK_STATUS(hashTablePut(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(ssrc), (UINT64) pKvsRtpTransceiver));
+    CHK_STATUS(hashTablePut(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(rtxSsrc), (UINT64) pKvsRtpTransceiver));
     CHK_STATUS(doubleListInsertItemHead(pKvsPeerConnection->pTransceievers, (UINT64) pKvsRtpTransceiver));
     *ppRtcRtpTransceiver = (PRtcRtpTransceiver) pKvsRtpTransceiver;
     pKvsRtpTransceiver = NULL;
 
 CleanUp:
 
+    if (pKvsRtpTransceiver != NULL && ssrcsMapped) {
+        hashTableRemove(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(ssrc));
+        hashTableRemove(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(rtxSsrc));
+    }
+
     if (pJitterBuffer != NULL) {
         freeJitterBuffer(&pJitterBuffer);
     }
@@ -1097,10 +1313,16 @@ CleanUp:
 }
 
 STATUS initKvsWebRtc(VOID)
+{
+    return initKvsWebRtcWithIoWorkerCount(0);
+}
+
+STATUS initKvsWebRtcWithIoWorkerCount(UINT32 ioWorkerCount)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(!ATOMIC_LOAD_BOOL(&gKvsWebRtcInitialized), retStatus);
+    CHK(ioWorkerCount <= MAX_IO_WORKER_COUNT, STATUS_INVALID_ARG);
 
     SRAND(GETTIME());
 
@@ -1116,6 +1338,9 @@ STATUS initKvsWebRtc(VOID)
 
     CHK_STATUS(initSctpSession());
 
+    // fixed set of receive threads shared by every peer connection
+    CHK_STATUS(initConnectionListenerEventLoop(ioWorkerCount));
+
     ATOMIC_STORE_BOOL(&gKvsWebRtcInitialized, TRUE);
 
 CleanUp:
@@ -1125,12 +1350,32 @@ CleanUp:
 
 }
 
+STATUS getIoWorkerMetrics(PIoWorkerMetrics pIoWorkerMetrics, PUINT32 pIoWorkerCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIoWorkerCount != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(connectionListenerGetEventLoopMetrics(pIoWorkerMetrics, pIoWorkerCount));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS deinitKvsWebRtc(VOID)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(ATOMIC_LOAD_BOOL(&gKvsWebRtcInitialized), retStatus);
 
+    deinitDtlsCertificatePool();
+
+    deinitSendWorkerPool();
+
+    deinitConnectionListenerEventLoop();
+
     deinitSctpSession();
 
     srtp_shutdown();
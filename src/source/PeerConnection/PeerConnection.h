@@ -37,6 +37,14 @@ extern "C" {
 #define DATA_CHANNEL_HASH_TABLE_BUCKET_COUNT            200
 #define DATA_CHANNEL_HASH_TABLE_BUCKET_LENGTH           2
 
+#define TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT        32
+#define TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH       2
+
+// Keys of pTransceiverSsrcTable. Local sender and rtx ssrcs are picked by us while remote ones come from the remote
+// description, so the remote ones are tagged to keep the two from colliding.
+#define TRANSCEIVER_LOCAL_SSRC_KEY(ssrc)                ((UINT64) (ssrc))
+#define TRANSCEIVER_REMOTE_SSRC_KEY(ssrc)               ((UINT64) (ssrc) | ((UINT64) 1 << 32))
+
 // Environment variable to display SDPs
 #define DEBUG_LOG_SDP                                                     ((PCHAR) "DEBUG_LOG_SDP")
 
@@ -56,6 +64,24 @@ typedef struct {
 
     PSctpSession pSctpSession;
 
+    // Hands SRTP/SRTCP packets over to a thread of their own when set, see KvsRtcConfiguration.inboundPacketQueueSize
+    PInboundPacketQueue pInboundPacketQueue;
+
+    // Frames broadcast groups queued for the send worker of the peer connection, NULL without a send worker pool
+    PSendQueue pSendQueue;
+
+    // Received SRTP packets are copied into packets of this pool, decrypted in place and adopted by the jitter buffers
+    PRtpPacketPool pRtpPacketPool;
+
+    // Transport wide congestion control, only when the remote description negotiated the header extension
+    PTwccManager pTwccManager;
+    // Id of the transport wide sequence number header extension, 0 until negotiated
+    UINT8 twccExtensionId;
+    // Timer flushing the transport wide congestion control feedback, MAX_UINT32 until pTwccManager is created
+    UINT32 twccFeedbackTimerId;
+    // Timer sending the feedback of the received streams, MAX_UINT32 until SRTP is ready
+    UINT32 rtcpFeedbackTimerId;
+
     SessionDescription remoteSessionDescription;
     PDoubleList pTransceievers;
     BOOL sctpIsEnabled;
@@ -88,6 +114,10 @@ typedef struct {
     // DataChannels keyed by streamId
     PHashTable pDataChannels;
 
+    // Transceivers keyed by TRANSCEIVER_LOCAL_SSRC_KEY and TRANSCEIVER_REMOTE_SSRC_KEY so that inbound RTP and RTCP
+    // are dispatched without walking pTransceievers. Filled by addTransceiver and setReceiversSsrc.
+    PHashTable pTransceiverSsrcTable;
+
     UINT64 onDataChannelCustomData;
     RtcOnDataChannel onDataChannel;
 
@@ -115,7 +145,9 @@ VOID onSctpSessionOutboundPacket(UINT64, PBYTE, UINT32);
 VOID onSctpSessionDataChannelMessage(UINT64, UINT32, BOOL, PBYTE, UINT32);
 VOID onSctpSessionDataChannelOpen(UINT64, UINT32, PBYTE, UINT32);
 
-STATUS sendPacketToRtpReceiver(PKvsPeerConnection, PBYTE, UINT32);
+VOID onInboundPacket(UINT64, PBYTE, UINT32);
+VOID onInboundSrtpPacket(UINT64, PRtpPacket);
+STATUS sendPacketToRtpReceiver(PKvsPeerConnection, PRtpPacket);
 STATUS changePeerConnectionState(PKvsPeerConnection, RTC_PEER_CONNECTION_STATE);
 
 #ifdef  __cplusplus
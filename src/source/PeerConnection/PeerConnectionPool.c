@@ -0,0 +1,273 @@
+#define LOG_CLASS "PeerConnectionPool"
+
+#include "../Include_i.h"
+
+STATUS createPeerConnectionPool(PRtcConfiguration pRtcConfiguration, PPeerConnectionPoolConfiguration pPoolConfiguration,
+                                PPEER_CONNECTION_POOL_HANDLE pPoolHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPeerConnectionPool pPeerConnectionPool = NULL;
+    PEER_CONNECTION_POOL_HANDLE poolHandle = INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE;
+
+    CHK(pRtcConfiguration != NULL && pPoolConfiguration != NULL && pPoolHandle != NULL, STATUS_NULL_ARG);
+    CHK(pPoolConfiguration->peerConnectionCount <= MAX_PEER_CONNECTION_POOL_SIZE, STATUS_INVALID_ARG);
+
+    pPeerConnectionPool = (PPeerConnectionPool) MEMCALLOC(1, SIZEOF(PeerConnectionPool));
+    CHK(pPeerConnectionPool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pPeerConnectionPool->rtcConfiguration = *pRtcConfiguration;
+    pPeerConnectionPool->peerConnectionCount =
+        pPoolConfiguration->peerConnectionCount == 0 ? PEER_CONNECTION_POOL_DEFAULT_SIZE : pPoolConfiguration->peerConnectionCount;
+    pPeerConnectionPool->maxPeerConnectionAge =
+        pPoolConfiguration->maxPeerConnectionAge == 0 ? PEER_CONNECTION_POOL_DEFAULT_MAX_AGE : pPoolConfiguration->maxPeerConnectionAge;
+    pPeerConnectionPool->lock = MUTEX_CREATE(FALSE);
+    pPeerConnectionPool->refillCvar = CVAR_CREATE();
+    pPeerConnectionPool->refillRoutine = INVALID_TID_VALUE;
+    ATOMIC_STORE_BOOL(&pPeerConnectionPool->terminate, FALSE);
+
+    poolHandle = TO_PEER_CONNECTION_POOL_HANDLE(pPeerConnectionPool);
+
+    CHK_STATUS(THREAD_CREATE(&pPeerConnectionPool->refillRoutine, peerConnectionPoolRefillRoutine, (PVOID) pPeerConnectionPool));
+
+    DLOGI("Keeping %u peer connections ready", pPeerConnectionPool->peerConnectionCount);
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freePeerConnectionPool(&poolHandle);
+    }
+
+    if (pPoolHandle != NULL) {
+        *pPoolHandle = poolHandle;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freePeerConnectionPool(PPEER_CONNECTION_POOL_HANDLE pPoolHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPeerConnectionPool pPeerConnectionPool;
+    UINT32 i;
+
+    CHK(pPoolHandle != NULL, STATUS_NULL_ARG);
+
+    pPeerConnectionPool = FROM_PEER_CONNECTION_POOL_HANDLE(*pPoolHandle);
+    CHK(pPeerConnectionPool != NULL, retStatus);
+
+    ATOMIC_STORE_BOOL(&pPeerConnectionPool->terminate, TRUE);
+
+    if (IS_VALID_TID_VALUE(pPeerConnectionPool->refillRoutine)) {
+        // Signal under the lock so the refill thread can not miss it between checking the flag and waiting
+        MUTEX_LOCK(pPeerConnectionPool->lock);
+        CVAR_SIGNAL(pPeerConnectionPool->refillCvar);
+        MUTEX_UNLOCK(pPeerConnectionPool->lock);
+
+        THREAD_JOIN(pPeerConnectionPool->refillRoutine, NULL);
+        pPeerConnectionPool->refillRoutine = INVALID_TID_VALUE;
+    }
+
+    for (i = 0; i < pPeerConnectionPool->readyCount; i++) {
+        CHK_LOG_ERR(freePeerConnection(&pPeerConnectionPool->peerConnections[i].pPeerConnection));
+    }
+
+    if (IS_VALID_CVAR_VALUE(pPeerConnectionPool->refillCvar)) {
+        CVAR_FREE(pPeerConnectionPool->refillCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPeerConnectionPool->lock)) {
+        MUTEX_FREE(pPeerConnectionPool->lock);
+    }
+
+    MEMFREE(pPeerConnectionPool);
+
+    *pPoolHandle = INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS peerConnectionPoolGetPeerConnection(PEER_CONNECTION_POOL_HANDLE poolHandle, PRtcPeerConnection* ppPeerConnection)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPeerConnectionPool pPeerConnectionPool = FROM_PEER_CONNECTION_POOL_HANDLE(poolHandle);
+
+    CHK(pPeerConnectionPool != NULL && ppPeerConnection != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(peerConnectionPoolTake(pPeerConnectionPool, ppPeerConnection));
+
+    // Nothing was ready, the caller pays for the setup like without a pool
+    if (*ppPeerConnection == NULL) {
+        CHK_STATUS(createPeerConnection(&pPeerConnectionPool->rtcConfiguration, ppPeerConnection));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS peerConnectionPoolGetMetrics(PEER_CONNECTION_POOL_HANDLE poolHandle, PPeerConnectionPoolMetrics pPeerConnectionPoolMetrics)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPeerConnectionPool pPeerConnectionPool = FROM_PEER_CONNECTION_POOL_HANDLE(poolHandle);
+
+    CHK(pPeerConnectionPool != NULL && pPeerConnectionPoolMetrics != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pPeerConnectionPool->lock);
+    pPeerConnectionPoolMetrics->readyCount = pPeerConnectionPool->readyCount;
+    pPeerConnectionPoolMetrics->hitCount = pPeerConnectionPool->hitCount;
+    pPeerConnectionPoolMetrics->missCount = pPeerConnectionPool->missCount;
+    pPeerConnectionPoolMetrics->expiredCount = pPeerConnectionPool->expiredCount;
+    MUTEX_UNLOCK(pPeerConnectionPool->lock);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Take the oldest ready peer connection, NULL when there is none
+ */
+STATUS peerConnectionPoolTake(PPeerConnectionPool pPeerConnectionPool, PRtcPeerConnection* ppPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPeerConnectionPool != NULL && ppPeerConnection != NULL, STATUS_NULL_ARG);
+
+    *ppPeerConnection = NULL;
+
+    MUTEX_LOCK(pPeerConnectionPool->lock);
+
+    if (pPeerConnectionPool->readyCount > 0) {
+        *ppPeerConnection = pPeerConnectionPool->peerConnections[0].pPeerConnection;
+        pPeerConnectionPool->readyCount--;
+        MEMMOVE(&pPeerConnectionPool->peerConnections[0], &pPeerConnectionPool->peerConnections[1],
+                pPeerConnectionPool->readyCount * SIZEOF(PooledPeerConnection));
+        pPeerConnectionPool->hitCount++;
+    } else {
+        pPeerConnectionPool->missCount++;
+    }
+
+    // Replace it right away
+    CVAR_SIGNAL(pPeerConnectionPool->refillCvar);
+
+    MUTEX_UNLOCK(pPeerConnectionPool->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Create a peer connection and start gathering its candidates. They are reported once the application calls
+ * setLocalDescription, it has not registered for them yet.
+ */
+STATUS peerConnectionPoolCreatePeerConnection(PPeerConnectionPool pPeerConnectionPool, PRtcPeerConnection* ppPeerConnection)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtcPeerConnection pPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+
+    CHK(pPeerConnectionPool != NULL && ppPeerConnection != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(createPeerConnection(&pPeerConnectionPool->rtcConfiguration, &pPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
+
+    CHK_STATUS(iceAgentHoldCandidateReports(pKvsPeerConnection->pIceAgent, TRUE));
+    CHK_STATUS(iceAgentStartGathering(pKvsPeerConnection->pIceAgent));
+
+    *ppPeerConnection = pPeerConnection;
+    pPeerConnection = NULL;
+
+CleanUp:
+
+    if (pPeerConnection != NULL) {
+        freePeerConnection(&pPeerConnection);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Replaces the oldest ready peer connection once it expires and tops the pool up whenever it is short. Peer connections
+ * are created and freed without holding the lock.
+ */
+PVOID peerConnectionPoolRefillRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPeerConnectionPool pPeerConnectionPool = (PPeerConnectionPool) arg;
+    PRtcPeerConnection pExpiredPeerConnection, pPeerConnection;
+    UINT64 now, age;
+    BOOL refill;
+
+    CHK(pPeerConnectionPool != NULL, STATUS_NULL_ARG);
+
+    while (!ATOMIC_LOAD_BOOL(&pPeerConnectionPool->terminate)) {
+        pExpiredPeerConnection = NULL;
+        pPeerConnection = NULL;
+
+        MUTEX_LOCK(pPeerConnectionPool->lock);
+
+        now = GETTIME();
+        age = pPeerConnectionPool->readyCount > 0 ? now - pPeerConnectionPool->peerConnections[0].createTime : 0;
+        if (pPeerConnectionPool->readyCount > 0 && age >= pPeerConnectionPool->maxPeerConnectionAge) {
+            pExpiredPeerConnection = pPeerConnectionPool->peerConnections[0].pPeerConnection;
+            pPeerConnectionPool->readyCount--;
+            MEMMOVE(&pPeerConnectionPool->peerConnections[0], &pPeerConnectionPool->peerConnections[1],
+                    pPeerConnectionPool->readyCount * SIZEOF(PooledPeerConnection));
+            pPeerConnectionPool->expiredCount++;
+        }
+
+        refill = pPeerConnectionPool->readyCount < pPeerConnectionPool->peerConnectionCount;
+        if (!refill && pExpiredPeerConnection == NULL && !ATOMIC_LOAD_BOOL(&pPeerConnectionPool->terminate)) {
+            CVAR_WAIT(pPeerConnectionPool->refillCvar, pPeerConnectionPool->lock, pPeerConnectionPool->maxPeerConnectionAge - age);
+        }
+
+        MUTEX_UNLOCK(pPeerConnectionPool->lock);
+
+        if (pExpiredPeerConnection != NULL) {
+            CHK_LOG_ERR(freePeerConnection(&pExpiredPeerConnection));
+        }
+
+        if (!refill || ATOMIC_LOAD_BOOL(&pPeerConnectionPool->terminate)) {
+            continue;
+        }
+
+        if (STATUS_FAILED(peerConnectionPoolCreatePeerConnection(pPeerConnectionPool, &pPeerConnection))) {
+            DLOGW("Failed to create a peer connection ahead of time, retrying in %" PRIu64 " ms",
+                  PEER_CONNECTION_POOL_RETRY_INTERVAL / HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            MUTEX_LOCK(pPeerConnectionPool->lock);
+            if (!ATOMIC_LOAD_BOOL(&pPeerConnectionPool->terminate)) {
+                CVAR_WAIT(pPeerConnectionPool->refillCvar, pPeerConnectionPool->lock, PEER_CONNECTION_POOL_RETRY_INTERVAL);
+            }
+            MUTEX_UNLOCK(pPeerConnectionPool->lock);
+            continue;
+        }
+
+        // Only the refill thread adds peer connections so there is still room for it
+        MUTEX_LOCK(pPeerConnectionPool->lock);
+        pPeerConnectionPool->peerConnections[pPeerConnectionPool->readyCount].pPeerConnection = pPeerConnection;
+        pPeerConnectionPool->peerConnections[pPeerConnectionPool->readyCount].createTime = GETTIME();
+        pPeerConnectionPool->readyCount++;
+        MUTEX_UNLOCK(pPeerConnectionPool->lock);
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
@@ -0,0 +1,55 @@
+/*******************************************
+Peer connection pool internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PEERCONNECTIONPOOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PEERCONNECTIONPOOL__
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define PEER_CONNECTION_POOL_DEFAULT_SIZE               2
+// UDP mappings of common NATs last at least this long without traffic
+#define PEER_CONNECTION_POOL_DEFAULT_MAX_AGE            (30 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// Wait before trying again after a peer connection could not be created
+#define PEER_CONNECTION_POOL_RETRY_INTERVAL             (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+#define TO_PEER_CONNECTION_POOL_HANDLE(p) ((PEER_CONNECTION_POOL_HANDLE) (p))
+#define FROM_PEER_CONNECTION_POOL_HANDLE(h) (IS_VALID_PEER_CONNECTION_POOL_HANDLE(h) ? (PPeerConnectionPool) (h) : NULL)
+
+typedef struct {
+    PRtcPeerConnection pPeerConnection;
+    UINT64 createTime;
+} PooledPeerConnection, *PPooledPeerConnection;
+
+typedef struct {
+    RtcConfiguration rtcConfiguration;
+    UINT32 peerConnectionCount;
+    UINT64 maxPeerConnectionAge;
+
+    MUTEX lock;
+    // Signaled to wake the refill thread up early, on shutdown or when a peer connection was taken
+    CVAR refillCvar;
+    TID refillRoutine;
+    volatile ATOMIC_BOOL terminate;
+
+    // Ready peer connections, the oldest first. They are handed out oldest first as well.
+    PooledPeerConnection peerConnections[MAX_PEER_CONNECTION_POOL_SIZE];
+    UINT32 readyCount;
+
+    UINT64 hitCount;
+    UINT64 missCount;
+    UINT64 expiredCount;
+} PeerConnectionPool, *PPeerConnectionPool;
+
+PVOID peerConnectionPoolRefillRoutine(PVOID);
+STATUS peerConnectionPoolCreatePeerConnection(PPeerConnectionPool, PRtcPeerConnection*);
+STATUS peerConnectionPoolTake(PPeerConnectionPool, PRtcPeerConnection*);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  //__KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PEERCONNECTIONPOOL__
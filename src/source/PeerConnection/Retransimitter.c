@@ -48,8 +48,7 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 senderSsrc = 0, receiverSsrc = 0;
     UINT32 filledLen = 0, validIndexListLen = 0;
-    PDoubleListNode pCurNode = NULL;
-    PKvsRtpTransceiver pTransceiver, pSenderTranceiver = NULL;
+    PKvsRtpTransceiver pTransceiver = NULL, pSenderTranceiver = NULL;
     UINT64 item;
     UINT32 index;
     PRtpPacket pRtpPacket = NULL, pRtxRtpPacket = NULL;
@@ -58,23 +57,22 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
     CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
     CHK_STATUS(rtcpNackListGet(pRtcpPacket->payload, pRtcpPacket->payloadLength, &senderSsrc, &receiverSsrc, NULL, &filledLen));
 
-    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
-    while(pCurNode != NULL && pSenderTranceiver == NULL) {
-        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
-        pTransceiver = (PKvsRtpTransceiver) item;
-
-        CHK(pTransceiver != NULL, STATUS_INTERNAL_ERROR);
+    // Only the media ssrc of a sender has packets to resend, a NACK for its rtx ssrc is not served
+    CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(receiverSsrc), &pTransceiver));
+    if (pTransceiver == NULL || pTransceiver->sender.ssrc != receiverSsrc) {
+        CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(senderSsrc), &pTransceiver));
+    }
 
-        if (pTransceiver->sender.ssrc == receiverSsrc || pTransceiver->sender.ssrc == senderSsrc) {
-            pSenderTranceiver = pTransceiver;
-            pRetransmitter = pSenderTranceiver->sender.retransmitter;
-        }
-        pCurNode = pCurNode->pNext;
+    if (pTransceiver != NULL && (pTransceiver->sender.ssrc == receiverSsrc || pTransceiver->sender.ssrc == senderSsrc)) {
+        pSenderTranceiver = pTransceiver;
+        pRetransmitter = pSenderTranceiver->sender.retransmitter;
     }
 
     CHK_ERR(pSenderTranceiver != NULL, STATUS_RTCP_INPUT_SSRC_INVALID,
             "Receiving NACK for non existing ssrcs: senderSsrc %lu receiverSsrc %lu", senderSsrc, receiverSsrc);
 
+    ATOMIC_INCREMENT(&pSenderTranceiver->sender.nackCount);
+
     CHK_ERR(pRetransmitter != NULL, STATUS_INVALID_OPERATION,
             "Sender re-transmitter is not created successfully for an existing ssrcs: senderSsrc %lu receiverSsrc %lu", senderSsrc, receiverSsrc);
 
@@ -101,6 +99,8 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
             }
             // resendPacket
             if (STATUS_SUCCEEDED(retStatus)) {
+                ATOMIC_INCREMENT(&pSenderTranceiver->sender.retransmittedPacketsSent);
+                ATOMIC_ADD(&pSenderTranceiver->sender.retransmittedBytesSent, pRtpPacket->payloadLength);
                 DLOGV("Resent packet ssrc %lu seq %lu succeeded", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber);
             } else {
                 DLOGV("Resent packet ssrc %lu seq %lu failed 0x%08x", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber, retStatus);
@@ -15,6 +15,10 @@ STATUS onRtcpPacket(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuff, UINT32 b
 
         if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK && rtcpPacket.header.receptionReportCount == RTCP_FEEDBACK_MESSAGE_TYPE_NACK) {
             CHK_STATUS(resendPacketOnNack(&rtcpPacket, pKvsPeerConnection));
+        } else if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK &&
+                   rtcpPacket.header.receptionReportCount == RTCP_FEEDBACK_MESSAGE_TYPE_TRANSPORT_WIDE_CC)
+        {
+            CHK_STATUS(onRtcpTwccPacket(&rtcpPacket, pKvsPeerConnection));
         } else if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK &&
                    rtcpPacket.header.receptionReportCount == RTCP_FEEDBACK_MESSAGE_TYPE_APPLICATION_LAYER_FEEDBACK &&
                    isRembPacket(rtcpPacket.payload, rtcpPacket.payloadLength) == STATUS_SUCCESS)
@@ -24,6 +28,14 @@ STATUS onRtcpPacket(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuff, UINT32 b
                    rtcpPacket.header.receptionReportCount == RTCP_PSFB_PLI)
         {
             CHK_STATUS(onRtcpPLIPacket(&rtcpPacket, pKvsPeerConnection));
+        } else if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK &&
+                   rtcpPacket.header.receptionReportCount == RTCP_PSFB_FIR)
+        {
+            CHK_STATUS(onRtcpFIRPacket(&rtcpPacket, pKvsPeerConnection));
+        } else if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_SENDER_REPORT) {
+            CHK_STATUS(onRtcpSenderReport(&rtcpPacket, pKvsPeerConnection));
+        } else if (rtcpPacket.header.packetType == RTCP_PACKET_TYPE_RECEIVER_REPORT) {
+            CHK_STATUS(onRtcpReceiverReport(&rtcpPacket, pKvsPeerConnection));
         }
 
 
@@ -43,27 +55,15 @@ STATUS onRtcpRembPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConn
     DOUBLE maximumBitRate = 0;
     UINT8 ssrcListLen;
     UINT32 i;
-    PDoubleListNode pCurNode = NULL;
     PKvsRtpTransceiver pTransceiver = NULL;
-    UINT64 item;
 
     CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
 
     CHK_STATUS(rembValueGet(pRtcpPacket->payload, pRtcpPacket->payloadLength, &maximumBitRate, (PUINT32) &ssrcList, &ssrcListLen));
 
     for (i = 0; i < ssrcListLen; i++) {
-        CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
-        while(pCurNode != NULL && pTransceiver == NULL) {
-            CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
-            CHK(item != 0, STATUS_INTERNAL_ERROR);
-
-            pTransceiver = (PKvsRtpTransceiver) item;
-            if (pTransceiver->sender.ssrc != ssrcList[i] && pTransceiver->sender.rtxSsrc != ssrcList[i]) {
-                pTransceiver = NULL;
-            }
-
-            pCurNode = pCurNode->pNext;
-        }
+        // Both the media and the rtx ssrc of a sender map to its transceiver
+        CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(ssrcList[i]), &pTransceiver));
 
         CHK_ERR(pTransceiver != NULL, STATUS_RTCP_INPUT_SSRC_INVALID, "Received REMB for non existing ssrcs: ssrc %lu", ssrcList[i]);
         if (pTransceiver->onBandwidthEstimation != NULL) {
@@ -76,31 +76,51 @@ CleanUp:
     return retStatus;
 }
 
-STATUS onRtcpPLIPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
+STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 mediaSSRC = 0;
+    UINT64 targetBitrate = 0, item;
     PDoubleListNode pCurNode = NULL;
     PKvsRtpTransceiver pTransceiver = NULL;
-    UINT64 item;
 
     CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
-    mediaSSRC = getUnalignedInt32BigEndian((pRtcpPacket->payload + (SIZEOF(UINT32))));
+    // Feedback for an extension that was not negotiated
+    CHK(pKvsPeerConnection->pTwccManager != NULL, retStatus);
 
+    CHK_STATUS(twccManagerOnFeedback(pKvsPeerConnection->pTwccManager, pRtcpPacket->payload, pRtcpPacket->payloadLength, GETTIME(),
+                                     &targetBitrate));
+    CHK(targetBitrate > 0, retStatus);
+
+    // The estimate covers all the streams of the connection, like a REMB listing all of them
     CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
-    while(pCurNode != NULL && pTransceiver == NULL) {
+    while (pCurNode != NULL) {
         CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
-        CHK(item != 0, STATUS_INTERNAL_ERROR);
-
         pTransceiver = (PKvsRtpTransceiver) item;
-        if (pTransceiver->sender.ssrc != mediaSSRC && pTransceiver->sender.rtxSsrc != mediaSSRC) {
-            pTransceiver = NULL;
+        if (pTransceiver->onBandwidthEstimation != NULL) {
+            pTransceiver->onBandwidthEstimation(pTransceiver->onBandwidthEstimationCustomData, (DOUBLE) targetBitrate);
         }
 
         pCurNode = pCurNode->pNext;
     }
 
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS onRtcpPLIPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 mediaSSRC = 0;
+    PKvsRtpTransceiver pTransceiver = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+    mediaSSRC = getUnalignedInt32BigEndian((pRtcpPacket->payload + (SIZEOF(UINT32))));
+
+    CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(mediaSSRC), &pTransceiver));
+
     CHK_ERR(pTransceiver != NULL, STATUS_RTCP_INPUT_SSRC_INVALID, "Received PLI for non existing ssrcs: ssrc %lu", mediaSSRC);
+    ATOMIC_INCREMENT(&pTransceiver->sender.pliCount);
     if (pTransceiver->onPictureLoss != NULL) {
         pTransceiver->onPictureLoss(pTransceiver->onPictureLossCustomData);
     }
@@ -109,3 +129,445 @@ CleanUp:
 
     return retStatus;
 }
+
+STATUS onRtcpFIRPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 mediaSSRC = 0, offset;
+    PKvsRtpTransceiver pTransceiver = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+    CHK(pRtcpPacket->payloadLength >= RTCP_FIR_PACKET_LEN - RTCP_PACKET_HEADER_LEN, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+
+    // Unlike a PLI the media ssrcs are in the FCI entries, one for every source asked for a key frame
+    for (offset = RTCP_NACK_LIST_LEN; offset + RTCP_FIR_ENTRY_LEN <= pRtcpPacket->payloadLength; offset += RTCP_FIR_ENTRY_LEN) {
+        mediaSSRC = getUnalignedInt32BigEndian(pRtcpPacket->payload + offset);
+
+        CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(mediaSSRC), &pTransceiver));
+        if (pTransceiver == NULL) {
+            // FIRs of a sender can be shared by all the media sources of the connection, other entries may still match
+            continue;
+        }
+
+        ATOMIC_INCREMENT(&pTransceiver->sender.firCount);
+        if (pTransceiver->onPictureLoss != NULL) {
+            pTransceiver->onPictureLoss(pTransceiver->onPictureLossCustomData);
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS onRtcpSenderReport(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RtcpSenderInfo senderInfo;
+    UINT32 senderSsrc = 0;
+    UINT64 currentTime, reportInterval;
+    PKvsRtpTransceiver pTransceiver = NULL;
+    PRtcOutboundRtpStreamStats pRemoteOutboundRtpStreamStats;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(rtcpSenderReportGet(pRtcpPacket->payload, pRtcpPacket->payloadLength, &senderSsrc, &senderInfo));
+    CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_REMOTE_SSRC_KEY(senderSsrc), &pTransceiver));
+
+    // Reports of streams we do not receive still carry report blocks about the streams we send
+    if (pTransceiver != NULL) {
+        currentTime = GETTIME();
+        reportInterval = pTransceiver->receptionStats.lastSenderReportReceivedTime == 0 ? 0 :
+            currentTime - pTransceiver->receptionStats.lastSenderReportReceivedTime;
+
+        // Echoed in our next receiver report so that the sender can measure the round trip time
+        pTransceiver->receptionStats.lastSenderReport = (UINT32) (senderInfo.ntpTimestamp >> 16);
+        pTransceiver->receptionStats.lastSenderReportReceivedTime = currentTime;
+
+        MUTEX_LOCK(pTransceiver->statsLock);
+        pRemoteOutboundRtpStreamStats = &pTransceiver->remoteOutboundRtpStreamStats;
+        pRemoteOutboundRtpStreamStats->packetsSent = senderInfo.packetCount;
+        pRemoteOutboundRtpStreamStats->bytesSent = senderInfo.octetCount;
+        if (reportInterval != 0) {
+            if (pRemoteOutboundRtpStreamStats->averageRtcpInterval == 0) {
+                pRemoteOutboundRtpStreamStats->averageRtcpInterval = reportInterval;
+            } else {
+                pRemoteOutboundRtpStreamStats->averageRtcpInterval += (reportInterval >> RTCP_REPORT_INTERVAL_AVERAGE_SHIFT) -
+                    (pRemoteOutboundRtpStreamStats->averageRtcpInterval >> RTCP_REPORT_INTERVAL_AVERAGE_SHIFT);
+            }
+        }
+        MUTEX_UNLOCK(pTransceiver->statsLock);
+    }
+
+    CHK_STATUS(onRtcpReportBlocks(pRtcpPacket, pKvsPeerConnection, SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS onRtcpReceiverReport(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+
+    // The ssrc of the sender of the report is followed by the report blocks right away
+    CHK_STATUS(onRtcpReportBlocks(pRtcpPacket, pKvsPeerConnection, SIZEOF(UINT32)));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS onRtcpReportBlocks(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection, UINT32 offset)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RtcpReportBlock reportBlock;
+    PKvsRtpTransceiver pTransceiver = NULL;
+    PRtcRemoteInboundRtpStreamStats pRemoteInboundRtpStreamStats;
+    UINT32 i, currentNtpTime, roundTripTime;
+    BOOL roundTripTimeValid;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+
+    for (i = 0; i < pRtcpPacket->header.receptionReportCount; i++, offset += RTCP_REPORT_BLOCK_LEN) {
+        CHK(offset < pRtcpPacket->payloadLength, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+        CHK_STATUS(rtcpReportBlockGet(pRtcpPacket->payload + offset, pRtcpPacket->payloadLength - offset, &reportBlock));
+
+        // Blocks about streams sent to other peers of a shared session are of no interest
+        CHK_STATUS(findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(reportBlock.ssrc), &pTransceiver));
+        if (pTransceiver == NULL) {
+            continue;
+        }
+
+        // RFC 3550 6.4.1, the time the report took to come back minus the time it was held by the remote peer
+        roundTripTimeValid = FALSE;
+        roundTripTime = 0;
+        if (reportBlock.lastSenderReport != 0) {
+            currentNtpTime = (UINT32) (convertTimestampToNtp(GETTIME()) >> 16);
+            roundTripTime = currentNtpTime - reportBlock.lastSenderReport - reportBlock.delaySinceLastSenderReport;
+            roundTripTimeValid = (INT32) roundTripTime >= 0;
+        }
+
+        MUTEX_LOCK(pTransceiver->statsLock);
+        pRemoteInboundRtpStreamStats = &pTransceiver->remoteInboundRtpStreamStats;
+        pRemoteInboundRtpStreamStats->fractionLost = reportBlock.fractionLost;
+        pRemoteInboundRtpStreamStats->reportsReceived++;
+        if (roundTripTimeValid) {
+            pRemoteInboundRtpStreamStats->roundTripTime = (UINT64) roundTripTime * HUNDREDS_OF_NANOS_IN_A_SECOND / RTCP_SHORT_NTP_UNITS_IN_A_SECOND;
+            pRemoteInboundRtpStreamStats->totalRoundTripTime += pRemoteInboundRtpStreamStats->roundTripTime;
+            pRemoteInboundRtpStreamStats->roundTripTimeMeasurements++;
+        }
+        MUTEX_UNLOCK(pTransceiver->statsLock);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getRoundTripTime(PKvsPeerConnection pKvsPeerConnection, PUINT64 pRoundTripTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceAgent pIceAgent = NULL;
+    UINT64 roundTripTime = 0;
+
+    CHK(pKvsPeerConnection != NULL && pRoundTripTime != NULL, STATUS_NULL_ARG);
+
+    pIceAgent = pKvsPeerConnection->pIceAgent;
+    if (pIceAgent != NULL) {
+        MUTEX_LOCK(pIceAgent->lock);
+        if (pIceAgent->pDataSendingIceCandidatePair != NULL) {
+            roundTripTime = pIceAgent->pDataSendingIceCandidatePair->roundTripTime;
+        }
+        MUTEX_UNLOCK(pIceAgent->lock);
+    }
+
+CleanUp:
+    if (pRoundTripTime != NULL) {
+        *pRoundTripTime = roundTripTime;
+    }
+
+    return retStatus;
+}
+
+STATUS writeRtcpPacket(PKvsPeerConnection pKvsPeerConnection, PBYTE pRtcpPacket, UINT32 rtcpPacketLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    BYTE rawPacket[RTCP_MAX_PACKET_LEN + SRTCP_TRAILER_OVERHEAD];
+    INT32 rawLen = 0;
+
+    CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
+    CHK(rtcpPacketLen <= RTCP_MAX_PACKET_LEN, STATUS_INVALID_ARG_LEN);
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+    CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS); // Discard packets till SRTP is ready
+    rawLen = rtcpPacketLen;
+    MEMCPY(rawPacket, pRtcpPacket, rtcpPacketLen);
+    CHK_STATUS(encryptRtcpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, &rawLen));
+    CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, rawLen));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    return retStatus;
+}
+
+STATUS sendRtcpNackPacket(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pTransceiver)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 sequenceNumberList[JITTER_BUFFER_MAX_NACK_PACKET_COUNT];
+    BYTE rtcpPacket[RTCP_NACK_MAX_PACKET_LEN];
+    UINT32 sequenceNumberListLen = ARRAY_SIZE(sequenceNumberList), rtcpPacketLen = SIZEOF(rtcpPacket);
+    UINT64 roundTripTime = 0;
+
+    CHK(pKvsPeerConnection != NULL && pTransceiver != NULL && pTransceiver->pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    // Nothing is missing most of the time
+    CHK(pTransceiver->pJitterBuffer->missingPacketCount > 0, retStatus);
+
+    CHK_STATUS(getRoundTripTime(pKvsPeerConnection, &roundTripTime));
+    CHK_STATUS(jitterBufferGetNackList(pTransceiver->pJitterBuffer, GETTIME(), roundTripTime, sequenceNumberList, &sequenceNumberListLen));
+    CHK(sequenceNumberListLen > 0, retStatus);
+
+    CHK_STATUS(createRtcpNackPacket(pTransceiver->sender.ssrc, pTransceiver->jitterBufferSsrc, sequenceNumberList, sequenceNumberListLen,
+                                    rtcpPacket, &rtcpPacketLen));
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+    ATOMIC_INCREMENT(&pTransceiver->nackPacketsSent);
+
+    DLOGS("Sent NACK for %u packets of ssrc %u", sequenceNumberListLen, pTransceiver->jitterBufferSsrc);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sendRtcpKeyFrameRequest(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pTransceiver, BOOL fullIntraRequest)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE rtcpPacket[RTCP_FIR_PACKET_LEN + RTCP_PLI_PACKET_LEN];
+    UINT32 rtcpPacketLen = 0, firPacketLen = RTCP_FIR_PACKET_LEN, pliPacketLen = RTCP_PLI_PACKET_LEN;
+    UINT64 currentTime, roundTripTime = 0;
+    UINT8 firSequenceNumber = 0;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pTransceiver != NULL, STATUS_NULL_ARG);
+
+    // The ssrc of the remote sender is only known once the remote description was set
+    CHK(pTransceiver->jitterBufferSsrc != 0, retStatus);
+
+    CHK_STATUS(getRoundTripTime(pKvsPeerConnection, &roundTripTime));
+    currentTime = GETTIME();
+
+    MUTEX_LOCK(pKvsPeerConnection->peerConnectionObjLock);
+    locked = TRUE;
+
+    // The key frame asked for last time is likely still on its way
+    CHK(pTransceiver->lastKeyFrameRequestTime == 0 ||
+        currentTime >= pTransceiver->lastKeyFrameRequestTime + MAX(roundTripTime, RTCP_KEY_FRAME_REQUEST_MIN_INTERVAL), retStatus);
+    pTransceiver->lastKeyFrameRequestTime = currentTime;
+
+    // A new sequence number tells the sender this is a new request rather than a retransmission of the last one
+    if (fullIntraRequest) {
+        firSequenceNumber = pTransceiver->firSequenceNumber++;
+    }
+
+    MUTEX_UNLOCK(pKvsPeerConnection->peerConnectionObjLock);
+    locked = FALSE;
+
+    if (fullIntraRequest) {
+        CHK_STATUS(createRtcpFirPacket(pTransceiver->sender.ssrc, pTransceiver->jitterBufferSsrc, firSequenceNumber, rtcpPacket, &firPacketLen));
+        rtcpPacketLen += firPacketLen;
+    }
+
+    // Senders that did not negotiate FIR still answer the PLI of the same compound packet
+    CHK_STATUS(createRtcpPliPacket(pTransceiver->sender.ssrc, pTransceiver->jitterBufferSsrc, rtcpPacket + rtcpPacketLen, &pliPacketLen));
+    rtcpPacketLen += pliPacketLen;
+
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+    ATOMIC_INCREMENT(&pTransceiver->pliPacketsSent);
+    if (fullIntraRequest) {
+        ATOMIC_INCREMENT(&pTransceiver->firPacketsSent);
+    }
+
+    DLOGD("Asked ssrc %u for a key frame", pTransceiver->jitterBufferSsrc);
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->peerConnectionObjLock);
+    }
+
+    return retStatus;
+}
+
+STATUS sendRtcpSenderReport(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pTransceiver, UINT32 rtpTimestamp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE rtcpPacket[RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN];
+    UINT32 rtcpPacketLen = SIZEOF(rtcpPacket);
+    RtcpSenderInfo senderInfo;
+    UINT64 currentTime;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pTransceiver != NULL, STATUS_NULL_ARG);
+
+    // The session lock is recursive. Holding it makes the rate limit check and the counters consistent with the packets
+    // sent, which are only counted under it, no matter which thread sends the report.
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+
+    currentTime = GETTIME();
+    CHK(pTransceiver->sender.lastSenderReportTime == 0 || currentTime >= pTransceiver->sender.lastSenderReportTime + RTCP_REPORT_INTERVAL,
+        retStatus);
+    pTransceiver->sender.lastSenderReportTime = currentTime;
+
+    senderInfo.ntpTimestamp = convertTimestampToNtp(currentTime);
+    senderInfo.rtpTimestamp = rtpTimestamp;
+    // Counts wrap around in sender reports
+    senderInfo.packetCount = (UINT32) ATOMIC_LOAD(&pTransceiver->sender.packetsSent);
+    senderInfo.octetCount = (UINT32) ATOMIC_LOAD(&pTransceiver->sender.bytesSent);
+
+    // Report blocks of the stream the transceiver receives go in receiver reports sent by the RTCP feedback timer
+    CHK_STATUS(createRtcpReportPacket(pTransceiver->sender.ssrc, &senderInfo, NULL, 0, rtcpPacket, &rtcpPacketLen));
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    return retStatus;
+}
+
+STATUS sendRtcpReceiverReport(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pTransceiver)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE rtcpPacket[RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + RTCP_REPORT_BLOCK_LEN];
+    UINT32 rtcpPacketLen = SIZEOF(rtcpPacket), jitter;
+    RtcpReportBlock reportBlock;
+    UINT64 currentTime;
+
+    CHK(pKvsPeerConnection != NULL && pTransceiver != NULL && pTransceiver->pJitterBuffer != NULL, STATUS_NULL_ARG);
+
+    currentTime = GETTIME();
+    CHK(pTransceiver->lastReceiverReportTime == 0 || currentTime >= pTransceiver->lastReceiverReportTime + RTCP_REPORT_INTERVAL, retStatus);
+    pTransceiver->lastReceiverReportTime = currentTime;
+
+    jitter = (UINT32) (pTransceiver->pJitterBuffer->scaledJitter >> JITTER_BUFFER_JITTER_SCALE_SHIFT);
+    CHK_STATUS(rtcpReceptionStatsGetReportBlock(&pTransceiver->receptionStats, pTransceiver->jitterBufferSsrc, jitter, currentTime, &reportBlock));
+    // Sign extended so that duplicates read back as a negative loss
+    ATOMIC_STORE(&pTransceiver->packetsLost, (SIZE_T) (SSIZE_T) reportBlock.cumulativeLost);
+    ATOMIC_STORE(&pTransceiver->jitter, reportBlock.jitter);
+    CHK_STATUS(createRtcpReportPacket(pTransceiver->sender.ssrc, NULL, &reportBlock, 1, rtcpPacket, &rtcpPacketLen));
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sendRtcpTwccPacket(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pTransceiver, PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE rtcpPacket[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 rtcpPacketLen = SIZEOF(rtcpPacket), extensionLen = 0;
+    PBYTE pExtension = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pTransceiver != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->pTwccManager != NULL, retStatus);
+
+    // Packets without the transport wide sequence number, like the ones of a sender that ignored the extension, are not reported
+    CHK_STATUS(getRtpHeaderExtensionFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pKvsPeerConnection->twccExtensionId, &pExtension,
+                                              &extensionLen));
+    CHK(pExtension != NULL && extensionLen == SIZEOF(UINT16), retStatus);
+
+    CHK_STATUS(twccManagerOnPacketReceived(pKvsPeerConnection->pTwccManager, (UINT16) getUnalignedInt16BigEndian(pExtension),
+                                           pRtpPacket->receivedTime, pTransceiver->sender.ssrc, pRtpPacket->header.ssrc, rtcpPacket,
+                                           &rtcpPacketLen));
+    CHK(rtcpPacketLen > 0, retStatus);
+
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS twccFeedbackTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    BYTE rtcpPacket[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 rtcpPacketLen = SIZEOF(rtcpPacket);
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+
+    // The session lock is recursive, writeRtcpPacket takes it again
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+    CHK(pKvsPeerConnection->pTwccManager != NULL, retStatus);
+
+    CHK_STATUS(twccManagerFlushFeedback(pKvsPeerConnection->pTwccManager, currentTime, rtcpPacket, &rtcpPacketLen));
+    CHK(rtcpPacketLen > 0, retStatus);
+
+    CHK_STATUS(writeRtcpPacket(pKvsPeerConnection, rtcpPacket, rtcpPacketLen));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS rtcpFeedbackTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    UNUSED_PARAM(currentTime);
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PDoubleListNode pCurNode = NULL;
+    PKvsRtpTransceiver pTransceiver = NULL;
+    UINT64 item;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        pTransceiver = (PKvsRtpTransceiver) item;
+        pCurNode = pCurNode->pNext;
+
+        // Nothing to report before the first packet. A receiving thread busy in a frame callback is not waited for, its
+        // feedback goes out on the next tick instead.
+        if (ATOMIC_LOAD(&pTransceiver->packetsReceived) == 0 || !MUTEX_TRYLOCK(pTransceiver->receiverLock)) {
+            continue;
+        }
+
+        // Ask for what went missing since the last tick, and again for what is still missing after a round trip
+        CHK_LOG_ERR(sendRtcpNackPacket(pKvsPeerConnection, pTransceiver));
+        CHK_LOG_ERR(sendRtcpReceiverReport(pKvsPeerConnection, pTransceiver));
+
+        // Frames that can not be decoded keep coming until the sender is told, ask again every round trip until a key frame arrives
+        if (pTransceiver->keyFrameRequired) {
+            CHK_LOG_ERR(sendRtcpKeyFrameRequest(pKvsPeerConnection, pTransceiver, FALSE));
+        }
+
+        MUTEX_UNLOCK(pTransceiver->receiverLock);
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
@@ -3,6 +3,27 @@
 
 #pragma once
 
+// SRTCP appends the E flag and index word followed by the authentication tag
+#define SRTCP_TRAILER_OVERHEAD                          (SIZEOF(UINT32) + SRTP_AUTH_TAG_OVERHEAD)
+
+// A NACK lists at most every missing packet the jitter buffer tracks, each in an entry of its own
+#define RTCP_NACK_MAX_PACKET_LEN                        (RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN + JITTER_BUFFER_MAX_NACK_PACKET_COUNT * RTCP_NACK_ENTRY_LEN)
+
+// Largest RTCP packet we send, writeRtcpPacket encrypts it in a buffer on the stack
+#define RTCP_MAX_PACKET_LEN                             MAX(TWCC_FEEDBACK_MAX_PACKET_LEN, RTCP_NACK_MAX_PACKET_LEN)
+
+// NACKs, receiver reports and key frame requests of the received streams are sent from the timer queue this often
+#define RTCP_FEEDBACK_INTERVAL                          (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Leave the sender time to answer a key frame request before asking again, a key frame takes a while to encode and send
+#define RTCP_KEY_FRAME_REQUEST_MIN_INTERVAL             (300 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Sender and receiver reports of a stream are sent at most this often, as long as packets are sent or received
+#define RTCP_REPORT_INTERVAL                            (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// Smoothing of the average interval between the reports of a remote sender
+#define RTCP_REPORT_INTERVAL_AVERAGE_SHIFT              4
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -11,6 +32,133 @@ STATUS onRtcpPacket(PKvsPeerConnection, PBYTE, UINT32);
 STATUS onRtcpRembPacket(PRtcpPacket, PKvsPeerConnection);
 STATUS onRtcpPLIPacket(PRtcpPacket, PKvsPeerConnection);
 
+/**
+ * Update the bandwidth estimate from a transport wide congestion control feedback and hand it to all the transceivers
+ *
+ * @param - PRtcpPacket - IN - Feedback
+ * @param - PKvsPeerConnection - IN - Peer connection
+ *
+ * @return - STATUS status of execution
+ */
+STATUS onRtcpTwccPacket(PRtcpPacket, PKvsPeerConnection);
+
+STATUS onRtcpFIRPacket(PRtcpPacket, PKvsPeerConnection);
+STATUS onRtcpSenderReport(PRtcpPacket, PKvsPeerConnection);
+STATUS onRtcpReceiverReport(PRtcpPacket, PKvsPeerConnection);
+
+/**
+ * Update the stats of the streams we send from the report blocks of a SR or a RR
+ *
+ * @param - PRtcpPacket - IN - SR or RR
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - UINT32 - IN - Offset of the first report block in the payload
+ *
+ * @return - STATUS status of execution
+ */
+STATUS onRtcpReportBlocks(PRtcpPacket, PKvsPeerConnection, UINT32);
+
+/**
+ * Get the round trip time of the selected ice candidate pair
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PUINT64 - OUT - Round trip time, 0 if it is unknown
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getRoundTripTime(PKvsPeerConnection, PUINT64);
+
+/**
+ * Encrypt an RTCP packet and send it to the remote peer. Packets are discarded until SRTP is ready.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PBYTE - IN - Serialized RTCP packet
+ * @param - UINT32 - IN - Packet length, at most RTCP_MAX_PACKET_LEN
+ *
+ * @return - STATUS status of execution
+ */
+STATUS writeRtcpPacket(PKvsPeerConnection, PBYTE, UINT32);
+
+/**
+ * Send a generic NACK for the packets missing from the stream received by a transceiver, if any are due. Caller holds the
+ * receiver lock of the transceiver.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PKvsRtpTransceiver - IN - Transceiver whose jitter buffer tracks the missing packets
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendRtcpNackPacket(PKvsPeerConnection, PKvsRtpTransceiver);
+
+/**
+ * Ask the remote sender of a transceiver for a key frame with a PLI, preceded by a FIR if requested. Requests sent less
+ * than a round trip apart are dropped as the key frame asked for first is likely still on its way.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PKvsRtpTransceiver - IN - Transceiver receiving the stream that needs a key frame
+ * @param - BOOL - IN - Whether to send a FIR along with the PLI
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendRtcpKeyFrameRequest(PKvsPeerConnection, PKvsRtpTransceiver, BOOL);
+
+/**
+ * Send a SR for the stream a transceiver sends if the last one is RTCP_REPORT_INTERVAL old. Called right after a frame was
+ * sent, takes the SRTP session lock itself.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PKvsRtpTransceiver - IN - Transceiver sending the stream
+ * @param - UINT32 - IN - RTP timestamp of the frame that was just sent
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendRtcpSenderReport(PKvsPeerConnection, PKvsRtpTransceiver, UINT32);
+
+/**
+ * Send a RR for the stream a transceiver receives if the last one is RTCP_REPORT_INTERVAL old. Caller holds the receiver
+ * lock of the transceiver.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PKvsRtpTransceiver - IN - Transceiver receiving the stream
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendRtcpReceiverReport(PKvsPeerConnection, PKvsRtpTransceiver);
+
+/**
+ * Record the transport wide sequence number of a received packet. The transport wide congestion control feedback waiting
+ * to be sent only goes out here when the packet does not fit in it, twccFeedbackTimerCallback sends it otherwise.
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - PKvsRtpTransceiver - IN - Transceiver that received the packet
+ * @param - PRtpPacket - IN - Received packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendRtcpTwccPacket(PKvsPeerConnection, PKvsRtpTransceiver, PRtpPacket);
+
+/**
+ * Timer callback sending the transport wide congestion control feedback that is due, every TWCC_FEEDBACK_INTERVAL
+ *
+ * @param - UINT32 - IN - Timer id
+ * @param - UINT64 - IN - Current time
+ * @param - UINT64 - IN - Peer connection
+ *
+ * @return - STATUS status of execution
+ */
+STATUS twccFeedbackTimerCallback(UINT32, UINT64, UINT64);
+
+/**
+ * Timer callback sending the NACKs, receiver reports and key frame requests that are due for the received streams, every
+ * RTCP_FEEDBACK_INTERVAL. Transceivers whose receiver lock is busy are skipped until the next tick.
+ *
+ * @param - UINT32 - IN - Timer id
+ * @param - UINT64 - IN - Current time
+ * @param - UINT64 - IN - Peer connection
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpFeedbackTimerCallback(UINT32, UINT64, UINT64);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -2,8 +2,6 @@
 
 #include "../Include_i.h"
 
-typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
-
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc,
                                UINT32 rtxSsrc, PRtcMediaStreamTrack pRtcMediaStreamTrack, PJitterBuffer pJitterBuffer,
                                RTC_CODEC rtcCodec, PKvsRtpTransceiver* ppKvsRtpTransceiver)
@@ -29,6 +27,8 @@ STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeer
     pKvsRtpTransceiver->pJitterBuffer = pJitterBuffer;
     pKvsRtpTransceiver->transceiver.receiver.track.codec = rtcCodec;
     pKvsRtpTransceiver->transceiver.direction = direction;
+    pKvsRtpTransceiver->statsLock = MUTEX_CREATE(FALSE);
+    pKvsRtpTransceiver->receiverLock = MUTEX_CREATE(FALSE);
 
 CleanUp:
 
@@ -68,6 +68,15 @@ STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver* ppKvsRtpTransceiver)
     SAFE_MEMFREE(pKvsRtpTransceiver->peerFrameBuffer);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadBuffer);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadSubLength);
+    rtpPacketArenaFree(&pKvsRtpTransceiver->sender.packetArena);
+
+    if (IS_VALID_MUTEX_VALUE(pKvsRtpTransceiver->statsLock)) {
+        MUTEX_FREE(pKvsRtpTransceiver->statsLock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pKvsRtpTransceiver->receiverLock)) {
+        MUTEX_FREE(pKvsRtpTransceiver->receiverLock);
+    }
 
     SAFE_MEMFREE(pKvsRtpTransceiver);
 
@@ -90,6 +99,26 @@ CleanUp:
     return retStatus;
 }
 
+STATUS findTransceiverBySsrcKey(PKvsPeerConnection pKvsPeerConnection, UINT64 ssrcKey, PKvsRtpTransceiver* ppKvsRtpTransceiver)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 item = 0;
+
+    CHK(pKvsPeerConnection != NULL && ppKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+
+    retStatus = hashTableGet(pKvsPeerConnection->pTransceiverSsrcTable, ssrcKey, &item);
+    // An unknown ssrc is not an error, the caller decides what to do without a transceiver
+    if (retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
+        retStatus = STATUS_SUCCESS;
+    }
+
+    *ppKvsRtpTransceiver = (PKvsRtpTransceiver) item;
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS transceiverOnFrame(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnFrame rtcOnFrame) {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -106,6 +135,163 @@ CleanUp:
     return retStatus;
 }
 
+STATUS transceiverOnFrameSegments(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnFrameSegments rtcOnFrameSegments) {
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && rtcOnFrameSegments != NULL, STATUS_NULL_ARG);
+
+    pKvsRtpTransceiver->onFrameSegments = rtcOnFrameSegments;
+    pKvsRtpTransceiver->onFrameSegmentsCustomData = customData;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createFrameSegments(PJitterBuffer pJitterBuffer, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize, PRtcFrameSegments* ppFrameSegments)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsFrameSegments pKvsFrameSegments = NULL;
+    PRtcFrameSegments pFrameSegments = NULL;
+    PRtpPacket pRtpPacket;
+    UINT32 packetCount = (UINT16) (endIndex - startIndex) + 1, segmentCount = 0;
+    UINT16 index;
+
+    CHK(pJitterBuffer != NULL && ppFrameSegments != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(jitterBufferFillFrameSegments(pJitterBuffer, NULL, &segmentCount, startIndex, endIndex));
+
+    pKvsFrameSegments = (PKvsFrameSegments) MEMALLOC(SIZEOF(KvsFrameSegments) + packetCount * SIZEOF(PRtpPacket) +
+                                                     segmentCount * SIZEOF(RtcFrameSegment));
+    CHK(pKvsFrameSegments != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pFrameSegments = (PRtcFrameSegments) pKvsFrameSegments;
+    pKvsFrameSegments->packetCount = 0;
+    pKvsFrameSegments->pPackets = (PRtpPacket*) (pKvsFrameSegments + 1);
+    pFrameSegments->presentationTs = 0;
+    pFrameSegments->size = frameSize;
+    pFrameSegments->pSegments = (PRtcFrameSegment) (pKvsFrameSegments->pPackets + packetCount);
+
+    for (index = startIndex; UINT16_DEC(index) != endIndex; index++) {
+        pRtpPacket = jitterBufferGetPacket(pJitterBuffer, index);
+        CHK(pRtpPacket != NULL, STATUS_NULL_ARG);
+        CHK_STATUS(rtpPacketAddReference(pRtpPacket));
+        pKvsFrameSegments->pPackets[pKvsFrameSegments->packetCount++] = pRtpPacket;
+    }
+
+    pFrameSegments->segmentCount = segmentCount;
+    CHK_STATUS(jitterBufferFillFrameSegments(pJitterBuffer, pFrameSegments->pSegments, &pFrameSegments->segmentCount, startIndex, endIndex));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeRtcFrameSegments(&pFrameSegments);
+    }
+
+    if (ppFrameSegments != NULL) {
+        *ppFrameSegments = pFrameSegments;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeRtcFrameSegments(PRtcFrameSegments* ppFrameSegments)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsFrameSegments pKvsFrameSegments = NULL;
+    UINT32 i;
+
+    CHK(ppFrameSegments != NULL, STATUS_NULL_ARG);
+    CHK(*ppFrameSegments != NULL, retStatus);
+
+    pKvsFrameSegments = (PKvsFrameSegments) *ppFrameSegments;
+    for (i = 0; i < pKvsFrameSegments->packetCount; i++) {
+        freeRtpPacketAndRawPacket(&pKvsFrameSegments->pPackets[i]);
+    }
+
+    SAFE_MEMFREE(*ppFrameSegments);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS transceiverSetJitterBufferConfiguration(PRtcRtpTransceiver pRtcRtpTransceiver, PRtcJitterBufferConfiguration pConfiguration)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    UINT64 maxLatency, minLatency;
+    BOOL isVideo;
+
+    CHK(pKvsRtpTransceiver != NULL && pConfiguration != NULL, STATUS_NULL_ARG);
+
+    maxLatency = pConfiguration->maxLatency == 0 ? DEFAULT_JITTER_BUFFER_MAX_LATENCY : pConfiguration->maxLatency;
+    minLatency = pConfiguration->minLatency == 0 ? DEFAULT_JITTER_BUFFER_MIN_LATENCY : pConfiguration->minLatency;
+
+    if (pConfiguration->adaptiveLatency) {
+        CHK_STATUS(jitterBufferSetAdaptiveLatency(pKvsRtpTransceiver->pJitterBuffer, minLatency, maxLatency));
+    } else {
+        CHK_STATUS(jitterBufferSetMaxLatency(pKvsRtpTransceiver->pJitterBuffer, maxLatency));
+    }
+
+    // The marker bit of audio starts a talkspurt instead of ending a frame, and a lost audio packet is concealed rather
+    // than worth a retransmission
+    isVideo = pKvsRtpTransceiver->transceiver.receiver.track.codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE ||
+        pKvsRtpTransceiver->transceiver.receiver.track.codec == RTC_CODEC_VP8;
+    CHK_STATUS(jitterBufferSetReleaseOnMarker(pKvsRtpTransceiver->pJitterBuffer, pConfiguration->releaseOnMarker && isVideo));
+    CHK_STATUS(jitterBufferSetNackEnabled(pKvsRtpTransceiver->pJitterBuffer, !pConfiguration->disableNack && isVideo));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS transceiverGetNackStats(PRtcRtpTransceiver pRtcRtpTransceiver, PRtcNackStats pRtcNackStats)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && pKvsRtpTransceiver->pJitterBuffer != NULL && pRtcNackStats != NULL, STATUS_NULL_ARG);
+
+    pRtcNackStats->nackPacketsSent = ATOMIC_LOAD(&pKvsRtpTransceiver->nackPacketsSent);
+    pRtcNackStats->packetsNacked = ATOMIC_LOAD(&pKvsRtpTransceiver->pJitterBuffer->packetsNacked);
+    pRtcNackStats->packetsRecovered = ATOMIC_LOAD(&pKvsRtpTransceiver->pJitterBuffer->packetsRecovered);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS transceiverRequestKeyFrame(PRtcRtpTransceiver pRtcRtpTransceiver)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && pKvsRtpTransceiver->pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+    CHK(pKvsRtpTransceiver->transceiver.receiver.track.codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE ||
+        pKvsRtpTransceiver->transceiver.receiver.track.codec == RTC_CODEC_VP8, STATUS_INVALID_ARG);
+
+    CHK_STATUS(sendRtcpKeyFrameRequest(pKvsRtpTransceiver->pKvsPeerConnection, pKvsRtpTransceiver, TRUE));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS transceiverOnBandwidthEstimation(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnBandwidthEstimation rtcOnBandwidthEstimation) {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -127,30 +313,221 @@ UINT64 convertTimestampToRTP(UINT64 clockRate, UINT64 pts)
     return (pts * clockRate) / HUNDREDS_OF_NANOS_IN_A_SECOND;
 }
 
+STATUS rtpPacketArenaReserve(PRtpPacketArena pArena, UINT32 packetCount, UINT32 maxPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 slotSize = 0, slotCount = 0, packetListCapacity = 0;
+
+    CHK(pArena != NULL, STATUS_NULL_ARG);
+
+    if (packetCount > pArena->packetListCapacity) {
+        packetListCapacity = (UINT32) (packetCount * RTP_PACKET_ARENA_GROWTH_FACTOR);
+        SAFE_MEMFREE(pArena->pPacketList);
+        pArena->packetListCapacity = 0;
+        pArena->pPacketList = (PRtpPacket) MEMALLOC(packetListCapacity * SIZEOF(RtpPacket));
+        CHK(pArena->pPacketList != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pArena->packetListCapacity = packetListCapacity;
+        ATOMIC_INCREMENT(&pArena->allocationCount);
+    }
+
+    // Account for SRTP authentication tag so packets can be encrypted in place
+    slotSize = maxPacketLength + SRTP_AUTH_TAG_OVERHEAD;
+    if (packetCount > pArena->slotCount || slotSize > pArena->slotSize) {
+        slotCount = packetCount > pArena->slotCount ? (UINT32) (packetCount * RTP_PACKET_ARENA_GROWTH_FACTOR) : pArena->slotCount;
+        slotSize = MAX(slotSize, pArena->slotSize);
+        // Slots are scratch space so there is nothing to preserve
+        SAFE_MEMFREE(pArena->pSlab);
+        pArena->slotCount = 0;
+        pArena->slotSize = 0;
+        pArena->pSlab = (PBYTE) MEMALLOC(slotCount * slotSize);
+        CHK(pArena->pSlab != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pArena->slotCount = slotCount;
+        pArena->slotSize = slotSize;
+        ATOMIC_INCREMENT(&pArena->allocationCount);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS rtpPacketArenaFree(PRtpPacketArena pArena)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pArena != NULL, STATUS_NULL_ARG);
+
+    SAFE_MEMFREE(pArena->pPacketList);
+    SAFE_MEMFREE(pArena->pSlab);
+    pArena->packetListCapacity = 0;
+    pArena->slotCount = 0;
+    pArena->slotSize = 0;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS rtpPacketArenaCreateH264Packets(PRtpPacketArena pArena, UINT32 mtu, PFrame pFrame, PRtpPacketRing pRing)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 slotCount;
+    UINT16 sequenceNumber;
+
+    CHK(pArena != NULL && pFrame != NULL && pRing != NULL, STATUS_NULL_ARG);
+    CHK(mtu > FU_A_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    sequenceNumber = pRing->sequenceNumber;
+    slotCount = pFrame->size / (mtu - FU_A_HEADER_SIZE) + RTP_PACKET_RING_EXTRA_SLOT_COUNT;
+
+    do {
+        CHK_STATUS(rtpPacketArenaReserve(pArena, slotCount, mtu + RTP_PACKET_RING_HEADER_LENGTH(pRing)));
+        pRing->pPackets = pArena->pPacketList;
+        pRing->pSlots = pArena->pSlab;
+        pRing->slotSize = pArena->slotSize;
+        pRing->slotCount = MIN(pArena->slotCount, pArena->packetListCapacity);
+        pRing->slotTailroom = SRTP_AUTH_TAG_OVERHEAD;
+        pRing->sequenceNumber = sequenceNumber;
+        pRing->packetCount = 0;
+
+        retStatus = createRtpPacketsForH264(mtu, (PBYTE) pFrame->frameData, pFrame->size, pRing);
+        slotCount = pRing->slotCount * 2;
+    } while (retStatus == STATUS_BUFFER_TOO_SMALL && pRing->packetCount == pRing->slotCount);
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Buffers and encrypts in place a batch of serialized packets, then sends them in one go. Caller holds pSrtpSessionLock
+STATUS sendRtpPacketBatch(UINT64 customData, PRtpPacket pPackets, UINT32 packetCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) customData;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    BOOL bufferAfterEncrypt = FALSE;
+    UINT32 i = 0, batchCount = 0, twccExtensionLen = 0;
+    INT32 packetLen = 0;
+    UINT16 twccSequenceNumber = 0;
+    PBYTE pTwccExtension = NULL;
+    PBYTE pBatchBuffers[SOCKET_SEND_BATCH_MAX_PACKETS];
+    UINT32 batchBufferLens[SOCKET_SEND_BATCH_MAX_PACKETS];
+
+    CHK(pKvsRtpTransceiver != NULL && pPackets != NULL, STATUS_NULL_ARG);
+    pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+
+    bufferAfterEncrypt = (pKvsRtpTransceiver->sender.payloadType == pKvsRtpTransceiver->sender.rtxPayloadType);
+    for (i = 0; i < packetCount; i++) {
+        pRtpPacket = pPackets + i;
+        packetLen = (INT32) pRtpPacket->rawPacketLength;
+
+        // The transport wide sequence number follows the order packets of all the streams go out in, so it is only
+        // assigned now. Retransmissions from the rolling buffer keep the one of the original.
+        if (pKvsPeerConnection->pTwccManager != NULL) {
+            CHK_STATUS(getRtpHeaderExtensionFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pKvsPeerConnection->twccExtensionId,
+                                                      &pTwccExtension, &twccExtensionLen));
+            if (pTwccExtension != NULL && twccExtensionLen == SIZEOF(UINT16)) {
+                CHK_STATUS(twccManagerOnPacketSent(pKvsPeerConnection->pTwccManager, pRtpPacket->rawPacketLength, GETTIME(), &twccSequenceNumber));
+                putUnalignedInt16BigEndian(pTwccExtension, twccSequenceNumber);
+            }
+        }
+
+        if (!bufferAfterEncrypt) {
+            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+        }
+
+        CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pRtpPacket->pRawPacket, &packetLen));
+
+        // Counted as soon as it is encrypted as the SRTP session will not take its sequence number again
+        ATOMIC_INCREMENT(&pKvsRtpTransceiver->sender.packetsSent);
+        ATOMIC_ADD(&pKvsRtpTransceiver->sender.bytesSent, pRtpPacket->payloadLength);
+        ATOMIC_ADD(&pKvsRtpTransceiver->sender.headerBytesSent, pRtpPacket->rawPacketLength - pRtpPacket->payloadLength);
+
+        if (bufferAfterEncrypt) {
+            pRtpPacket->rawPacketLength = (UINT32) packetLen;
+            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+        }
+
+        pBatchBuffers[batchCount] = pRtpPacket->pRawPacket;
+        batchBufferLens[batchCount] = (UINT32) packetLen;
+        batchCount++;
+
+        if (batchCount == SOCKET_SEND_BATCH_MAX_PACKETS || i == packetCount - 1) {
+            CHK_STATUS(iceAgentSendPacketBatch(pKvsPeerConnection->pIceAgent, pBatchBuffers, batchBufferLens, batchCount));
+            batchCount = 0;
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Packetizes a frame into the payload array, growing it when the frame needs more room than any before it
+STATUS createRtpPayloads(RtpPayloadFunc rtpPayloadFunc, UINT32 mtu, PFrame pFrame, PPayloadArray pPayloadArray, volatile SIZE_T* pAllocationCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(rtpPayloadFunc != NULL && pFrame != NULL && pPayloadArray != NULL && pAllocationCount != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(rtpPayloadFunc(mtu, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL, &(pPayloadArray->payloadSubLenSize)));
+    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
+        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
+        pPayloadArray->maxPayloadLength = 0;
+        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
+        CHK(pPayloadArray->payloadBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
+        ATOMIC_INCREMENT(pAllocationCount);
+    }
+    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
+        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
+        pPayloadArray->maxPayloadSubLenSize = 0;
+        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
+        CHK(pPayloadArray->payloadSubLength != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+        ATOMIC_INCREMENT(pAllocationCount);
+    }
+    CHK_STATUS(rtpPayloadFunc(mtu, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer, &(pPayloadArray->payloadLength), pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = NULL;
     PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
-    BOOL locked = FALSE, bufferAfterEncrypt = FALSE;
-    PRtpPacket pPacketList = NULL, pRtpPacket = NULL;
-    UINT32 i = 0, packetLen = 0, allocSize;
+    BOOL locked = FALSE;
+    PRtpPacket pRtpPacket = NULL;
+    UINT32 i = 0, packetLen = 0, maxPacketLength = 0;
     PBYTE rawPacket = NULL;
     PPayloadArray pPayloadArray = NULL;
+    PRtpPacketArena pPacketArena = NULL;
     RtpPayloadFunc rtpPayloadFunc = NULL;
+    RtpPacketRing packetRing;
     UINT64 rtpTimestamp = 0;
+    // One byte header element of the transport wide sequence number, the number itself is written when the packet is sent
+    BYTE twccExtension[TWCC_HEADER_EXTENSION_LENGTH] = {0};
+    UINT32 extensionLength = 0, extensionOverhead = 0;
+    UINT16 startSequenceNumber = 0;
+    SIZE_T startPacketsSent = 0;
 
     CHK(pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
     pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
     pPayloadArray = &(pKvsRtpTransceiver->sender.payloadArray);
+    pPacketArena = &(pKvsRtpTransceiver->sender.packetArena);
 
     MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
     locked = TRUE;
     CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS); // Discard packets till SRTP is ready
+    startSequenceNumber = pKvsRtpTransceiver->sender.sequenceNumber;
+    startPacketsSent = ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent);
 
     switch (pKvsRtpTransceiver->sender.track.codec) {
         case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
-            rtpPayloadFunc = createPayloadForH264;
             rtpTimestamp = convertTimestampToRTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
             break;
 
@@ -174,63 +551,149 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
             CHK(FALSE, STATUS_NOT_IMPLEMENTED);
     }
 
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL, &(pPayloadArray->payloadSubLenSize)));
-    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
-        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
-        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
-        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
+    if (pKvsPeerConnection->pTwccManager != NULL) {
+        twccExtension[0] = (BYTE) ((pKvsPeerConnection->twccExtensionId << RTP_ONE_BYTE_HEADER_EXTENSION_ID_SHIFT) | (SIZEOF(UINT16) - 1));
+        extensionLength = SIZEOF(twccExtension);
+        extensionOverhead = TWCC_HEADER_EXTENSION_OVERHEAD;
     }
-    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
-        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
-        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
-        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+
+    if (rtpPayloadFunc == NULL) {
+        // H264 is packetized in a single pass straight into the arena slots, the packets go out once the frame is done
+        MEMSET(&packetRing, 0x00, SIZEOF(RtpPacketRing));
+        packetRing.payloadType = pKvsRtpTransceiver->sender.payloadType;
+        packetRing.sequenceNumber = pKvsRtpTransceiver->sender.sequenceNumber;
+        packetRing.timestamp = (UINT32) rtpTimestamp;
+        packetRing.ssrc = pKvsRtpTransceiver->sender.ssrc;
+        if (extensionLength > 0) {
+            packetRing.extensionProfile = RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE;
+            packetRing.extensionLength = extensionLength;
+            packetRing.extensionPayload = twccExtension;
+        }
+
+        CHK_STATUS(rtpPacketArenaCreateH264Packets(pPacketArena, pKvsPeerConnection->MTU, pFrame, &packetRing));
+        CHK_STATUS(sendRtpPacketBatch((UINT64) pKvsRtpTransceiver, packetRing.pPackets, packetRing.packetCount));
+        pKvsRtpTransceiver->sender.sequenceNumber = packetRing.sequenceNumber;
+        ATOMIC_INCREMENT(&pKvsRtpTransceiver->sender.framesSent);
+        CHK_STATUS(sendRtcpSenderReport(pKvsPeerConnection, pKvsRtpTransceiver, (UINT32) rtpTimestamp));
+        CHK(FALSE, retStatus);
     }
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer, &(pPayloadArray->payloadLength), pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
-    pPacketList = (PRtpPacket) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(RtpPacket));
 
-    CHK_STATUS(constructRtpPackets(pPayloadArray, pKvsRtpTransceiver->sender.payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp, pKvsRtpTransceiver->sender.ssrc, pPacketList, pPayloadArray->payloadSubLenSize));
-    pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + pPayloadArray->payloadSubLenSize);
+    CHK_STATUS(createRtpPayloads(rtpPayloadFunc, pKvsPeerConnection->MTU, pFrame, pPayloadArray, &pPacketArena->allocationCount));
 
-    bufferAfterEncrypt = (pKvsRtpTransceiver->sender.payloadType == pKvsRtpTransceiver->sender.rtxPayloadType);
+    // constructRtpPackets produces fixed size headers without CSRC, followed by the transport wide sequence number if negotiated
     for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
-        pRtpPacket = pPacketList + i;
+        maxPacketLength = MAX(maxPacketLength, pPayloadArray->payloadSubLength[i]);
+    }
+    maxPacketLength += MIN_HEADER_LENGTH + extensionOverhead;
+    CHK_STATUS(rtpPacketArenaReserve(pPacketArena, pPayloadArray->payloadSubLenSize, maxPacketLength));
+
+    CHK_STATUS(constructRtpPackets(pPayloadArray, pKvsRtpTransceiver->sender.payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp, pKvsRtpTransceiver->sender.ssrc,
+                                   RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE, extensionLength, extensionLength > 0 ? twccExtension : NULL, pPacketArena->pPacketList, pPacketArena->packetListCapacity));
+    pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + pPayloadArray->payloadSubLenSize);
 
-        // Get the required size first
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &packetLen));
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        pRtpPacket = pPacketArena->pPacketList + i;
+        rawPacket = pPacketArena->pSlab + i * pPacketArena->slotSize;
 
-        // Account for SRTP authentication tag
-        allocSize = packetLen + SRTP_AUTH_TAG_OVERHEAD;
-        CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+        // Serialize into the arena slot leaving the tail of the slot for the SRTP authentication tag
+        packetLen = pPacketArena->slotSize - SRTP_AUTH_TAG_OVERHEAD;
         CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, rawPacket, &packetLen));
+        pRtpPacket->pRawPacket = rawPacket;
+        pRtpPacket->rawPacketLength = packetLen;
+    }
 
-        if (!bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
-            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+    CHK_STATUS(sendRtpPacketBatch((UINT64) pKvsRtpTransceiver, pPacketArena->pPacketList, pPayloadArray->payloadSubLenSize));
+    ATOMIC_INCREMENT(&pKvsRtpTransceiver->sender.framesSent);
+
+    // The frame just went out, so its timestamp maps to the current time
+    CHK_STATUS(sendRtcpSenderReport(pKvsPeerConnection, pKvsRtpTransceiver, (UINT32) rtpTimestamp));
+
+CleanUp:
+    if (locked) {
+        if (STATUS_FAILED(retStatus)) {
+            // Only the packets that were sent before the failure keep their sequence numbers so that the stream has no gap
+            pKvsRtpTransceiver->sender.sequenceNumber =
+                GET_UINT16_SEQ_NUM(startSequenceNumber + (ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent) - startPacketsSent));
         }
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
 
-        CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, (PINT32) &packetLen));
-        CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, packetLen));
+    CHK_LOG_ERR(retStatus);
 
-        if (bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
-            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+    return retStatus;
+}
+
+STATUS writeSharedRtpPackets(PKvsRtpTransceiver pKvsRtpTransceiver, PRtpPacket* ppSharedPackets, UINT32 packetCount, UINT32 rtpTimestamp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    BOOL locked = FALSE;
+    PRtpPacket pSharedPacket = NULL, pRtpPacket = NULL;
+    PRtpPacketArena pPacketArena = NULL;
+    PBYTE rawPacket = NULL, pExtensionElement = NULL;
+    UINT32 i = 0, maxPacketLength = 0;
+    UINT16 startSequenceNumber = 0;
+    SIZE_T startPacketsSent = 0;
+
+    CHK(pKvsRtpTransceiver != NULL && ppSharedPackets != NULL, STATUS_NULL_ARG);
+    pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+    pPacketArena = &(pKvsRtpTransceiver->sender.packetArena);
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+    CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS); // Discard packets till SRTP is ready
+    startSequenceNumber = pKvsRtpTransceiver->sender.sequenceNumber;
+    startPacketsSent = ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent);
+
+    for (i = 0; i < packetCount; i++) {
+        maxPacketLength = MAX(maxPacketLength, ppSharedPackets[i]->rawPacketLength);
+    }
+    CHK_STATUS(rtpPacketArenaReserve(pPacketArena, packetCount, maxPacketLength));
+
+    for (i = 0; i < packetCount; i++) {
+        pSharedPacket = ppSharedPackets[i];
+        pRtpPacket = pPacketArena->pPacketList + i;
+        rawPacket = pPacketArena->pSlab + i * pPacketArena->slotSize;
+
+        // The shared packet is encrypted in place, so every session works on its own copy of it
+        MEMCPY(rawPacket, pSharedPacket->pRawPacket, pSharedPacket->rawPacketLength);
+        rawPacket[1] = (BYTE) ((rawPacket[1] & (MARKER_MASK << MARKER_SHIFT)) | (pKvsRtpTransceiver->sender.payloadType & PAYLOAD_TYPE_MASK));
+        putUnalignedInt16BigEndian(rawPacket + SEQ_NUMBER_OFFSET, GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + i));
+        putUnalignedInt32BigEndian(rawPacket + SSRC_OFFSET, pKvsRtpTransceiver->sender.ssrc);
+
+        // The only extension of a shared packet is the one byte header element of the transport wide sequence number.
+        // Sessions that did not negotiate it turn the element into padding.
+        if (((rawPacket[0] >> EXTENSION_SHIFT) & EXTENSION_MASK) != 0) {
+            pExtensionElement = rawPacket + MIN_HEADER_LENGTH + RTP_HEADER_EXTENSION_HEADER_LENGTH;
+            if (pKvsPeerConnection->pTwccManager != NULL) {
+                *pExtensionElement = (BYTE) ((pKvsPeerConnection->twccExtensionId << RTP_ONE_BYTE_HEADER_EXTENSION_ID_SHIFT) | (SIZEOF(UINT16) - 1));
+            } else {
+                MEMSET(pExtensionElement, 0x00, 1 + SIZEOF(UINT16));
+            }
         }
 
-        SAFE_MEMFREE(rawPacket);
+        MEMSET(pRtpPacket, 0x00, SIZEOF(RtpPacket));
+        pRtpPacket->pRawPacket = rawPacket;
+        pRtpPacket->rawPacketLength = pSharedPacket->rawPacketLength;
+        pRtpPacket->payloadLength = pSharedPacket->payloadLength;
+        pRtpPacket->payload = rawPacket + pSharedPacket->rawPacketLength - pSharedPacket->payloadLength;
     }
 
+    pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + packetCount);
+    CHK_STATUS(sendRtpPacketBatch((UINT64) pKvsRtpTransceiver, pPacketArena->pPacketList, packetCount));
+    ATOMIC_INCREMENT(&pKvsRtpTransceiver->sender.framesSent);
+
+    CHK_STATUS(sendRtcpSenderReport(pKvsPeerConnection, pKvsRtpTransceiver, rtpTimestamp));
+
 CleanUp:
     if (locked) {
+        if (STATUS_FAILED(retStatus)) {
+            pKvsRtpTransceiver->sender.sequenceNumber =
+                GET_UINT16_SEQ_NUM(startSequenceNumber + (ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent) - startPacketsSent));
+        }
         MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
     }
 
-    SAFE_MEMFREE(rawPacket);
-    SAFE_MEMFREE(pPacketList);
-
-    CHK_LOG_ERR(retStatus);
-
     return retStatus;
 }
 
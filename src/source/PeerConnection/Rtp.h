@@ -13,7 +13,34 @@ extern "C" {
 #define DEFAULT_SEQ_NUM_BUFFER_SIZE                             1000
 #define DEFAULT_VALID_INDEX_BUFFER_SIZE                         1000
 #define DEFAULT_PEER_FRAME_BUFFER_SIZE                          (5 * 1024)
-#define SRTP_AUTH_TAG_OVERHEAD                                  10
+// Largest authentication tag of the SRTP protection profiles, the 16 byte tag of AEAD_AES_*_GCM
+#define SRTP_AUTH_TAG_OVERHEAD                                  16
+
+// Growth factor for the per-transceiver packet arena, same policy as the peer frame buffer
+#define RTP_PACKET_ARENA_GROWTH_FACTOR                          1.5
+
+// Ring slots for an H264 frame on top of the ones its size calls for, room for parameter sets and slices
+#define RTP_PACKET_RING_EXTRA_SLOT_COUNT                        8
+
+typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+
+/*
+ * Per-transceiver scratch memory for the send path. Packet descriptors and wire buffers are reused across
+ * frames and only grow when a frame needs more/larger packets than any frame before it, so steady state
+ * writeFrame does not touch the heap. Each slot has SRTP_AUTH_TAG_OVERHEAD bytes of headroom for in place encryption.
+ */
+typedef struct {
+    PRtpPacket pPacketList;
+    UINT32 packetListCapacity;
+
+    PBYTE pSlab;
+    UINT32 slotSize;
+    UINT32 slotCount;
+
+    // number of heap allocations done by the send path, including payload array growth. Written under the SRTP session
+    // lock, read with atomics for the outbound stats
+    volatile SIZE_T allocationCount;
+} RtpPacketArena, *PRtpPacketArena;
 
 typedef struct {
     UINT8 payloadType;
@@ -23,10 +50,28 @@ typedef struct {
     UINT32 ssrc;
     UINT32 rtxSsrc;
     PayloadArray payloadArray;
+    RtpPacketArena packetArena;
 
     RtcMediaStreamTrack track;
     PRtpRollingBuffer packetBuffer;
     PRetransmitter retransmitter;
+
+    // Written on the send path under the SRTP session lock, read with atomics so that collecting stats does not take it.
+    // Sender reports carry the low 32 bits of the media packets and payload bytes sent
+    volatile SIZE_T packetsSent;
+    volatile SIZE_T bytesSent;
+    volatile SIZE_T headerBytesSent;
+    volatile SIZE_T framesSent;
+    volatile SIZE_T retransmittedPacketsSent;
+    volatile SIZE_T retransmittedBytesSent;
+
+    // Feedback received from the remote receiver
+    volatile SIZE_T nackCount;
+    volatile SIZE_T pliCount;
+    volatile SIZE_T firCount;
+
+    // Guarded by the SRTP session lock
+    UINT64 lastSenderReportTime;
 } RtcRtpSender, *PRtcRtpSender;
 
 typedef struct {
@@ -40,6 +85,8 @@ typedef struct {
 
     UINT64 onFrameCustomData;
     RtcOnFrame onFrame;
+    UINT64 onFrameSegmentsCustomData;
+    RtcOnFrameSegments onFrameSegments;
 
     UINT64 onBandwidthEstimationCustomData;
     RtcOnBandwidthEstimation onBandwidthEstimation;
@@ -48,16 +95,115 @@ typedef struct {
 
     PBYTE peerFrameBuffer;
     UINT32 peerFrameBufferSize;
+
+    // Held by the thread receiving the packets of the transceiver while it pushes them into the jitter buffer, and by the
+    // RTCP feedback timer while it reads the jitter buffer and the reception stats
+    MUTEX receiverLock;
+
+    // Only written under receiverLock
+    volatile SIZE_T nackPacketsSent;
+
+    // Set when a frame was dropped, every frame up to the next key frame refers to a frame the decoder never got.
+    // Guarded by receiverLock
+    BOOL keyFrameRequired;
+
+    // Guarded by the peer connection object lock as the application can ask for key frames too
+    UINT64 lastKeyFrameRequestTime;
+    UINT8 firSequenceNumber;
+    volatile SIZE_T pliPacketsSent;
+    volatile SIZE_T firPacketsSent;
+
+    // Received stream the receiver reports describe. Guarded by receiverLock
+    RtcpReceptionStats receptionStats;
+    UINT64 lastReceiverReportTime;
+
+    // Only written under receiverLock. Loss and jitter are those of the last receiver report
+    volatile SIZE_T packetsReceived;
+    volatile SIZE_T bytesReceived;
+    volatile SIZE_T framesReceived;
+    volatile SIZE_T framesDropped;
+    volatile SIZE_T packetsLost;
+    volatile SIZE_T jitter;
+
+    // What the RTCP reports of the remote peer tell about the stream it sends and the stream it receives from us
+    MUTEX statsLock;
+    RtcOutboundRtpStreamStats remoteOutboundRtpStreamStats;
+    RtcRemoteInboundRtpStreamStats remoteInboundRtpStreamStats;
 } KvsRtpTransceiver, *PKvsRtpTransceiver;
 
+/*
+ * Frame handed to RtcOnFrameSegments. It holds a reference on every packet of the frame so that the segments stay valid
+ * after the packets left the jitter buffer, and lives in a single allocation with its packets and segments.
+ */
+typedef struct {
+    RtcFrameSegments frameSegments;
+    UINT32 packetCount;
+    PRtpPacket* pPackets;
+} KvsFrameSegments, *PKvsFrameSegments;
+
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION, PKvsPeerConnection, UINT32, UINT32,
                                PRtcMediaStreamTrack, PJitterBuffer, RTC_CODEC, PKvsRtpTransceiver*);
 STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver*);
 
 STATUS kvsRtpTransceiverSetJitterBuffer(PKvsRtpTransceiver, PJitterBuffer);
 
+/**
+ * Take a reference on the packets of a frame ready in the jitter buffer and describe it as segments
+ *
+ * @param - PJitterBuffer - IN - Jitter buffer holding the frame
+ * @param - UINT16 - IN - First sequence number of the frame
+ * @param - UINT16 - IN - Last sequence number of the frame
+ * @param - UINT32 - IN - Frame size
+ * @param - PRtcFrameSegments* - OUT - Frame, released with freeRtcFrameSegments
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createFrameSegments(PJitterBuffer, UINT16, UINT16, UINT32, PRtcFrameSegments*);
+
+/**
+ * Find the transceiver an ssrc belongs to
+ *
+ * @param - PKvsPeerConnection - IN - Peer connection
+ * @param - UINT64 - IN - TRANSCEIVER_LOCAL_SSRC_KEY or TRANSCEIVER_REMOTE_SSRC_KEY of the ssrc
+ * @param - PKvsRtpTransceiver* - OUT - Transceiver, NULL if the ssrc is unknown
+ *
+ * @return - STATUS status of execution
+ */
+STATUS findTransceiverBySsrcKey(PKvsPeerConnection, UINT64, PKvsRtpTransceiver*);
+
 UINT64 convertTimestampToRTP(UINT64, UINT64);
 
+STATUS rtpPacketArenaReserve(PRtpPacketArena, UINT32, UINT32);
+STATUS rtpPacketArenaFree(PRtpPacketArena);
+
+/**
+ * Packetize a whole H264 frame into the slots of the arena. A frame of more NALUs than its size suggests is
+ * packetized again with more slots, nothing is sent before the ring holds every packet of the frame.
+ *
+ * @param - PRtpPacketArena - IN - Arena the slots are reserved in
+ * @param - UINT32 - IN - MTU
+ * @param - PFrame - IN - Frame
+ * @param - PRtpPacketRing - IN/OUT - Ring with the header fields and extension set, gets the slots and the packets
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtpPacketArenaCreateH264Packets(PRtpPacketArena, UINT32, PFrame, PRtpPacketRing);
+STATUS sendRtpPacketBatch(UINT64, PRtpPacket, UINT32);
+STATUS createRtpPayloads(RtpPayloadFunc, UINT32, PFrame, PPayloadArray, volatile SIZE_T*);
+
+/**
+ * Send packets serialized once for many transceivers through one of them. The copy of the packets it sends gets the
+ * payload type, ssrc and next sequence numbers of the transceiver before it is encrypted.
+ *
+ * @param - PKvsRtpTransceiver - IN - Transceiver to send through
+ * @param - PRtpPacket* - IN - Serialized packets of a frame, left untouched
+ * @param - UINT32 - IN - Number of packets
+ * @param - UINT32 - IN - RTP timestamp of the frame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS writeSharedRtpPackets(PKvsRtpTransceiver, PRtpPacket*, UINT32, UINT32);
+
 STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket);
 
 #ifdef  __cplusplus
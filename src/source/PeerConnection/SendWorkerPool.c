@@ -0,0 +1,534 @@
+#define LOG_CLASS "SendWorkerPool"
+
+#include "../Include_i.h"
+
+static PSendWorkerPool gSendWorkerPool = NULL;
+
+STATUS initSendWorkerPool(PSendWorkerPoolConfiguration pConfiguration)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorkerPool pSendWorkerPool = NULL;
+    UINT32 i, workerCount;
+    INT64 cpuCount = SEND_WORKER_POOL_FALLBACK_WORKER_COUNT;
+
+    CHK(pConfiguration != NULL, STATUS_NULL_ARG);
+    CHK(pConfiguration->workerCount <= MAX_SEND_WORKER_COUNT && pConfiguration->queueSize <= MAX_SEND_QUEUE_SIZE, STATUS_INVALID_ARG);
+    CHK(gSendWorkerPool == NULL, STATUS_INVALID_OPERATION);
+
+    workerCount = pConfiguration->workerCount;
+    if (workerCount == 0) {
+#if defined(__linux__)
+        cpuCount = (INT64) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        workerCount = (UINT32) MIN(MAX(cpuCount, 1), MAX_SEND_WORKER_COUNT);
+    }
+
+    pSendWorkerPool = (PSendWorkerPool) MEMCALLOC(1, SIZEOF(SendWorkerPool));
+    CHK(pSendWorkerPool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pSendWorkerPool->lock = MUTEX_CREATE(FALSE);
+    pSendWorkerPool->queueSize = pConfiguration->queueSize == 0 ? SEND_WORKER_POOL_DEFAULT_QUEUE_SIZE : pConfiguration->queueSize;
+    pSendWorkerPool->maxEnqueueWait =
+        pConfiguration->maxEnqueueWait == 0 ? SEND_WORKER_POOL_DEFAULT_MAX_ENQUEUE_WAIT : pConfiguration->maxEnqueueWait;
+
+    for (i = 0; i < workerCount; i++) {
+        CHK_STATUS(createSendWorker(&pSendWorkerPool->workers[i]));
+        pSendWorkerPool->workerCount++;
+    }
+
+    DLOGI("Sending queued frames of all peer connections on %u workers", workerCount);
+
+    gSendWorkerPool = pSendWorkerPool;
+    pSendWorkerPool = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (pSendWorkerPool != NULL) {
+        gSendWorkerPool = pSendWorkerPool;
+        deinitSendWorkerPool();
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS deinitSendWorkerPool()
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorkerPool pSendWorkerPool = gSendWorkerPool;
+    UINT32 i;
+
+    CHK(pSendWorkerPool != NULL, retStatus);
+    gSendWorkerPool = NULL;
+
+    for (i = 0; i < pSendWorkerPool->workerCount; i++) {
+        CHK_LOG_ERR(freeSendWorker(&pSendWorkerPool->workers[i]));
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSendWorkerPool->lock)) {
+        MUTEX_FREE(pSendWorkerPool->lock);
+    }
+
+    MEMFREE(pSendWorkerPool);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS getSendWorkerMetrics(PSendWorkerMetrics pMetrics, PUINT32 pCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorkerPool pSendWorkerPool = gSendWorkerPool;
+    UINT32 i, workerCount;
+
+    CHK(pCount != NULL, STATUS_NULL_ARG);
+
+    workerCount = pSendWorkerPool == NULL ? 0 : pSendWorkerPool->workerCount;
+    if (pMetrics != NULL) {
+        CHK(*pCount >= workerCount, STATUS_BUFFER_TOO_SMALL);
+        for (i = 0; i < workerCount; i++) {
+            MUTEX_LOCK(pSendWorkerPool->workers[i]->lock);
+            pMetrics[i] = pSendWorkerPool->workers[i]->metrics;
+            MUTEX_UNLOCK(pSendWorkerPool->workers[i]->lock);
+        }
+    }
+
+CleanUp:
+
+    if (pCount != NULL) {
+        *pCount = workerCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createSendWorker(PSendWorker* ppSendWorker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorker pSendWorker = NULL;
+
+    CHK(ppSendWorker != NULL, STATUS_NULL_ARG);
+
+    pSendWorker = (PSendWorker) MEMCALLOC(1, SIZEOF(SendWorker));
+    CHK(pSendWorker != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pSendWorker->lock = MUTEX_CREATE(FALSE);
+    pSendWorker->workCvar = CVAR_CREATE();
+    pSendWorker->spaceCvar = CVAR_CREATE();
+    pSendWorker->routine = INVALID_TID_VALUE;
+
+    CHK_STATUS(THREAD_CREATE(&pSendWorker->routine, sendWorkerRoutine, (PVOID) pSendWorker));
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeSendWorker(&pSendWorker);
+    }
+
+    if (ppSendWorker != NULL) {
+        *ppSendWorker = pSendWorker;
+    }
+
+    return retStatus;
+}
+
+STATUS freeSendWorker(PSendWorker* ppSendWorker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorker pSendWorker;
+
+    CHK(ppSendWorker != NULL, STATUS_NULL_ARG);
+    pSendWorker = *ppSendWorker;
+    CHK(pSendWorker != NULL, retStatus);
+
+    if (IS_VALID_TID_VALUE(pSendWorker->routine)) {
+        MUTEX_LOCK(pSendWorker->lock);
+        pSendWorker->terminate = TRUE;
+        CVAR_SIGNAL(pSendWorker->workCvar);
+        MUTEX_UNLOCK(pSendWorker->lock);
+
+        THREAD_JOIN(pSendWorker->routine, NULL);
+        pSendWorker->routine = INVALID_TID_VALUE;
+    }
+
+    if (IS_VALID_CVAR_VALUE(pSendWorker->workCvar)) {
+        CVAR_FREE(pSendWorker->workCvar);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pSendWorker->spaceCvar)) {
+        CVAR_FREE(pSendWorker->spaceCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSendWorker->lock)) {
+        MUTEX_FREE(pSendWorker->lock);
+    }
+
+    SAFE_MEMFREE(*ppSendWorker);
+
+CleanUp:
+
+    return retStatus;
+}
+
+PVOID sendWorkerRoutine(PVOID customData)
+{
+    STATUS sendStatus;
+    PSendWorker pSendWorker = (PSendWorker) customData;
+    PSendQueue pSendQueue;
+    SendJob sendJob;
+    UINT64 sendStartTime;
+
+    MUTEX_LOCK(pSendWorker->lock);
+
+    while (!pSendWorker->terminate) {
+        if (pSendWorker->pReadyHead == NULL) {
+            CVAR_WAIT(pSendWorker->workCvar, pSendWorker->lock, INFINITE_TIME_VALUE);
+            continue;
+        }
+
+        pSendQueue = pSendWorker->pReadyHead;
+        pSendWorker->pReadyHead = pSendQueue->pNextReady;
+        if (pSendWorker->pReadyHead == NULL) {
+            pSendWorker->pReadyTail = NULL;
+        }
+        pSendQueue->pNextReady = NULL;
+
+        // Its jobs might have been discarded since it became ready
+        if (pSendQueue->count == 0) {
+            pSendQueue->scheduled = FALSE;
+            continue;
+        }
+
+        sendJob = pSendQueue->pJobs[pSendQueue->head];
+        pSendQueue->head = (pSendQueue->head + 1) % pSendQueue->capacity;
+        pSendQueue->count--;
+        pSendWorker->pSendingQueue = pSendQueue;
+        CVAR_BROADCAST(pSendWorker->spaceCvar);
+        MUTEX_UNLOCK(pSendWorker->lock);
+
+        sendStartTime = GETTIME_MONOTONIC();
+        sendStatus = writeSharedRtpPackets((PKvsRtpTransceiver) sendJob.customData, sendJob.pSendFrame->pPackets,
+                                           sendJob.pSendFrame->packetCount, sendJob.pSendFrame->rtpTimestamp);
+        if (STATUS_FAILED(sendStatus)) {
+            DLOGW("Failed to send queued frame with status 0x%08x", sendStatus);
+        }
+        releaseSendFrame(&sendJob.pSendFrame);
+
+        MUTEX_LOCK(pSendWorker->lock);
+        pSendWorker->pSendingQueue = NULL;
+        pSendWorker->metrics.busyTime += GETTIME_MONOTONIC() - sendStartTime;
+        pSendWorker->metrics.framesSent++;
+        pSendQueue->stats.framesSent++;
+
+        // Back to the end of the ready list, after the other peer connections had their turn
+        if (pSendQueue->count > 0) {
+            if (pSendWorker->pReadyTail == NULL) {
+                pSendWorker->pReadyHead = pSendQueue;
+            } else {
+                pSendWorker->pReadyTail->pNextReady = pSendQueue;
+            }
+            pSendWorker->pReadyTail = pSendQueue;
+        } else {
+            pSendQueue->scheduled = FALSE;
+        }
+
+        // Wakes up whoever waits for this queue to be done sending as well
+        CVAR_BROADCAST(pSendWorker->spaceCvar);
+    }
+
+    MUTEX_UNLOCK(pSendWorker->lock);
+
+    return NULL;
+}
+
+/*
+ * Pick the worker serving the fewest peer connections, preferring the one that has been the least busy so far
+ * among those. The peer connection stays on it until it is freed so its frames are never sent concurrently.
+ */
+STATUS sendWorkerPoolAcquireQueue(PSendQueue* ppSendQueue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorkerPool pSendWorkerPool = gSendWorkerPool;
+    PSendWorker pSendWorker = NULL, pCurSendWorker;
+    PSendQueue pSendQueue = NULL;
+    BOOL locked = FALSE;
+    UINT32 i, peerConnectionCount, minPeerConnectionCount = MAX_UINT32;
+    UINT64 busyTime, minBusyTime = MAX_UINT64;
+
+    CHK(ppSendQueue != NULL, STATUS_NULL_ARG);
+    CHK(pSendWorkerPool != NULL, retStatus);
+
+    pSendQueue = (PSendQueue) MEMCALLOC(1, SIZEOF(SendQueue) + pSendWorkerPool->queueSize * SIZEOF(SendJob));
+    CHK(pSendQueue != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pSendQueue->pJobs = (PSendJob) (pSendQueue + 1);
+    pSendQueue->capacity = pSendWorkerPool->queueSize;
+    pSendQueue->maxEnqueueWait = pSendWorkerPool->maxEnqueueWait;
+
+    MUTEX_LOCK(pSendWorkerPool->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pSendWorkerPool->workerCount; i++) {
+        pCurSendWorker = pSendWorkerPool->workers[i];
+
+        MUTEX_LOCK(pCurSendWorker->lock);
+        peerConnectionCount = pCurSendWorker->metrics.peerConnectionCount;
+        busyTime = pCurSendWorker->metrics.busyTime;
+        MUTEX_UNLOCK(pCurSendWorker->lock);
+
+        if (peerConnectionCount < minPeerConnectionCount ||
+            (peerConnectionCount == minPeerConnectionCount && busyTime < minBusyTime)) {
+            pSendWorker = pCurSendWorker;
+            minPeerConnectionCount = peerConnectionCount;
+            minBusyTime = busyTime;
+        }
+    }
+
+    MUTEX_LOCK(pSendWorker->lock);
+    pSendWorker->metrics.peerConnectionCount++;
+    MUTEX_UNLOCK(pSendWorker->lock);
+    pSendQueue->pWorker = pSendWorker;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSendWorkerPool->lock);
+    }
+
+    if (ppSendQueue != NULL) {
+        *ppSendQueue = pSendQueue;
+    }
+
+    return retStatus;
+}
+
+STATUS sendWorkerPoolReleaseQueue(PSendQueue* ppSendQueue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendQueue pSendQueue, pCurSendQueue, pPrevSendQueue = NULL;
+    PSendWorker pSendWorker;
+
+    CHK(ppSendQueue != NULL, STATUS_NULL_ARG);
+    pSendQueue = *ppSendQueue;
+    CHK(pSendQueue != NULL, retStatus);
+    pSendWorker = pSendQueue->pWorker;
+
+    MUTEX_LOCK(pSendWorker->lock);
+
+    while (pSendWorker->pSendingQueue == pSendQueue) {
+        CVAR_WAIT(pSendWorker->spaceCvar, pSendWorker->lock, INFINITE_TIME_VALUE);
+    }
+
+    for (pCurSendQueue = pSendWorker->pReadyHead; pCurSendQueue != NULL; pCurSendQueue = pCurSendQueue->pNextReady) {
+        if (pCurSendQueue == pSendQueue) {
+            if (pPrevSendQueue == NULL) {
+                pSendWorker->pReadyHead = pSendQueue->pNextReady;
+            } else {
+                pPrevSendQueue->pNextReady = pSendQueue->pNextReady;
+            }
+            if (pSendWorker->pReadyTail == pSendQueue) {
+                pSendWorker->pReadyTail = pPrevSendQueue;
+            }
+            break;
+        }
+        pPrevSendQueue = pCurSendQueue;
+    }
+
+    sendQueueDiscardJobs(pSendQueue, TRUE, 0);
+    pSendWorker->metrics.peerConnectionCount--;
+
+    MUTEX_UNLOCK(pSendWorker->lock);
+
+    SAFE_MEMFREE(*ppSendQueue);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sendQueueEnqueue(PSendQueue pSendQueue, UINT64 customData, PSendFrame pSendFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorker pSendWorker = NULL;
+    BOOL locked = FALSE;
+    UINT64 waitStartTime = 0, waitTime, now;
+
+    CHK(pSendQueue != NULL && pSendFrame != NULL, STATUS_NULL_ARG);
+    pSendWorker = pSendQueue->pWorker;
+
+    MUTEX_LOCK(pSendWorker->lock);
+    locked = TRUE;
+
+    // Wait for the worker to catch up, which slows the writer down to the pace of the slowest peer connection for a while
+    while (pSendQueue->count == pSendQueue->capacity) {
+        now = GETTIME_MONOTONIC();
+        if (waitStartTime == 0) {
+            waitStartTime = now;
+        }
+        waitTime = now - waitStartTime;
+        if (waitTime >= pSendQueue->maxEnqueueWait) {
+            break;
+        }
+        CVAR_WAIT(pSendWorker->spaceCvar, pSendWorker->lock, pSendQueue->maxEnqueueWait - waitTime);
+    }
+
+    if (waitStartTime != 0) {
+        pSendQueue->stats.blockedTime += GETTIME_MONOTONIC() - waitStartTime;
+    }
+
+    if (pSendQueue->count == pSendQueue->capacity) {
+        pSendQueue->stats.framesDropped++;
+        CHK(FALSE, retStatus);
+    }
+
+    ATOMIC_INCREMENT(&pSendFrame->refCount);
+    pSendQueue->pJobs[(pSendQueue->head + pSendQueue->count) % pSendQueue->capacity].customData = customData;
+    pSendQueue->pJobs[(pSendQueue->head + pSendQueue->count) % pSendQueue->capacity].pSendFrame = pSendFrame;
+    pSendQueue->count++;
+    pSendQueue->stats.framesQueued++;
+    pSendQueue->stats.maxQueueDepth = MAX(pSendQueue->stats.maxQueueDepth, pSendQueue->count);
+
+    if (!pSendQueue->scheduled) {
+        pSendQueue->scheduled = TRUE;
+        if (pSendWorker->pReadyTail == NULL) {
+            pSendWorker->pReadyHead = pSendQueue;
+        } else {
+            pSendWorker->pReadyTail->pNextReady = pSendQueue;
+        }
+        pSendWorker->pReadyTail = pSendQueue;
+        CVAR_SIGNAL(pSendWorker->workCvar);
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSendWorker->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS sendQueueDiscard(PSendQueue pSendQueue, UINT64 customData)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendWorker pSendWorker;
+
+    CHK(pSendQueue != NULL, STATUS_NULL_ARG);
+    pSendWorker = pSendQueue->pWorker;
+
+    MUTEX_LOCK(pSendWorker->lock);
+
+    // The job being sent could be one of the transceiver
+    while (pSendWorker->pSendingQueue == pSendQueue) {
+        CVAR_WAIT(pSendWorker->spaceCvar, pSendWorker->lock, INFINITE_TIME_VALUE);
+    }
+
+    sendQueueDiscardJobs(pSendQueue, FALSE, customData);
+
+    MUTEX_UNLOCK(pSendWorker->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Drops every queued job, or only the ones of a transceiver, keeping the others in order. Caller holds the worker lock
+VOID sendQueueDiscardJobs(PSendQueue pSendQueue, BOOL all, UINT64 customData)
+{
+    UINT32 i, keptCount = 0;
+    PSendJob pSendJob;
+
+    for (i = 0; i < pSendQueue->count; i++) {
+        pSendJob = &pSendQueue->pJobs[(pSendQueue->head + i) % pSendQueue->capacity];
+        if (all || pSendJob->customData == customData) {
+            releaseSendFrame(&pSendJob->pSendFrame);
+            pSendQueue->stats.framesDropped++;
+        } else {
+            pSendQueue->pJobs[(pSendQueue->head + keptCount++) % pSendQueue->capacity] = *pSendJob;
+        }
+    }
+
+    pSendQueue->count = keptCount;
+    CVAR_BROADCAST(pSendQueue->pWorker->spaceCvar);
+}
+
+STATUS sendQueueGetStats(PSendQueue pSendQueue, PSendQueueStats pSendQueueStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSendQueue != NULL && pSendQueueStats != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSendQueue->pWorker->lock);
+    *pSendQueueStats = pSendQueue->stats;
+    pSendQueueStats->queueDepth = pSendQueue->count;
+    MUTEX_UNLOCK(pSendQueue->pWorker->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS createSendFrame(PRtpPacket* ppPackets, UINT32 packetCount, UINT32 rtpTimestamp, PSendFrame* ppSendFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendFrame pSendFrame = NULL;
+    UINT32 i;
+
+    CHK(ppPackets != NULL && ppSendFrame != NULL, STATUS_NULL_ARG);
+
+    pSendFrame = (PSendFrame) MEMCALLOC(1, SIZEOF(SendFrame) + packetCount * SIZEOF(PRtpPacket));
+    CHK(pSendFrame != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    ATOMIC_STORE(&pSendFrame->refCount, 1);
+    pSendFrame->rtpTimestamp = rtpTimestamp;
+    pSendFrame->pPackets = (PRtpPacket*) (pSendFrame + 1);
+
+    for (i = 0; i < packetCount; i++) {
+        CHK_STATUS(rtpPacketAddReference(ppPackets[i]));
+        pSendFrame->pPackets[i] = ppPackets[i];
+        pSendFrame->packetCount++;
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        releaseSendFrame(&pSendFrame);
+    }
+
+    if (ppSendFrame != NULL) {
+        *ppSendFrame = pSendFrame;
+    }
+
+    return retStatus;
+}
+
+STATUS releaseSendFrame(PSendFrame* ppSendFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSendFrame pSendFrame;
+    UINT32 i;
+
+    CHK(ppSendFrame != NULL, STATUS_NULL_ARG);
+    pSendFrame = *ppSendFrame;
+    CHK(pSendFrame != NULL, retStatus);
+    *ppSendFrame = NULL;
+
+    // ATOMIC_DECREMENT returns the count before the decrement
+    CHK(ATOMIC_DECREMENT(&pSendFrame->refCount) == 1, retStatus);
+
+    for (i = 0; i < pSendFrame->packetCount; i++) {
+        freeRtpPacketAndRawPacket(&pSendFrame->pPackets[i]);
+    }
+
+    MEMFREE(pSendFrame);
+
+CleanUp:
+
+    return retStatus;
+}
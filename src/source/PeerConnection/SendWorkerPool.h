@@ -0,0 +1,164 @@
+/*******************************************
+Send worker pool internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SENDWORKERPOOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SENDWORKERPOOL__
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define SEND_WORKER_POOL_DEFAULT_QUEUE_SIZE             8
+#define SEND_WORKER_POOL_DEFAULT_MAX_ENQUEUE_WAIT       (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Number of workers when the number of online cores is not known
+#define SEND_WORKER_POOL_FALLBACK_WORKER_COUNT          4
+
+/*
+ * Serialized packets of a frame shared by the queues it is sent through. Each queued job holds a reference, the
+ * references the frame holds on the packets are dropped with the last one.
+ */
+typedef struct {
+    volatile SIZE_T refCount;
+    UINT32 rtpTimestamp;
+    UINT32 packetCount;
+    // Directly follows the frame
+    PRtpPacket* pPackets;
+} SendFrame, *PSendFrame;
+
+typedef struct {
+    // Transceiver the frame is sent through
+    UINT64 customData;
+    PSendFrame pSendFrame;
+} SendJob, *PSendJob;
+
+typedef struct __SendWorker SendWorker;
+typedef SendWorker* PSendWorker;
+
+typedef struct __SendQueue SendQueue;
+typedef SendQueue* PSendQueue;
+
+/*
+ * Frames a peer connection has waiting for its worker. Everything is guarded by the lock of the worker.
+ */
+struct __SendQueue {
+    PSendWorker pWorker;
+    UINT64 maxEnqueueWait;
+
+    // Ring of queued jobs
+    PSendJob pJobs;
+    UINT32 capacity;
+    UINT32 head;
+    UINT32 count;
+
+    // Set while the queue is in the ready list of the worker or one of its jobs is being sent, so that the jobs of a
+    // peer connection are sent one at a time and in order
+    BOOL scheduled;
+    PSendQueue pNextReady;
+
+    SendQueueStats stats;
+};
+
+/*
+ * Worker thread sending the jobs of the queues assigned to it. Queues with jobs wait in the ready list and get one job
+ * sent per turn so that a busy peer connection does not hold the others back.
+ */
+struct __SendWorker {
+    MUTEX lock;
+    // Signaled when a queue becomes ready or on shutdown
+    CVAR workCvar;
+    // Broadcast whenever a job was taken out of a queue or is done being sent
+    CVAR spaceCvar;
+    TID routine;
+    BOOL terminate;
+
+    PSendQueue pReadyHead;
+    PSendQueue pReadyTail;
+    // Queue whose job is being sent outside of the lock
+    PSendQueue pSendingQueue;
+
+    SendWorkerMetrics metrics;
+};
+
+typedef struct {
+    MUTEX lock;
+    UINT32 queueSize;
+    UINT64 maxEnqueueWait;
+
+    PSendWorker workers[MAX_SEND_WORKER_COUNT];
+    UINT32 workerCount;
+} SendWorkerPool, *PSendWorkerPool;
+
+/**
+ * Stop the workers. Every peer connection assigned to them has to be freed already.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS deinitSendWorkerPool();
+
+/**
+ * Create a queue on the worker with the fewest peer connections
+ *
+ * @param - PSendQueue* - OUT - Queue freed with sendWorkerPoolReleaseQueue, NULL when there is no pool
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendWorkerPoolAcquireQueue(PSendQueue*);
+
+/**
+ * Drop the jobs left in a queue, waiting for the one being sent if any, and free it
+ *
+ * @param - PSendQueue* - IN/OUT - Queue to free, set to NULL
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendWorkerPoolReleaseQueue(PSendQueue*);
+
+/**
+ * Queue a frame to be sent through a transceiver. Waits up to the configured time for room when the queue is full and
+ * drops the frame if there is still none.
+ *
+ * @param - PSendQueue - IN - Queue of the peer connection of the transceiver
+ * @param - UINT64 - IN - Transceiver
+ * @param - PSendFrame - IN - Frame, the queue takes its own reference
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendQueueEnqueue(PSendQueue, UINT64, PSendFrame);
+
+/**
+ * Drop the queued jobs of a transceiver, after waiting for the one being sent if any
+ *
+ * @param - PSendQueue - IN - Queue of the peer connection of the transceiver
+ * @param - UINT64 - IN - Transceiver
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sendQueueDiscard(PSendQueue, UINT64);
+
+STATUS sendQueueGetStats(PSendQueue, PSendQueueStats);
+
+/**
+ * Create a frame holding its own reference on each of the packets
+ *
+ * @param - PRtpPacket* - IN - Pooled serialized packets of the frame
+ * @param - UINT32 - IN - Number of packets
+ * @param - UINT32 - IN - RTP timestamp of the frame
+ * @param - PSendFrame* - OUT - Frame with one reference, released with releaseSendFrame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createSendFrame(PRtpPacket*, UINT32, UINT32, PSendFrame*);
+STATUS releaseSendFrame(PSendFrame*);
+
+STATUS createSendWorker(PSendWorker*);
+STATUS freeSendWorker(PSendWorker*);
+PVOID sendWorkerRoutine(PVOID);
+VOID sendQueueDiscardJobs(PSendQueue, BOOL, UINT64);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif  //__KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SENDWORKERPOOL__
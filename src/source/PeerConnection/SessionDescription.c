@@ -301,6 +301,9 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
     UINT32 attributeCount = 0;
     PRtcMediaStreamTrack pRtcMediaStreamTrack = &(pKvsRtpTransceiver->sender.track);
     PCHAR currentFmtp = NULL;
+    // An answer only has the transport wide sequence number if the offer had it, under the id the offer picked
+    UINT8 twccExtensionId = pKvsPeerConnection->twccExtensionId != 0 ? pKvsPeerConnection->twccExtensionId :
+        (pKvsPeerConnection->isOffer ? TWCC_DEFAULT_EXTENSION_ID : 0);
 
     CHK_STATUS(hashTableGet(pKvsPeerConnection->pCodecTable, pRtcMediaStreamTrack->codec, &payloadType));
 
@@ -427,6 +430,12 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
     STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-rsize");
     attributeCount++;
 
+    if (twccExtensionId != 0) {
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "extmap");
+        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u %s", twccExtensionId, TWCC_EXT_URL);
+        attributeCount++;
+    }
+
     if (pRtcMediaStreamTrack->codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE) {
 
         if(pKvsPeerConnection->isOffer) {
@@ -493,6 +502,24 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
     SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%"PRId64" nack", payloadType);
     attributeCount++;
 
+    // Key frames are asked for when received video can not be decoded
+    if (pRtcMediaStreamTrack->codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE ||
+        pRtcMediaStreamTrack->codec == RTC_CODEC_VP8) {
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
+        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%"PRId64" nack pli", payloadType);
+        attributeCount++;
+
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
+        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%"PRId64" ccm fir", payloadType);
+        attributeCount++;
+    }
+
+    if (twccExtensionId != 0) {
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
+        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%"PRId64" transport-cc", payloadType);
+        attributeCount++;
+    }
+
     pSdpMediaDescription->mediaAttributesCount = attributeCount;
 
 CleanUp:
@@ -807,7 +834,7 @@ CleanUp:
     return retStatus;
 }
 
-STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleList pTransceievers)
+STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PKvsPeerConnection pKvsPeerConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PSdpMediaDescription pMediaDescription = NULL;
@@ -819,6 +846,8 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
     RTC_CODEC codec;
     PCHAR end = NULL;
 
+    CHK(pRemoteSessionDescription != NULL && pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+
     for (currentMedia = 0; currentMedia < pRemoteSessionDescription->mediaCount; currentMedia++) {
         pMediaDescription = &(pRemoteSessionDescription->mediaDescriptions[currentMedia]);
         isVideoMediaSection = (STRNCMP(pMediaDescription->mediaName, MEDIA_SECTION_VIDEO_VALUE, ARRAY_SIZE(MEDIA_SECTION_VIDEO_VALUE) - 1) == 0);
@@ -837,7 +866,7 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
             }
 
             if (foundSsrc) {
-                CHK_STATUS(doubleListGetHeadNode(pTransceievers, &pCurNode));
+                CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceievers, &pCurNode));
                 while (pCurNode != NULL) {
                     CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
                     pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
@@ -849,6 +878,8 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
                     if (pKvsRtpTransceiver->jitterBufferSsrc == 0 && ((isVideoCodec && isVideoMediaSection) || (isAudioCodec && isAudioMediaSection))) {
                         // Finish iteration, we assigned the ssrc move on to next media section
                         pKvsRtpTransceiver->jitterBufferSsrc = ssrc;
+                        CHK_STATUS(hashTableUpsert(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_REMOTE_SSRC_KEY(ssrc),
+                                                   (UINT64) pKvsRtpTransceiver));
                         pCurNode = NULL;
                     } else {
                         pCurNode = pCurNode->pNext;
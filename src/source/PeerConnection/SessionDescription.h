@@ -60,7 +60,7 @@ STATUS setPayloadTypesForOffer(PHashTable);
 STATUS setTransceiverPayloadTypes(PHashTable, PHashTable, PDoubleList);
 STATUS populateSessionDescription(PKvsPeerConnection, PSessionDescription, PSessionDescription);
 STATUS reorderTransceiverByRemoteDescription(PKvsPeerConnection, PSessionDescription);
-STATUS setReceiversSsrc(PSessionDescription, PDoubleList);
+STATUS setReceiversSsrc(PSessionDescription, PKvsPeerConnection);
 PCHAR fmtpForPayloadType(UINT64, PSessionDescription);
 
 #ifdef  __cplusplus
@@ -0,0 +1,489 @@
+#define LOG_CLASS "Twcc"
+
+#include "../Include_i.h"
+
+STATUS createTwccManager(PTwccManager* ppTwccManager)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTwccManager pTwccManager = NULL;
+    UINT32 i;
+
+    CHK(ppTwccManager != NULL, STATUS_NULL_ARG);
+
+    pTwccManager = (PTwccManager) MEMCALLOC(1, SIZEOF(TwccManager));
+    CHK(pTwccManager != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pTwccManager->lock = MUTEX_CREATE(FALSE);
+    for (i = 0; i < TWCC_PACKET_HISTORY_SIZE; i++) {
+        pTwccManager->packetHistory[i].arrivalTime = RTCP_TWCC_PACKET_NOT_RECEIVED;
+    }
+
+    pTwccManager->threshold = TWCC_INITIAL_THRESHOLD;
+    pTwccManager->overuseTime = -1;
+    pTwccManager->usage = TWCC_BANDWIDTH_USAGE_NORMAL;
+    pTwccManager->delayBasedBitrate = TWCC_INITIAL_BITRATE;
+    pTwccManager->lossBasedBitrate = TWCC_INITIAL_BITRATE;
+    pTwccManager->ackedWindowStartTime = RTCP_TWCC_PACKET_NOT_RECEIVED;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (ppTwccManager != NULL) {
+        *ppTwccManager = pTwccManager;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeTwccManager(PTwccManager* ppTwccManager)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppTwccManager != NULL, STATUS_NULL_ARG);
+    CHK(*ppTwccManager != NULL, retStatus);
+
+    if (IS_VALID_MUTEX_VALUE((*ppTwccManager)->lock)) {
+        MUTEX_FREE((*ppTwccManager)->lock);
+    }
+
+    SAFE_MEMFREE(*ppTwccManager);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS twccManagerOnPacketSent(PTwccManager pTwccManager, UINT32 packetSize, UINT64 sendTime, PUINT16 pSequenceNumber)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTwccPacketInfo pPacketInfo = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pTwccManager != NULL && pSequenceNumber != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTwccManager->lock);
+    locked = TRUE;
+
+    *pSequenceNumber = pTwccManager->nextSequenceNumber++;
+
+    // Packets that never got any feedback are simply overwritten
+    pPacketInfo = &pTwccManager->packetHistory[*pSequenceNumber & (TWCC_PACKET_HISTORY_SIZE - 1)];
+    pPacketInfo->sequenceNumber = *pSequenceNumber;
+    pPacketInfo->packetSize = packetSize;
+    pPacketInfo->sendTime = sendTime;
+    pPacketInfo->arrivalTime = RTCP_TWCC_PACKET_NOT_RECEIVED;
+    pPacketInfo->lossReported = FALSE;
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pTwccManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS twccManagerOnFeedback(PTwccManager pTwccManager, PBYTE pPayload, UINT32 payloadLen, UINT64 currentTime, PUINT64 pTargetBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTwccPacketInfo pPacketInfo = NULL;
+    UINT32 packetCount = TWCC_PACKET_HISTORY_SIZE, i;
+    UINT16 baseSequenceNumber = 0, sequenceNumber;
+    UINT8 feedbackCount = 0;
+    UINT64 targetBitrate = 0;
+    BOOL locked = FALSE;
+
+    CHK(pTwccManager != NULL && pPayload != NULL && pTargetBitrate != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTwccManager->lock);
+    locked = TRUE;
+
+    CHK_STATUS(rtcpTwccFeedbackGet(pPayload, payloadLen, &baseSequenceNumber, &feedbackCount, pTwccManager->feedbackArrivalTimes, &packetCount));
+
+    for (i = 0; i < packetCount; i++) {
+        sequenceNumber = (UINT16) (baseSequenceNumber + i);
+        pPacketInfo = &pTwccManager->packetHistory[sequenceNumber & (TWCC_PACKET_HISTORY_SIZE - 1)];
+
+        // Packets reported again by a later feedback, or too old to still be in the history, are only accounted once
+        if (pPacketInfo->sendTime == 0 || pPacketInfo->sequenceNumber != sequenceNumber ||
+            pPacketInfo->arrivalTime != RTCP_TWCC_PACKET_NOT_RECEIVED) {
+            continue;
+        }
+
+        if (pTwccManager->feedbackArrivalTimes[i] == RTCP_TWCC_PACKET_NOT_RECEIVED) {
+            if (!pPacketInfo->lossReported) {
+                pPacketInfo->lossReported = TRUE;
+                pTwccManager->lostPacketCount++;
+                pTwccManager->reportedPacketCount++;
+            }
+        } else {
+            pPacketInfo->arrivalTime = pTwccManager->feedbackArrivalTimes[i];
+            if (!pPacketInfo->lossReported) {
+                pTwccManager->reportedPacketCount++;
+            }
+
+            CHK_STATUS(twccOnPacketArrival(pTwccManager, pPacketInfo));
+        }
+    }
+
+    CHK_STATUS(twccUpdateBitrate(pTwccManager, currentTime));
+
+    if (pTwccManager->lastEstimateTime == 0 || currentTime >= pTwccManager->lastEstimateTime + TWCC_ESTIMATE_INTERVAL) {
+        pTwccManager->lastEstimateTime = currentTime;
+        targetBitrate = MIN(pTwccManager->delayBasedBitrate, pTwccManager->lossBasedBitrate);
+    }
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pTwccManager->lock);
+    }
+
+    if (pTargetBitrate != NULL) {
+        *pTargetBitrate = targetBitrate;
+    }
+
+    return retStatus;
+}
+
+// Feeds the acked bitrate and the delay based estimator with a packet the feedback reported received
+STATUS twccOnPacketArrival(PTwccManager pTwccManager, PTwccPacketInfo pPacketInfo)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    INT64 ackedWindow;
+    DOUBLE delayVariation, sendDelta;
+
+    CHK(pTwccManager != NULL && pPacketInfo != NULL, STATUS_NULL_ARG);
+
+    if (pTwccManager->ackedWindowStartTime == RTCP_TWCC_PACKET_NOT_RECEIVED) {
+        pTwccManager->ackedWindowStartTime = pPacketInfo->arrivalTime;
+    }
+
+    pTwccManager->ackedBytes += pPacketInfo->packetSize;
+    ackedWindow = pPacketInfo->arrivalTime - pTwccManager->ackedWindowStartTime;
+    if (ackedWindow >= TWCC_ACKED_BITRATE_WINDOW) {
+        pTwccManager->ackedBitrate = pTwccManager->ackedBytes * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND / (UINT64) ackedWindow;
+        pTwccManager->ackedBytes = 0;
+        pTwccManager->ackedWindowStartTime = pPacketInfo->arrivalTime;
+    }
+
+    if (!pTwccManager->groupStarted) {
+        pTwccManager->groupStarted = TRUE;
+        pTwccManager->groupFirstSendTime = pPacketInfo->sendTime;
+        pTwccManager->groupSendTime = pPacketInfo->sendTime;
+        pTwccManager->groupArrivalTime = pPacketInfo->arrivalTime;
+        pTwccManager->firstArrivalTime = pPacketInfo->arrivalTime;
+        CHK(FALSE, retStatus);
+    }
+
+    // Packets of a group that was already complete when they arrived tell nothing about the current queuing delay
+    CHK(pPacketInfo->sendTime >= pTwccManager->groupFirstSendTime, retStatus);
+
+    if (pPacketInfo->sendTime - pTwccManager->groupFirstSendTime <= TWCC_BURST_INTERVAL) {
+        pTwccManager->groupSendTime = MAX(pTwccManager->groupSendTime, pPacketInfo->sendTime);
+        pTwccManager->groupArrivalTime = MAX(pTwccManager->groupArrivalTime, pPacketInfo->arrivalTime);
+        CHK(FALSE, retStatus);
+    }
+
+    // The packet starts a new group, so the current one is complete. How much longer it took to arrive than to be sent
+    // after the previous one is the change in queuing delay.
+    if (pTwccManager->previousGroupValid) {
+        sendDelta = (DOUBLE) (pTwccManager->groupSendTime - pTwccManager->previousGroupSendTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        delayVariation = (DOUBLE) (pTwccManager->groupArrivalTime - pTwccManager->previousGroupArrivalTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND -
+            sendDelta;
+        CHK_STATUS(twccTrendlineUpdate(pTwccManager, delayVariation, sendDelta,
+                                       (DOUBLE) (pTwccManager->groupArrivalTime - pTwccManager->firstArrivalTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND));
+    }
+
+    pTwccManager->previousGroupValid = TRUE;
+    pTwccManager->previousGroupSendTime = pTwccManager->groupSendTime;
+    pTwccManager->previousGroupArrivalTime = pTwccManager->groupArrivalTime;
+
+    pTwccManager->groupFirstSendTime = pPacketInfo->sendTime;
+    pTwccManager->groupSendTime = pPacketInfo->sendTime;
+    pTwccManager->groupArrivalTime = pPacketInfo->arrivalTime;
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Slope of the least squares fit of the smoothed accumulated delay variation over the arrival time of the last groups
+STATUS twccTrendlineUpdate(PTwccManager pTwccManager, DOUBLE delayVariation, DOUBLE sendDelta, DOUBLE arrivalTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, index;
+    DOUBLE meanArrivalTime = 0, meanDelay = 0, numerator = 0, denominator = 0;
+
+    CHK(pTwccManager != NULL, STATUS_NULL_ARG);
+
+    pTwccManager->deltaCount = MIN(pTwccManager->deltaCount + 1, TWCC_TRENDLINE_MAX_DELTA_COUNT);
+    pTwccManager->accumulatedDelay += delayVariation;
+    pTwccManager->smoothedDelay = TWCC_TRENDLINE_SMOOTHING_COEFFICIENT * pTwccManager->smoothedDelay +
+        (1 - TWCC_TRENDLINE_SMOOTHING_COEFFICIENT) * pTwccManager->accumulatedDelay;
+
+    index = pTwccManager->trendlineSampleCount % TWCC_TRENDLINE_WINDOW_SIZE;
+    pTwccManager->trendlineArrivalTimes[index] = arrivalTime;
+    pTwccManager->trendlineDelays[index] = pTwccManager->smoothedDelay;
+    pTwccManager->trendlineSampleCount++;
+
+    if (pTwccManager->trendlineSampleCount >= TWCC_TRENDLINE_WINDOW_SIZE) {
+        for (i = 0; i < TWCC_TRENDLINE_WINDOW_SIZE; i++) {
+            meanArrivalTime += pTwccManager->trendlineArrivalTimes[i];
+            meanDelay += pTwccManager->trendlineDelays[i];
+        }
+
+        meanArrivalTime /= TWCC_TRENDLINE_WINDOW_SIZE;
+        meanDelay /= TWCC_TRENDLINE_WINDOW_SIZE;
+
+        for (i = 0; i < TWCC_TRENDLINE_WINDOW_SIZE; i++) {
+            numerator += (pTwccManager->trendlineArrivalTimes[i] - meanArrivalTime) * (pTwccManager->trendlineDelays[i] - meanDelay);
+            denominator += (pTwccManager->trendlineArrivalTimes[i] - meanArrivalTime) * (pTwccManager->trendlineArrivalTimes[i] - meanArrivalTime);
+        }
+
+        // All the groups arriving at once leaves the trend as it was
+        if (denominator != 0) {
+            pTwccManager->trend = numerator / denominator;
+        }
+    }
+
+    CHK_STATUS(twccDetectOveruse(pTwccManager, sendDelta, arrivalTime));
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Compares the trend, scaled by the number of samples it is based on, to a threshold that adapts to it
+STATUS twccDetectOveruse(PTwccManager pTwccManager, DOUBLE sendDelta, DOUBLE arrivalTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    DOUBLE modifiedTrend, absoluteTrend, timeDelta;
+
+    CHK(pTwccManager != NULL, STATUS_NULL_ARG);
+
+    modifiedTrend = pTwccManager->deltaCount * pTwccManager->trend * TWCC_TRENDLINE_THRESHOLD_GAIN;
+    absoluteTrend = modifiedTrend < 0 ? -modifiedTrend : modifiedTrend;
+
+    if (modifiedTrend > pTwccManager->threshold) {
+        if (pTwccManager->overuseTime < 0) {
+            // Only half of the first interval is counted as the trend crossed the threshold somewhere in it
+            pTwccManager->overuseTime = sendDelta / 2;
+        } else {
+            pTwccManager->overuseTime += sendDelta;
+        }
+
+        pTwccManager->overuseCount++;
+        if (pTwccManager->overuseTime > TWCC_OVERUSE_TIME_THRESHOLD_MS && pTwccManager->overuseCount > 1 &&
+            pTwccManager->trend >= pTwccManager->previousTrend) {
+            pTwccManager->overuseTime = 0;
+            pTwccManager->overuseCount = 0;
+            pTwccManager->usage = TWCC_BANDWIDTH_USAGE_OVERUSING;
+        }
+    } else if (modifiedTrend < -pTwccManager->threshold) {
+        pTwccManager->overuseTime = -1;
+        pTwccManager->overuseCount = 0;
+        pTwccManager->usage = TWCC_BANDWIDTH_USAGE_UNDERUSING;
+    } else {
+        pTwccManager->overuseTime = -1;
+        pTwccManager->overuseCount = 0;
+        pTwccManager->usage = TWCC_BANDWIDTH_USAGE_NORMAL;
+    }
+
+    pTwccManager->previousTrend = pTwccManager->trend;
+
+    // Without adapting, a threshold above the delay variation a competing TCP flow causes would starve this stream
+    if (absoluteTrend <= pTwccManager->threshold + TWCC_THRESHOLD_MAX_ADAPT_DISTANCE) {
+        timeDelta = MIN(arrivalTime - pTwccManager->lastThresholdUpdateTime, TWCC_THRESHOLD_MAX_TIME_DELTA_MS);
+        pTwccManager->threshold += (absoluteTrend < pTwccManager->threshold ? TWCC_THRESHOLD_DOWN_GAIN : TWCC_THRESHOLD_UP_GAIN) *
+            (absoluteTrend - pTwccManager->threshold) * timeDelta;
+        pTwccManager->threshold = MIN(MAX(pTwccManager->threshold, TWCC_MIN_THRESHOLD), TWCC_MAX_THRESHOLD);
+    }
+
+    pTwccManager->lastThresholdUpdateTime = arrivalTime;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS twccUpdateBitrate(PTwccManager pTwccManager, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 elapsed, targetBitrate, maxBitrate;
+    DOUBLE lossFraction;
+
+    CHK(pTwccManager != NULL, STATUS_NULL_ARG);
+
+    elapsed = pTwccManager->lastRateUpdateTime == 0 ? 0 : MIN(currentTime - pTwccManager->lastRateUpdateTime, HUNDREDS_OF_NANOS_IN_A_SECOND);
+    pTwccManager->lastRateUpdateTime = currentTime;
+
+    switch (pTwccManager->usage) {
+        case TWCC_BANDWIDTH_USAGE_OVERUSING:
+            // Back off below what actually got through so that the queue drains, once per decrease interval
+            if (pTwccManager->lastDecreaseTime == 0 || currentTime >= pTwccManager->lastDecreaseTime + TWCC_DECREASE_INTERVAL) {
+                targetBitrate = (UINT64) (TWCC_DECREASE_FACTOR *
+                                          (pTwccManager->ackedBitrate != 0 ? pTwccManager->ackedBitrate : pTwccManager->delayBasedBitrate));
+                pTwccManager->delayBasedBitrate = MIN(pTwccManager->delayBasedBitrate, targetBitrate);
+                pTwccManager->lastDecreaseTime = currentTime;
+            }
+            break;
+
+        case TWCC_BANDWIDTH_USAGE_UNDERUSING:
+            // Queues are draining, hold until the delay settles so that the drain is not mistaken for spare capacity
+            break;
+
+        default:
+            pTwccManager->delayBasedBitrate += (UINT64) (pTwccManager->delayBasedBitrate * TWCC_INCREASE_FACTOR_PER_SECOND * elapsed /
+                                                         HUNDREDS_OF_NANOS_IN_A_SECOND);
+            // There is no telling whether the path can carry much more than what is being sent
+            if (pTwccManager->ackedBitrate != 0) {
+                maxBitrate = (UINT64) (TWCC_ACKED_BITRATE_HEADROOM_FACTOR * pTwccManager->ackedBitrate) + TWCC_ACKED_BITRATE_HEADROOM;
+                pTwccManager->delayBasedBitrate = MIN(pTwccManager->delayBasedBitrate, maxBitrate);
+            }
+            break;
+    }
+
+    pTwccManager->delayBasedBitrate = MIN(MAX(pTwccManager->delayBasedBitrate, TWCC_MIN_BITRATE), TWCC_MAX_BITRATE);
+
+    // The loss based estimate moves from the current target so that it stays meaningful while the delay limits the rate
+    if (pTwccManager->reportedPacketCount >= TWCC_LOSS_MIN_PACKET_COUNT) {
+        lossFraction = (DOUBLE) pTwccManager->lostPacketCount / pTwccManager->reportedPacketCount;
+        targetBitrate = MIN(pTwccManager->delayBasedBitrate, pTwccManager->lossBasedBitrate);
+
+        if (lossFraction > TWCC_LOSS_HIGH_FRACTION) {
+            if (pTwccManager->lastLossDecreaseTime == 0 || currentTime >= pTwccManager->lastLossDecreaseTime + TWCC_DECREASE_INTERVAL) {
+                pTwccManager->lossBasedBitrate = (UINT64) (targetBitrate * (1 - 0.5 * lossFraction));
+                pTwccManager->lastLossDecreaseTime = currentTime;
+            }
+        } else if (lossFraction < TWCC_LOSS_LOW_FRACTION) {
+            if (pTwccManager->lastLossIncreaseTime == 0 || currentTime >= pTwccManager->lastLossIncreaseTime + TWCC_LOSS_INCREASE_INTERVAL) {
+                pTwccManager->lossBasedBitrate = (UINT64) (targetBitrate * TWCC_LOSS_INCREASE_FACTOR);
+                pTwccManager->lastLossIncreaseTime = currentTime;
+            }
+        }
+
+        pTwccManager->reportedPacketCount = 0;
+        pTwccManager->lostPacketCount = 0;
+    }
+
+    pTwccManager->lossBasedBitrate = MIN(MAX(pTwccManager->lossBasedBitrate, TWCC_MIN_BITRATE), TWCC_MAX_BITRATE);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS twccManagerOnPacketReceived(PTwccManager pTwccManager, UINT16 sequenceNumber, UINT64 arrivalTime, UINT32 senderSsrc, UINT32 mediaSsrc,
+                                   PBYTE pFeedback, PUINT32 pFeedbackLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 offset = 0;
+    UINT32 feedbackLen = 0, i;
+    BOOL locked = FALSE;
+
+    CHK(pTwccManager != NULL && pFeedback != NULL && pFeedbackLen != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTwccManager->lock);
+    locked = TRUE;
+
+    if (pTwccManager->feedbackPending) {
+        offset = (UINT16) (sequenceNumber - pTwccManager->feedbackBaseSequenceNumber);
+
+        // Report what is waiting right away when the packet is too far ahead to fit in the same feedback, otherwise it
+        // is due TWCC_FEEDBACK_INTERVAL after it started, see twccManagerFlushFeedback
+        if (offset >= TWCC_FEEDBACK_MAX_PACKET_COUNT && offset < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET) {
+            feedbackLen = *pFeedbackLen;
+            CHK_STATUS(twccManagerCreateFeedback(pTwccManager, pFeedback, &feedbackLen));
+            offset = (UINT16) (sequenceNumber - pTwccManager->feedbackBaseSequenceNumber);
+        }
+
+        // Packets older than the ones waiting were reported lost already
+        CHK(offset < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET, retStatus);
+    }
+
+    if (!pTwccManager->feedbackPending) {
+        // Sequence numbers skipped since the last feedback are still reported lost, as long as they fit, and packets older
+        // than it were reported lost in it. The offset is computed again as the feedback may just have been serialized.
+        offset = (UINT16) (sequenceNumber - pTwccManager->feedbackBaseSequenceNumber);
+        CHK(pTwccManager->feedbackCount == 0 || offset < JITTER_BUFFER_MAX_SEQUENCE_NUMBER_OFFSET, retStatus);
+        if (pTwccManager->feedbackCount == 0 || offset >= TWCC_FEEDBACK_MAX_PACKET_COUNT) {
+            pTwccManager->feedbackBaseSequenceNumber = sequenceNumber;
+            offset = 0;
+        }
+
+        for (i = 0; i < TWCC_FEEDBACK_MAX_PACKET_COUNT; i++) {
+            pTwccManager->arrivalTimes[i] = RTCP_TWCC_PACKET_NOT_RECEIVED;
+        }
+
+        pTwccManager->feedbackPending = TRUE;
+        pTwccManager->feedbackPacketCount = 0;
+        pTwccManager->feedbackStartTime = arrivalTime;
+    }
+
+    pTwccManager->arrivalTimes[offset] = (INT64) arrivalTime;
+    pTwccManager->feedbackPacketCount = MAX(pTwccManager->feedbackPacketCount, (UINT32) offset + 1);
+    pTwccManager->feedbackSenderSsrc = senderSsrc;
+    pTwccManager->feedbackMediaSsrc = mediaSsrc;
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pTwccManager->lock);
+    }
+
+    if (pFeedbackLen != NULL) {
+        *pFeedbackLen = feedbackLen;
+    }
+
+    return retStatus;
+}
+
+STATUS twccManagerFlushFeedback(PTwccManager pTwccManager, UINT64 currentTime, PBYTE pFeedback, PUINT32 pFeedbackLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 feedbackLen = 0;
+    BOOL locked = FALSE;
+
+    CHK(pTwccManager != NULL && pFeedback != NULL && pFeedbackLen != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTwccManager->lock);
+    locked = TRUE;
+
+    CHK(pTwccManager->feedbackPending && currentTime >= pTwccManager->feedbackStartTime + TWCC_FEEDBACK_INTERVAL, retStatus);
+
+    feedbackLen = *pFeedbackLen;
+    CHK_STATUS(twccManagerCreateFeedback(pTwccManager, pFeedback, &feedbackLen));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pTwccManager->lock);
+    }
+
+    if (pFeedbackLen != NULL) {
+        *pFeedbackLen = feedbackLen;
+    }
+
+    return retStatus;
+}
+
+// Serializes the pending feedback and starts the next one after it. Caller holds the lock
+STATUS twccManagerCreateFeedback(PTwccManager pTwccManager, PBYTE pFeedback, PUINT32 pFeedbackLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pTwccManager != NULL && pFeedback != NULL && pFeedbackLen != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(createRtcpTwccPacket(pTwccManager->feedbackSenderSsrc, pTwccManager->feedbackMediaSsrc, pTwccManager->feedbackBaseSequenceNumber,
+                                    pTwccManager->feedbackCount, pTwccManager->arrivalTimes, (UINT16) pTwccManager->feedbackPacketCount,
+                                    pFeedback, pFeedbackLen));
+    pTwccManager->feedbackCount++;
+    pTwccManager->feedbackBaseSequenceNumber += (UINT16) pTwccManager->feedbackPacketCount;
+    pTwccManager->feedbackPending = FALSE;
+
+CleanUp:
+
+    return retStatus;
+}
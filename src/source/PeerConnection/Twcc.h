@@ -0,0 +1,249 @@
+/*******************************************
+Transport wide congestion control internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT__TWCC_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT__TWCC_H
+
+#pragma once
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+// https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
+#define TWCC_EXT_URL (PCHAR) "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"
+
+// Header extension id offered for the transport wide sequence number, an answer to a remote offer uses the remote id
+#define TWCC_DEFAULT_EXTENSION_ID 1
+// Highest id a one byte header extension element can have
+#define TWCC_MAX_EXTENSION_ID 14
+// A one byte header element of the 16 bit sequence number, padded to a word
+#define TWCC_HEADER_EXTENSION_LENGTH 4
+#define TWCC_HEADER_EXTENSION_OVERHEAD (RTP_HEADER_EXTENSION_HEADER_LENGTH + TWCC_HEADER_EXTENSION_LENGTH)
+
+// Sent packets remembered until their feedback arrives, a power of 2
+#define TWCC_PACKET_HISTORY_SIZE 2048
+
+// Received packets are reported every interval, or as soon as this many sequence numbers are waiting to be reported
+#define TWCC_FEEDBACK_INTERVAL (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define TWCC_FEEDBACK_MAX_PACKET_COUNT 256
+// Every chunk covers at least a full status vector and every delta takes at most 2 bytes
+#define TWCC_FEEDBACK_MAX_PACKET_LEN (RTCP_PACKET_HEADER_LEN + RTCP_TWCC_FEEDBACK_HEADER_LEN + \
+    (TWCC_FEEDBACK_MAX_PACKET_COUNT / RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT + 1) * RTCP_TWCC_PACKET_CHUNK_LEN + \
+    TWCC_FEEDBACK_MAX_PACKET_COUNT * SIZEOF(INT16) + RTCP_PACKET_LEN_WORD_SIZE)
+
+// Encoders are handed a new target bitrate at most this often
+#define TWCC_ESTIMATE_INTERVAL (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Packets sent within this interval of the first packet of a group are a burst the delay is measured over as a whole
+#define TWCC_BURST_INTERVAL (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Trendline filter of the queuing delay, the slope of the smoothed accumulated delay over the last window of groups
+#define TWCC_TRENDLINE_WINDOW_SIZE 20
+#define TWCC_TRENDLINE_SMOOTHING_COEFFICIENT 0.9
+#define TWCC_TRENDLINE_THRESHOLD_GAIN 4.0
+#define TWCC_TRENDLINE_MAX_DELTA_COUNT 60
+
+// Adaptive overuse threshold in ms, it moves towards the trend faster when the trend is below it
+#define TWCC_INITIAL_THRESHOLD 12.5
+#define TWCC_MIN_THRESHOLD 6.0
+#define TWCC_MAX_THRESHOLD 600.0
+#define TWCC_THRESHOLD_UP_GAIN 0.0087
+#define TWCC_THRESHOLD_DOWN_GAIN 0.039
+// Trends further above the threshold than this are spikes the threshold does not adapt to
+#define TWCC_THRESHOLD_MAX_ADAPT_DISTANCE 15.0
+#define TWCC_THRESHOLD_MAX_TIME_DELTA_MS 100.0
+// Overuse is only signaled once the trend stayed above the threshold for this long
+#define TWCC_OVERUSE_TIME_THRESHOLD_MS 10.0
+
+// Bitrates in bits per second
+#define TWCC_INITIAL_BITRATE 300000
+#define TWCC_MIN_BITRATE 30000
+#define TWCC_MAX_BITRATE 20000000
+
+// Multiplicative increase per second while the delay is stable, decrease on overuse relative to the acked bitrate
+#define TWCC_INCREASE_FACTOR_PER_SECOND 0.08
+#define TWCC_DECREASE_FACTOR 0.85
+#define TWCC_DECREASE_INTERVAL (300 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+// Headroom over the acked bitrate the delay based estimate may grow to
+#define TWCC_ACKED_BITRATE_HEADROOM_FACTOR 1.5
+#define TWCC_ACKED_BITRATE_HEADROOM 10000
+#define TWCC_ACKED_BITRATE_WINDOW (500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Loss based estimate, backs off by half the loss fraction above the high mark and grows slowly below the low one
+#define TWCC_LOSS_HIGH_FRACTION 0.1
+#define TWCC_LOSS_LOW_FRACTION 0.02
+#define TWCC_LOSS_INCREASE_FACTOR 1.05
+#define TWCC_LOSS_INCREASE_INTERVAL (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define TWCC_LOSS_MIN_PACKET_COUNT 20
+
+typedef enum {
+    TWCC_BANDWIDTH_USAGE_NORMAL,
+    TWCC_BANDWIDTH_USAGE_OVERUSING,
+    TWCC_BANDWIDTH_USAGE_UNDERUSING,
+} TWCC_BANDWIDTH_USAGE;
+
+/*
+ * A sent packet, slot sequenceNumber & (TWCC_PACKET_HISTORY_SIZE - 1) of the history
+ */
+typedef struct {
+    UINT16 sequenceNumber;
+    UINT32 packetSize;
+    // Local time the packet was sent, 0 for a slot that was never used
+    UINT64 sendTime;
+    // Arrival time in the clock of the receiver, RTCP_TWCC_PACKET_NOT_RECEIVED until a feedback reports it received
+    INT64 arrivalTime;
+    BOOL lossReported;
+} TwccPacketInfo, *PTwccPacketInfo;
+
+/*
+ * Both ends of transport wide congestion control of a peer connection. The sender stamps every packet with a transport
+ * wide sequence number and remembers when it went out, the receiver reports when each of them arrived and the sender
+ * estimates the available bandwidth from the change in queuing delay (delay based, like Google congestion control) and
+ * from the loss (loss based). The lower of the two is the target bitrate. Thread safe.
+ */
+typedef struct {
+    MUTEX lock;
+
+    // Sender side
+    UINT16 nextSequenceNumber;
+    TwccPacketInfo packetHistory[TWCC_PACKET_HISTORY_SIZE];
+    // Scratch space for the packets of a received feedback
+    INT64 feedbackArrivalTimes[TWCC_PACKET_HISTORY_SIZE];
+
+    // Delay based estimator, the group being filled and the last complete one
+    BOOL groupStarted;
+    UINT64 groupFirstSendTime;
+    UINT64 groupSendTime;
+    INT64 groupArrivalTime;
+    BOOL previousGroupValid;
+    UINT64 previousGroupSendTime;
+    INT64 previousGroupArrivalTime;
+    INT64 firstArrivalTime;
+
+    // Trendline filter state, times and delays in ms
+    UINT32 deltaCount;
+    DOUBLE accumulatedDelay;
+    DOUBLE smoothedDelay;
+    DOUBLE trendlineArrivalTimes[TWCC_TRENDLINE_WINDOW_SIZE];
+    DOUBLE trendlineDelays[TWCC_TRENDLINE_WINDOW_SIZE];
+    UINT32 trendlineSampleCount;
+    DOUBLE trend;
+
+    // Overuse detector state
+    DOUBLE threshold;
+    DOUBLE lastThresholdUpdateTime;
+    DOUBLE overuseTime;
+    UINT32 overuseCount;
+    DOUBLE previousTrend;
+    TWCC_BANDWIDTH_USAGE usage;
+
+    // Rate control
+    UINT64 delayBasedBitrate;
+    UINT64 lossBasedBitrate;
+    UINT64 ackedBitrate;
+    UINT64 ackedBytes;
+    INT64 ackedWindowStartTime;
+    UINT32 reportedPacketCount;
+    UINT32 lostPacketCount;
+    UINT64 lastRateUpdateTime;
+    UINT64 lastDecreaseTime;
+    UINT64 lastLossDecreaseTime;
+    UINT64 lastLossIncreaseTime;
+    UINT64 lastEstimateTime;
+
+    // Receiver side, arrival times of the range of sequence numbers the next feedback reports
+    BOOL feedbackPending;
+    UINT16 feedbackBaseSequenceNumber;
+    UINT32 feedbackPacketCount;
+    UINT64 feedbackStartTime;
+    UINT8 feedbackCount;
+    // Ssrcs the next feedback is sent from and about, those given with the last packet recorded
+    UINT32 feedbackSenderSsrc;
+    UINT32 feedbackMediaSsrc;
+    INT64 arrivalTimes[TWCC_FEEDBACK_MAX_PACKET_COUNT];
+} TwccManager, *PTwccManager;
+
+/**
+ * Create the transport wide congestion control state of a peer connection
+ *
+ * @param - PTwccManager* - OUT - Created manager
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createTwccManager(PTwccManager*);
+
+/**
+ * Free the transport wide congestion control state
+ *
+ * @param - PTwccManager* - IN/OUT - Manager to free
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeTwccManager(PTwccManager*);
+
+/**
+ * Assign the transport wide sequence number of a packet that is about to be sent and remember it until its feedback
+ *
+ * @param - PTwccManager - IN - Manager
+ * @param - UINT32 - IN - Size of the packet
+ * @param - UINT64 - IN - Current time
+ * @param - PUINT16 - OUT - Transport wide sequence number to stamp the packet with
+ *
+ * @return - STATUS status of execution
+ */
+STATUS twccManagerOnPacketSent(PTwccManager, UINT32, UINT64, PUINT16);
+
+/**
+ * Update the bandwidth estimate from a received feedback
+ *
+ * @param - PTwccManager - IN - Manager
+ * @param - PBYTE - IN - Feedback payload
+ * @param - UINT32 - IN - Payload length
+ * @param - UINT64 - IN - Current time
+ * @param - PUINT64 - OUT - Target bitrate in bits per second, 0 if the last one is less than TWCC_ESTIMATE_INTERVAL old
+ *
+ * @return - STATUS status of execution
+ */
+STATUS twccManagerOnFeedback(PTwccManager, PBYTE, UINT32, UINT64, PUINT64);
+
+/**
+ * Record the arrival of a received packet. Feedback waiting to be sent is only serialized here when the packet is too far
+ * ahead to be reported in it, it is otherwise sent once due by twccManagerFlushFeedback.
+ *
+ * @param - PTwccManager - IN - Manager
+ * @param - UINT16 - IN - Transport wide sequence number of the packet
+ * @param - UINT64 - IN - Arrival time of the packet
+ * @param - UINT32 - IN - Ssrc of the sender of the feedback
+ * @param - UINT32 - IN - Ssrc the packet was received from
+ * @param - PBYTE - OUT - Feedback, TWCC_FEEDBACK_MAX_PACKET_LEN bytes fit any of them
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the feedback or to 0 if none is due
+ *
+ * @return - STATUS status of execution
+ */
+STATUS twccManagerOnPacketReceived(PTwccManager, UINT16, UINT64, UINT32, UINT32, PBYTE, PUINT32);
+
+/**
+ * Serialize the feedback waiting to be sent if it is TWCC_FEEDBACK_INTERVAL old, so that the last packets are reported
+ * even when no packet comes in after them
+ *
+ * @param - PTwccManager - IN - Manager
+ * @param - UINT64 - IN - Current time
+ * @param - PBYTE - OUT - Feedback, TWCC_FEEDBACK_MAX_PACKET_LEN bytes fit any of them
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the feedback or to 0 if none is due
+ *
+ * @return - STATUS status of execution
+ */
+STATUS twccManagerFlushFeedback(PTwccManager, UINT64, PBYTE, PUINT32);
+
+STATUS twccManagerCreateFeedback(PTwccManager, PBYTE, PUINT32);
+
+STATUS twccOnPacketArrival(PTwccManager, PTwccPacketInfo);
+STATUS twccTrendlineUpdate(PTwccManager, DOUBLE, DOUBLE, DOUBLE);
+STATUS twccDetectOveruse(PTwccManager, DOUBLE, DOUBLE);
+STATUS twccUpdateBitrate(PTwccManager, UINT64);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT__TWCC_H
@@ -16,7 +16,8 @@ STATUS createRollingBuffer(UINT32 capacity, FreeDataFunc freeDataFunc, PRollingB
     pRollingBuffer->headIndex = 0;
     pRollingBuffer->tailIndex = 0;
     pRollingBuffer->freeDataFn = freeDataFunc;
-    pRollingBuffer->lock = MUTEX_CREATE(FALSE);
+    // Recursive so that a user of the buffer can hold it across several calls, see rtpRollingBufferAddRtpPacket
+    pRollingBuffer->lock = MUTEX_CREATE(TRUE);
     pRollingBuffer->dataBuffer = (PUINT64) (pRollingBuffer + 1);
     MEMSET(pRollingBuffer->dataBuffer, 0, SIZEOF(UINT64) * pRollingBuffer->capacity);
 
@@ -80,6 +80,551 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createRtcpNackPacket(UINT32 senderSsrc, UINT32 mediaSsrc, PUINT16 pSequenceNumberList, UINT32 sequenceNumberListLen,
+                            PBYTE pPacket, PUINT32 pPacketLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetLen = RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN, bufferLen = 0, i;
+    UINT16 packetId = 0, bitmask = 0, distance;
+
+    CHK(pSequenceNumberList != NULL && pPacketLen != NULL, STATUS_NULL_ARG);
+    CHK(sequenceNumberListLen > 0, STATUS_INVALID_ARG);
+
+    if (pPacket != NULL) {
+        bufferLen = *pPacketLen;
+    }
+
+    for (i = 0; i < sequenceNumberListLen; i++) {
+        distance = (UINT16) (pSequenceNumberList[i] - packetId);
+        if (i == 0 || distance > RTCP_NACK_BITMASK_LEN) {
+            packetId = pSequenceNumberList[i];
+            bitmask = 0;
+            packetLen += RTCP_NACK_ENTRY_LEN;
+        } else if (distance > 0) {
+            bitmask |= (UINT16) (1 << (distance - 1));
+        }
+
+        // The current entry is rewritten as its bitmask fills up, entries past the end of the buffer are only counted
+        if (packetLen <= bufferLen) {
+            putUnalignedInt16BigEndian(pPacket + packetLen - RTCP_NACK_ENTRY_LEN, packetId);
+            putUnalignedInt16BigEndian(pPacket + packetLen - RTCP_NACK_ENTRY_LEN + SIZEOF(UINT16), bitmask);
+        }
+    }
+
+    // Check if we are trying to calculate the required size only
+    CHK(pPacket != NULL, retStatus);
+    CHK(packetLen <= bufferLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_FEEDBACK_MESSAGE_TYPE_NACK;
+    pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK;
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, packetLen / RTCP_PACKET_LEN_WORD_SIZE - 1);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32), mediaSsrc);
+
+CleanUp:
+    if (pPacketLen != NULL) {
+        *pPacketLen = packetLen;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createRtcpPliPacket(UINT32 senderSsrc, UINT32 mediaSsrc, PBYTE pPacket, PUINT32 pPacketLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetLen = RTCP_PLI_PACKET_LEN;
+
+    CHK(pPacketLen != NULL, STATUS_NULL_ARG);
+
+    // Check if we are trying to calculate the required size only
+    CHK(pPacket != NULL, retStatus);
+    CHK(packetLen <= *pPacketLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_PSFB_PLI;
+    pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK;
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, packetLen / RTCP_PACKET_LEN_WORD_SIZE - 1);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32), mediaSsrc);
+
+CleanUp:
+    if (pPacketLen != NULL) {
+        *pPacketLen = packetLen;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createRtcpFirPacket(UINT32 senderSsrc, UINT32 mediaSsrc, UINT8 commandSequenceNumber, PBYTE pPacket, PUINT32 pPacketLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetLen = RTCP_FIR_PACKET_LEN;
+
+    CHK(pPacketLen != NULL, STATUS_NULL_ARG);
+
+    // Check if we are trying to calculate the required size only
+    CHK(pPacket != NULL, retStatus);
+    CHK(packetLen <= *pPacketLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_PSFB_FIR;
+    pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK;
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, packetLen / RTCP_PACKET_LEN_WORD_SIZE - 1);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+
+    // The media source ssrc of the common header is unused, the ssrc is carried by the FCI entry instead
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32), 0);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PLI_PACKET_LEN, mediaSsrc);
+    MEMSET(pPacket + RTCP_PLI_PACKET_LEN + SIZEOF(UINT32), 0x00, RTCP_FIR_ENTRY_LEN - SIZEOF(UINT32));
+    pPacket[RTCP_PLI_PACKET_LEN + SIZEOF(UINT32)] = commandSequenceNumber;
+
+CleanUp:
+    if (pPacketLen != NULL) {
+        *pPacketLen = packetLen;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createRtcpReportPacket(UINT32 ssrc, PRtcpSenderInfo pSenderInfo, PRtcpReportBlock pReportBlocks, UINT32 reportBlockCount,
+                              PBYTE pPacket, PUINT32 pPacketLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetLen = 0, offset, i;
+    PRtcpReportBlock pReportBlock;
+
+    CHK(pPacketLen != NULL && (pReportBlocks != NULL || reportBlockCount == 0), STATUS_NULL_ARG);
+    CHK(reportBlockCount <= RTCP_MAX_REPORT_BLOCK_COUNT, STATUS_INVALID_ARG);
+
+    packetLen = RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + (pSenderInfo != NULL ? RTCP_SENDER_INFO_LEN : 0) +
+        reportBlockCount * RTCP_REPORT_BLOCK_LEN;
+
+    // Check if we are trying to calculate the required size only
+    CHK(pPacket != NULL, retStatus);
+    CHK(packetLen <= *pPacketLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | (BYTE) reportBlockCount;
+    pPacket[RTCP_PACKET_TYPE_OFFSET] = pSenderInfo != NULL ? RTCP_PACKET_TYPE_SENDER_REPORT : RTCP_PACKET_TYPE_RECEIVER_REPORT;
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, packetLen / RTCP_PACKET_LEN_WORD_SIZE - 1);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, ssrc);
+    offset = RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32);
+
+    if (pSenderInfo != NULL) {
+        putUnalignedInt64BigEndian(pPacket + offset, pSenderInfo->ntpTimestamp);
+        putUnalignedInt32BigEndian(pPacket + offset + 8, pSenderInfo->rtpTimestamp);
+        putUnalignedInt32BigEndian(pPacket + offset + 12, pSenderInfo->packetCount);
+        putUnalignedInt32BigEndian(pPacket + offset + 16, pSenderInfo->octetCount);
+        offset += RTCP_SENDER_INFO_LEN;
+    }
+
+    for (i = 0; i < reportBlockCount; i++, offset += RTCP_REPORT_BLOCK_LEN) {
+        pReportBlock = pReportBlocks + i;
+        putUnalignedInt32BigEndian(pPacket + offset, pReportBlock->ssrc);
+        // The cumulative number of packets lost is a 24 bit signed value sharing its word with the fraction lost
+        putUnalignedInt32BigEndian(pPacket + offset + 4, ((UINT32) pReportBlock->fractionLost << 24) | ((UINT32) pReportBlock->cumulativeLost & 0x00FFFFFF));
+        putUnalignedInt32BigEndian(pPacket + offset + 8, pReportBlock->extendedHighestSequenceNumber);
+        putUnalignedInt32BigEndian(pPacket + offset + 12, pReportBlock->jitter);
+        putUnalignedInt32BigEndian(pPacket + offset + 16, pReportBlock->lastSenderReport);
+        putUnalignedInt32BigEndian(pPacket + offset + 20, pReportBlock->delaySinceLastSenderReport);
+    }
+
+CleanUp:
+    if (pPacketLen != NULL) {
+        *pPacketLen = packetLen;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtcpSenderReportGet(PBYTE pPayload, UINT32 payloadLen, PUINT32 pSenderSsrc, PRtcpSenderInfo pSenderInfo)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPayload != NULL && pSenderSsrc != NULL && pSenderInfo != NULL, STATUS_NULL_ARG);
+    CHK(payloadLen >= SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+
+    *pSenderSsrc = (UINT32) getUnalignedInt32BigEndian(pPayload);
+    pSenderInfo->ntpTimestamp = (UINT64) getUnalignedInt64BigEndian(pPayload + 4);
+    pSenderInfo->rtpTimestamp = (UINT32) getUnalignedInt32BigEndian(pPayload + 12);
+    pSenderInfo->packetCount = (UINT32) getUnalignedInt32BigEndian(pPayload + 16);
+    pSenderInfo->octetCount = (UINT32) getUnalignedInt32BigEndian(pPayload + 20);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtcpReportBlockGet(PBYTE pPayload, UINT32 payloadLen, PRtcpReportBlock pReportBlock)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 lossWord;
+
+    CHK(pPayload != NULL && pReportBlock != NULL, STATUS_NULL_ARG);
+    CHK(payloadLen >= RTCP_REPORT_BLOCK_LEN, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+
+    pReportBlock->ssrc = (UINT32) getUnalignedInt32BigEndian(pPayload);
+    lossWord = (UINT32) getUnalignedInt32BigEndian(pPayload + 4);
+    pReportBlock->fractionLost = (UINT8) (lossWord >> 24);
+    // Sign extend the 24 bit cumulative number of packets lost
+    pReportBlock->cumulativeLost = ((INT32) (lossWord << 8)) >> 8;
+    pReportBlock->extendedHighestSequenceNumber = (UINT32) getUnalignedInt32BigEndian(pPayload + 8);
+    pReportBlock->jitter = (UINT32) getUnalignedInt32BigEndian(pPayload + 12);
+    pReportBlock->lastSenderReport = (UINT32) getUnalignedInt32BigEndian(pPayload + 16);
+    pReportBlock->delaySinceLastSenderReport = (UINT32) getUnalignedInt32BigEndian(pPayload + 20);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtcpReceptionStatsUpdate(PRtcpReceptionStats pReceptionStats, UINT16 sequenceNumber)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 highestSequenceNumber, delta;
+    UINT32 cycles;
+    BOOL restart = FALSE;
+
+    CHK(pReceptionStats != NULL, STATUS_NULL_ARG);
+
+    if (pReceptionStats->started) {
+        highestSequenceNumber = (UINT16) pReceptionStats->extendedHighestSequenceNumber;
+        cycles = pReceptionStats->extendedHighestSequenceNumber & 0xFFFF0000;
+        delta = (UINT16) (sequenceNumber - highestSequenceNumber);
+
+        if (delta < RTCP_RECEPTION_MAX_DROPOUT) {
+            // In order, with a permissible gap. Sequence numbers rolling over start a new cycle
+            if (sequenceNumber < highestSequenceNumber) {
+                cycles += 1 << 16;
+            }
+            pReceptionStats->extendedHighestSequenceNumber = cycles | sequenceNumber;
+        } else if (delta <= MAX_UINT16 + 1 - RTCP_RECEPTION_MAX_MISORDER) {
+            // Too far ahead to be a gap or behind to be reordered, the sender restarted its sequence numbers
+            restart = TRUE;
+        }
+        // Otherwise a duplicate or a reordered packet, counted as received
+    }
+
+    if (!pReceptionStats->started || restart) {
+        pReceptionStats->started = TRUE;
+        pReceptionStats->baseSequenceNumber = sequenceNumber;
+        pReceptionStats->extendedHighestSequenceNumber = sequenceNumber;
+        pReceptionStats->packetsReceived = 0;
+        pReceptionStats->expectedPrior = 0;
+        pReceptionStats->receivedPrior = 0;
+    }
+
+    pReceptionStats->packetsReceived++;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS rtcpReceptionStatsGetReportBlock(PRtcpReceptionStats pReceptionStats, UINT32 ssrc, UINT32 jitter, UINT64 currentTime,
+                                        PRtcpReportBlock pReportBlock)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 expected, expectedInterval, receivedInterval;
+    INT64 lost;
+    INT32 lostInterval;
+
+    CHK(pReceptionStats != NULL && pReportBlock != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pReportBlock, 0x00, SIZEOF(RtcpReportBlock));
+    pReportBlock->ssrc = ssrc;
+    pReportBlock->jitter = jitter;
+    CHK(pReceptionStats->started, retStatus);
+
+    // RFC 3550 A.3, duplicates can make the number of packets lost negative
+    expected = pReceptionStats->extendedHighestSequenceNumber - pReceptionStats->baseSequenceNumber + 1;
+    lost = (INT64) expected - pReceptionStats->packetsReceived;
+    pReportBlock->cumulativeLost = (INT32) MIN(MAX(lost, -0x800000), 0x7FFFFF);
+
+    expectedInterval = expected - pReceptionStats->expectedPrior;
+    receivedInterval = pReceptionStats->packetsReceived - pReceptionStats->receivedPrior;
+    lostInterval = (INT32) (expectedInterval - receivedInterval);
+    pReceptionStats->expectedPrior = expected;
+    pReceptionStats->receivedPrior = pReceptionStats->packetsReceived;
+    if (expectedInterval != 0 && lostInterval > 0) {
+        pReportBlock->fractionLost = (UINT8) (((UINT64) lostInterval << 8) / expectedInterval);
+    }
+
+    pReportBlock->extendedHighestSequenceNumber = pReceptionStats->extendedHighestSequenceNumber;
+
+    if (pReceptionStats->lastSenderReport != 0) {
+        pReportBlock->lastSenderReport = pReceptionStats->lastSenderReport;
+        pReportBlock->delaySinceLastSenderReport = (UINT32) ((currentTime - pReceptionStats->lastSenderReportReceivedTime) *
+                                                             RTCP_SHORT_NTP_UNITS_IN_A_SECOND / HUNDREDS_OF_NANOS_IN_A_SECOND);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+UINT64 convertTimestampToNtp(UINT64 time)
+{
+    UINT64 seconds = time / HUNDREDS_OF_NANOS_IN_A_SECOND + NTP_OFFSET_FROM_UNIX_EPOCH_IN_SECONDS;
+    UINT64 fraction = ((time % HUNDREDS_OF_NANOS_IN_A_SECOND) << 32) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+    return (seconds << 32) | fraction;
+}
+
+STATUS createRtcpTwccPacket(UINT32 senderSsrc, UINT32 mediaSsrc, UINT16 baseSequenceNumber, UINT8 feedbackPacketCount, PINT64 pArrivalTimes,
+                            UINT16 packetCount, PBYTE pPacket, PUINT32 pPacketLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetLen = 0, paddingLen = 0, chunksLen = 0, deltasLen = 0, i = 0;
+    INT64 referenceTime = 0, referenceTicks;
+    PBYTE pChunks = NULL;
+
+    CHK(pArrivalTimes != NULL && pPacketLen != NULL, STATUS_NULL_ARG);
+    CHK(packetCount > 0, STATUS_INVALID_ARG);
+
+    // The deltas start from the reference time, the arrival time of the first received packet rounded down
+    while (i < packetCount && pArrivalTimes[i] == RTCP_TWCC_PACKET_NOT_RECEIVED) {
+        i++;
+    }
+
+    if (i < packetCount) {
+        referenceTime = pArrivalTimes[i] / RTCP_TWCC_REFERENCE_TIME_UNIT;
+    }
+
+    referenceTicks = referenceTime * (RTCP_TWCC_REFERENCE_TIME_UNIT / RTCP_TWCC_DELTA_UNIT);
+
+    // Chunks come before the deltas, so their length is needed before anything can be written
+    CHK_STATUS(rtcpTwccEncodePacketStatus(pArrivalTimes, packetCount, referenceTicks, NULL, NULL, &chunksLen, &deltasLen));
+    packetLen = RTCP_PACKET_HEADER_LEN + RTCP_TWCC_FEEDBACK_HEADER_LEN + chunksLen + deltasLen;
+    paddingLen = (UINT32) ROUND_UP(packetLen, RTCP_PACKET_LEN_WORD_SIZE) - packetLen;
+    packetLen += paddingLen;
+
+    // Check if we are trying to calculate the required size only
+    CHK(pPacket != NULL, retStatus);
+    CHK(packetLen <= *pPacketLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    MEMSET(pPacket, 0x00, packetLen);
+    pChunks = pPacket + RTCP_PACKET_HEADER_LEN + RTCP_TWCC_FEEDBACK_HEADER_LEN;
+    CHK_STATUS(rtcpTwccEncodePacketStatus(pArrivalTimes, packetCount, referenceTicks, pChunks, pChunks + chunksLen, &chunksLen, &deltasLen));
+
+    pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_FEEDBACK_MESSAGE_TYPE_TRANSPORT_WIDE_CC;
+    pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK;
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, packetLen / RTCP_PACKET_LEN_WORD_SIZE - 1);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32), mediaSsrc);
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + 2 * SIZEOF(UINT32), baseSequenceNumber);
+    putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + 2 * SIZEOF(UINT32) + SIZEOF(UINT16), packetCount);
+    putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + 3 * SIZEOF(UINT32),
+                               (UINT32) ((referenceTime & RTCP_TWCC_REFERENCE_TIME_MASK) << 8) | feedbackPacketCount);
+
+    // The last padding byte tells how many there are, RFC 3550 6.4.1
+    if (paddingLen > 0) {
+        pPacket[0] |= (1 << PADDING_SHIFT);
+        pPacket[packetLen - 1] = (BYTE) paddingLen;
+    }
+
+CleanUp:
+    if (pPacketLen != NULL) {
+        *pPacketLen = packetLen;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+// Status chunks and receive deltas of a feedback. Identical statuses take a run length chunk once there are enough of them
+// to fill a status vector, others go in status vectors of 2 bit symbols. Only the lengths are computed when nothing is written.
+STATUS rtcpTwccEncodePacketStatus(PINT64 pArrivalTimes, UINT16 packetCount, INT64 referenceTicks, PBYTE pChunks, PBYTE pDeltas,
+                                  PUINT32 pChunksLen, PUINT32 pDeltasLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i = 0, j, runLength, symbolCount, chunksLen = 0, deltasLen = 0;
+    INT64 previousTicks = referenceTicks, runTicks, ticks;
+    RTCP_TWCC_SYMBOL symbol, runSymbol;
+    UINT16 chunk;
+
+    CHK(pArrivalTimes != NULL && pChunksLen != NULL && pDeltasLen != NULL, STATUS_NULL_ARG);
+
+    while (i < packetCount) {
+        runSymbol = rtcpTwccGetSymbol(pArrivalTimes[i], previousTicks);
+        runTicks = previousTicks;
+        runLength = 0;
+        while (i + runLength < packetCount && runLength < RTCP_TWCC_RUN_LENGTH_MAX &&
+               rtcpTwccGetSymbol(pArrivalTimes[i + runLength], runTicks) == runSymbol) {
+            if (runSymbol != RTCP_TWCC_SYMBOL_NOT_RECEIVED) {
+                runTicks = pArrivalTimes[i + runLength] / RTCP_TWCC_DELTA_UNIT;
+            }
+
+            runLength++;
+        }
+
+        if (runLength >= RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT) {
+            chunk = (UINT16) ((runSymbol << 13) | runLength);
+            symbolCount = runLength;
+        } else {
+            // Status vector with 2 bit symbols
+            chunk = 0xC000;
+            symbolCount = MIN(RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT, packetCount - i);
+        }
+
+        for (j = 0; j < symbolCount; j++) {
+            symbol = rtcpTwccGetSymbol(pArrivalTimes[i + j], previousTicks);
+            CHK(symbol != RTCP_TWCC_SYMBOL_RESERVED, STATUS_INVALID_ARG);
+
+            if (runLength < RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT) {
+                chunk |= (UINT16) (symbol << (2 * (RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT - 1 - j)));
+            }
+
+            if (symbol != RTCP_TWCC_SYMBOL_NOT_RECEIVED) {
+                ticks = pArrivalTimes[i + j] / RTCP_TWCC_DELTA_UNIT;
+                if (symbol == RTCP_TWCC_SYMBOL_SMALL_DELTA) {
+                    if (pDeltas != NULL) {
+                        pDeltas[deltasLen] = (BYTE) (ticks - previousTicks);
+                    }
+                    deltasLen++;
+                } else {
+                    if (pDeltas != NULL) {
+                        putUnalignedInt16BigEndian(pDeltas + deltasLen, (INT16) (ticks - previousTicks));
+                    }
+                    deltasLen += SIZEOF(INT16);
+                }
+
+                previousTicks = ticks;
+            }
+        }
+
+        if (pChunks != NULL) {
+            putUnalignedInt16BigEndian(pChunks + chunksLen, chunk);
+        }
+
+        chunksLen += RTCP_TWCC_PACKET_CHUNK_LEN;
+        i += symbolCount;
+    }
+
+CleanUp:
+    if (pChunksLen != NULL) {
+        *pChunksLen = chunksLen;
+    }
+
+    if (pDeltasLen != NULL) {
+        *pDeltasLen = deltasLen;
+    }
+
+    return retStatus;
+}
+
+// Deltas from the previous received packet that fit a byte are small, ones that fit a signed 16 bit integer large
+RTCP_TWCC_SYMBOL rtcpTwccGetSymbol(INT64 arrivalTime, INT64 previousTicks)
+{
+    INT64 delta;
+
+    if (arrivalTime == RTCP_TWCC_PACKET_NOT_RECEIVED) {
+        return RTCP_TWCC_SYMBOL_NOT_RECEIVED;
+    }
+
+    delta = arrivalTime / RTCP_TWCC_DELTA_UNIT - previousTicks;
+    if (delta >= 0 && delta <= MAX_UINT8) {
+        return RTCP_TWCC_SYMBOL_SMALL_DELTA;
+    }
+
+    return (INT16) delta == delta ? RTCP_TWCC_SYMBOL_LARGE_DELTA : RTCP_TWCC_SYMBOL_RESERVED;
+}
+
+STATUS rtcpTwccFeedbackGet(PBYTE pPayload, UINT32 payloadLen, PUINT16 pBaseSequenceNumber, PUINT8 pFeedbackPacketCount, PINT64 pArrivalTimes,
+                           PUINT32 pPacketCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetCount = 0, offset = RTCP_TWCC_FEEDBACK_HEADER_LEN, i = 0, j, symbolCount;
+    UINT16 chunk;
+    INT64 ticks;
+
+    CHK(pPayload != NULL && pBaseSequenceNumber != NULL && pFeedbackPacketCount != NULL && pPacketCount != NULL, STATUS_NULL_ARG);
+    CHK(payloadLen >= RTCP_TWCC_FEEDBACK_HEADER_LEN, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+
+    *pBaseSequenceNumber = (UINT16) getUnalignedInt16BigEndian(pPayload + 2 * SIZEOF(UINT32));
+    packetCount = (UINT16) getUnalignedInt16BigEndian(pPayload + 2 * SIZEOF(UINT32) + SIZEOF(UINT16));
+    ticks = (INT64) ((UINT32) getUnalignedInt32BigEndian(pPayload + 3 * SIZEOF(UINT32)) >> 8) *
+        (RTCP_TWCC_REFERENCE_TIME_UNIT / RTCP_TWCC_DELTA_UNIT);
+    *pFeedbackPacketCount = pPayload[RTCP_TWCC_FEEDBACK_HEADER_LEN - 1];
+
+    // Check if we are trying to get the packet count only
+    CHK(pArrivalTimes != NULL, retStatus);
+    CHK(packetCount <= *pPacketCount, STATUS_NOT_ENOUGH_MEMORY);
+
+    // The statuses of all the packets come first, they are kept in the arrival times until the deltas are read
+    while (i < packetCount) {
+        CHK(offset + RTCP_TWCC_PACKET_CHUNK_LEN <= payloadLen, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+        chunk = (UINT16) getUnalignedInt16BigEndian(pPayload + offset);
+        offset += RTCP_TWCC_PACKET_CHUNK_LEN;
+
+        if ((chunk & 0x8000) == 0) {
+            symbolCount = MIN(chunk & RTCP_TWCC_RUN_LENGTH_MAX, packetCount - i);
+            // An empty run would never get to the end of the statuses
+            CHK(symbolCount > 0, STATUS_RTCP_INPUT_TWCC_INVALID);
+            for (j = 0; j < symbolCount; j++) {
+                pArrivalTimes[i + j] = (chunk >> 13) & 0x3;
+            }
+        } else if ((chunk & 0x4000) == 0) {
+            // Received packets of a 1 bit status vector have small deltas
+            symbolCount = MIN(RTCP_TWCC_ONE_BIT_VECTOR_SYMBOL_COUNT, packetCount - i);
+            for (j = 0; j < symbolCount; j++) {
+                pArrivalTimes[i + j] = (chunk >> (RTCP_TWCC_ONE_BIT_VECTOR_SYMBOL_COUNT - 1 - j)) & 0x1;
+            }
+        } else {
+            symbolCount = MIN(RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT, packetCount - i);
+            for (j = 0; j < symbolCount; j++) {
+                pArrivalTimes[i + j] = (chunk >> (2 * (RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT - 1 - j))) & 0x3;
+            }
+        }
+
+        i += symbolCount;
+    }
+
+    for (i = 0; i < packetCount; i++) {
+        switch ((RTCP_TWCC_SYMBOL) pArrivalTimes[i]) {
+            case RTCP_TWCC_SYMBOL_NOT_RECEIVED:
+                pArrivalTimes[i] = RTCP_TWCC_PACKET_NOT_RECEIVED;
+                break;
+
+            case RTCP_TWCC_SYMBOL_SMALL_DELTA:
+                CHK(offset + SIZEOF(BYTE) <= payloadLen, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+                ticks += pPayload[offset];
+                offset += SIZEOF(BYTE);
+                pArrivalTimes[i] = ticks * RTCP_TWCC_DELTA_UNIT;
+                break;
+
+            case RTCP_TWCC_SYMBOL_LARGE_DELTA:
+                CHK(offset + SIZEOF(INT16) <= payloadLen, STATUS_RTCP_INPUT_PACKET_TOO_SMALL);
+                ticks += (INT16) getUnalignedInt16BigEndian(pPayload + offset);
+                offset += SIZEOF(INT16);
+                pArrivalTimes[i] = ticks * RTCP_TWCC_DELTA_UNIT;
+                break;
+
+            default:
+                CHK(FALSE, STATUS_RTCP_INPUT_TWCC_INVALID);
+        }
+    }
+
+CleanUp:
+    if (pPacketCount != NULL) {
+        *pPacketCount = packetCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 // Assert that Application Layer Feedback payload is REMB
 STATUS isRembPacket(PBYTE pPayload, UINT32 payloadLen)
 {
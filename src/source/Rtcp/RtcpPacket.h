@@ -18,6 +18,30 @@ extern "C" {
 #define RTCP_PACKET_HEADER_LEN  4
 #define RTCP_NACK_LIST_LEN  8
 
+// Each NACK entry is a packet id followed by a bitmask of the 16 sequence numbers after it
+#define RTCP_NACK_ENTRY_LEN 4
+#define RTCP_NACK_BITMASK_LEN 16
+
+// A PLI has no feedback control information, a FIR carries an ssrc and a sequence number padded to two words
+#define RTCP_PLI_PACKET_LEN (RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN)
+#define RTCP_FIR_ENTRY_LEN 8
+#define RTCP_FIR_PACKET_LEN (RTCP_PLI_PACKET_LEN + RTCP_FIR_ENTRY_LEN)
+
+// Sender info of a SR is the NTP and RTP timestamps of the report followed by the packet and octet counts
+#define RTCP_SENDER_INFO_LEN 20
+#define RTCP_REPORT_BLOCK_LEN 24
+// The report count of the header is 5 bits
+#define RTCP_MAX_REPORT_BLOCK_COUNT 31
+
+// RFC 3550 A.1, sequence numbers further ahead than this are taken for a restart of the stream
+#define RTCP_RECEPTION_MAX_DROPOUT 3000
+#define RTCP_RECEPTION_MAX_MISORDER 100
+
+// NTP timestamps count seconds from 1900 rather than 1970
+#define NTP_OFFSET_FROM_UNIX_EPOCH_IN_SECONDS 2208988800ULL
+// Last SR and delay since last SR fields are in 1/65536 seconds
+#define RTCP_SHORT_NTP_UNITS_IN_A_SECOND 65536
+
 #define RTCP_PACKET_VERSION_VAL 2
 
 #define RTCP_PACKET_LEN_WORD_SIZE 4
@@ -26,8 +50,23 @@ extern "C" {
 #define RTCP_PACKET_REMB_IDENTIFIER_OFFSET 8
 #define RTCP_PACKET_REMB_MANTISSA_BITMASK 0x3FFFF
 
+// Transport wide congestion control feedback, the ssrcs are followed by the base sequence number, the packet status
+// count, the reference time and the feedback packet count
+#define RTCP_TWCC_FEEDBACK_HEADER_LEN 16
+#define RTCP_TWCC_PACKET_CHUNK_LEN 2
+#define RTCP_TWCC_RUN_LENGTH_MAX 0x1FFF
+#define RTCP_TWCC_ONE_BIT_VECTOR_SYMBOL_COUNT 14
+#define RTCP_TWCC_TWO_BIT_VECTOR_SYMBOL_COUNT 7
+// Receive deltas count 250us and the 24 bit reference time 64ms
+#define RTCP_TWCC_DELTA_UNIT (250 * HUNDREDS_OF_NANOS_IN_A_MICROSECOND)
+#define RTCP_TWCC_REFERENCE_TIME_UNIT (64 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define RTCP_TWCC_REFERENCE_TIME_MASK 0xFFFFFF
+// Arrival time of a packet the feedback reports as not received
+#define RTCP_TWCC_PACKET_NOT_RECEIVED MAX_INT64
+
 typedef enum {
     RTCP_PACKET_TYPE_SENDER_REPORT = 200,
+    RTCP_PACKET_TYPE_RECEIVER_REPORT = 201,
     RTCP_PACKET_TYPE_SOURCE_DESCRIPTION = 202,
     RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK = 205,
     RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK = 206,
@@ -36,9 +75,19 @@ typedef enum {
 typedef enum {
     RTCP_FEEDBACK_MESSAGE_TYPE_NACK = 1,
     RTCP_PSFB_PLI = 1, //https://tools.ietf.org/html/rfc4585#section-6.3
+    RTCP_PSFB_FIR = 4, //https://tools.ietf.org/html/rfc5104#section-4.3.1
     RTCP_FEEDBACK_MESSAGE_TYPE_APPLICATION_LAYER_FEEDBACK = 15,
+    RTCP_FEEDBACK_MESSAGE_TYPE_TRANSPORT_WIDE_CC = 15, //https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01#section-3.1
 } RTCP_FEEDBACK_MESSAGE_TYPE;
 
+// Status symbols of the packet chunks of a transport wide congestion control feedback
+typedef enum {
+    RTCP_TWCC_SYMBOL_NOT_RECEIVED = 0,
+    RTCP_TWCC_SYMBOL_SMALL_DELTA = 1,
+    RTCP_TWCC_SYMBOL_LARGE_DELTA = 2,
+    RTCP_TWCC_SYMBOL_RESERVED = 3,
+} RTCP_TWCC_SYMBOL;
+
 /*
  *
  *  0                   1                   2                   3
@@ -63,8 +112,206 @@ typedef struct {
     UINT32 payloadLength;
 } RtcpPacket, *PRtcpPacket;
 
+/*
+ * Sender info of a SR, RFC 3550 6.4.1
+ */
+typedef struct {
+    UINT64 ntpTimestamp;
+    UINT32 rtpTimestamp;
+    UINT32 packetCount;
+    UINT32 octetCount;
+} RtcpSenderInfo, *PRtcpSenderInfo;
+
+/*
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ * |                 SSRC_1 (SSRC of first source)                 |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | fraction lost |       cumulative number of packets lost       |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |           extended highest sequence number received           |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                      interarrival jitter                      |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                         last SR (LSR)                         |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                   delay since last SR (DLSR)                  |
+ * +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ */
+typedef struct {
+    UINT32 ssrc;
+    UINT8 fractionLost;
+    INT32 cumulativeLost;
+    UINT32 extendedHighestSequenceNumber;
+    UINT32 jitter;
+    UINT32 lastSenderReport;
+    UINT32 delaySinceLastSenderReport;
+} RtcpReportBlock, *PRtcpReportBlock;
+
+/*
+ * Statistics of a received RTP stream that its report blocks are built from, RFC 3550 A.1 and A.3
+ */
+typedef struct {
+    BOOL started;
+    UINT32 baseSequenceNumber;
+    // Highest sequence number received, with the count of sequence number wrap arounds in the upper 16 bits
+    UINT32 extendedHighestSequenceNumber;
+    UINT32 packetsReceived;
+    // Expected and received packet counts at the last report, the fraction lost covers the interval since
+    UINT32 expectedPrior;
+    UINT32 receivedPrior;
+    // Middle 32 bits of the NTP timestamp of the last SR of the sender and when it was received, 0 until one arrives
+    UINT32 lastSenderReport;
+    UINT64 lastSenderReportReceivedTime;
+} RtcpReceptionStats, *PRtcpReceptionStats;
+
 STATUS setRtcpPacketFromBytes(PBYTE, UINT32, PRtcpPacket);
 STATUS rtcpNackListGet(PBYTE, UINT32, PUINT32, PUINT32, PUINT16, PUINT32);
+
+/**
+ * Serialize a generic NACK (RFC 4585 6.2.1) for a list of sequence numbers. Sequence numbers up to 16 apart share an
+ * entry, so the list should be in ascending order.
+ *
+ * @param - UINT32 - IN - Ssrc of the sender of the NACK
+ * @param - UINT32 - IN - Ssrc of the media source the packets are missing from
+ * @param - PUINT16 - IN - Sequence numbers of the missing packets
+ * @param - UINT32 - IN - Number of sequence numbers
+ * @param - PBYTE - OUT - Packet, NULL to only compute its size
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtcpNackPacket(UINT32, UINT32, PUINT16, UINT32, PBYTE, PUINT32);
+
+/**
+ * Serialize a Picture Loss Indication (RFC 4585 6.3.1)
+ *
+ * @param - UINT32 - IN - Ssrc of the sender of the PLI
+ * @param - UINT32 - IN - Ssrc of the media source the picture was lost from
+ * @param - PBYTE - OUT - Packet, NULL to only compute its size
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtcpPliPacket(UINT32, UINT32, PBYTE, PUINT32);
+
+/**
+ * Serialize a Full Intra Request (RFC 5104 4.3.1) for a single media source
+ *
+ * @param - UINT32 - IN - Ssrc of the sender of the FIR
+ * @param - UINT32 - IN - Ssrc of the media source that should send a key frame
+ * @param - UINT8 - IN - Command sequence number, incremented for every new request
+ * @param - PBYTE - OUT - Packet, NULL to only compute its size
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtcpFirPacket(UINT32, UINT32, UINT8, PBYTE, PUINT32);
+/**
+ * Serialize a SR (RFC 3550 6.4.1) or, without sender info, a RR (RFC 3550 6.4.2)
+ *
+ * @param - UINT32 - IN - Ssrc of the sender of the report
+ * @param - PRtcpSenderInfo - IN - Sender info of a SR, NULL for a RR
+ * @param - PRtcpReportBlock - IN - Report blocks of the received streams
+ * @param - UINT32 - IN - Number of report blocks, at most RTCP_MAX_REPORT_BLOCK_COUNT
+ * @param - PBYTE - OUT - Packet, NULL to only compute its size
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtcpReportPacket(UINT32, PRtcpSenderInfo, PRtcpReportBlock, UINT32, PBYTE, PUINT32);
+
+/**
+ * Get the sender ssrc and the sender info from the payload of a SR
+ *
+ * @param - PBYTE - IN - SR payload
+ * @param - UINT32 - IN - Payload length
+ * @param - PUINT32 - OUT - Ssrc of the sender of the report
+ * @param - PRtcpSenderInfo - OUT - Sender info
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpSenderReportGet(PBYTE, UINT32, PUINT32, PRtcpSenderInfo);
+
+/**
+ * Get a report block of a SR or a RR
+ *
+ * @param - PBYTE - IN - Report block
+ * @param - UINT32 - IN - Length left in the packet from the report block on
+ * @param - PRtcpReportBlock - OUT - Report block
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpReportBlockGet(PBYTE, UINT32, PRtcpReportBlock);
+
+/**
+ * Account for a received RTP packet in the reception statistics of its stream
+ *
+ * @param - PRtcpReceptionStats - IN/OUT - Reception statistics
+ * @param - UINT16 - IN - Sequence number of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpReceptionStatsUpdate(PRtcpReceptionStats, UINT16);
+
+/**
+ * Build the report block of a received stream, the fraction lost covers the packets since the previous report block
+ *
+ * @param - PRtcpReceptionStats - IN/OUT - Reception statistics
+ * @param - UINT32 - IN - Ssrc of the received stream
+ * @param - UINT32 - IN - Interarrival jitter in clock units
+ * @param - UINT64 - IN - Current time
+ * @param - PRtcpReportBlock - OUT - Report block
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpReceptionStatsGetReportBlock(PRtcpReceptionStats, UINT32, UINT32, UINT64, PRtcpReportBlock);
+
+/**
+ * Convert a time in 100ns units since the unix epoch into a 64 bit NTP timestamp
+ *
+ * @param - UINT64 - IN - Time
+ *
+ * @return - NTP timestamp, seconds since 1900 in the upper 32 bits and the fraction of a second in the lower ones
+ */
+UINT64 convertTimestampToNtp(UINT64);
+
+/**
+ * Serialize a transport wide congestion control feedback for a range of transport wide sequence numbers. Arrival times
+ * of consecutive received packets must be less than the 8 seconds a receive delta covers apart.
+ *
+ * @param - UINT32 - IN - Ssrc of the sender of the feedback
+ * @param - UINT32 - IN - Ssrc of a media source the packets were received from
+ * @param - UINT16 - IN - Transport wide sequence number of the first packet
+ * @param - UINT8 - IN - Feedback packet count, incremented for every feedback sent
+ * @param - PINT64 - IN - Arrival time of every packet from the first on, RTCP_TWCC_PACKET_NOT_RECEIVED for lost ones
+ * @param - UINT16 - IN - Number of packets
+ * @param - PBYTE - OUT - Packet, NULL to only compute its size
+ * @param - PUINT32 - IN/OUT - Size of the buffer, set to the size of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtcpTwccPacket(UINT32, UINT32, UINT16, UINT8, PINT64, UINT16, PBYTE, PUINT32);
+
+/**
+ * Get the packet statuses of a transport wide congestion control feedback
+ *
+ * @param - PBYTE - IN - Feedback payload
+ * @param - UINT32 - IN - Payload length
+ * @param - PUINT16 - OUT - Transport wide sequence number of the first packet
+ * @param - PUINT8 - OUT - Feedback packet count
+ * @param - PINT64 - OUT - Arrival time of every packet in the clock of the receiver, RTCP_TWCC_PACKET_NOT_RECEIVED
+ *                         for lost ones. NULL to only get the number of packets
+ * @param - PUINT32 - IN/OUT - Number of arrival times that fit, set to the number of packets
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtcpTwccFeedbackGet(PBYTE, UINT32, PUINT16, PUINT8, PINT64, PUINT32);
+
+STATUS rtcpTwccEncodePacketStatus(PINT64, UINT16, INT64, PBYTE, PBYTE, PUINT32, PUINT32);
+RTCP_TWCC_SYMBOL rtcpTwccGetSymbol(INT64, INT64);
+
 STATUS rembValueGet(PBYTE, UINT32, PDOUBLE, PUINT32, PUINT8);
 STATUS isRembPacket(PBYTE, UINT32);
 
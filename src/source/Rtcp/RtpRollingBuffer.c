@@ -10,7 +10,7 @@ STATUS createRtpRollingBuffer(UINT32 capacity, PRtpRollingBuffer* ppRtpRollingBu
     CHK(capacity != 0, STATUS_INVALID_ARG);
     CHK(ppRtpRollingBuffer != NULL, STATUS_NULL_ARG);
 
-    pRtpRollingBuffer = (PRtpRollingBuffer) MEMALLOC(SIZEOF(RtpRollingBuffer));
+    pRtpRollingBuffer = (PRtpRollingBuffer) MEMCALLOC(1, SIZEOF(RtpRollingBuffer));
     CHK(pRtpRollingBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
     CHK_STATUS(createRollingBuffer(capacity, freeRtpRollingBufferData, &pRtpRollingBuffer->pRollingBuffer));
 
@@ -45,7 +45,8 @@ STATUS freeRtpRollingBufferData(PUINT64 pData)
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(pData != NULL, STATUS_NULL_ARG);
-    CHK_STATUS(freeRtpPacketAndRawPacket((PRtpPacket*) pData));
+    // raw packet lives in the same allocation as the packet, see RtpRollingBufferSlot
+    CHK_STATUS(freeRtpPacket((PRtpPacket*) pData));
 CleanUp:
     LEAVES();
     return retStatus;
@@ -55,22 +56,54 @@ STATUS rtpRollingBufferAddRtpPacket(PRtpRollingBuffer pRollingBuffer, PRtpPacket
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PRtpPacket pRtpPacketCopy = NULL;
+    PRtpRollingBufferSlot pSlot = NULL;
     PBYTE pRawPacketCopy = NULL;
-    UINT64 index = 0;
+    UINT64 index = 0, item = 0;
+    UINT32 size = 0, slotCapacity = 0;
+    BOOL locked = FALSE;
     CHK(pRollingBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
-    pRawPacketCopy = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength);
-    CHK(pRawPacketCopy != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    // The NACK retransmitter borrows and puts back packets under the lock of the rolling buffer. Recycling the tail and
+    // appending are done under the same lock so that both see the same tail and size.
+    MUTEX_LOCK(pRollingBuffer->pRollingBuffer->lock);
+    locked = TRUE;
+
+    CHK_STATUS(rollingBufferGetSize(pRollingBuffer->pRollingBuffer, &size));
+    if (size == pRollingBuffer->pRollingBuffer->capacity) {
+        // Buffer is full so the oldest packet is about to be evicted. Take it out and reuse its storage instead
+        // of freeing it on append. The slot can be NULL if it is currently borrowed by the retransmitter.
+        CHK_STATUS(rollingBufferExtractData(pRollingBuffer->pRollingBuffer, pRollingBuffer->pRollingBuffer->tailIndex, &item));
+        pSlot = (PRtpRollingBufferSlot) item;
+        if (pSlot != NULL && pSlot->rawPacketCapacity < pRtpPacket->rawPacketLength) {
+            SAFE_MEMFREE(pSlot);
+        }
+    }
+
+    if (pSlot == NULL) {
+        slotCapacity = (UINT32) ROUND_UP(pRtpPacket->rawPacketLength, RTP_ROLLING_BUFFER_SLOT_GRANULARITY);
+        pSlot = (PRtpRollingBufferSlot) MEMALLOC(SIZEOF(RtpRollingBufferSlot) + slotCapacity);
+        CHK(pSlot != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pSlot->rawPacketCapacity = slotCapacity;
+        ATOMIC_INCREMENT(&pRollingBuffer->allocationCount);
+    }
+
+    pRawPacketCopy = (PBYTE) (pSlot + 1);
     MEMCPY(pRawPacketCopy, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
-    CHK_STATUS(createRtpPacketFromBytes(pRawPacketCopy, pRtpPacket->rawPacketLength, &pRtpPacketCopy));
+    CHK_STATUS(setRtpPacketFromBytes(pRawPacketCopy, pRtpPacket->rawPacketLength, &pSlot->rtpPacket));
 
-    CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pRtpPacketCopy, &index));
+    CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pSlot, &index));
     pRollingBuffer->lastIndex = index;
+    pSlot = NULL;
 
 CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pRollingBuffer->pRollingBuffer->lock);
+    }
+
     CHK_LOG_ERR(retStatus);
 
+    SAFE_MEMFREE(pSlot);
+
     LEAVES();
     return retStatus;
 }
@@ -87,9 +120,14 @@ STATUS rtpRollingBufferGetValidSeqIndexList(PRtpRollingBuffer pRollingBuffer, PU
     PUINT64 pCurSeqIndexListPtr;
     UINT16 seqNum;
     UINT32 size = 0;
+    BOOL locked = FALSE;
 
     CHK(pRollingBuffer != NULL && pValidSeqIndexList != NULL && pSequenceNumberList != NULL, STATUS_NULL_ARG);
 
+    // Size and last index have to match, see rtpRollingBufferAddRtpPacket
+    MUTEX_LOCK(pRollingBuffer->pRollingBuffer->lock);
+    locked = TRUE;
+
     CHK_STATUS(rollingBufferGetSize(pRollingBuffer->pRollingBuffer, &size));
     // Empty buffer, just return
     CHK(size > 0, retStatus);
@@ -120,6 +158,10 @@ STATUS rtpRollingBufferGetValidSeqIndexList(PRtpRollingBuffer pRollingBuffer, PU
     }
 
 CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pRollingBuffer->pRollingBuffer->lock);
+    }
+
     CHK_LOG_ERR(retStatus);
 
     if (pValidIndexListLen != NULL) {
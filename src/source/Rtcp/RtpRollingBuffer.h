@@ -10,12 +10,24 @@ RTCP Rolling Buffer include file
 extern "C" {
 #endif
 
+// Buffered packet storage is rounded up to this granularity so evicted slots fit most new packets
+#define RTP_ROLLING_BUFFER_SLOT_GRANULARITY 256
+
 typedef struct {
     PRollingBuffer pRollingBuffer;
     // index of last rtp packet in rolling buffer
     UINT64 lastIndex;
+    // number of packet slots allocated from the heap. Evicted slots are recycled so this stays flat once the buffer is full.
+    // Read with atomics for the outbound stats
+    volatile SIZE_T allocationCount;
 } RtpRollingBuffer, *PRtpRollingBuffer;
 
+// Each buffered packet is a single allocation of the RtpPacket followed by rawPacketCapacity bytes of raw packet
+typedef struct {
+    RtpPacket rtpPacket;
+    UINT32 rawPacketCapacity;
+} RtpRollingBufferSlot, *PRtpRollingBufferSlot;
+
 STATUS createRtpRollingBuffer(UINT32, PRtpRollingBuffer*);
 STATUS freeRtpRollingBuffer(PRtpRollingBuffer*);
 STATUS freeRtpRollingBufferData(PUINT64);
@@ -75,14 +75,218 @@ CleanUp:
     return retStatus;
 }
 
+/*
+ * Single pass packetizer. Every NALU is copied exactly once, straight into the ring slot it is sent from.
+ * NALUs larger than mtu are fragmented with FU-A, consecutive SPS/PPS are aggregated into a STAP-A packet while
+ * they fit in mtu, everything else is sent as a single NALU packet like createPayloadForH264 does.
+ */
+STATUS createRtpPacketsForH264(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PRtpPacketRing pRing)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE curPtrInNalus = nalus, pPayload = NULL, pCurPtrInNalu = NULL;
+    UINT32 remainNalusLength = nalusLength, nextNaluLength = 0, startIndex = 0;
+    UINT32 maxPayloadLength = 0, payloadLength = 0, curPayloadSize = 0, remainingNaluLength = 0;
+    UINT8 naluType = 0, naluRefIdc = 0;
+    BOOL payloadPending = FALSE, isStapA = FALSE, isParameterSet = FALSE;
+
+    CHK(nalus != NULL && pRing != NULL, STATUS_NULL_ARG);
+    CHK(mtu > FU_A_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    do {
+        CHK_STATUS(getNextNaluLength(curPtrInNalus, remainNalusLength, &startIndex, &nextNaluLength));
+
+        curPtrInNalus += startIndex;
+        remainNalusLength -= startIndex;
+
+        CHK(remainNalusLength != 0, retStatus);
+
+        naluType = *curPtrInNalus & NAL_TYPE_MASK;
+        naluRefIdc = *curPtrInNalus & NAL_REF_IDC_MASK;
+        // Only parameter sets are aggregated, receivers handle those in a STAP-A while other NALUs keep their own packets
+        isParameterSet = naluType == NAL_TYPE_SPS || naluType == NAL_TYPE_PPS;
+
+        if (payloadPending && isParameterSet && !isStapA &&
+            STAP_A_HEADER_SIZE + 2 * STAP_A_NALU_SIZE_LENGTH + payloadLength + nextNaluLength <= mtu) {
+            // Turn the pending single NALU packet into a STAP-A https://tools.ietf.org/html/rfc6184#section-5.7.1
+            MEMMOVE(pPayload + STAP_A_HEADER_SIZE + STAP_A_NALU_SIZE_LENGTH, pPayload, payloadLength);
+            putUnalignedInt16BigEndian(pPayload + STAP_A_HEADER_SIZE, (INT16) payloadLength);
+            pPayload[0] = (pPayload[STAP_A_HEADER_SIZE + STAP_A_NALU_SIZE_LENGTH] & (NAL_FORBIDDEN_BIT_MASK | NAL_REF_IDC_MASK)) | STAP_A_INDICATOR;
+            payloadLength += STAP_A_HEADER_SIZE + STAP_A_NALU_SIZE_LENGTH;
+            isStapA = TRUE;
+        }
+
+        if (isStapA && isParameterSet && payloadLength + STAP_A_NALU_SIZE_LENGTH + nextNaluLength <= mtu) {
+            // F bit is the OR and NRI the maximum of the aggregated NALUs
+            pPayload[0] |= *curPtrInNalus & NAL_FORBIDDEN_BIT_MASK;
+            if (naluRefIdc > (pPayload[0] & NAL_REF_IDC_MASK)) {
+                pPayload[0] = (pPayload[0] & ~NAL_REF_IDC_MASK) | naluRefIdc;
+            }
+            putUnalignedInt16BigEndian(pPayload + payloadLength, (INT16) nextNaluLength);
+            MEMCPY(pPayload + payloadLength + STAP_A_NALU_SIZE_LENGTH, curPtrInNalus, nextNaluLength);
+            payloadLength += STAP_A_NALU_SIZE_LENGTH + nextNaluLength;
+        } else {
+            if (payloadPending) {
+                CHK_STATUS(rtpPacketRingCommit(pRing, payloadLength));
+                payloadPending = FALSE;
+                isStapA = FALSE;
+            }
+
+            if (nextNaluLength <= mtu) {
+                // Single NALU https://tools.ietf.org/html/rfc6184#section-5.6
+                // A parameter set is kept pending as the next one might be aggregated with it
+                CHK_STATUS(rtpPacketRingAcquire(pRing, &pPayload, &maxPayloadLength));
+                CHK(maxPayloadLength >= mtu, STATUS_BUFFER_TOO_SMALL);
+                MEMCPY(pPayload, curPtrInNalus, nextNaluLength);
+                if (isParameterSet) {
+                    payloadLength = nextNaluLength;
+                    payloadPending = TRUE;
+                } else {
+                    CHK_STATUS(rtpPacketRingCommit(pRing, nextNaluLength));
+                }
+            } else {
+                // FU-A https://tools.ietf.org/html/rfc6184#section-5.8
+                // According to the RFC, the first octet is skipped due to redundant information
+                remainingNaluLength = nextNaluLength - 1;
+                pCurPtrInNalu = curPtrInNalus + 1;
+
+                while (remainingNaluLength != 0) {
+                    CHK_STATUS(rtpPacketRingAcquire(pRing, &pPayload, &maxPayloadLength));
+                    CHK(maxPayloadLength >= mtu, STATUS_BUFFER_TOO_SMALL);
+                    curPayloadSize = MIN(mtu - FU_A_HEADER_SIZE, remainingNaluLength);
+
+                    pPayload[0] = FU_A_INDICATOR | naluRefIdc;
+                    pPayload[1] = naluType;
+                    if (remainingNaluLength == nextNaluLength - 1) {
+                        // Set for starting bit
+                        pPayload[1] |= 1 << 7;
+                    } else if (remainingNaluLength == curPayloadSize) {
+                        // Set for ending bit
+                        pPayload[1] |= 1 << 6;
+                    }
+                    MEMCPY(pPayload + FU_A_HEADER_SIZE, pCurPtrInNalu, curPayloadSize);
+                    CHK_STATUS(rtpPacketRingCommit(pRing, FU_A_HEADER_SIZE + curPayloadSize));
+
+                    pCurPtrInNalu += curPayloadSize;
+                    remainingNaluLength -= curPayloadSize;
+                }
+            }
+        }
+
+        remainNalusLength -= nextNaluLength;
+        curPtrInNalus += nextNaluLength;
+    } while (remainNalusLength != 0);
+
+CleanUp:
+
+    if (payloadPending && STATUS_SUCCEEDED(retStatus)) {
+        retStatus = rtpPacketRingCommit(pRing, payloadLength);
+    }
+
+    if (STATUS_SUCCEEDED(retStatus) && pRing != NULL) {
+        retStatus = rtpPacketRingFinish(pRing);
+    }
+
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Byte wise start code search. Whenever the current byte is neither 0 nor 1 no start code can end within the next
+ * two bytes, so the scan skips ahead by 3.
+ */
+UINT32 findStartCodeScalar(PBYTE pData, UINT32 dataLength)
+{
+    UINT32 offset = 2;
+
+    while (offset < dataLength) {
+        if (pData[offset] > 1) {
+            offset += 3;
+        } else if (pData[offset] == 0) {
+            offset++;
+        } else if (pData[offset - 1] == 0 && pData[offset - 2] == 0) {
+            return offset - 2;
+        } else {
+            offset += 3;
+        }
+    }
+
+    return dataLength;
+}
+
+/*
+ * Returns the offset of the first 00 00 01 sequence in the buffer or dataLength if there is none. 4 byte start codes
+ * are found as the 3 byte code following their leading zero. The bulk of the buffer is scanned a vector at a time by
+ * comparing three overlapping loads against 0, 0 and 1, the remainder is handed to the scalar search.
+ */
+UINT32 findStartCode(PBYTE pData, UINT32 dataLength)
+{
+    UINT32 offset = 0;
+
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    __m256i zeros = _mm256_setzero_si256(), ones = _mm256_set1_epi8(1), match;
+    UINT32 mask;
+
+    for (; offset + SIZEOF(__m256i) + 2 <= dataLength; offset += SIZEOF(__m256i)) {
+        match = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i*) (pData + offset)), zeros),
+                                 _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i*) (pData + offset + 1)), zeros));
+        match = _mm256_and_si256(match, _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i*) (pData + offset + 2)), ones));
+        mask = (UINT32) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+    __m128i zeros = _mm_setzero_si128(), ones = _mm_set1_epi8(1), match;
+    UINT32 mask;
+
+    for (; offset + SIZEOF(__m128i) + 2 <= dataLength; offset += SIZEOF(__m128i)) {
+        match = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i*) (pData + offset)), zeros),
+                              _mm_cmpeq_epi8(_mm_loadu_si128((__m128i*) (pData + offset + 1)), zeros));
+        match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i*) (pData + offset + 2)), ones));
+        mask = (UINT32) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x16_t zeros = vdupq_n_u8(0), ones = vdupq_n_u8(1), match;
+
+    for (; offset + SIZEOF(uint8x16_t) + 2 <= dataLength; offset += SIZEOF(uint8x16_t)) {
+        match = vandq_u8(vceqq_u8(vld1q_u8(pData + offset), zeros), vceqq_u8(vld1q_u8(pData + offset + 1), zeros));
+        match = vandq_u8(match, vceqq_u8(vld1q_u8(pData + offset + 2), ones));
+        // NEON has no movemask, resolve the exact position within the vector with the scalar search
+        if (vmaxvq_u8(match) != 0) {
+            return offset + findStartCodeScalar(pData + offset, SIZEOF(uint8x16_t) + 2);
+        }
+    }
+#else
+    UINT64 word;
+    UINT32 found;
+
+    // Portable fallback, words without a zero byte can not hold the start of a start code and are skipped as a whole
+    for (; offset + SIZEOF(UINT64) + 2 <= dataLength; offset += SIZEOF(UINT64)) {
+        MEMCPY(&word, pData + offset, SIZEOF(UINT64));
+        if (((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL) != 0) {
+            found = findStartCodeScalar(pData + offset, SIZEOF(UINT64) + 2);
+            if (found < SIZEOF(UINT64) + 2) {
+                return offset + found;
+            }
+        }
+    }
+#endif
+
+    return offset + findStartCodeScalar(pData + offset, dataLength - offset);
+}
+
 STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT32 pNaluLength)
 {
     ENTERS();
 
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 zeroCount = 0, offset;
-    BOOL naluFound = FALSE;
-    PBYTE pCurrent = NULL;
 
     CHK(nalus != NULL && pStart != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
 
@@ -91,35 +295,16 @@ STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT3
 
     CHK(offset < nalusLength && offset < 4 && offset >= 2 && nalus[offset] == 1, STATUS_RTP_INVALID_NALU);
     *pStart = ++offset;
-    pCurrent = nalus + offset;
 
     /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
      * data with trailing zeros. */
-    while(offset < nalusLength) {
-        if (*pCurrent == 0) {
-            /* Maybe next byte is 1 */
-            offset++;
-            pCurrent++;
+    offset += findStartCode(nalus + offset, nalusLength - offset);
 
-        } else if (*pCurrent == 1) {
-            if (*(pCurrent - 1) == 0 && *(pCurrent - 2) == 0) {
-                zeroCount = *(pCurrent - 3) == 0 ? 3 : 2;
-                naluFound = TRUE;
-                break;
-            }
-
-            /* The jump is always 3 because of the 1 previously matched.
-             * All the 0's must be after this '1' matched at offset */
-            offset += 3;
-            pCurrent += 3;
-        } else {
-
-            /* Can jump 3 bytes forward */
-            offset += 3;
-            pCurrent += 3;
-        }
+    // A zero right in front of the 3 byte start code belongs to a 4 byte start code
+    if (offset < nalusLength && offset > *pStart && nalus[offset - 1] == 0) {
+        zeroCount = 1;
     }
-    *pNaluLength = MIN(offset, nalusLength) - *pStart - (naluFound? zeroCount : 0);
+    *pNaluLength = offset - *pStart - zeroCount;
 
 CleanUp:
 
@@ -380,3 +565,103 @@ CleanUp:
     return retStatus;
 }
 
+STATUS depayH264SegmentsFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PRtcFrameSegment pSegments, PUINT32 pSegmentCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 segmentCount = 0, maxSegmentCount = 0, headerSize = 0;
+    UINT8 indicator = 0;
+    PBYTE pCurPtr = pRawPacket;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+    UINT16 subNaluSize = 0;
+
+    CHK(pRawPacket != NULL && pSegmentCount != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+    maxSegmentCount = *pSegmentCount;
+
+    indicator = *pRawPacket & NAL_TYPE_MASK;
+    switch (indicator) {
+        case FU_A_INDICATOR:
+        case FU_B_INDICATOR:
+            headerSize = indicator == FU_A_INDICATOR ? FU_A_HEADER_SIZE : FU_B_HEADER_SIZE;
+            CHK(packetLength >= headerSize, STATUS_INVALID_ARG_LEN);
+            if ((pRawPacket[1] & (1 << 7)) != 0) {
+                CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, start4ByteCode, SIZEOF(start4ByteCode)));
+                CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, pRawPacket + headerSize - 1, packetLength - headerSize + 1));
+                if (pSegments != NULL) {
+                    pRawPacket[headerSize - 1] = (pRawPacket[0] & NAL_REF_IDC_MASK) | (pRawPacket[1] & NAL_TYPE_MASK);
+                }
+            } else {
+                CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, pRawPacket + headerSize, packetLength - headerSize));
+            }
+            break;
+        case STAP_A_INDICATOR:
+        case STAP_B_INDICATOR:
+            pCurPtr += indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE;
+            do {
+                CHK(pCurPtr + SIZEOF(UINT16) <= pRawPacket + packetLength, STATUS_INVALID_ARG_LEN);
+                subNaluSize = getInt16(*((PUINT16) pCurPtr));
+                pCurPtr += SIZEOF(UINT16);
+                CHK(pCurPtr + subNaluSize <= pRawPacket + packetLength, STATUS_INVALID_ARG_LEN);
+                CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, start4ByteCode, SIZEOF(start4ByteCode)));
+                CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, pCurPtr, subNaluSize));
+                pCurPtr += subNaluSize;
+            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
+            break;
+        default:
+            // Single NALU https://tools.ietf.org/html/rfc6184#section-5.6
+            CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, start4ByteCode, SIZEOF(start4ByteCode)));
+            CHK_STATUS(appendFrameSegment(pSegments, maxSegmentCount, &segmentCount, pRawPacket, packetLength));
+    }
+
+CleanUp:
+    if (pSegmentCount != NULL) {
+        *pSegmentCount = segmentCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS isH264KeyFrameRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBOOL pIsKeyFrame)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 offset;
+    UINT16 subNaluSize;
+    UINT8 naluType;
+    BOOL isKeyFrame = FALSE;
+
+    CHK(pRawPacket != NULL && pIsKeyFrame != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    switch (*pRawPacket & NAL_TYPE_MASK) {
+        case FU_A_INDICATOR:
+            // Only the first fragment tells the type of the fragmented NAL unit
+            CHK(packetLength >= FU_A_HEADER_SIZE && (pRawPacket[1] & FU_HEADER_START_BIT_MASK) != 0, retStatus);
+            naluType = pRawPacket[1] & NAL_TYPE_MASK;
+            isKeyFrame = naluType == NAL_TYPE_IDR || naluType == NAL_TYPE_SPS;
+            break;
+
+        case STAP_A_INDICATOR:
+            for (offset = STAP_A_HEADER_SIZE; !isKeyFrame && offset + STAP_A_NALU_SIZE_LENGTH < packetLength;
+                 offset += STAP_A_NALU_SIZE_LENGTH + subNaluSize) {
+                subNaluSize = (UINT16) getUnalignedInt16BigEndian(pRawPacket + offset);
+                naluType = pRawPacket[offset + STAP_A_NALU_SIZE_LENGTH] & NAL_TYPE_MASK;
+                isKeyFrame = naluType == NAL_TYPE_IDR || naluType == NAL_TYPE_SPS;
+            }
+            break;
+
+        default:
+            naluType = *pRawPacket & NAL_TYPE_MASK;
+            isKeyFrame = naluType == NAL_TYPE_IDR || naluType == NAL_TYPE_SPS;
+    }
+
+CleanUp:
+    if (pIsKeyFrame != NULL) {
+        *pIsKeyFrame = isKeyFrame;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -20,6 +20,13 @@ extern "C" {
 #define STAP_A_INDICATOR 24
 #define STAP_B_INDICATOR 25
 #define NAL_TYPE_MASK 31
+#define NAL_REF_IDC_MASK 0x60
+#define NAL_FORBIDDEN_BIT_MASK 0x80
+#define STAP_A_NALU_SIZE_LENGTH 2
+#define FU_HEADER_START_BIT_MASK 0x80
+#define NAL_TYPE_IDR 5
+#define NAL_TYPE_SPS 7
+#define NAL_TYPE_PPS 8
 
 /*
  *   0                   1                   2                   3
@@ -37,9 +44,38 @@ extern "C" {
 
 STATUS createPayloadForH264(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS getNextNaluLength(PBYTE, UINT32, PUINT32, PUINT32);
+UINT32 findStartCode(PBYTE, UINT32);
+UINT32 findStartCodeScalar(PBYTE, UINT32);
 STATUS createPayloadFromNalu(UINT32, PBYTE, UINT32, PPayloadArray, PUINT32, PUINT32);
+STATUS createRtpPacketsForH264(UINT32, PBYTE, UINT32, PRtpPacketRing);
 STATUS depayH264FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
+/**
+ * Describe the Annex-B data depayH264FromRtpPayload would copy out of a payload as segments pointing into the payload.
+ * The NAL unit header of the first fragment of a fragmented NAL unit is rebuilt in place over the last byte of the
+ * fragmentation header, so the payload can not be depayloaded again afterwards.
+ *
+ * @param - PBYTE - IN - RTP payload
+ * @param - UINT32 - IN - RTP payload length
+ * @param - PRtcFrameSegment - OUT - Segments, NULL to only count them without touching the payload
+ * @param - PUINT32 - IN/OUT - Number of segments that fit, set to the number of segments of the payload
+ *
+ * @return - STATUS status of execution
+ */
+STATUS depayH264SegmentsFromRtpPayload(PBYTE, UINT32, PRtcFrameSegment, PUINT32);
+
+/**
+ * Check whether the first RTP payload of a frame starts a key frame, that is carries an IDR slice or the SPS
+ * preceding it. The payload must not have been rewritten by depayH264SegmentsFromRtpPayload.
+ *
+ * @param - PBYTE - IN - RTP payload
+ * @param - UINT32 - IN - RTP payload length
+ * @param - PBOOL - OUT - Whether the payload starts a key frame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS isH264KeyFrameRtpPayload(PBYTE, UINT32, PBOOL);
+
 #ifdef  __cplusplus
 
 }
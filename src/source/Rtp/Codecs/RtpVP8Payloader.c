@@ -116,3 +116,50 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS isVP8KeyFrameRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBOOL pIsKeyFrame)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadDescriptorLength = VP8_PAYLOAD_DESCRIPTOR_SIZE;
+    BOOL isKeyFrame = FALSE;
+
+    CHK(pRawPacket != NULL && pIsKeyFrame != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    // The VP8 payload header is only present at the start of the first partition
+    CHK((pRawPacket[0] & VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE) != 0 &&
+        (pRawPacket[0] & VP8_PAYLOAD_DESCRIPTOR_PARTITION_INDEX_MASK) == 0, retStatus);
+
+    if ((pRawPacket[0] & 0x80) != 0) {
+        CHK(packetLength > payloadDescriptorLength, retStatus);
+        payloadDescriptorLength++;
+
+        // PictureID is 7 or 15 bit
+        if ((pRawPacket[1] & 0x80) != 0) {
+            CHK(packetLength > payloadDescriptorLength, retStatus);
+            payloadDescriptorLength += (pRawPacket[payloadDescriptorLength] & 0x80) != 0 ? 2 : 1;
+        }
+
+        // TL0PICIDX
+        if ((pRawPacket[1] & 0x40) != 0) {
+            payloadDescriptorLength++;
+        }
+
+        // TID and KEYIDX share a byte
+        if ((pRawPacket[1] & 0x30) != 0) {
+            payloadDescriptorLength++;
+        }
+    }
+
+    CHK(packetLength > payloadDescriptorLength, retStatus);
+    isKeyFrame = (pRawPacket[payloadDescriptorLength] & VP8_PAYLOAD_HEADER_INVERSE_KEY_FRAME_MASK) == 0;
+
+CleanUp:
+    if (pIsKeyFrame != NULL) {
+        *pIsKeyFrame = isKeyFrame;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -12,10 +12,24 @@ extern "C" {
 
 #define VP8_PAYLOAD_DESCRIPTOR_SIZE 1
 #define VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE 0X10
+#define VP8_PAYLOAD_DESCRIPTOR_PARTITION_INDEX_MASK 0x0F
+#define VP8_PAYLOAD_HEADER_INVERSE_KEY_FRAME_MASK 0x01
 
 STATUS createPayloadForVP8(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS depayVP8FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
+/**
+ * Check whether the first RTP payload of a frame starts a key frame, from the inverse key frame flag of the VP8
+ * payload header following the payload descriptor
+ *
+ * @param - PBYTE - IN - RTP payload
+ * @param - UINT32 - IN - RTP payload length
+ * @param - PBOOL - OUT - Whether the payload starts a key frame
+ *
+ * @return - STATUS status of execution
+ */
+STATUS isVP8KeyFrameRtpPayload(PBYTE, UINT32, PBOOL);
+
 #ifdef  __cplusplus
 
 }
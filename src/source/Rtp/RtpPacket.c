@@ -13,6 +13,8 @@ STATUS createRtpPacket(UINT8 version, BOOL padding, BOOL extension, UINT8 csrcCo
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pRtpPacket->pRawPacket = NULL;
     pRtpPacket->rawPacketLength = 0;
+    pRtpPacket->pPool = NULL;
+    pRtpPacket->receivedTime = 0;
     CHK_STATUS(setRtpPacket(version, padding, extension, csrcCount, marker, payloadType, sequenceNumber, timestamp, ssrc, csrcArray,
             extensionProfile, extensionLength, extensionPayload, payload, payloadLength, pRtpPacket));
 
@@ -91,6 +93,12 @@ STATUS freeRtpPacketAndRawPacket(PRtpPacket * ppRtpPacket)
 
     CHK(ppRtpPacket != NULL, STATUS_NULL_ARG);
 
+    if (*ppRtpPacket != NULL && (*ppRtpPacket)->pPool != NULL) {
+        // Pooled packets share their allocation with the raw packet and only go back to the pool on the last reference
+        CHK_STATUS(rtpPacketPoolRelease((*ppRtpPacket)->pPool, *ppRtpPacket));
+        *ppRtpPacket = NULL;
+    }
+
     if (*ppRtpPacket != NULL) {
         SAFE_MEMFREE((*ppRtpPacket)->pRawPacket);
     }
@@ -112,6 +120,8 @@ STATUS createRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLength, PRtpPacket
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pRtpPacket->pRawPacket = rawPacket;
     pRtpPacket->rawPacketLength = packetLength;
+    pRtpPacket->pPool = NULL;
+    pRtpPacket->receivedTime = 0;
     CHK_STATUS(setRtpPacketFromBytes(rawPacket, packetLength, pRtpPacket));
 
 CleanUp:
@@ -139,6 +149,8 @@ STATUS constructRetransmitRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLengt
     PRtpPacket pRtpPacket = (PRtpPacket) MEMALLOC(SIZEOF(RtpPacket));
 
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pRtpPacket->pPool = NULL;
+    pRtpPacket->receivedTime = 0;
     CHK_STATUS(setRtpPacketFromBytes(rawPacket, packetLength, pRtpPacket));
     pPayload = (PBYTE) MEMALLOC(pRtpPacket->payloadLength + SIZEOF(UINT16));
     CHK(pPayload != NULL, STATUS_NOT_ENOUGH_MEMORY);
@@ -341,7 +353,8 @@ CleanUp:
     return retStatus;
 }
 
-STATUS constructRtpPackets(PPayloadArray pPayloadArray, UINT8 payloadType, UINT16 startSequenceNumber, UINT32 timestamp, UINT32 ssrc, PRtpPacket pPackets, UINT32 packetCount)
+STATUS constructRtpPackets(PPayloadArray pPayloadArray, UINT8 payloadType, UINT16 startSequenceNumber, UINT32 timestamp, UINT32 ssrc,
+                           UINT16 extensionProfile, UINT32 extensionLength, PBYTE extensionPayload, PRtpPacket pPackets, UINT32 packetCount)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -356,9 +369,9 @@ STATUS constructRtpPackets(PPayloadArray pPayloadArray, UINT8 payloadType, UINT1
 
     curPtrInPayload = pPayloadArray->payloadBuffer;
     for (i = 0, curPtrInPayloadSubLen = pPayloadArray->payloadSubLength; i < pPayloadArray->payloadSubLenSize; i++, curPtrInPayloadSubLen++) {
-        CHK_STATUS(setRtpPacket(2, FALSE, FALSE, 0, i == pPayloadArray->payloadSubLenSize - 1,
+        CHK_STATUS(setRtpPacket(2, FALSE, extensionLength > 0, 0, i == pPayloadArray->payloadSubLenSize - 1,
                         payloadType, sequenceNumber, timestamp, ssrc, NULL,
-                        0, 0, NULL, curPtrInPayload, *curPtrInPayloadSubLen, pPackets + i));
+                        extensionProfile, extensionLength, extensionPayload, curPtrInPayload, *curPtrInPayloadSubLen, pPackets + i));
 
         sequenceNumber = GET_UINT16_SEQ_NUM(sequenceNumber + 1);
 
@@ -369,3 +382,342 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS rtpPacketRingAcquire(PRtpPacketRing pRing, PBYTE* ppPayload, PUINT32 pMaxPayloadLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRing != NULL && ppPayload != NULL && pMaxPayloadLength != NULL, STATUS_NULL_ARG);
+    CHK(((pRing->pPackets != NULL && pRing->pSlots != NULL) || pRing->ppPackets != NULL) && pRing->slotCount > 0, STATUS_INVALID_ARG);
+    CHK(pRing->slotSize > RTP_PACKET_RING_HEADER_LENGTH(pRing) + pRing->slotTailroom, STATUS_BUFFER_TOO_SMALL);
+
+    // Packets of a frame only go out together, a ring too small for the frame has to be replaced by a larger one
+    CHK(pRing->packetCount < pRing->slotCount, STATUS_BUFFER_TOO_SMALL);
+
+    *ppPayload = RTP_PACKET_RING_SLOT(pRing, pRing->packetCount) + RTP_PACKET_RING_HEADER_LENGTH(pRing);
+    *pMaxPayloadLength = pRing->slotSize - pRing->slotTailroom - RTP_PACKET_RING_HEADER_LENGTH(pRing);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketRingCommit(PRtpPacketRing pRing, UINT32 payloadLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pRtpPacket = NULL;
+    PBYTE pRawPacket = NULL;
+    BOOL extension;
+    UINT32 headerLength;
+
+    CHK(pRing != NULL, STATUS_NULL_ARG);
+    CHK(pRing->packetCount < pRing->slotCount, STATUS_INVALID_OPERATION);
+    CHK(pRing->extensionLength % SIZEOF(UINT32) == 0 && (pRing->extensionLength == 0 || pRing->extensionPayload != NULL),
+        STATUS_RTP_INVALID_EXTENSION_LEN);
+
+    extension = pRing->extensionLength > 0;
+    headerLength = RTP_PACKET_RING_HEADER_LENGTH(pRing);
+    CHK(headerLength + payloadLength + pRing->slotTailroom <= pRing->slotSize, STATUS_BUFFER_TOO_SMALL);
+
+    pRtpPacket = RTP_PACKET_RING_PACKET(pRing, pRing->packetCount);
+    pRawPacket = RTP_PACKET_RING_SLOT(pRing, pRing->packetCount);
+
+    // The extension of the packet points at its copy in the slot so that it can be updated before the packet goes out
+    CHK_STATUS(setRtpPacket(2, FALSE, extension, 0, FALSE, pRing->payloadType, pRing->sequenceNumber, pRing->timestamp, pRing->ssrc, NULL,
+                            pRing->extensionProfile, pRing->extensionLength, pRawPacket + MIN_HEADER_LENGTH + RTP_HEADER_EXTENSION_HEADER_LENGTH,
+                            pRawPacket + headerLength, payloadLength, pRtpPacket));
+    pRtpPacket->pRawPacket = pRawPacket;
+    pRtpPacket->rawPacketLength = headerLength + payloadLength;
+
+    // The payload is already in place, only the header needs to be written in front of it
+    pRawPacket[0] = (BYTE) (2 << VERSION_SHIFT);
+    pRawPacket[1] = pRing->payloadType & PAYLOAD_TYPE_MASK;
+    putUnalignedInt16BigEndian(pRawPacket + SEQ_NUMBER_OFFSET, pRing->sequenceNumber);
+    putUnalignedInt32BigEndian(pRawPacket + TIMESTAMP_OFFSET, pRing->timestamp);
+    putUnalignedInt32BigEndian(pRawPacket + SSRC_OFFSET, pRing->ssrc);
+
+    if (extension) {
+        pRawPacket[0] |= (1 << EXTENSION_SHIFT);
+        putUnalignedInt16BigEndian(pRawPacket + MIN_HEADER_LENGTH, pRing->extensionProfile);
+        putUnalignedInt16BigEndian(pRawPacket + MIN_HEADER_LENGTH + SIZEOF(UINT16), pRing->extensionLength / SIZEOF(UINT32));
+        MEMCPY(pRawPacket + MIN_HEADER_LENGTH + RTP_HEADER_EXTENSION_HEADER_LENGTH, pRing->extensionPayload, pRing->extensionLength);
+    }
+
+    pRing->sequenceNumber = GET_UINT16_SEQ_NUM(pRing->sequenceNumber + 1);
+    pRing->packetCount++;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketRingFinish(PRtpPacketRing pRing)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pLastPacket = NULL;
+
+    CHK(pRing != NULL, STATUS_NULL_ARG);
+    CHK(pRing->packetCount > 0, retStatus);
+
+    // Marker bit goes on the last packet of the frame
+    pLastPacket = RTP_PACKET_RING_PACKET(pRing, pRing->packetCount - 1);
+    pLastPacket->header.marker = TRUE;
+    pLastPacket->pRawPacket[1] |= (1 << MARKER_SHIFT);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS getRtpHeaderExtensionFromBytes(PBYTE rawPacket, UINT32 packetLength, UINT8 id, PBYTE* ppData, PUINT32 pDataLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 offset, extensionEnd, elementLength, dataLength = 0;
+    UINT16 profile;
+    UINT8 elementId;
+    PBYTE pData = NULL;
+
+    CHK(rawPacket != NULL && ppData != NULL && pDataLength != NULL, STATUS_NULL_ARG);
+    CHK(packetLength >= MIN_HEADER_LENGTH, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+    CHK(((rawPacket[0] >> EXTENSION_SHIFT) & EXTENSION_MASK) > 0, retStatus);
+
+    offset = MIN_HEADER_LENGTH + (rawPacket[0] & CSRC_COUNT_MASK) * CSRC_LENGTH;
+    CHK(offset + RTP_HEADER_EXTENSION_HEADER_LENGTH <= packetLength, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+    profile = (UINT16) getUnalignedInt16BigEndian(rawPacket + offset);
+    extensionEnd = offset + RTP_HEADER_EXTENSION_HEADER_LENGTH +
+        (UINT16) getUnalignedInt16BigEndian(rawPacket + offset + SIZEOF(UINT16)) * SIZEOF(UINT32);
+    CHK(extensionEnd <= packetLength, STATUS_RTP_INVALID_EXTENSION_LEN);
+    offset += RTP_HEADER_EXTENSION_HEADER_LENGTH;
+
+    if (profile == RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE) {
+        // Elements start with a 4 bit id and the length minus one, id 0 is padding
+        while (pData == NULL && offset < extensionEnd) {
+            elementId = rawPacket[offset] >> RTP_ONE_BYTE_HEADER_EXTENSION_ID_SHIFT;
+            if (elementId == 0) {
+                offset++;
+            } else if (elementId == RTP_ONE_BYTE_HEADER_EXTENSION_ID_STOP) {
+                offset = extensionEnd;
+            } else {
+                elementLength = (rawPacket[offset] & RTP_ONE_BYTE_HEADER_EXTENSION_LENGTH_MASK) + 1;
+                CHK(offset + 1 + elementLength <= extensionEnd, STATUS_RTP_INVALID_EXTENSION_LEN);
+                if (elementId == id) {
+                    pData = rawPacket + offset + 1;
+                    dataLength = elementLength;
+                }
+
+                offset += 1 + elementLength;
+            }
+        }
+    } else if ((profile & RTP_TWO_BYTE_HEADER_EXTENSION_PROFILE_MASK) == RTP_TWO_BYTE_HEADER_EXTENSION_PROFILE) {
+        // Elements start with a byte of id and a byte of length, id 0 is padding
+        while (pData == NULL && offset < extensionEnd) {
+            elementId = rawPacket[offset];
+            if (elementId == 0) {
+                offset++;
+            } else {
+                CHK(offset + 2 <= extensionEnd, STATUS_RTP_INVALID_EXTENSION_LEN);
+                elementLength = rawPacket[offset + 1];
+                CHK(offset + 2 + elementLength <= extensionEnd, STATUS_RTP_INVALID_EXTENSION_LEN);
+                if (elementId == id) {
+                    pData = rawPacket + offset + 2;
+                    dataLength = elementLength;
+                }
+
+                offset += 2 + elementLength;
+            }
+        }
+    }
+
+CleanUp:
+    if (ppData != NULL) {
+        *ppData = pData;
+    }
+
+    if (pDataLength != NULL) {
+        *pDataLength = dataLength;
+    }
+
+    return retStatus;
+}
+
+STATUS appendFrameSegment(PRtcFrameSegment pSegments, UINT32 maxSegmentCount, PUINT32 pSegmentCount, PBYTE pData, UINT32 size)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSegmentCount != NULL, STATUS_NULL_ARG);
+
+    if (pSegments != NULL) {
+        CHK(*pSegmentCount < maxSegmentCount, STATUS_BUFFER_TOO_SMALL);
+        pSegments[*pSegmentCount].pData = pData;
+        pSegments[*pSegmentCount].size = size;
+    }
+
+    (*pSegmentCount)++;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS createRtpPacketPool(UINT32 bufferSize, UINT32 capacity, PRtpPacketPool* ppRtpPacketPool)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPool pRtpPacketPool = NULL;
+
+    CHK(ppRtpPacketPool != NULL, STATUS_NULL_ARG);
+    CHK(bufferSize >= MIN_HEADER_LENGTH && capacity > 0, STATUS_INVALID_ARG);
+
+    pRtpPacketPool = (PRtpPacketPool) MEMCALLOC(1, SIZEOF(RtpPacketPool));
+    CHK(pRtpPacketPool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pRtpPacketPool->lock = MUTEX_CREATE(FALSE);
+    pRtpPacketPool->bufferSize = bufferSize;
+    pRtpPacketPool->capacity = capacity;
+    ATOMIC_STORE(&pRtpPacketPool->outstandingCount, 0);
+    ATOMIC_STORE(&pRtpPacketPool->allocationCount, 0);
+
+    pRtpPacketPool->pFreePackets = (PRtpPacket*) MEMALLOC(capacity * SIZEOF(PRtpPacket));
+    CHK(pRtpPacketPool->pFreePackets != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeRtpPacketPool(&pRtpPacketPool);
+    }
+
+    if (ppRtpPacketPool != NULL) {
+        *ppRtpPacketPool = pRtpPacketPool;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeRtpPacketPool(PRtpPacketPool* ppRtpPacketPool)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    UINT32 i;
+
+    CHK(ppRtpPacketPool != NULL, STATUS_NULL_ARG);
+    CHK(*ppRtpPacketPool != NULL, retStatus);
+
+    pRtpPacketPool = *ppRtpPacketPool;
+
+    if (ATOMIC_LOAD(&pRtpPacketPool->outstandingCount) != 0) {
+        DLOGW("Freeing packet pool with %u packets still in use", (UINT32) ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    }
+
+    if (pRtpPacketPool->pFreePackets != NULL) {
+        for (i = 0; i < pRtpPacketPool->freePacketCount; i++) {
+            MEMFREE(pRtpPacketPool->pFreePackets[i]);
+        }
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pRtpPacketPool->lock)) {
+        MUTEX_FREE(pRtpPacketPool->lock);
+    }
+
+    SAFE_MEMFREE(pRtpPacketPool->pFreePackets);
+    SAFE_MEMFREE(*ppRtpPacketPool);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketPoolGet(PRtpPacketPool pRtpPacketPool, PRtpPacket* ppRtpPacket)
+{
+    return rtpPacketPoolGetWithSize(pRtpPacketPool, 0, ppRtpPacket);
+}
+
+STATUS rtpPacketPoolGetWithSize(PRtpPacketPool pRtpPacketPool, UINT32 size, PRtpPacket* ppRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pRtpPacket = NULL;
+    UINT32 bufferSize;
+
+    CHK(pRtpPacketPool != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+
+    bufferSize = MAX(size, pRtpPacketPool->bufferSize);
+
+    if (bufferSize == pRtpPacketPool->bufferSize) {
+        MUTEX_LOCK(pRtpPacketPool->lock);
+        if (pRtpPacketPool->freePacketCount > 0) {
+            pRtpPacket = pRtpPacketPool->pFreePackets[--pRtpPacketPool->freePacketCount];
+        }
+        MUTEX_UNLOCK(pRtpPacketPool->lock);
+    }
+
+    if (pRtpPacket == NULL) {
+        // The raw packet buffer directly follows the packet
+        pRtpPacket = (PRtpPacket) MEMALLOC(SIZEOF(RtpPacket) + bufferSize);
+        CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        ATOMIC_INCREMENT(&pRtpPacketPool->allocationCount);
+    }
+
+    MEMSET(pRtpPacket, 0x00, SIZEOF(RtpPacket));
+    pRtpPacket->pRawPacket = (PBYTE) (pRtpPacket + 1);
+    pRtpPacket->rawPacketBufferSize = bufferSize;
+    pRtpPacket->pPool = pRtpPacketPool;
+    ATOMIC_STORE(&pRtpPacket->refCount, 1);
+    ATOMIC_INCREMENT(&pRtpPacketPool->outstandingCount);
+
+CleanUp:
+
+    if (ppRtpPacket != NULL) {
+        *ppRtpPacket = pRtpPacket;
+    }
+
+    return retStatus;
+}
+
+STATUS rtpPacketAddReference(PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRtpPacket != NULL, STATUS_NULL_ARG);
+    CHK(pRtpPacket->pPool != NULL, STATUS_INVALID_OPERATION);
+
+    ATOMIC_INCREMENT(&pRtpPacket->refCount);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS rtpPacketPoolRelease(PRtpPacketPool pRtpPacketPool, PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRtpPacketPool != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+
+    // ATOMIC_DECREMENT returns the count before the decrement
+    CHK(ATOMIC_DECREMENT(&pRtpPacket->refCount) == 1, retStatus);
+
+    ATOMIC_DECREMENT(&pRtpPacketPool->outstandingCount);
+
+    // Oversized packets are one-off allocations and go straight back to the heap
+    if (pRtpPacket->rawPacketBufferSize == pRtpPacketPool->bufferSize) {
+        MUTEX_LOCK(pRtpPacketPool->lock);
+        if (pRtpPacketPool->freePacketCount < pRtpPacketPool->capacity) {
+            pRtpPacketPool->pFreePackets[pRtpPacketPool->freePacketCount++] = pRtpPacket;
+            pRtpPacket = NULL;
+        }
+        MUTEX_UNLOCK(pRtpPacketPool->lock);
+    }
+
+    SAFE_MEMFREE(pRtpPacket);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -27,13 +27,29 @@ extern "C" {
 #define CSRC_OFFSET 12
 #define CSRC_LENGTH 4
 
+// RFC 8285, the extension elements follow the profile and the length in 32-bit words
+#define RTP_HEADER_EXTENSION_HEADER_LENGTH 4
+#define RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE 0xBEDE
+#define RTP_TWO_BYTE_HEADER_EXTENSION_PROFILE 0x1000
+#define RTP_TWO_BYTE_HEADER_EXTENSION_PROFILE_MASK 0xFFF0
+#define RTP_ONE_BYTE_HEADER_EXTENSION_ID_SHIFT 4
+#define RTP_ONE_BYTE_HEADER_EXTENSION_LENGTH_MASK 0x0F
+// Id of a one byte header element that ends the extension
+#define RTP_ONE_BYTE_HEADER_EXTENSION_ID_STOP 15
+
 #define RTP_GET_RAW_PACKET_SIZE(pRtpPacket) (12 + (pRtpPacket)->header.csrcCount * CSRC_LENGTH \
     + ((pRtpPacket)->header.extension ? 4 + (pRtpPacket)->header.extensionLength : 0) \
     + (pRtpPacket)->payloadLength)
 
 #define GET_UINT16_SEQ_NUM(seqIndex) ((UINT16) ((seqIndex) % (MAX_UINT16 + 1)))
 
+// Raw packet buffer size of pooled packets, the largest datagram an Ethernet path carries without fragmentation
+#define RTP_PACKET_POOL_BUFFER_SIZE 1500
+// Number of released packets a pool keeps around for reuse
+#define DEFAULT_RTP_PACKET_POOL_CAPACITY 1024
+
 typedef STATUS (*DepayRtpPayloadFunc)(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+typedef STATUS (*DepayRtpPayloadSegmentsFunc)(PBYTE, UINT32, PRtcFrameSegment, PUINT32);
 
 /*
  *  0                   1                   2                   3
@@ -79,6 +95,9 @@ struct __Payloads {
 typedef struct __Payloads PayloadArray;
 typedef PayloadArray* PPayloadArray;
 
+typedef struct __RtpPacketPool RtpPacketPool;
+typedef RtpPacketPool* PRtpPacketPool;
+
 typedef struct __RtpPacket RtpPacket;
 struct __RtpPacket {
     RtpPacketHeader header;
@@ -86,9 +105,77 @@ struct __RtpPacket {
     UINT32 payloadLength;
     PBYTE pRawPacket;
     UINT32 rawPacketLength;
+    // Pool the packet belongs to, NULL for packets owned by whoever allocated them
+    PRtpPacketPool pPool;
+    // References held on a pooled packet. freeRtpPacketAndRawPacket drops one and the packet goes back to the pool on the last
+    volatile SIZE_T refCount;
+    // Time the packet came off the network, 0 if it was not received
+    UINT64 receivedTime;
+    // Size of the raw packet buffer of a pooled packet, above the pool buffer size for packets that do not fit in one
+    UINT32 rawPacketBufferSize;
 };
 typedef RtpPacket* PRtpPacket;
 
+/*
+ * RtpPacketPool hands out packets whose raw packet buffer of bufferSize bytes lives in the same allocation, so that a
+ * received packet can be decrypted, parsed and held by the jitter buffer in place. Packets are reference counted and
+ * released ones are kept for reuse, up to capacity of them, instead of going back to the heap. Thread safe.
+ */
+struct __RtpPacketPool {
+    MUTEX lock;
+    UINT32 bufferSize;
+    UINT32 capacity;
+    // Stack of released packets ready for reuse
+    PRtpPacket* pFreePackets;
+    UINT32 freePacketCount;
+    // Packets currently handed out
+    volatile SIZE_T outstandingCount;
+    // Number of packets allocated from the heap. Stays flat once the pool is warm
+    volatile SIZE_T allocationCount;
+};
+
+/*
+ * RtpPacketRing lets a packetizer write finished wire format packets straight into caller provided slots.
+ * The packetizer acquires the payload area of the next slot, writes the payload in place and commits it, at
+ * which point the fixed RTP header is written in front of it. Nothing leaves the ring before the whole frame is
+ * packetized: once all slots are used up acquiring fails with STATUS_BUFFER_TOO_SMALL and the caller starts over
+ * with more slots. On finish the last packet gets the marker bit and the packets are ready to be sent.
+ */
+typedef struct {
+    UINT8 payloadType;
+    // Sequence number of the next packet, advanced on every commit
+    UINT16 sequenceNumber;
+    UINT32 timestamp;
+    UINT32 ssrc;
+
+    // slotCount slots of slotSize bytes each, with a packet descriptor per slot
+    PRtpPacket pPackets;
+    PBYTE pSlots;
+    // Or, when set, slotCount packets whose raw packet buffers of at least slotSize bytes are the slots, e.g. pooled
+    // packets that are handed over as they are once the frame is packetized
+    PRtpPacket* ppPackets;
+    UINT32 slotSize;
+    UINT32 slotCount;
+    // Bytes at the end of every slot that are never written by the packetizer, e.g. room for the SRTP auth tag
+    UINT32 slotTailroom;
+
+    // Header extension copied into every packet, a multiple of 4 bytes long. No extension when extensionLength is 0
+    UINT16 extensionProfile;
+    UINT32 extensionLength;
+    PBYTE extensionPayload;
+
+    // Number of committed packets, the first packetCount slots
+    UINT32 packetCount;
+} RtpPacketRing, *PRtpPacketRing;
+
+// Packet descriptor and raw packet buffer of a slot of the ring
+#define RTP_PACKET_RING_PACKET(pRing, i) ((pRing)->ppPackets != NULL ? (pRing)->ppPackets[i] : (pRing)->pPackets + (i))
+#define RTP_PACKET_RING_SLOT(pRing, i) ((pRing)->ppPackets != NULL ? (pRing)->ppPackets[i]->pRawPacket : (pRing)->pSlots + (i) * (pRing)->slotSize)
+
+// Size of the header the ring writes in front of the payload of every packet
+#define RTP_PACKET_RING_HEADER_LENGTH(pRing) (MIN_HEADER_LENGTH + \
+    ((pRing)->extensionLength > 0 ? RTP_HEADER_EXTENSION_HEADER_LENGTH + (pRing)->extensionLength : 0))
+
 STATUS createRtpPacket(UINT8, BOOL, BOOL, UINT8, BOOL, UINT8, UINT16, UINT32, UINT32, PUINT32, UINT16, UINT32, PBYTE, PBYTE, UINT32, PRtpPacket*);
 STATUS setRtpPacket(UINT8, BOOL, BOOL, UINT8, BOOL, UINT8, UINT16, UINT32, UINT32, PUINT32, UINT16, UINT32, PBYTE, PBYTE, UINT32, PRtpPacket);
 STATUS freeRtpPacket(PRtpPacket*);
@@ -98,7 +185,108 @@ STATUS constructRetransmitRtpPacketFromBytes(PBYTE, UINT32, UINT16, UINT8, UINT3
 STATUS setRtpPacketFromBytes(PBYTE, UINT32, PRtpPacket);
 STATUS createBytesFromRtpPacket(PRtpPacket, PBYTE, PUINT32);
 STATUS setBytesFromRtpPacket(PRtpPacket, PBYTE, UINT32);
-STATUS constructRtpPackets(PPayloadArray, UINT8, UINT16, UINT32, UINT32, PRtpPacket, UINT32);
+
+/**
+ * Set up a packet for every payload of the array, only the last one gets the marker bit
+ *
+ * @param - PPayloadArray - IN - Payloads
+ * @param - UINT8 - IN - Payload type
+ * @param - UINT16 - IN - Sequence number of the first packet
+ * @param - UINT32 - IN - RTP timestamp
+ * @param - UINT32 - IN - Ssrc
+ * @param - UINT16 - IN - Header extension profile
+ * @param - UINT32 - IN - Header extension length, a multiple of 4 bytes, 0 for no extension
+ * @param - PBYTE - IN - Header extension shared by all the packets, NULL for no extension
+ * @param - PRtpPacket - OUT - Packets
+ * @param - UINT32 - IN - Number of packets that fit
+ *
+ * @return - STATUS status of execution
+ */
+STATUS constructRtpPackets(PPayloadArray, UINT8, UINT16, UINT32, UINT32, UINT16, UINT32, PBYTE, PRtpPacket, UINT32);
+
+/**
+ * Find an element of the RFC 8285 header extension of a serialized packet
+ *
+ * @param - PBYTE - IN - Serialized packet
+ * @param - UINT32 - IN - Packet length
+ * @param - UINT8 - IN - Id of the element
+ * @param - PBYTE* - OUT - Data of the element in the packet, NULL if the packet does not carry it
+ * @param - PUINT32 - OUT - Length of the data
+ *
+ * @return - STATUS status of execution
+ */
+STATUS getRtpHeaderExtensionFromBytes(PBYTE, UINT32, UINT8, PBYTE*, PUINT32);
+
+STATUS rtpPacketRingAcquire(PRtpPacketRing, PBYTE*, PUINT32);
+STATUS rtpPacketRingCommit(PRtpPacketRing, UINT32);
+STATUS rtpPacketRingFinish(PRtpPacketRing);
+
+/**
+ * Append a segment of depayloaded data, or only count it when there is nowhere to write segments to
+ *
+ * @param - PRtcFrameSegment - IN - Segments, NULL to only count
+ * @param - UINT32 - IN - Number of segments that fit
+ * @param - PUINT32 - IN/OUT - Number of segments so far
+ * @param - PBYTE - IN - Data of the segment
+ * @param - UINT32 - IN - Size of the segment
+ *
+ * @return - STATUS status of execution
+ */
+STATUS appendFrameSegment(PRtcFrameSegment, UINT32, PUINT32, PBYTE, UINT32);
+
+/**
+ * Create a packet pool
+ *
+ * @param - UINT32 - IN - Raw packet buffer size of every packet
+ * @param - UINT32 - IN - Maximum number of released packets kept for reuse
+ * @param - PRtpPacketPool* - OUT - Created pool
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtpPacketPool(UINT32, UINT32, PRtpPacketPool*);
+
+/**
+ * Free the pool. All packets handed out must have been released already.
+ *
+ * @param - PRtpPacketPool* - IN/OUT - Pool to free
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeRtpPacketPool(PRtpPacketPool*);
+
+/**
+ * Get a packet holding a single reference, with pRawPacket pointing to bufferSize bytes and rawPacketLength set to 0.
+ * The reference is dropped with freeRtpPacketAndRawPacket.
+ *
+ * @param - PRtpPacketPool - IN - Pool
+ * @param - PRtpPacket* - OUT - Packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtpPacketPoolGet(PRtpPacketPool, PRtpPacket*);
+
+/**
+ * Get a packet like rtpPacketPoolGet whose raw packet buffer holds at least the given number of bytes. A packet larger
+ * than the buffers of the pool is allocated for the occasion and goes back to the heap instead of the pool once released.
+ *
+ * @param - PRtpPacketPool - IN - Pool
+ * @param - UINT32 - IN - Minimum raw packet buffer size
+ * @param - PRtpPacket* - OUT - Packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtpPacketPoolGetWithSize(PRtpPacketPool, UINT32, PRtpPacket*);
+
+/**
+ * Take an additional reference on a pooled packet so that it can be handed to a new owner
+ *
+ * @param - PRtpPacket - IN - Pooled packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS rtpPacketAddReference(PRtpPacket);
+
+STATUS rtpPacketPoolRelease(PRtpPacketPool, PRtpPacket);
 
 #ifdef  __cplusplus
 
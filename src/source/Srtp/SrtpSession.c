@@ -4,7 +4,6 @@
 STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, SRTP_PROFILE profile, PSrtpSession* ppSrtpSession)
 {
     ENTERS();
-    UNUSED_PARAM(profile);
 
     STATUS retStatus = STATUS_SUCCESS;
     PSrtpSession pSrtpSession = NULL;
@@ -28,6 +27,15 @@ STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, SRTP_PROFILE profile
             srtp_policy_setter = srtp_crypto_policy_set_rtp_default;
             srtcp_policy_setter = srtp_crypto_policy_set_rtp_default;
             break;
+        // https://tools.ietf.org/html/rfc7714#section-14.2, RTCP is protected with the same AEAD
+        case SRTP_PROFILE_AEAD_AES_128_GCM:
+            srtp_policy_setter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            srtcp_policy_setter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            break;
+        case SRTP_PROFILE_AEAD_AES_256_GCM:
+            srtp_policy_setter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            srtcp_policy_setter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            break;
         default:
             CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
     }
@@ -135,3 +143,18 @@ CleanUp:
     return retStatus;
 }
 
+STATUS encryptRtcpPacket(PSrtpSession pSrtpSession, PVOID message, PINT32 len)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    srtp_err_status_t status;
+
+    status = srtp_protect_rtcp(pSrtpSession->srtp_transmit_session, message, len);
+
+    CHK_ERR(status == srtp_err_status_ok, STATUS_SRTP_ENCRYPT_FAILED,
+            "srtp_protect_rtcp returned %lu on srtp session %llu", status, pSrtpSession->srtp_transmit_session);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
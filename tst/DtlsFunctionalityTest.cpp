@@ -0,0 +1,273 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video { namespace webrtcclient {
+
+class DtlsFunctionalityTest : public WebRtcClientTestBase {
+};
+
+#define DTLS_TEST_POOL_READY_TIMEOUT (30 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// Waits for the background generator to fill the given number of slots
+BOOL waitForDtlsCertificatePool(UINT32 readyCount)
+{
+    UINT32 currentReadyCount = 0;
+    UINT64 deadline = GETTIME() + DTLS_TEST_POOL_READY_TIMEOUT;
+
+    while (GETTIME() < deadline) {
+        EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolGetStats(&currentReadyCount, NULL, NULL));
+        if (currentReadyCount >= readyCount) {
+            return TRUE;
+        }
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    return FALSE;
+}
+
+TEST_F(DtlsFunctionalityTest, pooledSessionsShareSslCtx)
+{
+    DtlsCertificatePoolConfiguration configuration;
+    DtlsSessionCallbacks callbacks;
+    PDtlsSession pDtlsSessions[4] = {NULL};
+    CHAR fingerprints[4][CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    UINT64 hitCount, missCount;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(DtlsCertificatePoolConfiguration));
+    MEMSET(&callbacks, 0x00, SIZEOF(DtlsSessionCallbacks));
+    MEMSET(fingerprints, 0x00, SIZEOF(fingerprints));
+
+    EXPECT_EQ(STATUS_NULL_ARG, initDtlsCertificatePool(NULL));
+    configuration.certificateCount = MAX_DTLS_CERTIFICATE_POOL_SIZE + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, initDtlsCertificatePool(&configuration));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, dtlsCertificatePoolGetStats(NULL, NULL, NULL));
+
+    configuration.certificateCount = 2;
+    EXPECT_EQ(STATUS_SUCCESS, initDtlsCertificatePool(&configuration));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, initDtlsCertificatePool(&configuration));
+    EXPECT_TRUE(waitForDtlsCertificatePool(2));
+
+    // The two ready certificates are handed out in turns
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, FALSE, NULL, &pDtlsSessions[i]));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSessions[i], fingerprints[i], SIZEOF(fingerprints[i])));
+    }
+
+    EXPECT_EQ(pDtlsSessions[0]->pSslCtx, pDtlsSessions[2]->pSslCtx);
+    EXPECT_NE(pDtlsSessions[0]->pSslCtx, pDtlsSessions[1]->pSslCtx);
+    EXPECT_NE(pDtlsSessions[0]->pSsl, pDtlsSessions[2]->pSsl);
+    EXPECT_STREQ(fingerprints[0], fingerprints[2]);
+    EXPECT_STRNE(fingerprints[0], fingerprints[1]);
+
+    // A session asking for a different kind of certificate generates its own
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, TRUE, NULL, &pDtlsSessions[3]));
+    EXPECT_NE(pDtlsSessions[0]->pSslCtx, pDtlsSessions[3]->pSslCtx);
+    EXPECT_NE(pDtlsSessions[1]->pSslCtx, pDtlsSessions[3]->pSslCtx);
+
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolGetStats(NULL, &hitCount, &missCount));
+    EXPECT_EQ(3, hitCount);
+    EXPECT_EQ(0, missCount);
+
+    // Sessions outlive the pool
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSessions[0]));
+    EXPECT_EQ(STATUS_SUCCESS, deinitDtlsCertificatePool());
+    EXPECT_EQ(STATUS_SUCCESS, deinitDtlsCertificatePool());
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSessions[2], fingerprints[3], SIZEOF(fingerprints[3])));
+    EXPECT_STREQ(fingerprints[0], fingerprints[3]);
+
+    for (i = 0; i < ARRAY_SIZE(pDtlsSessions); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSessions[i]));
+    }
+}
+
+TEST_F(DtlsFunctionalityTest, certificatesAreReplacedByAge)
+{
+    DtlsCertificatePoolConfiguration configuration;
+    DtlsSessionCallbacks callbacks;
+    PDtlsSession pOldDtlsSession = NULL, pDtlsSession = NULL;
+    CHAR oldFingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1], fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    UINT64 deadline;
+    BOOL replaced = FALSE;
+    SSL* pSsl = NULL;
+
+    MEMSET(&configuration, 0x00, SIZEOF(DtlsCertificatePoolConfiguration));
+    MEMSET(&callbacks, 0x00, SIZEOF(DtlsSessionCallbacks));
+    MEMSET(oldFingerprint, 0x00, SIZEOF(oldFingerprint));
+    MEMSET(fingerprint, 0x00, SIZEOF(fingerprint));
+
+    configuration.certificateCount = 1;
+    configuration.maxCertificateAge = 100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS, initDtlsCertificatePool(&configuration));
+    EXPECT_TRUE(waitForDtlsCertificatePool(1));
+
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, FALSE, NULL, &pOldDtlsSession));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pOldDtlsSession, oldFingerprint, SIZEOF(oldFingerprint)));
+
+    deadline = GETTIME() + DTLS_TEST_POOL_READY_TIMEOUT;
+    while (!replaced && GETTIME() < deadline) {
+        THREAD_SLEEP(20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, FALSE, NULL, &pDtlsSession));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSession, fingerprint, SIZEOF(fingerprint)));
+        replaced = pDtlsSession->pSslCtx != pOldDtlsSession->pSslCtx;
+        EXPECT_EQ(replaced, STRCMP(fingerprint, oldFingerprint) != 0);
+        EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSession));
+    }
+
+    EXPECT_TRUE(replaced);
+
+    // The session using the replaced certificate still works with it
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pOldDtlsSession, fingerprint, SIZEOF(fingerprint)));
+    EXPECT_STREQ(oldFingerprint, fingerprint);
+    EXPECT_EQ(STATUS_SUCCESS, createSsl(pOldDtlsSession->pSslCtx, &pSsl));
+    EXPECT_TRUE(pSsl != NULL);
+    SSL_free(pSsl);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pOldDtlsSession));
+    EXPECT_EQ(STATUS_SUCCESS, deinitDtlsCertificatePool());
+}
+
+#define DTLS_TEST_HANDSHAKE_TIMEOUT (5 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+struct DtlsTestPackets {
+    std::mutex lock;
+    std::vector<std::vector<BYTE>> packets;
+};
+
+VOID onDtlsTestOutboundPacket(UINT64 customData, PBYTE pPacket, UINT32 packetLen)
+{
+    DtlsTestPackets* pPackets = (DtlsTestPackets*) customData;
+    std::lock_guard<std::mutex> lock(pPackets->lock);
+    pPackets->packets.push_back(std::vector<BYTE>(pPacket, pPacket + packetLen));
+}
+
+// Delivers the packets one session sent to the other
+VOID dtlsTestDeliverPackets(DtlsTestPackets* pPackets, PDtlsSession pDtlsSession)
+{
+    std::vector<std::vector<BYTE>> packets;
+    INT32 packetLen;
+
+    {
+        std::lock_guard<std::mutex> lock(pPackets->lock);
+        packets.swap(pPackets->packets);
+    }
+
+    for (auto& packet : packets) {
+        packetLen = (INT32) packet.size();
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionProcessPacket(pDtlsSession, packet.data(), &packetLen));
+    }
+}
+
+// Runs a handshake between a client and a server offering the given profiles, NULL offers the default ones
+BOOL dtlsTestHandshake(PRTC_SRTP_PROFILE pClientProfiles, PRTC_SRTP_PROFILE pServerProfiles,
+                       PDtlsKeyingMaterial pClientKeyingMaterial, PDtlsKeyingMaterial pServerKeyingMaterial)
+{
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    DtlsSessionCallbacks callbacks;
+    DtlsTestPackets clientPackets, serverPackets;
+    PDtlsSession pClient = NULL, pServer = NULL;
+    BOOL clientFinished = FALSE, serverFinished = FALSE;
+    UINT64 deadline;
+
+    MEMSET(&callbacks, 0x00, SIZEOF(DtlsSessionCallbacks));
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+
+    callbacks.outboundPacketFn = onDtlsTestOutboundPacket;
+    callbacks.outBoundPacketFnCustomData = (UINT64) &clientPackets;
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pClient));
+    callbacks.outBoundPacketFnCustomData = (UINT64) &serverPackets;
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pServer));
+
+    if (pClientProfiles != NULL) {
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionSetSrtpProfiles(pClient, pClientProfiles, MAX_RTCCONFIGURATION_SRTP_PROFILES));
+    }
+    if (pServerProfiles != NULL) {
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionSetSrtpProfiles(pServer, pServerProfiles, MAX_RTCCONFIGURATION_SRTP_PROFILES));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionStart(pServer, TRUE));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionStart(pClient, FALSE));
+
+    deadline = GETTIME() + DTLS_TEST_HANDSHAKE_TIMEOUT;
+    while (!(clientFinished && serverFinished) && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        dtlsTestDeliverPackets(&clientPackets, pServer);
+        dtlsTestDeliverPackets(&serverPackets, pClient);
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionIsInitFinished(pClient, &clientFinished));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionIsInitFinished(pServer, &serverFinished));
+    }
+
+    if (clientFinished && serverFinished) {
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pClient, pClientKeyingMaterial));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pServer, pServerKeyingMaterial));
+    }
+
+    // Freeing the sessions cancels their timers
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pClient));
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pServer));
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueFree(&timerQueueHandle));
+
+    return clientFinished && serverFinished;
+}
+
+VOID expectSameKeyingMaterial(PDtlsKeyingMaterial pClientKeyingMaterial, PDtlsKeyingMaterial pServerKeyingMaterial, SRTP_PROFILE srtpProfile,
+                              UINT32 keyLength)
+{
+    EXPECT_EQ(srtpProfile, pClientKeyingMaterial->srtpProfile);
+    EXPECT_EQ(srtpProfile, pServerKeyingMaterial->srtpProfile);
+    EXPECT_EQ(keyLength, pClientKeyingMaterial->key_length);
+    EXPECT_EQ(keyLength, pServerKeyingMaterial->key_length);
+    EXPECT_EQ(0, MEMCMP(pClientKeyingMaterial->clientWriteKey, pServerKeyingMaterial->clientWriteKey, keyLength));
+    EXPECT_EQ(0, MEMCMP(pClientKeyingMaterial->serverWriteKey, pServerKeyingMaterial->serverWriteKey, keyLength));
+    EXPECT_NE(0, MEMCMP(pClientKeyingMaterial->clientWriteKey, pClientKeyingMaterial->serverWriteKey, keyLength));
+}
+
+TEST_F(DtlsFunctionalityTest, srtpProfileNegotiation)
+{
+    DtlsKeyingMaterial clientKeyingMaterial, serverKeyingMaterial;
+    RTC_SRTP_PROFILE noProfiles[MAX_RTCCONFIGURATION_SRTP_PROFILES] = {RTC_SRTP_PROFILE_NONE};
+    RTC_SRTP_PROFILE cmProfiles[MAX_RTCCONFIGURATION_SRTP_PROFILES] = {RTC_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80};
+    RTC_SRTP_PROFILE gcmProfiles[MAX_RTCCONFIGURATION_SRTP_PROFILES] = {RTC_SRTP_PROFILE_AEAD_AES_256_GCM,
+                                                                         RTC_SRTP_PROFILE_AEAD_AES_128_GCM};
+
+    MEMSET(&clientKeyingMaterial, 0x00, SIZEOF(DtlsKeyingMaterial));
+    MEMSET(&serverKeyingMaterial, 0x00, SIZEOF(DtlsKeyingMaterial));
+
+    // AES-GCM is preferred by default
+    EXPECT_TRUE(dtlsTestHandshake(NULL, noProfiles, &clientKeyingMaterial, &serverKeyingMaterial));
+    expectSameKeyingMaterial(&clientKeyingMaterial, &serverKeyingMaterial, SRTP_PROFILE_AEAD_AES_128_GCM,
+                             SRTP_AES_128_MASTER_KEY_LEN + SRTP_AEAD_SALT_KEY_LEN);
+
+    // A peer without AES-GCM
+    EXPECT_TRUE(dtlsTestHandshake(cmProfiles, NULL, &clientKeyingMaterial, &serverKeyingMaterial));
+    expectSameKeyingMaterial(&clientKeyingMaterial, &serverKeyingMaterial, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80,
+                             SRTP_AES_128_MASTER_KEY_LEN + SRTP_AES_CM_SALT_KEY_LEN);
+
+    // The server picks by its own preference
+    EXPECT_TRUE(dtlsTestHandshake(NULL, gcmProfiles, &clientKeyingMaterial, &serverKeyingMaterial));
+    expectSameKeyingMaterial(&clientKeyingMaterial, &serverKeyingMaterial, SRTP_PROFILE_AEAD_AES_256_GCM,
+                             SRTP_AES_256_MASTER_KEY_LEN + SRTP_AEAD_SALT_KEY_LEN);
+}
+
+TEST_F(DtlsFunctionalityTest, setSrtpProfilesValidatesProfiles)
+{
+    DtlsSessionCallbacks callbacks;
+    PDtlsSession pDtlsSession = NULL;
+    RTC_SRTP_PROFILE profiles[MAX_RTCCONFIGURATION_SRTP_PROFILES] = {RTC_SRTP_PROFILE_AEAD_AES_128_GCM,
+                                                                      (RTC_SRTP_PROFILE) 0x0003};
+
+    MEMSET(&callbacks, 0x00, SIZEOF(DtlsSessionCallbacks));
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, FALSE, NULL, &pDtlsSession));
+
+    EXPECT_EQ(STATUS_NULL_ARG, dtlsSessionSetSrtpProfiles(NULL, profiles, ARRAY_SIZE(profiles)));
+    EXPECT_EQ(STATUS_NULL_ARG, dtlsSessionSetSrtpProfiles(pDtlsSession, NULL, ARRAY_SIZE(profiles)));
+    EXPECT_EQ(STATUS_SSL_UNKNOWN_SRTP_PROFILE, dtlsSessionSetSrtpProfiles(pDtlsSession, profiles, ARRAY_SIZE(profiles)));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionSetSrtpProfiles(pDtlsSession, profiles, 1));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSession));
+}
+
+}
+}
+}
+}
+}
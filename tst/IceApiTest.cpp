@@ -25,6 +25,8 @@ namespace com { namespace amazonaws { namespace kinesis { namespace video { name
         EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&localhost, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pDummySocketConnection));
 
         EXPECT_NE(STATUS_SUCCESS, createConnectionListener(NULL));
+        EXPECT_NE(STATUS_SUCCESS, createConnectionListenerWithReceiveBatchSize(0, NULL));
+        EXPECT_NE(STATUS_SUCCESS, createConnectionListenerWithReceiveBatchSize(CONNECTION_LISTENER_MAX_RECEIVE_BATCH_SIZE + 1, &pConnectionListener));
         EXPECT_NE(STATUS_SUCCESS, freeConnectionListener(NULL));
         EXPECT_NE(STATUS_SUCCESS, connectionListenerRemoveConnection(NULL, NULL));
         EXPECT_NE(STATUS_SUCCESS, connectionListenerAddConnection(NULL, NULL));
@@ -192,12 +192,17 @@ namespace com { namespace amazonaws { namespace kinesis { namespace video { name
         EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(pConnectionListener->connectionList, &newConnectionCount));
         EXPECT_EQ(connectionCount, newConnectionCount);
 
-        EXPECT_EQ(TRUE, IS_VALID_TID_VALUE(pConnectionListener->receiveDataRoutine));
-        ATOMIC_STORE_BOOL(&pConnectionListener->terminate, TRUE);
+        if (pConnectionListener->pEventLoop != NULL) {
+            // served by the shared event loop, no thread of its own
+            EXPECT_FALSE(IS_VALID_TID_VALUE(pConnectionListener->receiveDataRoutine));
+        } else {
+            EXPECT_EQ(TRUE, IS_VALID_TID_VALUE(pConnectionListener->receiveDataRoutine));
+            ATOMIC_STORE_BOOL(&pConnectionListener->terminate, TRUE);
 
-        THREAD_SLEEP((SOCKET_WAIT_FOR_DATA_TIMEOUT_SECONDS + 1) * HUNDREDS_OF_NANOS_IN_A_SECOND);
+            THREAD_SLEEP((SOCKET_WAIT_FOR_DATA_TIMEOUT_SECONDS + 1) * HUNDREDS_OF_NANOS_IN_A_SECOND);
 
-        EXPECT_EQ(FALSE, ATOMIC_LOAD_BOOL(&pConnectionListener->listenerRoutineStarted));
+            EXPECT_EQ(FALSE, ATOMIC_LOAD_BOOL(&pConnectionListener->listenerRoutineStarted));
+        }
 
         EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
 
@@ -212,6 +217,408 @@ namespace com { namespace amazonaws { namespace kinesis { namespace video { name
         }
     }
 
+    TEST_F(IceFunctionalityTest, socketConnectionSendDataBatchTest)
+    {
+        PSocketConnection pSender = NULL, pReceiver = NULL;
+        KvsIpAddress senderAddress, receiverAddress;
+        BYTE packets[90][1200], receiveBuffer[2000];
+        PBYTE packetPointers[90];
+        UINT32 packetLengths[90], i, receivedCount, mismatchCount, attempts;
+        BOOL gsoEnabled;
+        SSIZE_T readLength;
+
+        MEMSET(&senderAddress, 0x00, SIZEOF(KvsIpAddress));
+        senderAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        // 127.0.0.1
+        senderAddress.address[0] = 0x7f;
+        senderAddress.address[3] = 0x01;
+        receiverAddress = senderAddress;
+
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&senderAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pSender));
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&receiverAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pReceiver));
+
+        // Runs of full sized packets broken up by shorter ones, like the packets of a frame
+        for (i = 0; i < ARRAY_SIZE(packets); i++) {
+            packetLengths[i] = i % 17 == 5 ? 300 : (i % 23 == 7 ? 100 : SIZEOF(packets[i]));
+            packetPointers[i] = packets[i];
+            MEMSET(packets[i], (BYTE) i, packetLengths[i]);
+        }
+
+        // Once with whatever the kernel supports and once forcing plain sendmmsg
+        for (gsoEnabled = pSender->gsoEnabled;; gsoEnabled = FALSE) {
+            pSender->gsoEnabled = gsoEnabled;
+            EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataBatch(pSender, packetPointers, packetLengths, ARRAY_SIZE(packets), &receiverAddress));
+
+            receivedCount = 0;
+            mismatchCount = 0;
+            for (attempts = 0; receivedCount < ARRAY_SIZE(packets) && attempts < 100;) {
+                readLength = recv(pReceiver->localSocket, receiveBuffer, SIZEOF(receiveBuffer), 0);
+                if (readLength < 0) {
+                    THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+                    attempts++;
+                    continue;
+                }
+
+                if ((UINT32) readLength != packetLengths[receivedCount] || receiveBuffer[0] != (BYTE) receivedCount) {
+                    mismatchCount++;
+                }
+                receivedCount++;
+            }
+
+            EXPECT_EQ(ARRAY_SIZE(packets), receivedCount);
+            EXPECT_EQ(0, mismatchCount);
+
+            if (!gsoEnabled) {
+                break;
+            }
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+    }
+
+    typedef struct {
+        volatile ATOMIC_BOOL outOfOrder;
+        volatile SIZE_T receivedCount;
+    } BatchReceiveCustomData, *PBatchReceiveCustomData;
+
+    STATUS batchReceiveDataAvailable(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                     PKvsIpAddress pSrc, PKvsIpAddress pDest)
+    {
+        PBatchReceiveCustomData pCustomData = (PBatchReceiveCustomData) customData;
+        UNUSED_PARAM(pSocketConnection);
+        UNUSED_PARAM(pDest);
+
+        if (pSrc == NULL || bufferLen != 100 + pBuffer[0] || pBuffer[0] != (BYTE) pCustomData->receivedCount) {
+            ATOMIC_STORE_BOOL(&pCustomData->outOfOrder, TRUE);
+        }
+        ATOMIC_INCREMENT(&pCustomData->receivedCount);
+
+        return STATUS_SUCCESS;
+    }
+
+    TEST_F(IceFunctionalityTest, connectionListenerBatchReceiveTest)
+    {
+        PConnectionListener pConnectionListener = NULL;
+        PSocketConnection pSender = NULL, pReceiver = NULL;
+        BatchReceiveCustomData customData;
+        KvsIpAddress senderAddress, receiverAddress;
+        BYTE packets[200][300];
+        PBYTE packetPointers[200];
+        UINT32 packetLengths[200], i;
+
+        MEMSET(&senderAddress, 0x00, SIZEOF(KvsIpAddress));
+        senderAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        // 127.0.0.1
+        senderAddress.address[0] = 0x7f;
+        senderAddress.address[3] = 0x01;
+        receiverAddress = senderAddress;
+        ATOMIC_STORE_BOOL(&customData.outOfOrder, FALSE);
+        ATOMIC_STORE(&customData.receivedCount, 0);
+
+        EXPECT_EQ(STATUS_SUCCESS, createConnectionListenerWithReceiveBatchSize(8, &pConnectionListener));
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&senderAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pSender));
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&receiverAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, (UINT64) &customData,
+                                                         batchReceiveDataAvailable, 0, &pReceiver));
+        ATOMIC_STORE_BOOL(&pReceiver->receiveData, TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pReceiver));
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+        // More datagrams than a batch holds, with a length that identifies each of them
+        for (i = 0; i < ARRAY_SIZE(packets); i++) {
+            packetLengths[i] = 100 + (i % 200);
+            packetPointers[i] = packets[i];
+            MEMSET(packets[i], (BYTE) i, packetLengths[i]);
+        }
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataBatch(pSender, packetPointers, packetLengths, ARRAY_SIZE(packets), &receiverAddress));
+
+        for (i = 0; i < 100 && ATOMIC_LOAD(&customData.receivedCount) < ARRAY_SIZE(packets); i++) {
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+        EXPECT_EQ(ARRAY_SIZE(packets), ATOMIC_LOAD(&customData.receivedCount));
+        EXPECT_FALSE(ATOMIC_LOAD_BOOL(&customData.outOfOrder));
+
+        EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+    }
+
+    TEST_F(IceFunctionalityTest, connectionListenerSharedEventLoopTest)
+    {
+        PConnectionListener pConnectionListeners[8];
+        PSocketConnection pSender = NULL, pReceivers[ARRAY_SIZE(pConnectionListeners)];
+        BatchReceiveCustomData customData[ARRAY_SIZE(pConnectionListeners)];
+        KvsIpAddress senderAddress, receiverAddress;
+        BYTE packets[16][200];
+        PBYTE packetPointers[16];
+        UINT32 packetLengths[16], i, j;
+
+        MEMSET(&senderAddress, 0x00, SIZEOF(KvsIpAddress));
+        senderAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        // 127.0.0.1
+        senderAddress.address[0] = 0x7f;
+        senderAddress.address[3] = 0x01;
+        receiverAddress = senderAddress;
+
+        for (i = 0; i < ARRAY_SIZE(packets); i++) {
+            packetLengths[i] = 100 + i;
+            packetPointers[i] = packets[i];
+            MEMSET(packets[i], (BYTE) i, packetLengths[i]);
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&senderAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pSender));
+
+        // One listener per simulated peer connection, alternating between single and batched receive
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            ATOMIC_STORE_BOOL(&customData[i].outOfOrder, FALSE);
+            ATOMIC_STORE(&customData[i].receivedCount, 0);
+            // bind each receiver to its own ephemeral port
+            receiverAddress.port = 0;
+            EXPECT_EQ(STATUS_SUCCESS, createConnectionListenerWithReceiveBatchSize(i % 2 == 0 ? 1 : 4, &pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&receiverAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, (UINT64) &customData[i],
+                                                             batchReceiveDataAvailable, 0, &pReceivers[i]));
+            ATOMIC_STORE_BOOL(&pReceivers[i]->receiveData, TRUE);
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListeners[i], pReceivers[i]));
+            if (pConnectionListeners[i]->pEventLoop != NULL) {
+                EXPECT_FALSE(IS_VALID_TID_VALUE(pConnectionListeners[i]->receiveDataRoutine));
+            }
+        }
+
+        // The first listener stops receiving once its connection is removed
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListeners[0], pReceivers[0]));
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            receiverAddress.port = pReceivers[i]->hostIpAddr.port;
+            EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataBatch(pSender, packetPointers, packetLengths, ARRAY_SIZE(packets), &receiverAddress));
+        }
+
+        for (j = 0; j < 100; j++) {
+            for (i = 1; i < ARRAY_SIZE(pConnectionListeners) && ATOMIC_LOAD(&customData[i].receivedCount) == ARRAY_SIZE(packets); i++);
+            if (i == ARRAY_SIZE(pConnectionListeners)) {
+                break;
+            }
+
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+        EXPECT_EQ(0, ATOMIC_LOAD(&customData[0].receivedCount));
+        for (i = 1; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            EXPECT_EQ(ARRAY_SIZE(packets), ATOMIC_LOAD(&customData[i].receivedCount));
+            EXPECT_FALSE(ATOMIC_LOAD_BOOL(&customData[i].outOfOrder));
+        }
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceivers[i]));
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    }
+
+#if defined(__linux__)
+    // I/O workers are only available on linux
+    TEST_F(IceFunctionalityTest, connectionListenerIoWorkerShardingTest)
+    {
+        PConnectionListener pConnectionListeners[6];
+        PSocketConnection pSender = NULL, pReceivers[ARRAY_SIZE(pConnectionListeners)];
+        BatchReceiveCustomData customData[ARRAY_SIZE(pConnectionListeners)];
+        IoWorkerMetrics metrics[3];
+        KvsIpAddress senderAddress, receiverAddress;
+        BYTE packets[8][200];
+        PBYTE packetPointers[8];
+        UINT32 packetLengths[8], i, j, workerCount = 0;
+        UINT64 packetsReceived = 0;
+
+        // Restart with a known number of workers
+        EXPECT_EQ(STATUS_SUCCESS, deinitKvsWebRtc());
+        EXPECT_EQ(STATUS_INVALID_ARG, initKvsWebRtcWithIoWorkerCount(MAX_IO_WORKER_COUNT + 1));
+        EXPECT_EQ(STATUS_SUCCESS, initKvsWebRtcWithIoWorkerCount(ARRAY_SIZE(metrics)));
+
+        EXPECT_EQ(STATUS_NULL_ARG, getIoWorkerMetrics(metrics, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, getIoWorkerMetrics(NULL, &workerCount));
+        EXPECT_EQ(ARRAY_SIZE(metrics), workerCount);
+        workerCount = 1;
+        EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, getIoWorkerMetrics(metrics, &workerCount));
+        EXPECT_EQ(ARRAY_SIZE(metrics), workerCount);
+
+        MEMSET(&senderAddress, 0x00, SIZEOF(KvsIpAddress));
+        senderAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        // 127.0.0.1
+        senderAddress.address[0] = 0x7f;
+        senderAddress.address[3] = 0x01;
+        receiverAddress = senderAddress;
+
+        for (i = 0; i < ARRAY_SIZE(packets); i++) {
+            packetLengths[i] = 100 + i;
+            packetPointers[i] = packets[i];
+            MEMSET(packets[i], (BYTE) i, packetLengths[i]);
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&senderAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pSender));
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            ATOMIC_STORE_BOOL(&customData[i].outOfOrder, FALSE);
+            ATOMIC_STORE(&customData[i].receivedCount, 0);
+            receiverAddress.port = 0;
+            EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&receiverAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, (UINT64) &customData[i],
+                                                             batchReceiveDataAvailable, 0, &pReceivers[i]));
+            ATOMIC_STORE_BOOL(&pReceivers[i]->receiveData, TRUE);
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListeners[i], pReceivers[i]));
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListeners[i]));
+        }
+
+        workerCount = ARRAY_SIZE(metrics);
+        EXPECT_EQ(STATUS_SUCCESS, getIoWorkerMetrics(metrics, &workerCount));
+        EXPECT_EQ(ARRAY_SIZE(metrics), workerCount);
+        for (i = 0; i < workerCount; i++) {
+            // New listeners are spread evenly over the least loaded workers
+            EXPECT_EQ(ARRAY_SIZE(pConnectionListeners) / ARRAY_SIZE(metrics), metrics[i].peerConnectionCount);
+            EXPECT_EQ(ARRAY_SIZE(pConnectionListeners) / ARRAY_SIZE(metrics), metrics[i].socketCount);
+        }
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            receiverAddress.port = pReceivers[i]->hostIpAddr.port;
+            EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataBatch(pSender, packetPointers, packetLengths, ARRAY_SIZE(packets), &receiverAddress));
+        }
+
+        for (j = 0; j < 100; j++) {
+            for (i = 0; i < ARRAY_SIZE(pConnectionListeners) && ATOMIC_LOAD(&customData[i].receivedCount) == ARRAY_SIZE(packets); i++);
+            if (i == ARRAY_SIZE(pConnectionListeners)) {
+                break;
+            }
+
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            EXPECT_EQ(ARRAY_SIZE(packets), ATOMIC_LOAD(&customData[i].receivedCount));
+            EXPECT_FALSE(ATOMIC_LOAD_BOOL(&customData[i].outOfOrder));
+        }
+
+        // metrics are published once the worker is done with the events it picked up
+        for (j = 0; j < 100 && packetsReceived != ARRAY_SIZE(pConnectionListeners) * ARRAY_SIZE(packets); j++) {
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            workerCount = ARRAY_SIZE(metrics);
+            EXPECT_EQ(STATUS_SUCCESS, getIoWorkerMetrics(metrics, &workerCount));
+            for (i = 0, packetsReceived = 0; i < workerCount; i++) {
+                packetsReceived += metrics[i].packetsReceived;
+            }
+        }
+        EXPECT_EQ(ARRAY_SIZE(pConnectionListeners) * ARRAY_SIZE(packets), packetsReceived);
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceivers[i]));
+        }
+
+        workerCount = ARRAY_SIZE(metrics);
+        EXPECT_EQ(STATUS_SUCCESS, getIoWorkerMetrics(metrics, &workerCount));
+        for (i = 0; i < workerCount; i++) {
+            EXPECT_EQ(0, metrics[i].peerConnectionCount);
+            EXPECT_EQ(0, metrics[i].socketCount);
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    }
+
+    typedef struct {
+        volatile ATOMIC_BOOL entered;
+        volatile ATOMIC_BOOL release;
+        volatile ATOMIC_BOOL returned;
+    } BlockingReceiveCustomData, *PBlockingReceiveCustomData;
+
+    STATUS blockingReceiveDataAvailable(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                        PKvsIpAddress pSrc, PKvsIpAddress pDest)
+    {
+        PBlockingReceiveCustomData pCustomData = (PBlockingReceiveCustomData) customData;
+        UINT32 i;
+        UNUSED_PARAM(pSocketConnection);
+        UNUSED_PARAM(pBuffer);
+        UNUSED_PARAM(bufferLen);
+        UNUSED_PARAM(pSrc);
+        UNUSED_PARAM(pDest);
+
+        // Stands for an application callback that takes its time
+        ATOMIC_STORE_BOOL(&pCustomData->entered, TRUE);
+        for (i = 0; i < 1000 && !ATOMIC_LOAD_BOOL(&pCustomData->release); i++) {
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+        ATOMIC_STORE_BOOL(&pCustomData->returned, TRUE);
+
+        return STATUS_SUCCESS;
+    }
+
+    TEST_F(IceFunctionalityTest, connectionListenerRemovalDoesNotWaitForOtherSockets)
+    {
+        PConnectionListener pConnectionListeners[2];
+        PSocketConnection pSender = NULL, pReceivers[ARRAY_SIZE(pConnectionListeners)];
+        BlockingReceiveCustomData blockingCustomData;
+        BatchReceiveCustomData customData;
+        KvsIpAddress senderAddress, receiverAddress;
+        BYTE packet[100];
+        UINT32 i;
+
+        // A single worker serves both listeners
+        EXPECT_EQ(STATUS_SUCCESS, deinitKvsWebRtc());
+        EXPECT_EQ(STATUS_SUCCESS, initKvsWebRtcWithIoWorkerCount(1));
+
+        MEMSET(&senderAddress, 0x00, SIZEOF(KvsIpAddress));
+        senderAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        // 127.0.0.1
+        senderAddress.address[0] = 0x7f;
+        senderAddress.address[3] = 0x01;
+        receiverAddress = senderAddress;
+        MEMSET(packet, 0x00, SIZEOF(packet));
+        ATOMIC_STORE_BOOL(&blockingCustomData.entered, FALSE);
+        ATOMIC_STORE_BOOL(&blockingCustomData.release, FALSE);
+        ATOMIC_STORE_BOOL(&blockingCustomData.returned, FALSE);
+        ATOMIC_STORE_BOOL(&customData.outOfOrder, FALSE);
+        ATOMIC_STORE(&customData.receivedCount, 0);
+
+        EXPECT_EQ(STATUS_SUCCESS, createSocketConnection(&senderAddress, NULL, KVS_SOCKET_PROTOCOL_UDP, 0, NULL, 0, &pSender));
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            receiverAddress.port = 0;
+            EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS,
+                      createSocketConnection(&receiverAddress, NULL, KVS_SOCKET_PROTOCOL_UDP,
+                                             i == 0 ? (UINT64) &blockingCustomData : (UINT64) &customData,
+                                             i == 0 ? blockingReceiveDataAvailable : batchReceiveDataAvailable, 0, &pReceivers[i]));
+            ATOMIC_STORE_BOOL(&pReceivers[i]->receiveData, TRUE);
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListeners[i], pReceivers[i]));
+            EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListeners[i]));
+        }
+        EXPECT_EQ(pConnectionListeners[0]->pEventLoop, pConnectionListeners[1]->pEventLoop);
+
+        // Block the worker in the callback of the first socket
+        receiverAddress.port = pReceivers[0]->hostIpAddr.port;
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSender, packet, SIZEOF(packet), &receiverAddress));
+        for (i = 0; i < 100 && !ATOMIC_LOAD_BOOL(&blockingCustomData.entered); i++) {
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+        EXPECT_TRUE(ATOMIC_LOAD_BOOL(&blockingCustomData.entered));
+
+        // Closing the other socket does not wait for that callback
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListeners[1], pReceivers[1]));
+        EXPECT_FALSE(ATOMIC_LOAD_BOOL(&blockingCustomData.returned));
+        EXPECT_EQ(pReceivers[0], pConnectionListeners[0]->pEventLoop->pDispatchingSocket);
+
+        // Closing the socket being drained does
+        ATOMIC_STORE_BOOL(&blockingCustomData.release, TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListeners[0], pReceivers[0]));
+        EXPECT_TRUE(ATOMIC_LOAD_BOOL(&blockingCustomData.returned));
+
+        for (i = 0; i < ARRAY_SIZE(pConnectionListeners); i++) {
+            EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListeners[i]));
+            EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceivers[i]));
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    }
+#endif
+
     ///////////////////////////////////////////////
     // IceAgent Test
     ///////////////////////////////////////////////
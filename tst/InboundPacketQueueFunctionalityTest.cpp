@@ -0,0 +1,236 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video { namespace webrtcclient {
+
+class InboundPacketQueueFunctionalityTest : public WebRtcClientTestBase {
+};
+
+typedef struct {
+    volatile SIZE_T handledCount;
+    volatile ATOMIC_BOOL outOfOrder;
+    volatile ATOMIC_BOOL blocked;
+    volatile ATOMIC_BOOL inHandler;
+} InboundPacketQueueTestData, *PInboundPacketQueueTestData;
+
+// Every packet carries its index in the first 4 bytes and is 4 + index % 100 bytes long
+VOID inboundPacketQueueTestHandler(UINT64 customData, PRtpPacket pRtpPacket)
+{
+    PInboundPacketQueueTestData pTestData = (PInboundPacketQueueTestData) customData;
+    UINT32 index;
+
+    ATOMIC_STORE_BOOL(&pTestData->inHandler, TRUE);
+
+    // simulates a slow application callback
+    while (ATOMIC_LOAD_BOOL(&pTestData->blocked)) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    MEMCPY(&index, pRtpPacket->pRawPacket, SIZEOF(UINT32));
+    if (index != ATOMIC_LOAD(&pTestData->handledCount) || pRtpPacket->rawPacketLength != SIZEOF(UINT32) + index % 100) {
+        ATOMIC_STORE_BOOL(&pTestData->outOfOrder, TRUE);
+    }
+
+    ATOMIC_INCREMENT(&pTestData->handledCount);
+}
+
+static VOID pushIndexedPacket(PInboundPacketQueue pInboundPacketQueue, UINT32 index)
+{
+    BYTE packet[SIZEOF(UINT32) + 100];
+
+    MEMSET(packet, 0xAB, SIZEOF(packet));
+    MEMCPY(packet, &index, SIZEOF(UINT32));
+    EXPECT_EQ(STATUS_SUCCESS, inboundPacketQueuePush(pInboundPacketQueue, packet, SIZEOF(UINT32) + index % 100));
+}
+
+TEST_F(InboundPacketQueueFunctionalityTest, createInvalidArgs)
+{
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    InboundPacketQueueStats stats;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, 16, &pRtpPacketPool));
+
+    EXPECT_EQ(STATUS_NULL_ARG, createInboundPacketQueue(16, pRtpPacketPool, inboundPacketQueueTestHandler, 0, NULL));
+    EXPECT_EQ(STATUS_NULL_ARG, createInboundPacketQueue(16, NULL, inboundPacketQueueTestHandler, 0, &pInboundPacketQueue));
+    EXPECT_EQ(STATUS_NULL_ARG, createInboundPacketQueue(16, pRtpPacketPool, NULL, 0, &pInboundPacketQueue));
+    EXPECT_EQ(STATUS_INVALID_ARG, createInboundPacketQueue(0, pRtpPacketPool, inboundPacketQueueTestHandler, 0, &pInboundPacketQueue));
+    EXPECT_EQ(STATUS_INVALID_ARG, createInboundPacketQueue(INBOUND_PACKET_QUEUE_MAX_SLOT_COUNT + 1, pRtpPacketPool, inboundPacketQueueTestHandler, 0,
+                                                           &pInboundPacketQueue));
+    EXPECT_TRUE(pInboundPacketQueue == NULL);
+
+    // rounded up to a power of 2
+    EXPECT_EQ(STATUS_SUCCESS, createInboundPacketQueue(100, pRtpPacketPool, inboundPacketQueueTestHandler, 0, &pInboundPacketQueue));
+    EXPECT_EQ(128, pInboundPacketQueue->slotCount);
+
+    EXPECT_EQ(STATUS_NULL_ARG, inboundPacketQueuePush(NULL, (PBYTE) &stats, 1));
+    EXPECT_EQ(STATUS_NULL_ARG, inboundPacketQueuePush(pInboundPacketQueue, NULL, 1));
+    EXPECT_EQ(STATUS_NULL_ARG, inboundPacketQueueGetStats(pInboundPacketQueue, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeInboundPacketQueue(&pInboundPacketQueue));
+    EXPECT_TRUE(pInboundPacketQueue == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeInboundPacketQueue(&pInboundPacketQueue));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+TEST_F(InboundPacketQueueFunctionalityTest, packetsAreHandledInOrder)
+{
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    InboundPacketQueueTestData testData;
+    InboundPacketQueueStats stats;
+    UINT32 i, packetCount = 10000;
+
+    ATOMIC_STORE(&testData.handledCount, 0);
+    ATOMIC_STORE_BOOL(&testData.outOfOrder, FALSE);
+    ATOMIC_STORE_BOOL(&testData.blocked, FALSE);
+    ATOMIC_STORE_BOOL(&testData.inHandler, FALSE);
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, packetCount, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createInboundPacketQueue(packetCount, pRtpPacketPool, inboundPacketQueueTestHandler, (UINT64) &testData,
+                                                       &pInboundPacketQueue));
+
+    for (i = 0; i < packetCount; i++) {
+        pushIndexedPacket(pInboundPacketQueue, i);
+        // give the consumer a chance to go to sleep and be woken up again
+        if (i % 1000 == 0) {
+            THREAD_SLEEP(5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    }
+
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData.handledCount) < packetCount; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(packetCount, ATOMIC_LOAD(&testData.handledCount));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.outOfOrder));
+
+    EXPECT_EQ(STATUS_SUCCESS, inboundPacketQueueGetStats(pInboundPacketQueue, &stats));
+    EXPECT_EQ(packetCount, stats.packetsQueued);
+    EXPECT_EQ(0, stats.packetsDropped);
+    EXPECT_EQ(0, stats.overflowCount);
+    EXPECT_GE(stats.maxQueueDepth, 1);
+
+    // Every packet went back to the pool once handled and allocations are bounded by the queue depth
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_LE(ATOMIC_LOAD(&pRtpPacketPool->allocationCount), stats.maxQueueDepth + 1);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeInboundPacketQueue(&pInboundPacketQueue));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+TEST_F(InboundPacketQueueFunctionalityTest, slowConsumerDropsInsteadOfBlocking)
+{
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    InboundPacketQueueTestData testData;
+    InboundPacketQueueStats stats;
+    UINT32 i, slotCount = 64, extraCount = 3 * 64;
+
+    ATOMIC_STORE(&testData.handledCount, 0);
+    ATOMIC_STORE_BOOL(&testData.outOfOrder, FALSE);
+    ATOMIC_STORE_BOOL(&testData.blocked, TRUE);
+    ATOMIC_STORE_BOOL(&testData.inHandler, FALSE);
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, slotCount, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createInboundPacketQueue(slotCount, pRtpPacketPool, inboundPacketQueueTestHandler, (UINT64) &testData,
+                                                       &pInboundPacketQueue));
+
+    // The consumer takes the first packet and gets stuck in the handler. Its slot is only released once the handler
+    // returns so the queue then fills up after exactly slotCount packets.
+    pushIndexedPacket(pInboundPacketQueue, 0);
+    for (i = 0; i < 1000 && !ATOMIC_LOAD_BOOL(&testData.inHandler); i++) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_TRUE(ATOMIC_LOAD_BOOL(&testData.inHandler));
+
+    // Nothing is drained while the handler is stuck, every push past slotCount returns right away with its packet dropped
+    for (i = 1; i < slotCount + extraCount; i++) {
+        pushIndexedPacket(pInboundPacketQueue, i);
+    }
+    EXPECT_EQ(0, ATOMIC_LOAD(&testData.handledCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, inboundPacketQueueGetStats(pInboundPacketQueue, &stats));
+    EXPECT_EQ(slotCount, stats.maxQueueDepth);
+    EXPECT_EQ(1, stats.overflowCount);
+    EXPECT_EQ(slotCount, stats.packetsQueued);
+    EXPECT_EQ(extraCount, stats.packetsDropped);
+
+    // Everything that got in is handled once the application catches up
+    ATOMIC_STORE_BOOL(&testData.blocked, FALSE);
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData.handledCount) < stats.packetsQueued; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(stats.packetsQueued, ATOMIC_LOAD(&testData.handledCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeInboundPacketQueue(&pInboundPacketQueue));
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+
+typedef struct {
+    volatile SIZE_T handledCount;
+    volatile SIZE_T handledLength;
+    volatile ATOMIC_BOOL corrupted;
+} OversizedPacketTestData, *POversizedPacketTestData;
+
+VOID oversizedPacketTestHandler(UINT64 customData, PRtpPacket pRtpPacket)
+{
+    POversizedPacketTestData pTestData = (POversizedPacketTestData) customData;
+    UINT32 i;
+
+    for (i = 0; i < pRtpPacket->rawPacketLength; i++) {
+        if (pRtpPacket->pRawPacket[i] != (BYTE) i) {
+            ATOMIC_STORE_BOOL(&pTestData->corrupted, TRUE);
+        }
+    }
+
+    ATOMIC_STORE(&pTestData->handledLength, pRtpPacket->rawPacketLength);
+    ATOMIC_INCREMENT(&pTestData->handledCount);
+}
+
+TEST_F(InboundPacketQueueFunctionalityTest, packetsLargerThanPoolBuffersAreQueued)
+{
+    PInboundPacketQueue pInboundPacketQueue = NULL;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    OversizedPacketTestData testData;
+    InboundPacketQueueStats stats;
+    BYTE largePacket[1600];
+    UINT32 i;
+
+    ATOMIC_STORE(&testData.handledCount, 0);
+    ATOMIC_STORE(&testData.handledLength, 0);
+    ATOMIC_STORE_BOOL(&testData.corrupted, FALSE);
+    for (i = 0; i < SIZEOF(largePacket); i++) {
+        largePacket[i] = (BYTE) i;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, 16, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createInboundPacketQueue(16, pRtpPacketPool, oversizedPacketTestHandler, (UINT64) &testData, &pInboundPacketQueue));
+
+    EXPECT_EQ(STATUS_SUCCESS, inboundPacketQueuePush(pInboundPacketQueue, largePacket, SIZEOF(largePacket)));
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData.handledCount) == 0; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.handledCount));
+    EXPECT_EQ(SIZEOF(largePacket), ATOMIC_LOAD(&testData.handledLength));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.corrupted));
+
+    EXPECT_EQ(STATUS_SUCCESS, inboundPacketQueueGetStats(pInboundPacketQueue, &stats));
+    EXPECT_EQ(1, stats.packetsQueued);
+    EXPECT_EQ(0, stats.packetsDropped);
+
+    // The oversized packet went back to the heap rather than the pool
+    EXPECT_EQ(STATUS_SUCCESS, freeInboundPacketQueue(&pInboundPacketQueue));
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(0, pRtpPacketPool->freePacketCount);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+}
+}
+}
+}
+}
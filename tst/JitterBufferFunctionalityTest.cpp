@@ -770,6 +770,349 @@ TEST_F(JitterBufferFunctionalityTest, pushFrameArrivingLate)
     clearJitterBufferForTest();
 }
 
+TEST_F(JitterBufferFunctionalityTest, frameReleasedOnMarkerPacket)
+{
+    UINT32 i;
+    UINT32 pktCount = 6;
+    initializeJitterBuffer(4, 0, pktCount);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferSetReleaseOnMarker(mJitterBuffer, TRUE));
+
+    // First frame "1" at timestamp 100 - rtp packet #0
+    mPRtpPackets[0]->payloadLength = 1;
+    mPRtpPackets[0]->payload = (PBYTE) MEMALLOC(mPRtpPackets[0]->payloadLength + 1);
+    mPRtpPackets[0]->payload[0] = 1;
+    mPRtpPackets[0]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.marker = TRUE;
+
+    // Expected to get frame "1"
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[0][0] = 1;
+    mExpectedFrameSizeArr[0] = 1;
+
+    // Second frame "2" "3" "4" at timestamp 200 - rtp packet #1 #3 #2, the marker packet comes before the one in the middle
+    mPRtpPackets[1]->payloadLength = 1;
+    mPRtpPackets[1]->payload = (PBYTE) MEMALLOC(mPRtpPackets[1]->payloadLength + 1);
+    mPRtpPackets[1]->payload[0] = 2;
+    mPRtpPackets[1]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[1]->header.timestamp = 200;
+    mPRtpPackets[1]->header.sequenceNumber = 1;
+    mPRtpPackets[2]->payloadLength = 1;
+    mPRtpPackets[2]->payload = (PBYTE) MEMALLOC(mPRtpPackets[2]->payloadLength + 1);
+    mPRtpPackets[2]->payload[0] = 4;
+    mPRtpPackets[2]->payload[1] = 0; // Following packet of a frame
+    mPRtpPackets[2]->header.timestamp = 200;
+    mPRtpPackets[2]->header.sequenceNumber = 3;
+    mPRtpPackets[2]->header.marker = TRUE;
+    mPRtpPackets[3]->payloadLength = 1;
+    mPRtpPackets[3]->payload = (PBYTE) MEMALLOC(mPRtpPackets[3]->payloadLength + 1);
+    mPRtpPackets[3]->payload[0] = 3;
+    mPRtpPackets[3]->payload[1] = 0; // Following packet of a frame
+    mPRtpPackets[3]->header.timestamp = 200;
+    mPRtpPackets[3]->header.sequenceNumber = 2;
+
+    // Expected to get frame "234"
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(3);
+    mPExpectedFrameArr[1][0] = 2;
+    mPExpectedFrameArr[1][1] = 3;
+    mPExpectedFrameArr[1][2] = 4;
+    mExpectedFrameSizeArr[1] = 3;
+
+    // Third frame "5" at timestamp 300 without a marker bit - rtp packet #4, only ready once frame "6" starts
+    mPRtpPackets[4]->payloadLength = 1;
+    mPRtpPackets[4]->payload = (PBYTE) MEMALLOC(mPRtpPackets[4]->payloadLength + 1);
+    mPRtpPackets[4]->payload[0] = 5;
+    mPRtpPackets[4]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[4]->header.timestamp = 300;
+
+    // Expected to get frame "5"
+    mPExpectedFrameArr[2] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[2][0] = 5;
+    mExpectedFrameSizeArr[2] = 1;
+
+    // Fourth frame "6" at timestamp 400 without a marker bit - rtp packet #5
+    mPRtpPackets[5]->payloadLength = 1;
+    mPRtpPackets[5]->payload = (PBYTE) MEMALLOC(mPRtpPackets[5]->payloadLength + 1);
+    mPRtpPackets[5]->payload[0] = 6;
+    mPRtpPackets[5]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[5]->header.timestamp = 400;
+
+    // Expected to get frame "6" at close
+    mPExpectedFrameArr[3] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[3][0] = 6;
+    mExpectedFrameSizeArr[3] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < pktCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i]));
+        switch (i) {
+            case 0:
+            case 1:
+            case 2:
+                EXPECT_EQ(1, mReadyFrameIndex);
+                break;
+            case 3:
+            case 4:
+                EXPECT_EQ(2, mReadyFrameIndex);
+                break;
+            case 5:
+                EXPECT_EQ(3, mReadyFrameIndex);
+                break;
+            default:
+                ASSERT_TRUE(FALSE);
+        }
+        EXPECT_EQ(0, mDroppedFrameIndex);
+    }
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, packetReorderedAheadOfFirstPacket)
+{
+    UINT32 i = 0;
+    initializeJitterBuffer(2, 0, 3);
+
+    // First frame "1" "2" at timestamp 100 - rtp packet #0 #1, #1 arrives first
+    mPRtpPackets[0]->payloadLength = 1;
+    mPRtpPackets[0]->payload = (PBYTE) MEMALLOC(mPRtpPackets[0]->payloadLength + 1);
+    mPRtpPackets[0]->payload[0] = 2;
+    mPRtpPackets[0]->payload[1] = 0; // Following packet of a frame
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.sequenceNumber = 1;
+    mPRtpPackets[1]->payloadLength = 1;
+    mPRtpPackets[1]->payload = (PBYTE) MEMALLOC(mPRtpPackets[1]->payloadLength + 1);
+    mPRtpPackets[1]->payload[0] = 1;
+    mPRtpPackets[1]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[1]->header.timestamp = 100;
+    mPRtpPackets[1]->header.sequenceNumber = 0;
+
+    // Expected to get frame "12"
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(2);
+    mPExpectedFrameArr[0][0] = 1;
+    mPExpectedFrameArr[0][1] = 2;
+    mExpectedFrameSizeArr[0] = 2;
+
+    // Second frame "3" at timestamp 200 - rtp packet #2
+    mPRtpPackets[2]->payloadLength = 1;
+    mPRtpPackets[2]->payload = (PBYTE) MEMALLOC(mPRtpPackets[2]->payloadLength + 1);
+    mPRtpPackets[2]->payload[0] = 3;
+    mPRtpPackets[2]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[2]->header.timestamp = 200;
+    mPRtpPackets[2]->header.sequenceNumber = 2;
+
+    // Expected to get frame "3" at close
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = 3;
+    mExpectedFrameSizeArr[1] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i]));
+        EXPECT_EQ(i == 2 ? 1 : 0, mReadyFrameIndex);
+        EXPECT_EQ(0, mDroppedFrameIndex);
+    }
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, packetRingGrowsWithBufferedPackets)
+{
+    UINT32 i = 0, pktCount = 1001, initialRingSize;
+    initializeJitterBuffer(2, 0, pktCount);
+    initialRingSize = mJitterBuffer->packetRingSize;
+
+    // First frame at timestamp 100 - rtp packet #0 to #999, far more packets than the ring was sized for
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(pktCount - 1);
+    mExpectedFrameSizeArr[0] = pktCount - 1;
+    for (i = 0; i < pktCount - 1; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+        mPRtpPackets[i]->payload[1] = (i == 0); // First packet of a frame
+        mPRtpPackets[i]->header.timestamp = 100;
+        mPExpectedFrameArr[0][i] = (BYTE) i;
+    }
+
+    // Second frame at timestamp 200 - rtp packet #1000
+    mPRtpPackets[i]->payloadLength = 1;
+    mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+    mPRtpPackets[i]->payload[0] = 1;
+    mPRtpPackets[i]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[i]->header.timestamp = 200;
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = 1;
+    mExpectedFrameSizeArr[1] = 1;
+
+    setPayloadToFree();
+
+    // Push the frame backwards, every packet moves the start back and the buffered packets further away from it
+    for (i = pktCount - 1; i > 0; i--) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i - 1]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[pktCount - 1]));
+
+    EXPECT_GT(pktCount, initialRingSize);
+    EXPECT_LE(pktCount, mJitterBuffer->packetRingSize);
+    EXPECT_EQ(1, mReadyFrameIndex);
+
+    clearJitterBufferForTest();
+}
+
+typedef struct {
+    UINT32 readyFrameCount;
+    UINT32 droppedFrameCount;
+    UINT64 readyFrameBytes;
+} JitterBufferFrameCounts, *PJitterBufferFrameCounts;
+
+STATUS countFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+{
+    PJitterBufferFrameCounts pFrameCounts = (PJitterBufferFrameCounts) customData;
+
+    UNUSED_PARAM(startIndex);
+    UNUSED_PARAM(endIndex);
+    pFrameCounts->readyFrameCount++;
+    pFrameCounts->readyFrameBytes += frameSize;
+
+    return STATUS_SUCCESS;
+}
+
+STATUS countFrameDroppedFunc(UINT64 customData, UINT32 timestamp)
+{
+    PJitterBufferFrameCounts pFrameCounts = (PJitterBufferFrameCounts) customData;
+
+    UNUSED_PARAM(timestamp);
+    pFrameCounts->droppedFrameCount++;
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(JitterBufferFunctionalityTest, adaptiveLatencyFollowsHoleFillDelay)
+{
+    // One single packet frame every 20ms, received exactly on time
+    UINT32 i, frameInterval = 20, receivedOffset = 1000;
+    PRtpPacket pRtpPacket;
+    JitterBufferFrameCounts frameCounts;
+
+    MEMSET(&frameCounts, 0x00, SIZEOF(JitterBufferFrameCounts));
+    EXPECT_EQ(STATUS_SUCCESS, createJitterBuffer(countFrameReadyFunc, countFrameDroppedFunc, testDepayRtpFunc, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                                 TEST_JITTER_BUFFER_CLOCK_RATE, (UINT64) &frameCounts, &mJitterBuffer));
+    EXPECT_EQ(STATUS_INVALID_ARG, jitterBufferSetAdaptiveLatency(mJitterBuffer, DEFAULT_JITTER_BUFFER_MAX_LATENCY + 1, DEFAULT_JITTER_BUFFER_MAX_LATENCY));
+    EXPECT_EQ(STATUS_INVALID_ARG, jitterBufferSetAdaptiveLatency(mJitterBuffer, 0, 0));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferSetAdaptiveLatency(mJitterBuffer, DEFAULT_JITTER_BUFFER_MIN_LATENCY, DEFAULT_JITTER_BUFFER_MAX_LATENCY));
+    EXPECT_EQ(2000, mJitterBuffer->latency);
+
+    for (i = 0; i < 200; i++) {
+        // Frame 100 is lost and only shows up again 300ms late, frame 150 is lost for good
+        if (i == 100 || i == 150) {
+            continue;
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, createRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, i, i * frameInterval, 0x1234ABCD, NULL, 0, 0, NULL, NULL, 0,
+                                                  &pRtpPacket));
+        pRtpPacket->payloadLength = 1;
+        pRtpPacket->payload = (PBYTE) MEMCALLOC(1, pRtpPacket->payloadLength + 1);
+        pRtpPacket->payload[pRtpPacket->payloadLength] = 1;
+        pRtpPacket->pRawPacket = pRtpPacket->payload;
+        pRtpPacket->receivedTime = (UINT64) (i * frameInterval + receivedOffset) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, pRtpPacket));
+
+        if (i == 99) {
+            // Without jitter or holes the wait shrinks to the min latency
+            EXPECT_EQ(50, mJitterBuffer->latency);
+            EXPECT_EQ(99, frameCounts.readyFrameCount);
+        } else if (i == 115) {
+            // Frame 99 could not wait for the missing packet
+            EXPECT_EQ(1, frameCounts.droppedFrameCount);
+
+            EXPECT_EQ(STATUS_SUCCESS, createRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, 100, 100 * frameInterval, 0x1234ABCD, NULL, 0, 0, NULL,
+                                                      NULL, 0, &pRtpPacket));
+            pRtpPacket->payloadLength = 1;
+            pRtpPacket->payload = (PBYTE) MEMCALLOC(1, pRtpPacket->payloadLength + 1);
+            pRtpPacket->payload[pRtpPacket->payloadLength] = 1;
+            pRtpPacket->pRawPacket = pRtpPacket->payload;
+            pRtpPacket->receivedTime = (UINT64) (i * frameInterval + receivedOffset) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+            EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, pRtpPacket));
+
+            // The next hole gets enough time for a packet that late
+            EXPECT_LE(300, mJitterBuffer->latency);
+            EXPECT_GT(500, mJitterBuffer->latency);
+        }
+    }
+
+    // Frame 149 was given up on after the adapted wait instead of the 2 seconds of max latency
+    EXPECT_EQ(2, frameCounts.droppedFrameCount);
+    EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&mJitterBuffer));
+    EXPECT_EQ(2, frameCounts.droppedFrameCount);
+    EXPECT_EQ(196, frameCounts.readyFrameCount);
+}
+
+TEST_F(JitterBufferFunctionalityTest, nackListFollowsMissingPackets)
+{
+    // One single packet frame every 20ms, packets 2 and 3 are missing until 2 is retransmitted
+    UINT16 pushedSeqNums[] = {0, 1, 4, 5, 2};
+    UINT16 nackList[JITTER_BUFFER_MAX_NACK_PACKET_COUNT];
+    UINT32 i, nackListLen, frameInterval = 20, receivedOffset = 1000;
+    UINT64 roundTripTime = 50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, detectedTime;
+    PRtpPacket pRtpPacket;
+    JitterBufferFrameCounts frameCounts;
+
+    MEMSET(&frameCounts, 0x00, SIZEOF(JitterBufferFrameCounts));
+    EXPECT_EQ(STATUS_SUCCESS, createJitterBuffer(countFrameReadyFunc, countFrameDroppedFunc, testDepayRtpFunc, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                                 TEST_JITTER_BUFFER_CLOCK_RATE, (UINT64) &frameCounts, &mJitterBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferSetNackEnabled(mJitterBuffer, TRUE));
+
+    for (i = 0; i < ARRAY_SIZE(pushedSeqNums); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, pushedSeqNums[i], pushedSeqNums[i] * frameInterval, 0x1234ABCD,
+                                                  NULL, 0, 0, NULL, NULL, 0, &pRtpPacket));
+        pRtpPacket->payloadLength = 1;
+        pRtpPacket->payload = (PBYTE) MEMCALLOC(1, pRtpPacket->payloadLength + 1);
+        pRtpPacket->payload[pRtpPacket->payloadLength] = 1;
+        pRtpPacket->pRawPacket = pRtpPacket->payload;
+        pRtpPacket->receivedTime = (UINT64) (i * frameInterval + receivedOffset) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, pRtpPacket));
+
+        if (pushedSeqNums[i] != 4) {
+            continue;
+        }
+
+        // The gap is asked for right away in a single list
+        detectedTime = (UINT64) (i * frameInterval + receivedOffset) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        nackListLen = ARRAY_SIZE(nackList);
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferGetNackList(mJitterBuffer, detectedTime, roundTripTime, nackList, &nackListLen));
+        EXPECT_EQ(2, nackListLen);
+        EXPECT_EQ(2, nackList[0]);
+        EXPECT_EQ(3, nackList[1]);
+
+        // And only again once the retransmissions had a round trip to arrive
+        nackListLen = ARRAY_SIZE(nackList);
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferGetNackList(mJitterBuffer, detectedTime + roundTripTime - 1, roundTripTime, nackList, &nackListLen));
+        EXPECT_EQ(0, nackListLen);
+        nackListLen = ARRAY_SIZE(nackList);
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferGetNackList(mJitterBuffer, detectedTime + roundTripTime, roundTripTime, nackList, &nackListLen));
+        EXPECT_EQ(2, nackListLen);
+        EXPECT_EQ(4, mJitterBuffer->packetsNacked);
+    }
+
+    // The retransmission of packet 2 is a recovery, packet 3 is still missing
+    EXPECT_EQ(1, mJitterBuffer->packetsRecovered);
+    EXPECT_EQ(1, mJitterBuffer->missingPacketCount);
+    nackListLen = ARRAY_SIZE(nackList);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferGetNackList(mJitterBuffer, detectedTime + 2 * roundTripTime, roundTripTime, nackList, &nackListLen));
+    EXPECT_EQ(1, nackListLen);
+    EXPECT_EQ(3, nackList[0]);
+
+    // Once a retransmission would arrive after the frame stopped waiting, the packet is given up on
+    nackListLen = ARRAY_SIZE(nackList);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferGetNackList(mJitterBuffer, detectedTime + DEFAULT_JITTER_BUFFER_MAX_LATENCY - roundTripTime + 1,
+                                                      roundTripTime, nackList, &nackListLen));
+    EXPECT_EQ(0, nackListLen);
+    EXPECT_EQ(0, mJitterBuffer->missingPacketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&mJitterBuffer));
+}
+
 }
 }
 }
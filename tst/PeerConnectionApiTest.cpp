@@ -90,6 +90,208 @@ TEST_F(PeerConnectionApiTest, suppliedCertificatesVariation)
     EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
 }
 
+TEST_F(PeerConnectionApiTest, inboundPacketQueueStats)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection;
+    InboundPacketQueueStats stats;
+    UINT32 ioWorkerCount = 0;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    configuration.iceTransportPolicy = ICE_TRANSPORT_POLICY_RELAY;
+
+    // Inbound packets are queued by default when the I/O workers are shared and processed on the receiving thread otherwise
+    EXPECT_EQ(STATUS_SUCCESS, getIoWorkerMetrics(NULL, &ioWorkerCount));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionGetInboundPacketQueueStats(pRtcPeerConnection, NULL));
+    EXPECT_EQ(ioWorkerCount == 0 ? STATUS_INVALID_OPERATION : STATUS_SUCCESS, peerConnectionGetInboundPacketQueueStats(pRtcPeerConnection, &stats));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+
+    configuration.kvsRtcConfiguration.inboundPacketQueueSize = INBOUND_PACKET_QUEUE_SIZE_DISABLED;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, peerConnectionGetInboundPacketQueueStats(pRtcPeerConnection, &stats));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+
+    configuration.kvsRtcConfiguration.inboundPacketQueueSize = 256;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetInboundPacketQueueStats(pRtcPeerConnection, &stats));
+    EXPECT_EQ(0, stats.packetsQueued);
+    EXPECT_EQ(0, stats.packetsDropped);
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+TEST_F(PeerConnectionApiTest, getMetrics)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection, pOtherRtcPeerConnection;
+    RtcMediaStreamTrack track;
+    PRtcRtpTransceiver pRtcRtpTransceiver, pOtherRtcRtpTransceiver;
+    RtcStats rtcStats;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&rtcStats, 0xFF, SIZEOF(RtcStats));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pOtherRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &track, &pRtcRtpTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    addTrackToPeerConnection(pOtherRtcPeerConnection, &track, &pOtherRtcRtpTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+
+    EXPECT_EQ(STATUS_NULL_ARG, RtcPeerConnectionGetMetrics(NULL, &rtcStats));
+    EXPECT_EQ(STATUS_NULL_ARG, RtcPeerConnectionGetMetrics(pRtcPeerConnection, NULL));
+
+    // Connection level stats do not need a transceiver
+    rtcStats.pRtcRtpTransceiver = NULL;
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_TRANSPORT;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.transportStats.packetsSent);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.transportStats.bytesReceived);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.transportStats.selectedCandidatePairChanges);
+
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_CANDIDATE_PAIR;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.iceCandidatePairStats.packetsReceived);
+
+    // Stream stats do
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_OUTBOUND_RTP;
+    EXPECT_EQ(STATUS_NULL_ARG, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    rtcStats.pRtcRtpTransceiver = pOtherRtcRtpTransceiver;
+    EXPECT_EQ(STATUS_INVALID_ARG, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    rtcStats.pRtcRtpTransceiver = pRtcRtpTransceiver;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.packetsSent);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.framesSent);
+
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_RTC_ALL;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.inboundRtpStreamStats.packetsReceived);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.remoteInboundRtpStreamStats.reportsReceived);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.remoteOutboundRtpStreamStats.packetsSent);
+
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_CODEC;
+    EXPECT_EQ(STATUS_NOT_IMPLEMENTED, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pOtherRtcPeerConnection));
+}
+
+TEST_F(PeerConnectionApiTest, transceiversAreFoundBySsrc)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection;
+    PKvsPeerConnection pKvsPeerConnection;
+    RtcMediaStreamTrack track;
+    PRtcRtpTransceiver transceivers[16];
+    PKvsRtpTransceiver pKvsRtpTransceiver, pFoundTransceiver;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+    for (i = 0; i < ARRAY_SIZE(transceivers); i++) {
+        addTrackToPeerConnection(pRtcPeerConnection, &track, &transceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    }
+
+    // Every sender owns its media and rtx ssrc
+    for (i = 0; i < ARRAY_SIZE(transceivers); i++) {
+        pKvsRtpTransceiver = (PKvsRtpTransceiver) transceivers[i];
+        EXPECT_NE(pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->sender.rtxSsrc);
+
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(pKvsRtpTransceiver->sender.ssrc), &pFoundTransceiver));
+        EXPECT_EQ(pKvsRtpTransceiver, pFoundTransceiver);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(pKvsRtpTransceiver->sender.rtxSsrc), &pFoundTransceiver));
+        EXPECT_EQ(pKvsRtpTransceiver, pFoundTransceiver);
+
+        // Nothing is received before the remote description assigns the remote ssrcs
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_REMOTE_SSRC_KEY(pKvsRtpTransceiver->sender.ssrc), &pFoundTransceiver));
+        EXPECT_TRUE(pFoundTransceiver == NULL);
+    }
+
+    EXPECT_EQ(STATUS_NULL_ARG, findTransceiverBySsrcKey(pKvsPeerConnection, TRANSCEIVER_LOCAL_SSRC_KEY(0), NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+TEST_F(PeerConnectionApiTest, jitterBufferConfiguration)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection;
+    RtcMediaStreamTrack track;
+    RtcRtpTransceiverInit rtcRtpTransceiverInit;
+    RtcJitterBufferConfiguration jitterBufferConfiguration;
+    PRtcRtpTransceiver pTransceiver;
+    PJitterBuffer pJitterBuffer;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&track, 0x00, SIZEOF(RtcMediaStreamTrack));
+    MEMSET(&rtcRtpTransceiverInit, 0x00, SIZEOF(RtcRtpTransceiverInit));
+    MEMSET(&jitterBufferConfiguration, 0x00, SIZEOF(RtcJitterBufferConfiguration));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, addSupportedCodec(pRtcPeerConnection, RTC_CODEC_OPUS));
+    track.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+    track.codec = RTC_CODEC_OPUS;
+    STRCPY(track.streamId, "myKvsVideoStream");
+    STRCPY(track.trackId, "myAudioTrack");
+
+    // Audio is not NACKed
+    rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY;
+    EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pTransceiver));
+    pJitterBuffer = ((PKvsRtpTransceiver) pTransceiver)->pJitterBuffer;
+    EXPECT_FALSE(pJitterBuffer->adaptiveLatency);
+    EXPECT_FALSE(pJitterBuffer->releaseOnMarker);
+    EXPECT_FALSE(pJitterBuffer->nackEnabled);
+    EXPECT_EQ(DEFAULT_JITTER_BUFFER_MAX_LATENCY * OPUS_CLOCKRATE / HUNDREDS_OF_NANOS_IN_A_SECOND, pJitterBuffer->latency);
+
+    EXPECT_EQ(STATUS_NULL_ARG, transceiverSetJitterBufferConfiguration(NULL, &jitterBufferConfiguration));
+    EXPECT_EQ(STATUS_NULL_ARG, transceiverSetJitterBufferConfiguration(pTransceiver, NULL));
+
+    // Unset bounds fall back to the defaults, the marker bit of audio does not end frames
+    jitterBufferConfiguration.adaptiveLatency = TRUE;
+    jitterBufferConfiguration.releaseOnMarker = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+    EXPECT_TRUE(pJitterBuffer->adaptiveLatency);
+    EXPECT_FALSE(pJitterBuffer->releaseOnMarker);
+    EXPECT_FALSE(pJitterBuffer->nackEnabled);
+    EXPECT_EQ(DEFAULT_JITTER_BUFFER_MIN_LATENCY * OPUS_CLOCKRATE / HUNDREDS_OF_NANOS_IN_A_SECOND, pJitterBuffer->minLatency);
+    EXPECT_EQ(DEFAULT_JITTER_BUFFER_MAX_LATENCY * OPUS_CLOCKRATE / HUNDREDS_OF_NANOS_IN_A_SECOND, pJitterBuffer->maxLatency);
+
+    jitterBufferConfiguration.minLatency = 20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    jitterBufferConfiguration.maxLatency = 500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+    EXPECT_EQ(20 * OPUS_CLOCKRATE / 1000, pJitterBuffer->minLatency);
+    EXPECT_EQ(500 * OPUS_CLOCKRATE / 1000, pJitterBuffer->maxLatency);
+    EXPECT_EQ(pJitterBuffer->maxLatency, pJitterBuffer->latency);
+
+    // The max latency still applies without adaptation
+    jitterBufferConfiguration.adaptiveLatency = FALSE;
+    EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+    EXPECT_FALSE(pJitterBuffer->adaptiveLatency);
+    EXPECT_EQ(500 * OPUS_CLOCKRATE / 1000, pJitterBuffer->latency);
+
+    jitterBufferConfiguration.adaptiveLatency = TRUE;
+    jitterBufferConfiguration.minLatency = jitterBufferConfiguration.maxLatency + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+
+    // The marker bit ends video frames and video is NACKed unless disabled
+    MEMSET(&jitterBufferConfiguration, 0x00, SIZEOF(RtcJitterBufferConfiguration));
+    jitterBufferConfiguration.releaseOnMarker = TRUE;
+    addTrackToPeerConnection(pRtcPeerConnection, &track, &pTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pJitterBuffer = ((PKvsRtpTransceiver) pTransceiver)->pJitterBuffer;
+    EXPECT_FALSE(pJitterBuffer->releaseOnMarker);
+    EXPECT_TRUE(pJitterBuffer->nackEnabled);
+    EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+    EXPECT_TRUE(pJitterBuffer->releaseOnMarker);
+    EXPECT_TRUE(pJitterBuffer->nackEnabled);
+
+    jitterBufferConfiguration.disableNack = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(pTransceiver, &jitterBufferConfiguration));
+    EXPECT_FALSE(pJitterBuffer->nackEnabled);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
 TEST_F(PeerConnectionApiTest, deserializeSessionDescriptionInit)
 {
     RtcSessionDescriptionInit rtcSessionDescriptionInit;
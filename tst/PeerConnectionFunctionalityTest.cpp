@@ -370,6 +370,7 @@ TEST_F(PeerConnectionFunctionalityTest, exchangeMedia)
     PRtcRtpTransceiver offerVideoTransceiver, answerVideoTransceiver, offerAudioTransceiver, answerAudioTransceiver;
     SIZE_T seenVideo = 0;
     Frame videoFrame;
+    RtcStats rtcStats;
 
     MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
     MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
@@ -401,6 +402,19 @@ TEST_F(PeerConnectionFunctionalityTest, exchangeMedia)
         THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
     }
 
+    MEMSET(&rtcStats, 0x00, SIZEOF(RtcStats));
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_RTC_ALL;
+    rtcStats.pRtcRtpTransceiver = offerVideoTransceiver;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(offerPc, &rtcStats));
+    EXPECT_LT(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.framesSent);
+    EXPECT_LE(rtcStats.rtcStatsObject.outboundRtpStreamStats.packetsSent, rtcStats.rtcStatsObject.transportStats.packetsSent);
+    EXPECT_LT(0, rtcStats.rtcStatsObject.transportStats.selectedCandidatePairChanges);
+
+    rtcStats.pRtcRtpTransceiver = answerVideoTransceiver;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(answerPc, &rtcStats));
+    EXPECT_LT(0, rtcStats.rtcStatsObject.inboundRtpStreamStats.packetsReceived);
+    EXPECT_LT(0, rtcStats.rtcStatsObject.inboundRtpStreamStats.framesReceived);
+
     MEMFREE(videoFrame.frameData);
 
     closePeerConnection(offerPc);
@@ -679,6 +693,939 @@ TEST_F(PeerConnectionFunctionalityTest, DISABLED_exchangeMediaThroughTurnRandomS
     deinitializeSignalingClient();
 }
 
+// Waits for the refill thread of a pool to have the given number of peer connections ready
+BOOL waitForPeerConnectionPool(PEER_CONNECTION_POOL_HANDLE poolHandle, UINT32 readyCount, PPeerConnectionPoolMetrics pMetrics)
+{
+    for (auto i = 0; i < 100; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetMetrics(poolHandle, pMetrics));
+        if (pMetrics->readyCount >= readyCount) {
+            return TRUE;
+        }
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    return FALSE;
+}
+
+TEST_F(PeerConnectionFunctionalityTest, connectTwoPeersFromPool)
+{
+    RtcConfiguration configuration;
+    PeerConnectionPoolConfiguration poolConfiguration;
+    PeerConnectionPoolMetrics metrics;
+    PEER_CONNECTION_POOL_HANDLE poolHandle = INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&poolConfiguration, 0x00, SIZEOF(PeerConnectionPoolConfiguration));
+    MEMSET(&metrics, 0x00, SIZEOF(PeerConnectionPoolMetrics));
+
+    poolConfiguration.peerConnectionCount = 2;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnectionPool(&configuration, &poolConfiguration, &poolHandle));
+    EXPECT_TRUE(waitForPeerConnectionPool(poolHandle, 2, &metrics));
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetPeerConnection(poolHandle, &offerPc));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetPeerConnection(poolHandle, &answerPc));
+
+    EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetMetrics(poolHandle, &metrics));
+    EXPECT_EQ(2, metrics.hitCount);
+    EXPECT_EQ(0, metrics.missCount);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnectionPool(&poolHandle));
+    EXPECT_FALSE(IS_VALID_PEER_CONNECTION_POOL_HANDLE(poolHandle));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnectionPool(&poolHandle));
+}
+
+// Candidates gathered while a peer connection waits in a pool are reported after setLocalDescription
+TEST_F(PeerConnectionFunctionalityTest, pooledPeerConnectionReportsCandidatesOnSetLocalDescription)
+{
+    RtcConfiguration configuration;
+    PeerConnectionPoolConfiguration poolConfiguration;
+    PeerConnectionPoolMetrics metrics;
+    PEER_CONNECTION_POOL_HANDLE poolHandle = INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    RtcSessionDescriptionInit sdp;
+    // Number of candidates and number of ends of gathering reported
+    volatile SIZE_T reportCounts[2] = {0, 0};
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&poolConfiguration, 0x00, SIZEOF(PeerConnectionPoolConfiguration));
+    MEMSET(&metrics, 0x00, SIZEOF(PeerConnectionPoolMetrics));
+
+    poolConfiguration.peerConnectionCount = 1;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnectionPool(&configuration, &poolConfiguration, &poolHandle));
+    EXPECT_TRUE(waitForPeerConnectionPool(poolHandle, 1, &metrics));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetPeerConnection(poolHandle, &pRtcPeerConnection));
+
+    auto onICECandidateHdlr = [](UINT64 customData, PCHAR candidateStr) -> void {
+        ATOMIC_INCREMENT((PSIZE_T) customData + (candidateStr == NULL ? 1 : 0));
+    };
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnIceCandidate(pRtcPeerConnection, (UINT64) reportCounts, onICECandidateHdlr));
+
+    // Host candidates are gathered by now
+    THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
+    EXPECT_EQ(0, ATOMIC_LOAD(&reportCounts[0]));
+    EXPECT_EQ(0, ATOMIC_LOAD(&reportCounts[1]));
+
+    EXPECT_EQ(STATUS_SUCCESS, createOffer(pRtcPeerConnection, &sdp));
+    EXPECT_NE((PCHAR) NULL, STRSTR(sdp.sdp, "a=candidate:"));
+    EXPECT_EQ(STATUS_SUCCESS, setLocalDescription(pRtcPeerConnection, &sdp));
+
+    for (auto i = 0; i < 50 && ATOMIC_LOAD(&reportCounts[1]) == 0; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_LT(0, ATOMIC_LOAD(&reportCounts[0]));
+    EXPECT_EQ(1, ATOMIC_LOAD(&reportCounts[1]));
+
+    freePeerConnection(&pRtcPeerConnection);
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnectionPool(&poolHandle));
+}
+
+TEST_F(PeerConnectionFunctionalityTest, peerConnectionPoolReplacesOldPeerConnections)
+{
+    RtcConfiguration configuration;
+    PeerConnectionPoolConfiguration poolConfiguration;
+    PeerConnectionPoolMetrics metrics;
+    PEER_CONNECTION_POOL_HANDLE poolHandle = INVALID_PEER_CONNECTION_POOL_HANDLE_VALUE;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&poolConfiguration, 0x00, SIZEOF(PeerConnectionPoolConfiguration));
+    MEMSET(&metrics, 0x00, SIZEOF(PeerConnectionPoolMetrics));
+
+    EXPECT_EQ(STATUS_NULL_ARG, createPeerConnectionPool(NULL, &poolConfiguration, &poolHandle));
+    EXPECT_EQ(STATUS_NULL_ARG, createPeerConnectionPool(&configuration, &poolConfiguration, NULL));
+    poolConfiguration.peerConnectionCount = MAX_PEER_CONNECTION_POOL_SIZE + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, createPeerConnectionPool(&configuration, &poolConfiguration, &poolHandle));
+    EXPECT_FALSE(IS_VALID_PEER_CONNECTION_POOL_HANDLE(poolHandle));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionPoolGetPeerConnection(poolHandle, &pRtcPeerConnection));
+
+    poolConfiguration.peerConnectionCount = 1;
+    poolConfiguration.maxPeerConnectionAge = 200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnectionPool(&configuration, &poolConfiguration, &poolHandle));
+
+    for (auto i = 0; i < 100 && metrics.expiredCount < 2; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionPoolGetMetrics(poolHandle, &metrics));
+    }
+
+    EXPECT_LE(2, metrics.expiredCount);
+    EXPECT_TRUE(waitForPeerConnectionPool(poolHandle, 1, &metrics));
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnectionPool(&poolHandle));
+}
+
+// Assert that a frame written to a broadcast group is packetized once and reaches every viewer
+TEST_F(PeerConnectionFunctionalityTest, broadcastGroupSendsFrameToEveryViewer)
+{
+    if (!mAccessKeyIdSet) {
+        return;
+    }
+
+    auto const viewerCount = 3;
+    auto const frameBufferSize = 200000;
+
+    RtcConfiguration configuration;
+    PRtcPeerConnection masterPcs[viewerCount] = {NULL}, viewerPcs[viewerCount] = {NULL};
+    RtcMediaStreamTrack masterTracks[viewerCount], viewerTracks[viewerCount];
+    PRtcRtpTransceiver masterTransceivers[viewerCount], viewerTransceivers[viewerCount];
+    SIZE_T seenVideo[viewerCount] = {0};
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    PBroadcastGroup pBroadcastGroup;
+    Frame videoFrame;
+    RtcStats rtcStats;
+    BOOL seenAll = FALSE;
+    UINT64 packetsPerFrame;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(frameBufferSize);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    auto onFrameHandler = [](UINT64 customData, PFrame pFrame) -> void {
+        UNUSED_PARAM(pFrame);
+        ATOMIC_STORE((PSIZE_T) customData, 1);
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    pBroadcastGroup = (PBroadcastGroup) groupHandle;
+
+    for (auto i = 0; i < viewerCount; i++) {
+        EXPECT_EQ(createPeerConnection(&configuration, &masterPcs[i]), STATUS_SUCCESS);
+        EXPECT_EQ(createPeerConnection(&configuration, &viewerPcs[i]), STATUS_SUCCESS);
+        addTrackToPeerConnection(masterPcs[i], &masterTracks[i], &masterTransceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        addTrackToPeerConnection(viewerPcs[i], &viewerTracks[i], &viewerTransceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        EXPECT_EQ(transceiverOnFrame(viewerTransceivers[i], (UINT64) &seenVideo[i], onFrameHandler), STATUS_SUCCESS);
+        EXPECT_EQ(connectTwoPeers(masterPcs[i], viewerPcs[i]), TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, masterTransceivers[i]));
+    }
+
+    // Adding a transceiver twice does nothing
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, masterTransceivers[0]));
+    EXPECT_EQ(viewerCount, pBroadcastGroup->transceiverCount);
+
+    for (auto i = 0; i <= 1000 && !seenAll; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+        videoFrame.presentationTs += (HUNDREDS_OF_NANOS_IN_A_SECOND / 25);
+
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+
+        seenAll = TRUE;
+        for (auto j = 0; j < viewerCount; j++) {
+            seenAll = seenAll && ATOMIC_LOAD(&seenVideo[j]) == 1;
+        }
+    }
+
+    EXPECT_TRUE(seenAll);
+
+    // Frames are all the same size, so every one of them was packetized once into the same number of packets, which
+    // went out through every viewer it was sent to
+    EXPECT_EQ(0, pBroadcastGroup->packetsCreated % pBroadcastGroup->framesWritten);
+    packetsPerFrame = pBroadcastGroup->packetsCreated / pBroadcastGroup->framesWritten;
+    for (auto i = 0; i < viewerCount; i++) {
+        MEMSET(&rtcStats, 0x00, SIZEOF(RtcStats));
+        rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_OUTBOUND_RTP;
+        rtcStats.pRtcRtpTransceiver = masterTransceivers[i];
+        EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(masterPcs[i], &rtcStats));
+        EXPECT_LT(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.framesSent);
+        EXPECT_GE(pBroadcastGroup->framesWritten, rtcStats.rtcStatsObject.outboundRtpStreamStats.framesSent);
+        EXPECT_EQ(packetsPerFrame * rtcStats.rtcStatsObject.outboundRtpStreamStats.framesSent,
+                  rtcStats.rtcStatsObject.outboundRtpStreamStats.packetsSent);
+    }
+
+    for (auto i = 0; i < viewerCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, masterTransceivers[i]));
+    }
+    EXPECT_EQ(0, pBroadcastGroup->transceiverCount);
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+    EXPECT_FALSE(IS_VALID_BROADCAST_GROUP_HANDLE(groupHandle));
+
+    MEMFREE(videoFrame.frameData);
+
+    for (auto i = 0; i < viewerCount; i++) {
+        closePeerConnection(masterPcs[i]);
+        closePeerConnection(viewerPcs[i]);
+        freePeerConnection(&masterPcs[i]);
+        freePeerConnection(&viewerPcs[i]);
+    }
+}
+
+TEST_F(PeerConnectionFunctionalityTest, broadcastGroupValidatesTransceivers)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL, pLargeMtuPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack, audioTrack, largeMtuTrack;
+    PRtcRtpTransceiver videoTransceiver, audioTransceiver, largeMtuTransceiver;
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    Frame videoFrame;
+    BroadcastGroupStats stats;
+    UINT64 allocationCount;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+
+    EXPECT_EQ(STATUS_NULL_ARG, createBroadcastGroup(RTC_CODEC_VP8, NULL));
+    EXPECT_EQ(STATUS_NOT_IMPLEMENTED, createBroadcastGroup((RTC_CODEC) 0, &groupHandle));
+    EXPECT_FALSE(IS_VALID_BROADCAST_GROUP_HANDLE(groupHandle));
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    addTrackToPeerConnection(pRtcPeerConnection, &audioTrack, &audioTransceiver, RTC_CODEC_OPUS, MEDIA_STREAM_TRACK_KIND_AUDIO);
+
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupAddTransceiver(groupHandle, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, broadcastGroupAddTransceiver(groupHandle, audioTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, audioTransceiver));
+
+    // Packets of the group are created in pooled buffers that a payload of that size would not fit
+    configuration.kvsRtcConfiguration.maximumTransmissionUnit = RTP_PACKET_POOL_BUFFER_SIZE - MIN_HEADER_LENGTH;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pLargeMtuPeerConnection));
+    addTrackToPeerConnection(pLargeMtuPeerConnection, &largeMtuTrack, &largeMtuTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    EXPECT_EQ(STATUS_INVALID_ARG, broadcastGroupAddTransceiver(groupHandle, largeMtuTransceiver));
+    EXPECT_EQ(1, ((PBroadcastGroup) groupHandle)->transceiverCount);
+    freePeerConnection(&pLargeMtuPeerConnection);
+
+    // Not connected yet, so the frame is dropped like writeFrame does
+    videoFrame.frameData = (PBYTE) MEMALLOC(TEST_VIDEO_FRAME_SIZE);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupGetStats(groupHandle, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupGetStats(groupHandle, &stats));
+    EXPECT_EQ(1, stats.framesWritten);
+    EXPECT_LT(0, stats.packetsCreated);
+    EXPECT_LT(0, stats.allocationCount);
+    allocationCount = stats.allocationCount;
+
+    // Packets and scratch memory of the first frame are reused for the next ones
+    for (auto i = 0; i < 5; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupGetStats(groupHandle, &stats));
+    EXPECT_EQ(6, stats.framesWritten);
+    EXPECT_EQ(allocationCount, stats.allocationCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+
+    MEMFREE(videoFrame.frameData);
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+// Waits for the send worker of a peer connection to be left with the given number of queued frames
+static BOOL waitForSendQueueDepth(PRtcPeerConnection pRtcPeerConnection, UINT32 queueDepth, PSendQueueStats pStats)
+{
+    for (auto i = 0; i < 1000; i++) {
+        if (STATUS_SUCCEEDED(peerConnectionGetSendQueueStats(pRtcPeerConnection, pStats)) && pStats->queueDepth == queueDepth) {
+            return TRUE;
+        }
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    return FALSE;
+}
+
+TEST_F(PeerConnectionFunctionalityTest, sendWorkerPoolQueuesBroadcastFramesWithBackPressure)
+{
+    RtcConfiguration configuration;
+    SendWorkerPoolConfiguration poolConfiguration;
+    SendWorkerMetrics workerMetrics[2];
+    SendQueueStats stats;
+    PRtcPeerConnection pcs[2] = {NULL};
+    RtcMediaStreamTrack tracks[2];
+    PRtcRtpTransceiver transceivers[2];
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    Frame videoFrame;
+    UINT32 workerCount = 0;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&poolConfiguration, 0x00, SIZEOF(SendWorkerPoolConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+
+    EXPECT_EQ(STATUS_NULL_ARG, initSendWorkerPool(NULL));
+    poolConfiguration.workerCount = MAX_SEND_WORKER_COUNT + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, initSendWorkerPool(&poolConfiguration));
+    poolConfiguration.workerCount = 2;
+    poolConfiguration.queueSize = MAX_SEND_QUEUE_SIZE + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, initSendWorkerPool(&poolConfiguration));
+    EXPECT_EQ(STATUS_SUCCESS, getSendWorkerMetrics(NULL, &workerCount));
+    EXPECT_EQ(0, workerCount);
+
+    poolConfiguration.queueSize = 2;
+    poolConfiguration.maxEnqueueWait = 10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS, initSendWorkerPool(&poolConfiguration));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, initSendWorkerPool(&poolConfiguration));
+
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    for (auto i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pcs[i]));
+        addTrackToPeerConnection(pcs[i], &tracks[i], &transceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, transceivers[i]));
+    }
+
+    // Each peer connection went to a worker of its own
+    workerCount = 1;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, getSendWorkerMetrics(workerMetrics, &workerCount));
+    EXPECT_EQ(2, workerCount);
+    EXPECT_EQ(STATUS_SUCCESS, getSendWorkerMetrics(workerMetrics, &workerCount));
+    EXPECT_EQ(1, workerMetrics[0].peerConnectionCount);
+    EXPECT_EQ(1, workerMetrics[1].peerConnectionCount);
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(TEST_VIDEO_FRAME_SIZE);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    // Stall the worker of the first peer connection on its first frame
+    MUTEX_LOCK(((PKvsPeerConnection) pcs[0])->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    EXPECT_TRUE(waitForSendQueueDepth(pcs[0], 0, &stats));
+
+    // Two more fill its queue up, the last one waits for room in vain and is dropped for it only
+    for (auto i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetSendQueueStats(pcs[0], &stats));
+    EXPECT_EQ(2, stats.queueDepth);
+    EXPECT_EQ(2, stats.maxQueueDepth);
+    EXPECT_EQ(3, stats.framesQueued);
+    EXPECT_EQ(1, stats.framesDropped);
+    EXPECT_LE(poolConfiguration.maxEnqueueWait, stats.blockedTime);
+
+    MUTEX_UNLOCK(((PKvsPeerConnection) pcs[0])->pSrtpSessionLock);
+    EXPECT_TRUE(waitForSendQueueDepth(pcs[0], 0, &stats));
+    for (auto i = 0; i < 1000 && stats.framesSent != 3; i++) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetSendQueueStats(pcs[0], &stats));
+    }
+    EXPECT_EQ(3, stats.framesSent);
+
+    EXPECT_TRUE(waitForSendQueueDepth(pcs[1], 0, &stats));
+    EXPECT_EQ(4, stats.framesQueued);
+    EXPECT_EQ(0, stats.framesDropped);
+
+    for (auto i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, transceivers[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionGetSendQueueStats(pcs[0], NULL));
+    for (auto i = 0; i < 2; i++) {
+        freePeerConnection(&pcs[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, getSendWorkerMetrics(workerMetrics, &workerCount));
+    EXPECT_EQ(0, workerMetrics[0].peerConnectionCount + workerMetrics[1].peerConnectionCount);
+    EXPECT_EQ(7, workerMetrics[0].framesSent + workerMetrics[1].framesSent);
+
+    EXPECT_EQ(STATUS_SUCCESS, deinitSendWorkerPool());
+    EXPECT_EQ(STATUS_SUCCESS, deinitSendWorkerPool());
+
+    // Peer connections created without a pool send on the writer's thread
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pcs[0]));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, peerConnectionGetSendQueueStats(pcs[0], &stats));
+    freePeerConnection(&pcs[0]);
+
+    MEMFREE(videoFrame.frameData);
+}
+
+
+TEST_F(PeerConnectionFunctionalityTest, writeFrameGivesBackSequenceNumbersOfUnsentPackets)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    BYTE srtpKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    BYTE smallFrameData[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0x11, 0x22, 0x33};
+    Frame smallFrame, largeFrame;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&smallFrame, 0x00, SIZEOF(Frame));
+    MEMSET(&largeFrame, 0x00, SIZEOF(Frame));
+    MEMSET(srtpKey, 0x5a, SIZEOF(srtpKey));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE,
+                             MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) videoTransceiver;
+
+    // Packets are encrypted without a DTLS handshake, sending them goes nowhere as no candidate pair was selected. The
+    // retransmission buffer is normally created when the remote description is set.
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(16, &pKvsRtpTransceiver->sender.packetBuffer));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+
+    smallFrame.frameData = smallFrameData;
+    smallFrame.size = SIZEOF(smallFrameData);
+
+    // A single IDR slice fragmented into 5 FU-A packets
+    largeFrame.size = 4 + 1 + 4 * (pKvsPeerConnection->MTU - FU_A_HEADER_SIZE) + 10;
+    largeFrame.frameData = (PBYTE) MEMALLOC(largeFrame.size);
+    MEMSET(largeFrame.frameData, 0x11, largeFrame.size);
+    MEMCPY(largeFrame.frameData, smallFrameData, 5);
+
+    pKvsRtpTransceiver->sender.sequenceNumber = 1003;
+    EXPECT_EQ(STATUS_SUCCESS, writeFrame(videoTransceiver, &smallFrame));
+    EXPECT_EQ(1004, pKvsRtpTransceiver->sender.sequenceNumber);
+    EXPECT_EQ(1, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+
+    // The SRTP session already used 1003, so the fourth packet of the frame fails to encrypt as a replay
+    pKvsRtpTransceiver->sender.sequenceNumber = 1000;
+    EXPECT_NE(STATUS_SUCCESS, writeFrame(videoTransceiver, &largeFrame));
+    EXPECT_EQ(4, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+    EXPECT_EQ(1, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.framesSent));
+
+    // Only the three packets that went out consumed their sequence numbers, the next frame picks up right after them
+    EXPECT_EQ(1003, pKvsRtpTransceiver->sender.sequenceNumber);
+
+    MEMFREE(largeFrame.frameData);
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+TEST_F(PeerConnectionFunctionalityTest, writeFrameSendsFramesOfManySmallNalus)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    BYTE srtpKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    BYTE sliceData[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x11, 0x22, 0x33};
+    BYTE frameData[40 * SIZEOF(sliceData)];
+    Frame videoFrame;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(srtpKey, 0x5a, SIZEOF(srtpKey));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE,
+                             MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) videoTransceiver;
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(64, &pKvsRtpTransceiver->sender.packetBuffer));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+
+    // 40 slices of a few bytes need far more packets than the size of the frame suggests, the frame is packetized
+    // again with more slots and still goes out whole, one packet per slice
+    for (i = 0; i < 40; i++) {
+        MEMCPY(frameData + i * SIZEOF(sliceData), sliceData, SIZEOF(sliceData));
+    }
+    videoFrame.frameData = frameData;
+    videoFrame.size = SIZEOF(frameData);
+
+    pKvsRtpTransceiver->sender.sequenceNumber = 100;
+    EXPECT_EQ(STATUS_SUCCESS, writeFrame(videoTransceiver, &videoFrame));
+    EXPECT_EQ(40, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+    EXPECT_EQ(1, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.framesSent));
+    EXPECT_EQ(140, pKvsRtpTransceiver->sender.sequenceNumber);
+
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+TEST_F(PeerConnectionFunctionalityTest, outboundStatsReportSendPathAllocations)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    BYTE srtpKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    BYTE startCode[] = {0x00, 0x00, 0x00, 0x01, 0x65};
+    Frame videoFrame;
+    RtcStats rtcStats;
+    UINT64 sendBufferAllocations, retransmissionBufferAllocations;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(&rtcStats, 0x00, SIZEOF(RtcStats));
+    MEMSET(srtpKey, 0x5a, SIZEOF(srtpKey));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE,
+                             MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) videoTransceiver;
+
+    rtcStats.requestedTypeOfStats = RTC_STATS_TYPE_OUTBOUND_RTP;
+    rtcStats.pRtcRtpTransceiver = videoTransceiver;
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.sendBufferAllocations);
+    EXPECT_EQ(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.retransmissionBufferAllocations);
+
+    // Packets are encrypted without a DTLS handshake and go nowhere. A small retransmission buffer fills up quickly
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(8, &pKvsRtpTransceiver->sender.packetBuffer));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+
+    // A single IDR slice fragmented into 3 FU-A packets of the same size, so that every evicted slot fits the next packet
+    videoFrame.size = SIZEOF(startCode) + 3 * (pKvsPeerConnection->MTU - FU_A_HEADER_SIZE);
+    videoFrame.frameData = (PBYTE) MEMALLOC(videoFrame.size);
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+    MEMCPY(videoFrame.frameData, startCode, SIZEOF(startCode));
+
+    for (auto i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, writeFrame(videoTransceiver, &videoFrame));
+        videoFrame.presentationTs += HUNDREDS_OF_NANOS_IN_A_SECOND / 25;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(9, rtcStats.rtcStatsObject.outboundRtpStreamStats.packetsSent);
+    EXPECT_LT(0, rtcStats.rtcStatsObject.outboundRtpStreamStats.sendBufferAllocations);
+    EXPECT_EQ(8, rtcStats.rtcStatsObject.outboundRtpStreamStats.retransmissionBufferAllocations);
+    sendBufferAllocations = rtcStats.rtcStatsObject.outboundRtpStreamStats.sendBufferAllocations;
+    retransmissionBufferAllocations = rtcStats.rtcStatsObject.outboundRtpStreamStats.retransmissionBufferAllocations;
+
+    // Steady state frames reuse the packet arena and the evicted retransmission slots
+    for (auto i = 0; i < 20; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, writeFrame(videoTransceiver, &videoFrame));
+        videoFrame.presentationTs += HUNDREDS_OF_NANOS_IN_A_SECOND / 25;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, RtcPeerConnectionGetMetrics(pRtcPeerConnection, &rtcStats));
+    EXPECT_EQ(23 * 3, rtcStats.rtcStatsObject.outboundRtpStreamStats.packetsSent);
+    EXPECT_EQ(sendBufferAllocations, rtcStats.rtcStatsObject.outboundRtpStreamStats.sendBufferAllocations);
+    EXPECT_EQ(retransmissionBufferAllocations, rtcStats.rtcStatsObject.outboundRtpStreamStats.retransmissionBufferAllocations);
+
+    MEMFREE(videoFrame.frameData);
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+TEST_F(PeerConnectionFunctionalityTest, broadcastGroupPacketizesH264LikeWriteFrame)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    BroadcastGroupStats stats;
+    UINT64 allocationCount;
+    BYTE srtpKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    BYTE parameterSets[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1f, 0x11, 0x22, 0x33, 0x44, 0x55,
+                            0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80,
+                            0x00, 0x00, 0x00, 0x01, 0x65};
+    Frame videoFrame;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(srtpKey, 0x5a, SIZEOF(srtpKey));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE,
+                             MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) videoTransceiver;
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(16, &pKvsRtpTransceiver->sender.packetBuffer));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+
+    // SPS and PPS aggregated into a STAP-A, followed by an IDR slice fragmented into 3 FU-A packets
+    videoFrame.size = SIZEOF(parameterSets) + 3 * (pKvsPeerConnection->MTU - FU_A_HEADER_SIZE);
+    videoFrame.frameData = (PBYTE) MEMALLOC(videoFrame.size);
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+    MEMCPY(videoFrame.frameData, parameterSets, SIZEOF(parameterSets));
+
+    EXPECT_EQ(STATUS_SUCCESS, writeFrame(videoTransceiver, &videoFrame));
+    EXPECT_EQ(4, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, &groupHandle));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, videoTransceiver));
+    videoFrame.presentationTs += HUNDREDS_OF_NANOS_IN_A_SECOND / 25;
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupGetStats(groupHandle, &stats));
+    EXPECT_EQ(1, stats.framesWritten);
+    EXPECT_EQ(4, stats.packetsCreated);
+    EXPECT_EQ(8, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+    EXPECT_EQ(2, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.framesSent));
+    EXPECT_EQ(0, ATOMIC_LOAD(&((PBroadcastGroup) groupHandle)->pRtpPacketPool->outstandingCount));
+    allocationCount = stats.allocationCount;
+
+    // The frame is packetized right into the pooled packets, which the next frames reuse
+    videoFrame.presentationTs += HUNDREDS_OF_NANOS_IN_A_SECOND / 25;
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupGetStats(groupHandle, &stats));
+    EXPECT_EQ(8, stats.packetsCreated);
+    EXPECT_EQ(12, ATOMIC_LOAD(&pKvsRtpTransceiver->sender.packetsSent));
+    EXPECT_EQ(allocationCount, stats.allocationCount);
+    EXPECT_EQ(0, ATOMIC_LOAD(&((PBroadcastGroup) groupHandle)->pRtpPacketPool->outstandingCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+
+    MEMFREE(videoFrame.frameData);
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+TEST_F(PeerConnectionFunctionalityTest, broadcastGroupDoesNotHoldLockWhileQueueIsFull)
+{
+    RtcConfiguration configuration;
+    SendWorkerPoolConfiguration poolConfiguration;
+    SendQueueStats queueStats;
+    BroadcastGroupStats groupStats;
+    PRtcPeerConnection pcs[2] = {NULL};
+    RtcMediaStreamTrack tracks[2];
+    PRtcRtpTransceiver transceivers[2];
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    PBroadcastGroup pBroadcastGroup = NULL;
+    Frame videoFrame;
+    MUTEX latchLock = MUTEX_CREATE(FALSE);
+    CVAR latchCvar = CVAR_CREATE();
+    BOOL writerStarted = FALSE, groupLockFree = FALSE;
+    volatile ATOMIC_BOOL writerDone = FALSE;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&poolConfiguration, 0x00, SIZEOF(SendWorkerPoolConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(&groupStats, 0x00, SIZEOF(BroadcastGroupStats));
+
+    poolConfiguration.workerCount = 1;
+    poolConfiguration.queueSize = 1;
+    poolConfiguration.maxEnqueueWait = 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    EXPECT_EQ(STATUS_SUCCESS, initSendWorkerPool(&poolConfiguration));
+
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    for (auto i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pcs[i]));
+        addTrackToPeerConnection(pcs[i], &tracks[i], &transceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, transceivers[0]));
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(TEST_VIDEO_FRAME_SIZE);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    // Stall the worker on the first frame and fill the queue up with the second
+    MUTEX_LOCK(((PKvsPeerConnection) pcs[0])->pSrtpSessionLock);
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+    EXPECT_TRUE(waitForSendQueueDepth(pcs[0], 0, &queueStats));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+
+    // The third one waits for room
+    std::thread writer([&]() {
+        MUTEX_LOCK(latchLock);
+        writerStarted = TRUE;
+        CVAR_BROADCAST(latchCvar);
+        MUTEX_UNLOCK(latchLock);
+
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &videoFrame));
+        ATOMIC_STORE_BOOL(&writerDone, TRUE);
+    });
+
+    MUTEX_LOCK(latchLock);
+    while (!writerStarted) {
+        CVAR_WAIT(latchCvar, latchLock, INFINITE_TIME_VALUE);
+    }
+    MUTEX_UNLOCK(latchLock);
+
+    // The frame is counted right before the writer leaves the group lock to queue it
+    for (auto i = 0; i < 1000 && groupStats.framesWritten != 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupGetStats(groupHandle, &groupStats));
+        if (groupStats.framesWritten != 3) {
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    }
+    EXPECT_EQ(3, groupStats.framesWritten);
+
+    // The worker can not make room while it is stalled, so the writer is still waiting in the full queue once the group
+    // lock was found free
+    pBroadcastGroup = (PBroadcastGroup) groupHandle;
+    groupLockFree = MUTEX_TRYLOCK(pBroadcastGroup->lock);
+    if (groupLockFree) {
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+    }
+    EXPECT_TRUE(groupLockFree);
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&writerDone));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetSendQueueStats(pcs[0], &queueStats));
+    EXPECT_EQ(1, queueStats.queueDepth);
+
+    // The group stays usable meanwhile
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, transceivers[1]));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&writerDone));
+
+    MUTEX_UNLOCK(((PKvsPeerConnection) pcs[0])->pSrtpSessionLock);
+    writer.join();
+    EXPECT_TRUE(ATOMIC_LOAD_BOOL(&writerDone));
+
+    EXPECT_TRUE(waitForSendQueueDepth(pcs[0], 0, &queueStats));
+    EXPECT_EQ(3, queueStats.framesQueued);
+    EXPECT_EQ(0, queueStats.framesDropped);
+
+    for (auto i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, transceivers[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+    for (auto i = 0; i < 2; i++) {
+        freePeerConnection(&pcs[i]);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, deinitSendWorkerPool());
+
+    MEMFREE(videoFrame.frameData);
+    CVAR_FREE(latchCvar);
+    MUTEX_FREE(latchLock);
+}
+
+TEST_F(PeerConnectionFunctionalityTest, broadcastGroupRemovalOnlyWaitsForEarlierWriters)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    BROADCAST_GROUP_HANDLE groupHandle = INVALID_BROADCAST_GROUP_HANDLE_VALUE;
+    PBroadcastGroup pBroadcastGroup = NULL;
+    volatile ATOMIC_BOOL removed = FALSE;
+    BOOL waiting = FALSE;
+    UINT64 generation;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    EXPECT_EQ(STATUS_SUCCESS, createBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, videoTransceiver));
+    pBroadcastGroup = (PBroadcastGroup) groupHandle;
+
+    // A writer sending a frame outside of the group lock, as broadcastGroupWriteFrame does
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    generation = pBroadcastGroup->writerGeneration;
+    pBroadcastGroup->writerCounts[generation % ARRAY_SIZE(pBroadcastGroup->writerCounts)]++;
+    MUTEX_UNLOCK(pBroadcastGroup->lock);
+
+    std::thread remover([&]() {
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, videoTransceiver));
+        ATOMIC_STORE_BOOL(&removed, TRUE);
+    });
+
+    // The removal starts a new generation and waits for the writer of the previous one
+    for (auto i = 0; i < 1000 && !waiting; i++) {
+        MUTEX_LOCK(pBroadcastGroup->lock);
+        waiting = pBroadcastGroup->writerGeneration != generation;
+        MUTEX_UNLOCK(pBroadcastGroup->lock);
+        if (!waiting) {
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    }
+    EXPECT_TRUE(waiting);
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&removed));
+
+    // A writer starting after the removal is still busy when the earlier one is done, the removal goes through anyway
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    pBroadcastGroup->writerCounts[pBroadcastGroup->writerGeneration % ARRAY_SIZE(pBroadcastGroup->writerCounts)]++;
+    pBroadcastGroup->writerCounts[generation % ARRAY_SIZE(pBroadcastGroup->writerCounts)]--;
+    CVAR_BROADCAST(pBroadcastGroup->writersDoneCvar);
+    MUTEX_UNLOCK(pBroadcastGroup->lock);
+
+    remover.join();
+    EXPECT_TRUE(ATOMIC_LOAD_BOOL(&removed));
+    EXPECT_EQ(0, pBroadcastGroup->transceiverCount);
+
+    MUTEX_LOCK(pBroadcastGroup->lock);
+    pBroadcastGroup->writerCounts[pBroadcastGroup->writerGeneration % ARRAY_SIZE(pBroadcastGroup->writerCounts)]--;
+    MUTEX_UNLOCK(pBroadcastGroup->lock);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeBroadcastGroup(&groupHandle));
+    freePeerConnection(&pRtcPeerConnection);
+}
+
+#if defined(__linux__)
+// I/O workers are only shared on linux
+TEST_F(PeerConnectionFunctionalityTest, blockedOnFrameDoesNotDelayOtherPeerConnections)
+{
+    typedef struct {
+        volatile SIZE_T framesReceived;
+        volatile ATOMIC_BOOL blocked;
+    } OnFrameTestData;
+
+    RtcConfiguration configuration;
+    PRtcPeerConnection pcs[2] = {NULL};
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcMediaStreamTrack tracks[2];
+    PRtcRtpTransceiver transceivers[2];
+    RtcJitterBufferConfiguration jitterBufferConfiguration;
+    InboundPacketQueueStats queueStats;
+    OnFrameTestData testData[2];
+    PSrtpSession pSenderSrtpSession = NULL;
+    BYTE srtpKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    // VP8 payload descriptor starting the first partition of a key frame
+    BYTE payload[] = {0x10, 0x00, 0x11, 0x22};
+    BYTE packet[MIN_HEADER_LENGTH + SIZEOF(payload) + SRTP_MAX_TRAILER_LEN];
+    UINT32 packetLength, ssrc = 0x1234;
+    INT32 encryptedLength;
+    RtpPacket rtpPacket;
+    auto i = 0;
+
+    auto onFrameHandler = [](UINT64 customData, PFrame pFrame) -> void {
+        OnFrameTestData* pTestData = (OnFrameTestData*) customData;
+        UNUSED_PARAM(pFrame);
+        ATOMIC_INCREMENT(&pTestData->framesReceived);
+        // an application doing heavy work in the callback, bounded so that a failing test still finishes
+        for (auto j = 0; j < 1000 && ATOMIC_LOAD_BOOL(&pTestData->blocked); j++) {
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    };
+
+    // Both frames are sent to both peer connections from this thread, standing for the I/O worker they share
+    auto receiveFrame = [&](UINT16 sequenceNumber) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  setRtpPacket(2, FALSE, FALSE, 0, TRUE, DEFAULT_PAYLOAD_VP8, sequenceNumber, sequenceNumber * 3000, ssrc, NULL, 0, 0, NULL,
+                               payload, SIZEOF(payload), &rtpPacket));
+        packetLength = SIZEOF(packet);
+        EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, packet, &packetLength));
+        encryptedLength = (INT32) packetLength;
+        EXPECT_EQ(STATUS_SUCCESS, encryptRtpPacket(pSenderSrtpSession, packet, &encryptedLength));
+        for (auto j = 0; j < 2; j++) {
+            onInboundPacket((UINT64) pcs[j], packet, (UINT32) encryptedLength);
+        }
+    };
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&jitterBufferConfiguration, 0x00, SIZEOF(RtcJitterBufferConfiguration));
+    MEMSET(srtpKey, 0x5a, SIZEOF(srtpKey));
+    jitterBufferConfiguration.releaseOnMarker = TRUE;
+
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pSenderSrtpSession));
+
+    for (i = 0; i < 2; i++) {
+        ATOMIC_STORE(&testData[i].framesReceived, 0);
+        ATOMIC_STORE_BOOL(&testData[i].blocked, i == 0);
+
+        // Queued by default
+        EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pcs[i]));
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetInboundPacketQueueStats(pcs[i], &queueStats));
+        addTrackToPeerConnection(pcs[i], &tracks[i], &transceivers[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        EXPECT_EQ(STATUS_SUCCESS, transceiverSetJitterBufferConfiguration(transceivers[i], &jitterBufferConfiguration));
+        EXPECT_EQ(STATUS_SUCCESS, transceiverOnFrame(transceivers[i], (UINT64) &testData[i], onFrameHandler));
+
+        // Keys and the remote ssrc are normally set up by the DTLS handshake and the remote description
+        pKvsPeerConnection = (PKvsPeerConnection) pcs[i];
+        MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+        EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(srtpKey, srtpKey, SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+        EXPECT_EQ(STATUS_SUCCESS,
+                  hashTableUpsert(pKvsPeerConnection->pTransceiverSsrcTable, TRANSCEIVER_REMOTE_SSRC_KEY(ssrc), (UINT64) transceivers[i]));
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    // The first peer connection gets stuck in its callback
+    receiveFrame(1000);
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData[0].framesReceived) == 0; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData[0].framesReceived));
+
+    // The second one keeps receiving meanwhile
+    receiveFrame(1001);
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData[1].framesReceived) < 2; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(2, ATOMIC_LOAD(&testData[1].framesReceived));
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData[0].framesReceived));
+
+    // and the first one catches up once the application returns
+    ATOMIC_STORE_BOOL(&testData[0].blocked, FALSE);
+    for (i = 0; i < 500 && ATOMIC_LOAD(&testData[0].framesReceived) < 2; i++) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(2, ATOMIC_LOAD(&testData[0].framesReceived));
+
+    for (i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetInboundPacketQueueStats(pcs[i], &queueStats));
+        EXPECT_EQ(2, queueStats.packetsQueued);
+        EXPECT_EQ(0, queueStats.packetsDropped);
+        freePeerConnection(&pcs[i]);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSenderSrtpSession));
+}
+#endif
 }
 }
 }
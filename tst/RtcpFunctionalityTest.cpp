@@ -121,8 +121,83 @@ TEST_F(RtcpFunctionalityTest, rtcpNackListCompound) {
     EXPECT_EQ(compoundBuffer[1], 3327);
 }
 
+TEST_F(RtcpFunctionalityTest, createRtcpNackPacket) {
+    // 3243 and 3256 fit in the bitmask of 3240, 3257 is 17 away and starts an entry of its own
+    UINT16 sequenceNumbers[] = {3240, 3243, 3256, 3257, 65535, 2};
+    UINT16 parsedSequenceNumbers[ARRAY_SIZE(sequenceNumbers)];
+    UINT32 senderSsrc = 0, receiverSsrc = 0, sequenceNumberListLen = ARRAY_SIZE(parsedSequenceNumbers), packetLen = 0, i;
+    BYTE packet[64];
+    RtcpPacket rtcpPacket;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpNackPacket(0x2cd1a0de, 0xabe0, NULL, 1, packet, &packetLen));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtcpNackPacket(0x2cd1a0de, 0xabe0, sequenceNumbers, 0, packet, &packetLen));
+
+    // Sequence numbers wrapping around share an entry as well
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpNackPacket(0x2cd1a0de, 0xabe0, sequenceNumbers, ARRAY_SIZE(sequenceNumbers), NULL, &packetLen));
+    EXPECT_EQ(RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN + 3 * RTCP_NACK_ENTRY_LEN, packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRtcpNackPacket(0x2cd1a0de, 0xabe0, sequenceNumbers, ARRAY_SIZE(sequenceNumbers), packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpNackPacket(0x2cd1a0de, 0xabe0, sequenceNumbers, ARRAY_SIZE(sequenceNumbers), packet, &packetLen));
+
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK, rtcpPacket.header.packetType);
+    EXPECT_EQ(RTCP_FEEDBACK_MESSAGE_TYPE_NACK, rtcpPacket.header.receptionReportCount);
+    EXPECT_EQ(packetLen, rtcpPacket.payloadLength + RTCP_PACKET_HEADER_LEN);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcpNackListGet(rtcpPacket.payload, rtcpPacket.payloadLength, &senderSsrc, &receiverSsrc, parsedSequenceNumbers,
+                                              &sequenceNumberListLen));
+    EXPECT_EQ(0x2cd1a0de, senderSsrc);
+    EXPECT_EQ(0xabe0, receiverSsrc);
+    EXPECT_EQ(ARRAY_SIZE(sequenceNumbers), sequenceNumberListLen);
+    for (i = 0; i < ARRAY_SIZE(sequenceNumbers); i++) {
+        EXPECT_EQ(sequenceNumbers[i], parsedSequenceNumbers[i]);
+    }
+}
+
+TEST_F(RtcpFunctionalityTest, createRtcpPliAndFirPacket) {
+    BYTE packet[RTCP_FIR_PACKET_LEN];
+    UINT32 packetLen = 0;
+    RtcpPacket rtcpPacket;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpPliPacket(0x2cd1a0de, 0xabe0, packet, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpPliPacket(0x2cd1a0de, 0xabe0, NULL, &packetLen));
+    EXPECT_EQ(RTCP_PLI_PACKET_LEN, packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRtcpPliPacket(0x2cd1a0de, 0xabe0, packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpPliPacket(0x2cd1a0de, 0xabe0, packet, &packetLen));
+
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK, rtcpPacket.header.packetType);
+    EXPECT_EQ(RTCP_PSFB_PLI, rtcpPacket.header.receptionReportCount);
+    EXPECT_EQ(packetLen, rtcpPacket.payloadLength + RTCP_PACKET_HEADER_LEN);
+    EXPECT_EQ(0x2cd1a0de, getUnalignedInt32BigEndian(rtcpPacket.payload));
+    EXPECT_EQ(0xabe0, getUnalignedInt32BigEndian(rtcpPacket.payload + SIZEOF(UINT32)));
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpFirPacket(0x2cd1a0de, 0xabe0, 7, NULL, &packetLen));
+    EXPECT_EQ(RTCP_FIR_PACKET_LEN, packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRtcpFirPacket(0x2cd1a0de, 0xabe0, 7, packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpFirPacket(0x2cd1a0de, 0xabe0, 7, packet, &packetLen));
+
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK, rtcpPacket.header.packetType);
+    EXPECT_EQ(RTCP_PSFB_FIR, rtcpPacket.header.receptionReportCount);
+    EXPECT_EQ(packetLen, rtcpPacket.payloadLength + RTCP_PACKET_HEADER_LEN);
+
+    // The media source is named in the FCI entry, followed by the sequence number and reserved bytes
+    EXPECT_EQ(0x2cd1a0de, getUnalignedInt32BigEndian(rtcpPacket.payload));
+    EXPECT_EQ(0, getUnalignedInt32BigEndian(rtcpPacket.payload + SIZEOF(UINT32)));
+    EXPECT_EQ(0xabe0, getUnalignedInt32BigEndian(rtcpPacket.payload + RTCP_NACK_LIST_LEN));
+    EXPECT_EQ(0x07000000, getUnalignedInt32BigEndian(rtcpPacket.payload + RTCP_NACK_LIST_LEN + SIZEOF(UINT32)));
+}
+
 TEST_F(RtcpFunctionalityTest, onRtcpPacketCompound) {
     KvsPeerConnection peerConnection;
+    MEMSET(&peerConnection, 0x00, SIZEOF(KvsPeerConnection));
+    hashTableCreateWithParams(TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT, TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH, &peerConnection.pTransceiverSsrcTable);
 
     BYTE compound[] =  {
         0x80, 0xc8, 0x00, 0x06, 0xf1, 0x2d, 0x7b, 0x4b, 0xe1, 0xe3, 0x20, 0x43, 0xe5, 0x3d, 0x10, 0x2b,
@@ -131,6 +206,165 @@ TEST_F(RtcpFunctionalityTest, onRtcpPacketCompound) {
         0x4f, 0x2b, 0x70, 0x38, 0x64, 0x52, 0x00, 0x00,
     };
     EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&peerConnection, compound, SIZEOF(compound)));
+
+    hashTableFree(peerConnection.pTransceiverSsrcTable);
+}
+
+TEST_F(RtcpFunctionalityTest, createRtcpReportPacket) {
+    BYTE packet[RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN + 2 * RTCP_REPORT_BLOCK_LEN];
+    UINT32 packetLen = 0, ssrc = 0;
+    RtcpSenderInfo senderInfo, parsedSenderInfo;
+    RtcpReportBlock reportBlocks[2], parsedReportBlock;
+    RtcpPacket rtcpPacket;
+
+    senderInfo.ntpTimestamp = 0xe1e32043e53d102bULL;
+    senderInfo.rtpTimestamp = 0xbf58f7ef;
+    senderInfo.packetCount = 0x23f3;
+    senderInfo.octetCount = 0x6cd375;
+
+    MEMSET(reportBlocks, 0x00, SIZEOF(reportBlocks));
+    reportBlocks[0].ssrc = 0xabe0;
+    reportBlocks[0].fractionLost = 25;
+    reportBlocks[0].cumulativeLost = 300;
+    reportBlocks[0].extendedHighestSequenceNumber = 0x1fff0;
+    reportBlocks[0].jitter = 90;
+    reportBlocks[0].lastSenderReport = 0x2043e53d;
+    reportBlocks[0].delaySinceLastSenderReport = 0x8000;
+    reportBlocks[1].ssrc = 0xabe1;
+    // Duplicates make the number of packets lost negative
+    reportBlocks[1].cumulativeLost = -2;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpReportPacket(0x2cd1a0de, &senderInfo, reportBlocks, 2, packet, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x2cd1a0de, &senderInfo, reportBlocks, 2, NULL, &packetLen));
+    EXPECT_EQ(SIZEOF(packet), packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRtcpReportPacket(0x2cd1a0de, &senderInfo, reportBlocks, 2, packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x2cd1a0de, &senderInfo, reportBlocks, 2, packet, &packetLen));
+
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_SENDER_REPORT, rtcpPacket.header.packetType);
+    EXPECT_EQ(2, rtcpPacket.header.receptionReportCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcpSenderReportGet(rtcpPacket.payload, rtcpPacket.payloadLength, &ssrc, &parsedSenderInfo));
+    EXPECT_EQ(0x2cd1a0de, ssrc);
+    EXPECT_EQ(senderInfo.ntpTimestamp, parsedSenderInfo.ntpTimestamp);
+    EXPECT_EQ(senderInfo.rtpTimestamp, parsedSenderInfo.rtpTimestamp);
+    EXPECT_EQ(senderInfo.packetCount, parsedSenderInfo.packetCount);
+    EXPECT_EQ(senderInfo.octetCount, parsedSenderInfo.octetCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReportBlockGet(rtcpPacket.payload + SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN, RTCP_REPORT_BLOCK_LEN, &parsedReportBlock));
+    EXPECT_EQ(0xabe0, parsedReportBlock.ssrc);
+    EXPECT_EQ(25, parsedReportBlock.fractionLost);
+    EXPECT_EQ(300, parsedReportBlock.cumulativeLost);
+    EXPECT_EQ(0x1fff0, parsedReportBlock.extendedHighestSequenceNumber);
+    EXPECT_EQ(90, parsedReportBlock.jitter);
+    EXPECT_EQ(0x2043e53d, parsedReportBlock.lastSenderReport);
+    EXPECT_EQ(0x8000, parsedReportBlock.delaySinceLastSenderReport);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReportBlockGet(rtcpPacket.payload + SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN + RTCP_REPORT_BLOCK_LEN,
+                                                 RTCP_REPORT_BLOCK_LEN, &parsedReportBlock));
+    EXPECT_EQ(0xabe1, parsedReportBlock.ssrc);
+    EXPECT_EQ(-2, parsedReportBlock.cumulativeLost);
+    EXPECT_EQ(STATUS_RTCP_INPUT_PACKET_TOO_SMALL, rtcpReportBlockGet(rtcpPacket.payload, RTCP_REPORT_BLOCK_LEN - 1, &parsedReportBlock));
+
+    // Without sender info it is a receiver report
+    packetLen = SIZEOF(packet);
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x2cd1a0de, NULL, reportBlocks, 1, packet, &packetLen));
+    EXPECT_EQ(RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + RTCP_REPORT_BLOCK_LEN, packetLen);
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_RECEIVER_REPORT, rtcpPacket.header.packetType);
+    EXPECT_EQ(1, rtcpPacket.header.receptionReportCount);
+    EXPECT_EQ(0x2cd1a0de, getUnalignedInt32BigEndian(rtcpPacket.payload));
+    EXPECT_EQ(STATUS_RTCP_INPUT_PACKET_TOO_SMALL, rtcpSenderReportGet(rtcpPacket.payload, SIZEOF(UINT32) + RTCP_SENDER_INFO_LEN - 1, &ssrc, &parsedSenderInfo));
+}
+
+TEST_F(RtcpFunctionalityTest, rtcpReceptionStats) {
+    RtcpReceptionStats receptionStats;
+    RtcpReportBlock reportBlock;
+    UINT16 sequenceNumber;
+
+    MEMSET(&receptionStats, 0x00, SIZEOF(RtcpReceptionStats));
+
+    // Nothing received yet
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsGetReportBlock(&receptionStats, 0xabe0, 10, 0, &reportBlock));
+    EXPECT_EQ(0xabe0, reportBlock.ssrc);
+    EXPECT_EQ(10, reportBlock.jitter);
+    EXPECT_EQ(0, reportBlock.fractionLost);
+    EXPECT_EQ(0, reportBlock.cumulativeLost);
+
+    // 65530 to 9 across the wrap with 5 and 6 missing, 16 expected, 14 received
+    for (sequenceNumber = 65530; sequenceNumber != 10; sequenceNumber++) {
+        if (sequenceNumber != 5 && sequenceNumber != 6) {
+            EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsUpdate(&receptionStats, sequenceNumber));
+        }
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsGetReportBlock(&receptionStats, 0xabe0, 10, 0, &reportBlock));
+    EXPECT_EQ((1 << 16) + 9, reportBlock.extendedHighestSequenceNumber);
+    EXPECT_EQ(2, reportBlock.cumulativeLost);
+    EXPECT_EQ((2 << 8) / 16, reportBlock.fractionLost);
+    // No sender report received to echo
+    EXPECT_EQ(0, reportBlock.lastSenderReport);
+    EXPECT_EQ(0, reportBlock.delaySinceLastSenderReport);
+
+    // A retransmission of a missing packet arrives late, the next interval has more received than expected
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsUpdate(&receptionStats, 5));
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsUpdate(&receptionStats, 10));
+
+    receptionStats.lastSenderReport = 0x2043e53d;
+    receptionStats.lastSenderReportReceivedTime = HUNDREDS_OF_NANOS_IN_A_SECOND;
+    EXPECT_EQ(STATUS_SUCCESS, rtcpReceptionStatsGetReportBlock(&receptionStats, 0xabe0, 10, 3 * HUNDREDS_OF_NANOS_IN_A_SECOND / 2, &reportBlock));
+    EXPECT_EQ((1 << 16) + 10, reportBlock.extendedHighestSequenceNumber);
+    EXPECT_EQ(1, reportBlock.cumulativeLost);
+    EXPECT_EQ(0, reportBlock.fractionLost);
+    EXPECT_EQ(0x2043e53d, reportBlock.lastSenderReport);
+    EXPECT_EQ(RTCP_SHORT_NTP_UNITS_IN_A_SECOND / 2, reportBlock.delaySinceLastSenderReport);
+}
+
+TEST_F(RtcpFunctionalityTest, onRtcpReceiverReport) {
+    BYTE rawRtcpPacket[RTCP_PACKET_HEADER_LEN + SIZEOF(UINT32) + RTCP_REPORT_BLOCK_LEN];
+    UINT32 rawRtcpPacketLen = SIZEOF(rawRtcpPacket);
+    KvsPeerConnection kpc;
+    KvsRtpTransceiver kvsRtpTransceiver;
+    RtcpReportBlock reportBlock;
+
+    MEMSET(&kpc, 0x00, SIZEOF(KvsPeerConnection));
+    MEMSET(&kvsRtpTransceiver, 0x00, SIZEOF(KvsRtpTransceiver));
+    kvsRtpTransceiver.statsLock = MUTEX_CREATE(FALSE);
+    kvsRtpTransceiver.sender.ssrc = 0x1DC86991;
+    hashTableCreateWithParams(TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT, TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH, &kpc.pTransceiverSsrcTable);
+    hashTablePut(kpc.pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(kvsRtpTransceiver.sender.ssrc), (UINT64) &kvsRtpTransceiver);
+
+    // The remote peer got our report half a second ago and held it for a quarter of a second
+    MEMSET(&reportBlock, 0x00, SIZEOF(RtcpReportBlock));
+    reportBlock.ssrc = kvsRtpTransceiver.sender.ssrc;
+    reportBlock.fractionLost = 64;
+    reportBlock.lastSenderReport = (UINT32) (convertTimestampToNtp(GETTIME() - HUNDREDS_OF_NANOS_IN_A_SECOND / 2) >> 16);
+    reportBlock.delaySinceLastSenderReport = RTCP_SHORT_NTP_UNITS_IN_A_SECOND / 4;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x00000001, NULL, &reportBlock, 1, rawRtcpPacket, &rawRtcpPacketLen));
+    EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&kpc, rawRtcpPacket, rawRtcpPacketLen));
+    EXPECT_EQ(1, kvsRtpTransceiver.remoteInboundRtpStreamStats.reportsReceived);
+    EXPECT_EQ(64, kvsRtpTransceiver.remoteInboundRtpStreamStats.fractionLost);
+    EXPECT_EQ(1, kvsRtpTransceiver.remoteInboundRtpStreamStats.roundTripTimeMeasurements);
+    EXPECT_LE(HUNDREDS_OF_NANOS_IN_A_SECOND / 4 - HUNDREDS_OF_NANOS_IN_A_MILLISECOND, kvsRtpTransceiver.remoteInboundRtpStreamStats.roundTripTime);
+    EXPECT_GE(HUNDREDS_OF_NANOS_IN_A_SECOND / 2, kvsRtpTransceiver.remoteInboundRtpStreamStats.roundTripTime);
+
+    // Blocks about streams of other connections are ignored, and no round trip time without a sender report to echo
+    reportBlock.ssrc = 0x2cd1a0de;
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x00000001, NULL, &reportBlock, 1, rawRtcpPacket, &rawRtcpPacketLen));
+    EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&kpc, rawRtcpPacket, rawRtcpPacketLen));
+    reportBlock.ssrc = kvsRtpTransceiver.sender.ssrc;
+    reportBlock.lastSenderReport = 0;
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpReportPacket(0x00000001, NULL, &reportBlock, 1, rawRtcpPacket, &rawRtcpPacketLen));
+    EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&kpc, rawRtcpPacket, rawRtcpPacketLen));
+    EXPECT_EQ(2, kvsRtpTransceiver.remoteInboundRtpStreamStats.reportsReceived);
+    EXPECT_EQ(1, kvsRtpTransceiver.remoteInboundRtpStreamStats.roundTripTimeMeasurements);
+
+    hashTableFree(kpc.pTransceiverSsrcTable);
+    MUTEX_FREE(kvsRtpTransceiver.statsLock);
 }
 
 TEST_F(RtcpFunctionalityTest, rembValueGet) {
@@ -175,6 +409,77 @@ TEST_F(RtcpFunctionalityTest, rembValueGet) {
     EXPECT_EQ(STATUS_RTCP_INPUT_REMB_INVALID, rembValueGet(invalidSSRCLength, SIZEOF(invalidSSRCLength), &maximumBitRate, ssrcList, &ssrcListLen));
 }
 
+TEST_F(RtcpFunctionalityTest, createRtcpTwccPacket) {
+    // Multiples of the delta unit so that they read back unchanged
+    INT64 arrivalTimes[45], parsedArrivalTimes[45];
+    BYTE packet[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 packetLen = 0, parsedCount = ARRAY_SIZE(parsedArrivalTimes), i;
+    UINT16 baseSequenceNumber = 0;
+    UINT8 feedbackCount = 0;
+    RtcpPacket rtcpPacket;
+    INT64 startTime = 10 * HUNDREDS_OF_NANOS_IN_A_SECOND + 3 * RTCP_TWCC_DELTA_UNIT;
+
+    // Received, lost, small delta, large delta, negative delta and a few more to fill status vectors
+    arrivalTimes[0] = startTime;
+    arrivalTimes[1] = RTCP_TWCC_PACKET_NOT_RECEIVED;
+    arrivalTimes[2] = startTime + 4 * RTCP_TWCC_DELTA_UNIT;
+    arrivalTimes[3] = startTime + 100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    arrivalTimes[4] = startTime + 98 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    for (i = 5; i < 10; i++) {
+        arrivalTimes[i] = startTime + (100 + i) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    }
+    // A run of lost packets and a run of small deltas take run length chunks
+    for (i = 10; i < 30; i++) {
+        arrivalTimes[i] = RTCP_TWCC_PACKET_NOT_RECEIVED;
+    }
+    for (i = 30; i < ARRAY_SIZE(arrivalTimes); i++) {
+        arrivalTimes[i] = startTime + (200 + i) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    }
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpTwccPacket(0x2cd1a0de, 0xabe0, MAX_UINT16, 7, NULL, ARRAY_SIZE(arrivalTimes), packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpTwccPacket(0x2cd1a0de, 0xabe0, MAX_UINT16, 7, arrivalTimes, ARRAY_SIZE(arrivalTimes), NULL, &packetLen));
+    EXPECT_EQ(0, packetLen % RTCP_PACKET_LEN_WORD_SIZE);
+    EXPECT_GE(SIZEOF(packet), packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRtcpTwccPacket(0x2cd1a0de, 0xabe0, MAX_UINT16, 7, arrivalTimes, ARRAY_SIZE(arrivalTimes), packet, &packetLen));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpTwccPacket(0x2cd1a0de, 0xabe0, MAX_UINT16, 7, arrivalTimes, ARRAY_SIZE(arrivalTimes), packet, &packetLen));
+
+    MEMSET(&rtcpPacket, 0x00, SIZEOF(RtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet, packetLen, &rtcpPacket));
+    EXPECT_EQ(RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK, rtcpPacket.header.packetType);
+    EXPECT_EQ(RTCP_FEEDBACK_MESSAGE_TYPE_TRANSPORT_WIDE_CC, rtcpPacket.header.receptionReportCount);
+    EXPECT_EQ(0x2cd1a0de, getUnalignedInt32BigEndian(rtcpPacket.payload));
+
+    // Only the number of packets
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, NULL, &parsedCount));
+    EXPECT_EQ(ARRAY_SIZE(arrivalTimes), parsedCount);
+    parsedCount--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY,
+              rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, parsedArrivalTimes, &parsedCount));
+
+    parsedCount = ARRAY_SIZE(parsedArrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS,
+              rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, parsedArrivalTimes, &parsedCount));
+    EXPECT_EQ(MAX_UINT16, baseSequenceNumber);
+    EXPECT_EQ(7, feedbackCount);
+    EXPECT_EQ(ARRAY_SIZE(arrivalTimes), parsedCount);
+    for (i = 0; i < ARRAY_SIZE(arrivalTimes); i++) {
+        EXPECT_EQ(arrivalTimes[i], parsedArrivalTimes[i]) << "packet " << i;
+    }
+
+    // Deltas missing
+    parsedCount = ARRAY_SIZE(parsedArrivalTimes);
+    EXPECT_EQ(STATUS_RTCP_INPUT_PACKET_TOO_SMALL,
+              rtcpTwccFeedbackGet(rtcpPacket.payload, RTCP_TWCC_FEEDBACK_HEADER_LEN + 2, &baseSequenceNumber, &feedbackCount, parsedArrivalTimes, &parsedCount));
+
+    // A run length chunk of no packets and a reserved symbol are rejected
+    BYTE emptyRun[] = {0x2c, 0xd1, 0xa0, 0xde, 0x00, 0x00, 0xab, 0xe0, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_EQ(STATUS_RTCP_INPUT_TWCC_INVALID, rtcpTwccFeedbackGet(emptyRun, SIZEOF(emptyRun), &baseSequenceNumber, &feedbackCount, parsedArrivalTimes, &parsedCount));
+    BYTE reservedSymbol[] = {0x2c, 0xd1, 0xa0, 0xde, 0x00, 0x00, 0xab, 0xe0, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x60, 0x01, 0x00, 0x00};
+    EXPECT_EQ(STATUS_RTCP_INPUT_TWCC_INVALID,
+              rtcpTwccFeedbackGet(reservedSymbol, SIZEOF(reservedSymbol), &baseSequenceNumber, &feedbackCount, parsedArrivalTimes, &parsedCount));
+}
+
 TEST_F(RtcpFunctionalityTest, onpli) {
     BYTE rawRtcpPacket[] = {0x81, 0xCE, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x1D, 0xC8, 0x69, 0x91};
     RtcpPacket rtcpPacket;
@@ -186,6 +491,8 @@ TEST_F(RtcpFunctionalityTest, onpli) {
     doubleListCreate(&kpc.pTransceievers);
     doubleListInsertItemHead(kpc.pTransceievers, (UINT64) &kvsRtpTransceiver);
     kvsRtpTransceiver.sender.ssrc =  0x1DC86991;
+    hashTableCreateWithParams(TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT, TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH, &kpc.pTransceiverSsrcTable);
+    hashTablePut(kpc.pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(kvsRtpTransceiver.sender.ssrc), (UINT64) &kvsRtpTransceiver);
     kvsRtpTransceiver.onPictureLossCustomData = (UINT64) &on_picture_loss_called;
     kvsRtpTransceiver.onPictureLoss = [](UINT64 customData) -> void {
       *(PBOOL)customData = TRUE;
@@ -197,7 +504,90 @@ TEST_F(RtcpFunctionalityTest, onpli) {
 
     onRtcpPLIPacket(&rtcpPacket, &kpc);
     ASSERT_TRUE(on_picture_loss_called);
+
+    // A remote stream with the same ssrc is not mistaken for the local sender
+    on_picture_loss_called = FALSE;
+    hashTableRemove(kpc.pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(kvsRtpTransceiver.sender.ssrc));
+    hashTablePut(kpc.pTransceiverSsrcTable, TRANSCEIVER_REMOTE_SSRC_KEY(kvsRtpTransceiver.sender.ssrc), (UINT64) &kvsRtpTransceiver);
+    EXPECT_EQ(STATUS_RTCP_INPUT_SSRC_INVALID, onRtcpPLIPacket(&rtcpPacket, &kpc));
+    ASSERT_FALSE(on_picture_loss_called);
+
+    hashTableFree(kpc.pTransceiverSsrcTable);
+    doubleListFree(kpc.pTransceievers);
+}
+
+TEST_F(RtcpFunctionalityTest, onfir) {
+    BYTE rawRtcpPacket[RTCP_FIR_PACKET_LEN];
+    UINT32 rawRtcpPacketLen = SIZEOF(rawRtcpPacket);
+    KvsPeerConnection kpc;
+    KvsRtpTransceiver kvsRtpTransceiver;
+    UINT32 onPictureLossCount = 0;
+    MEMSET(&kvsRtpTransceiver, 0, sizeof(KvsRtpTransceiver));
+
+    doubleListCreate(&kpc.pTransceievers);
+    doubleListInsertItemHead(kpc.pTransceievers, (UINT64) &kvsRtpTransceiver);
+    kvsRtpTransceiver.sender.ssrc =  0x1DC86991;
+    hashTableCreateWithParams(TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_COUNT, TRANSCEIVER_SSRC_HASH_TABLE_BUCKET_LENGTH, &kpc.pTransceiverSsrcTable);
+    hashTablePut(kpc.pTransceiverSsrcTable, TRANSCEIVER_LOCAL_SSRC_KEY(kvsRtpTransceiver.sender.ssrc), (UINT64) &kvsRtpTransceiver);
+    kvsRtpTransceiver.onPictureLossCustomData = (UINT64) &onPictureLossCount;
+    kvsRtpTransceiver.onPictureLoss = [](UINT64 customData) -> void {
+      (*(PUINT32)customData)++;
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpFirPacket(0x00000001, kvsRtpTransceiver.sender.ssrc, 0, rawRtcpPacket, &rawRtcpPacketLen));
+    EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&kpc, rawRtcpPacket, rawRtcpPacketLen));
+    EXPECT_EQ(1, onPictureLossCount);
+
+    // FIRs for media sources of other connections are ignored
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpFirPacket(0x00000001, 0x2cd1a0de, 1, rawRtcpPacket, &rawRtcpPacketLen));
+    EXPECT_EQ(STATUS_SUCCESS, onRtcpPacket(&kpc, rawRtcpPacket, rawRtcpPacketLen));
+    EXPECT_EQ(1, onPictureLossCount);
+
+    hashTableFree(kpc.pTransceiverSsrcTable);
+    doubleListFree(kpc.pTransceievers);
+}
+
+TEST_F(RtcpFunctionalityTest, feedbackTimerSkipsBusyReceivers) {
+    KvsPeerConnection kpc;
+    KvsRtpTransceiver kvsRtpTransceiver;
+
+    MEMSET(&kpc, 0x00, SIZEOF(KvsPeerConnection));
+    MEMSET(&kvsRtpTransceiver, 0x00, SIZEOF(KvsRtpTransceiver));
+    kpc.pSrtpSessionLock = MUTEX_CREATE(TRUE);
+    kpc.peerConnectionObjLock = MUTEX_CREATE(FALSE);
+    doubleListCreate(&kpc.pTransceievers);
+    doubleListInsertItemHead(kpc.pTransceievers, (UINT64) &kvsRtpTransceiver);
+    kvsRtpTransceiver.receiverLock = MUTEX_CREATE(FALSE);
+    kvsRtpTransceiver.sender.ssrc = 0x1DC86991;
+    kvsRtpTransceiver.jitterBufferSsrc = 0x2cd1a0de;
+    kvsRtpTransceiver.transceiver.receiver.track.codec = RTC_CODEC_VP8;
+    EXPECT_EQ(STATUS_SUCCESS, createJitterBuffer(onFrameReadyFunc, onFrameDroppedFunc, depayVP8FromRtpPayload, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                                 VIDEO_CLOCKRATE, (UINT64) &kvsRtpTransceiver, &kvsRtpTransceiver.pJitterBuffer));
+
+    // Nothing to report before the first packet
+    kvsRtpTransceiver.keyFrameRequired = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, rtcpFeedbackTimerCallback(0, GETTIME(), (UINT64) &kpc));
+    EXPECT_EQ(0, kvsRtpTransceiver.lastReceiverReportTime);
+    EXPECT_EQ(0, ATOMIC_LOAD(&kvsRtpTransceiver.pliPacketsSent));
+
+    // The receiving thread holds the lock, the tick goes by without waiting for it
+    ATOMIC_STORE(&kvsRtpTransceiver.packetsReceived, 1);
+    MUTEX_LOCK(kvsRtpTransceiver.receiverLock);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpFeedbackTimerCallback(0, GETTIME(), (UINT64) &kpc));
+    MUTEX_UNLOCK(kvsRtpTransceiver.receiverLock);
+    EXPECT_EQ(0, kvsRtpTransceiver.lastReceiverReportTime);
+    EXPECT_EQ(0, ATOMIC_LOAD(&kvsRtpTransceiver.pliPacketsSent));
+
+    // Packets are discarded without SRTP, the report and the key frame request are accounted all the same
+    EXPECT_EQ(STATUS_SUCCESS, rtcpFeedbackTimerCallback(0, GETTIME(), (UINT64) &kpc));
+    EXPECT_NE(0, kvsRtpTransceiver.lastReceiverReportTime);
+    EXPECT_EQ(1, ATOMIC_LOAD(&kvsRtpTransceiver.pliPacketsSent));
+
+    freeJitterBuffer(&kvsRtpTransceiver.pJitterBuffer);
+    MUTEX_FREE(kvsRtpTransceiver.receiverLock);
     doubleListFree(kpc.pTransceievers);
+    MUTEX_FREE(kpc.peerConnectionObjLock);
+    MUTEX_FREE(kpc.pSrtpSessionLock);
 }
 
 }
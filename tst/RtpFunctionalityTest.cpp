@@ -42,7 +42,7 @@ TEST_F(RtpFunctionalityTest, marshallUnmarshallGettingSameData)
     packetList = (PRtpPacket) MEMALLOC(SIZEOF(RtpPacket));
 
     SRAND(GETTIME());
-    EXPECT_EQ(STATUS_SUCCESS, constructRtpPackets(&payloadArray, 8, 1, 1324857487, 0x1234ABCD, (PRtpPacket) packetList, payloadArray.payloadSubLenSize));
+    EXPECT_EQ(STATUS_SUCCESS, constructRtpPackets(&payloadArray, 8, 1, 1324857487, 0x1234ABCD, 0, 0, NULL, (PRtpPacket) packetList, payloadArray.payloadSubLenSize));
 
     EXPECT_NE(NULL, (UINT64) packetList);
 
@@ -155,6 +155,9 @@ TEST_F(RtpFunctionalityTest, marshallUnmarshallH264Data)
                             seqNum,
                             (UINT32) ((curTime - startTimeStamp) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND),
                             0x1234ABCD,
+                            0,
+                            0,
+                            NULL,
                             pPacketList,
                             payloadArray.payloadSubLenSize);
 
@@ -494,6 +497,421 @@ TEST_F(RtpFunctionalityTest, packingUnpackingVerifySameLongG711Frame)
     MEMFREE(depayload);
 }
 
+TEST_F(RtpFunctionalityTest, packetArenaOnlyGrowsWhenNeeded)
+{
+    RtpPacketArena packetArena;
+
+    MEMSET(&packetArena, 0x00, SIZEOF(RtpPacketArena));
+
+    EXPECT_NE(STATUS_SUCCESS, rtpPacketArenaReserve(NULL, 1, DEFAULT_MTU_SIZE));
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketArenaReserve(&packetArena, 10, DEFAULT_MTU_SIZE));
+    EXPECT_EQ(2, packetArena.allocationCount);
+    EXPECT_LE(10, packetArena.packetListCapacity);
+    EXPECT_LE(10, packetArena.slotCount);
+    EXPECT_LE(DEFAULT_MTU_SIZE + SRTP_AUTH_TAG_OVERHEAD, packetArena.slotSize);
+
+    // Smaller or equal frames reuse the arena
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketArenaReserve(&packetArena, 10, DEFAULT_MTU_SIZE));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketArenaReserve(&packetArena, 3, 100));
+    EXPECT_EQ(2, packetArena.allocationCount);
+
+    // Larger packets only grow the slab
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketArenaReserve(&packetArena, 10, DEFAULT_MTU_SIZE * 2));
+    EXPECT_EQ(3, packetArena.allocationCount);
+    EXPECT_LE(DEFAULT_MTU_SIZE * 2 + SRTP_AUTH_TAG_OVERHEAD, packetArena.slotSize);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketArenaFree(&packetArena));
+    EXPECT_EQ(NULL, (UINT64) packetArena.pPacketList);
+    EXPECT_EQ(NULL, (UINT64) packetArena.pSlab);
+}
+
+struct RingCapture {
+    BYTE packets[16][DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH];
+    UINT32 packetLengths[16];
+    UINT32 packetCount;
+};
+
+STATUS captureRingPackets(UINT64 customData, PRtpPacket pPackets, UINT32 packetCount)
+{
+    RingCapture* pCapture = (RingCapture*) customData;
+    UINT32 i;
+
+    for (i = 0; i < packetCount; i++) {
+        MEMCPY(pCapture->packets[pCapture->packetCount], pPackets[i].pRawPacket, pPackets[i].rawPacketLength);
+        pCapture->packetLengths[pCapture->packetCount] = pPackets[i].rawPacketLength;
+        pCapture->packetCount++;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(RtpFunctionalityTest, packetRingH264SinglePass)
+{
+    BYTE frame[4 + 10 + 4 + 4 + 4 + 3000];
+    BYTE depayBuffer[SIZEOF(frame)];
+    BYTE slots[4 * (DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD)];
+    RtpPacket packets[4];
+    RtpPacketRing ring;
+    RtpPacket rtpPacket;
+    RingCapture capture;
+    UINT32 i, frameLength = 0, naluLength, depayLength = 0;
+    BOOL isStart;
+
+    // SPS, PPS and a large IDR slice
+    MEMCPY(frame, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[4] = 0x67;
+    MEMSET(frame + 5, 0x11, 9);
+    MEMCPY(frame + 14, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[18] = 0x68;
+    MEMSET(frame + 19, 0x22, 3);
+    MEMCPY(frame + 22, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[26] = 0x65;
+    for (i = 27; i < SIZEOF(frame); i++) {
+        frame[i] = (BYTE) (i % 251 + 1);
+    }
+    frameLength = SIZEOF(frame);
+
+    MEMSET(&capture, 0x00, SIZEOF(RingCapture));
+    MEMSET(&ring, 0x00, SIZEOF(RtpPacketRing));
+    ring.payloadType = 96;
+    ring.sequenceNumber = MAX_UINT16;
+    ring.timestamp = 1234;
+    ring.ssrc = 0xdeadbeef;
+    ring.pPackets = packets;
+    ring.pSlots = slots;
+    ring.slotSize = DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD;
+    ring.slotCount = ARRAY_SIZE(packets) - 1;
+    ring.slotTailroom = SRTP_AUTH_TAG_OVERHEAD;
+
+    // A ring that can not hold the whole frame fails, the caller starts over with more slots
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, createRtpPacketsForH264(DEFAULT_MTU_SIZE, frame, frameLength, &ring));
+    EXPECT_EQ(ring.slotCount, ring.packetCount);
+
+    ring.packetCount = 0;
+    ring.sequenceNumber = MAX_UINT16;
+    ring.slotCount = ARRAY_SIZE(packets);
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketsForH264(DEFAULT_MTU_SIZE, frame, frameLength, &ring));
+    EXPECT_EQ(STATUS_SUCCESS, captureRingPackets((UINT64) &capture, ring.pPackets, ring.packetCount));
+
+    // STAP-A with SPS/PPS followed by three FU-A fragments of the IDR
+    EXPECT_EQ(4, capture.packetCount);
+    EXPECT_EQ(3, ring.sequenceNumber);
+
+    for (i = 0; i < capture.packetCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(capture.packets[i], capture.packetLengths[i], &rtpPacket));
+        EXPECT_EQ(96, rtpPacket.header.payloadType);
+        EXPECT_EQ((UINT16) (MAX_UINT16 + i), rtpPacket.header.sequenceNumber);
+        EXPECT_EQ(1234, rtpPacket.header.timestamp);
+        EXPECT_EQ(0xdeadbeef, rtpPacket.header.ssrc);
+        EXPECT_EQ(i == capture.packetCount - 1, rtpPacket.header.marker);
+        EXPECT_GE(DEFAULT_MTU_SIZE, rtpPacket.payloadLength);
+
+        naluLength = SIZEOF(depayBuffer) - depayLength;
+        EXPECT_EQ(STATUS_SUCCESS, depayH264FromRtpPayload(rtpPacket.payload, rtpPacket.payloadLength, depayBuffer + depayLength, &naluLength, &isStart));
+        depayLength += naluLength;
+    }
+
+    EXPECT_EQ(STAP_A_INDICATOR, capture.packets[0][MIN_HEADER_LENGTH] & NAL_TYPE_MASK);
+    EXPECT_EQ(frameLength, depayLength);
+    EXPECT_EQ(0, MEMCMP(frame, depayBuffer, frameLength));
+}
+
+TEST_F(RtpFunctionalityTest, packetRingH264AggregatesOnlyParameterSets)
+{
+    // SPS, PPS, SEI and a small IDR slice
+    BYTE frame[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80,
+                    0x00, 0x00, 0x00, 0x01, 0x06, 0x05, 0x01, 0xaa, 0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x21};
+    BYTE slots[4 * (DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD)];
+    RtpPacket packets[4];
+    RtpPacketRing ring;
+    RtpPacket rtpPacket;
+    RingCapture capture;
+
+    MEMSET(&capture, 0x00, SIZEOF(RingCapture));
+    MEMSET(&ring, 0x00, SIZEOF(RtpPacketRing));
+    ring.payloadType = 96;
+    ring.pPackets = packets;
+    ring.pSlots = slots;
+    ring.slotSize = DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD;
+    ring.slotCount = ARRAY_SIZE(packets);
+    ring.slotTailroom = SRTP_AUTH_TAG_OVERHEAD;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketsForH264(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &ring));
+    EXPECT_EQ(STATUS_SUCCESS, captureRingPackets((UINT64) &capture, ring.pPackets, ring.packetCount));
+
+    // The SEI and the slice keep single NALU packets, as createPayloadForH264 sends them
+    EXPECT_EQ(3, capture.packetCount);
+    EXPECT_EQ(STAP_A_INDICATOR, capture.packets[0][MIN_HEADER_LENGTH] & NAL_TYPE_MASK);
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(capture.packets[1], capture.packetLengths[1], &rtpPacket));
+    EXPECT_EQ(4, rtpPacket.payloadLength);
+    EXPECT_EQ(0, MEMCMP(frame + 20, rtpPacket.payload, rtpPacket.payloadLength));
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(capture.packets[2], capture.packetLengths[2], &rtpPacket));
+    EXPECT_EQ(4, rtpPacket.payloadLength);
+    EXPECT_EQ(0, MEMCMP(frame + 28, rtpPacket.payload, rtpPacket.payloadLength));
+    EXPECT_TRUE(rtpPacket.header.marker);
+}
+
+TEST_F(RtpFunctionalityTest, headerExtensionElements)
+{
+    // One byte header extension with padding, an element of id 3 and one of id 1, the transport wide sequence number
+    BYTE oneByteExtension[] = {0x00, 0x31, 0xaa, 0xbb, 0x11, 0x12, 0x34, 0x00};
+    // Two byte header extension with an element of id 1 and 3 bytes
+    BYTE twoByteExtension[] = {0x01, 0x03, 0xcc, 0xdd, 0xee, 0x00, 0x00, 0x00};
+    BYTE payload[] = {0x01, 0x02, 0x03};
+    BYTE rawPacket[MIN_HEADER_LENGTH + RTP_HEADER_EXTENSION_HEADER_LENGTH + SIZEOF(oneByteExtension) + SIZEOF(payload)];
+    UINT32 rawPacketLength = SIZEOF(rawPacket), dataLength = 0;
+    PBYTE pData = NULL;
+    RtpPacket rtpPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacket(2, FALSE, TRUE, 0, FALSE, 96, 1, 1234, 0xdeadbeef, NULL, RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE,
+                                           SIZEOF(oneByteExtension), oneByteExtension, payload, SIZEOF(payload), &rtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, rawPacket, &rawPacketLength));
+    EXPECT_EQ(SIZEOF(rawPacket), rawPacketLength);
+
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(rawPacket, rawPacketLength, 1, &pData, &dataLength));
+    EXPECT_EQ(2, dataLength);
+    EXPECT_EQ(0x1234, getUnalignedInt16BigEndian(pData));
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(rawPacket, rawPacketLength, 3, &pData, &dataLength));
+    EXPECT_EQ(2, dataLength);
+    EXPECT_EQ(0xaa, pData[0]);
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(rawPacket, rawPacketLength, 2, &pData, &dataLength));
+    EXPECT_TRUE(pData == NULL);
+    EXPECT_EQ(0, dataLength);
+
+    // The extension claims more than the packet has
+    EXPECT_EQ(STATUS_RTP_INVALID_EXTENSION_LEN,
+              getRtpHeaderExtensionFromBytes(rawPacket, MIN_HEADER_LENGTH + RTP_HEADER_EXTENSION_HEADER_LENGTH, 1, &pData, &dataLength));
+
+    rawPacketLength = SIZEOF(rawPacket);
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacket(2, FALSE, TRUE, 0, FALSE, 96, 1, 1234, 0xdeadbeef, NULL, RTP_TWO_BYTE_HEADER_EXTENSION_PROFILE,
+                                           SIZEOF(twoByteExtension), twoByteExtension, payload, SIZEOF(payload), &rtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, rawPacket, &rawPacketLength));
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(rawPacket, rawPacketLength, 1, &pData, &dataLength));
+    EXPECT_EQ(3, dataLength);
+    EXPECT_EQ(0xcc, pData[0]);
+
+    // No extension at all
+    rawPacketLength = SIZEOF(rawPacket);
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, 1, 1234, 0xdeadbeef, NULL, 0, 0, NULL, payload, SIZEOF(payload),
+                                           &rtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, rawPacket, &rawPacketLength));
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(rawPacket, rawPacketLength, 1, &pData, &dataLength));
+    EXPECT_TRUE(pData == NULL);
+}
+
+TEST_F(RtpFunctionalityTest, packetRingCopiesHeaderExtension)
+{
+    BYTE frame[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0x11, 0x22, 0x33};
+    BYTE extension[TWCC_HEADER_EXTENSION_LENGTH] = {(TWCC_DEFAULT_EXTENSION_ID << RTP_ONE_BYTE_HEADER_EXTENSION_ID_SHIFT) | 1, 0x00, 0x00, 0x00};
+    BYTE slots[2 * (DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + TWCC_HEADER_EXTENSION_OVERHEAD + SRTP_AUTH_TAG_OVERHEAD)];
+    RtpPacket packets[2];
+    RtpPacketRing ring;
+    RtpPacket rtpPacket;
+    RingCapture capture;
+    UINT32 dataLength = 0;
+    PBYTE pData = NULL;
+
+    MEMSET(&capture, 0x00, SIZEOF(RingCapture));
+    MEMSET(&ring, 0x00, SIZEOF(RtpPacketRing));
+    ring.payloadType = 96;
+    ring.timestamp = 1234;
+    ring.ssrc = 0xdeadbeef;
+    ring.pPackets = packets;
+    ring.pSlots = slots;
+    ring.slotSize = DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + TWCC_HEADER_EXTENSION_OVERHEAD + SRTP_AUTH_TAG_OVERHEAD;
+    ring.slotCount = ARRAY_SIZE(packets);
+    ring.slotTailroom = SRTP_AUTH_TAG_OVERHEAD;
+    ring.extensionProfile = RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE;
+    ring.extensionLength = SIZEOF(extension);
+    ring.extensionPayload = extension;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketsForH264(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &ring));
+    EXPECT_EQ(STATUS_SUCCESS, captureRingPackets((UINT64) &capture, ring.pPackets, ring.packetCount));
+    EXPECT_EQ(1, capture.packetCount);
+    EXPECT_EQ(MIN_HEADER_LENGTH + TWCC_HEADER_EXTENSION_OVERHEAD + SIZEOF(frame) - 4, capture.packetLengths[0]);
+
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(capture.packets[0], capture.packetLengths[0], &rtpPacket));
+    EXPECT_TRUE(rtpPacket.header.extension);
+    EXPECT_EQ(RTP_ONE_BYTE_HEADER_EXTENSION_PROFILE, rtpPacket.header.extensionProfile);
+    EXPECT_EQ(SIZEOF(extension), rtpPacket.header.extensionLength);
+    EXPECT_EQ(SIZEOF(frame) - 4, rtpPacket.payloadLength);
+    EXPECT_EQ(0, MEMCMP(frame + 4, rtpPacket.payload, rtpPacket.payloadLength));
+
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionFromBytes(capture.packets[0], capture.packetLengths[0], TWCC_DEFAULT_EXTENSION_ID, &pData, &dataLength));
+    EXPECT_EQ(SIZEOF(UINT16), dataLength);
+}
+
+struct FrameSegmentsCapture {
+    PJitterBuffer pJitterBuffer;
+    PRtcFrameSegments pFrameSegments;
+};
+
+STATUS captureFrameSegments(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+{
+    FrameSegmentsCapture* pCapture = (FrameSegmentsCapture*) customData;
+
+    EXPECT_TRUE(pCapture->pFrameSegments == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, createFrameSegments(pCapture->pJitterBuffer, startIndex, endIndex, frameSize, &pCapture->pFrameSegments));
+
+    return STATUS_SUCCESS;
+}
+
+STATUS ignoreDroppedFrame(UINT64 customData, UINT32 timestamp)
+{
+    UNUSED_PARAM(customData);
+    UNUSED_PARAM(timestamp);
+    ADD_FAILURE();
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(RtpFunctionalityTest, frameSegmentsMatchCopiedH264Frame)
+{
+    BYTE frame[4 + 10 + 4 + 4 + 4 + 3000];
+    BYTE slots[4 * (DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD)];
+    RtpPacket packets[4];
+    RtpPacketRing ring;
+    RingCapture capture;
+    FrameSegmentsCapture segmentsCapture;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    UINT32 i, offset = 0;
+
+    // SPS, PPS and a large IDR slice
+    MEMCPY(frame, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[4] = 0x67;
+    MEMSET(frame + 5, 0x11, 9);
+    MEMCPY(frame + 14, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[18] = 0x68;
+    MEMSET(frame + 19, 0x22, 3);
+    MEMCPY(frame + 22, start4ByteCode, SIZEOF(start4ByteCode));
+    frame[26] = 0x65;
+    for (i = 27; i < SIZEOF(frame); i++) {
+        frame[i] = (BYTE) (i % 251 + 1);
+    }
+
+    MEMSET(&capture, 0x00, SIZEOF(RingCapture));
+    MEMSET(&ring, 0x00, SIZEOF(RtpPacketRing));
+    ring.payloadType = 96;
+    ring.sequenceNumber = MAX_UINT16;
+    ring.timestamp = 1234;
+    ring.ssrc = 0xdeadbeef;
+    ring.pPackets = packets;
+    ring.pSlots = slots;
+    ring.slotSize = DEFAULT_MTU_SIZE + MIN_HEADER_LENGTH + SRTP_AUTH_TAG_OVERHEAD;
+    ring.slotCount = ARRAY_SIZE(packets);
+    ring.slotTailroom = SRTP_AUTH_TAG_OVERHEAD;
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketsForH264(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &ring));
+    EXPECT_EQ(STATUS_SUCCESS, captureRingPackets((UINT64) &capture, ring.pPackets, ring.packetCount));
+
+    MEMSET(&segmentsCapture, 0x00, SIZEOF(FrameSegmentsCapture));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, capture.packetCount, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createJitterBuffer(captureFrameSegments, ignoreDroppedFrame, depayH264FromRtpPayload, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                                 VIDEO_CLOCKRATE, (UINT64) &segmentsCapture, &segmentsCapture.pJitterBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferSetDepayPayloadSegmentsFunc(segmentsCapture.pJitterBuffer, depayH264SegmentsFromRtpPayload));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferSetReleaseOnMarker(segmentsCapture.pJitterBuffer, TRUE));
+
+    for (i = 0; i < capture.packetCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGet(pRtpPacketPool, &pRtpPacket));
+        MEMCPY(pRtpPacket->pRawPacket, capture.packets[i], capture.packetLengths[i]);
+        pRtpPacket->rawPacketLength = capture.packetLengths[i];
+        EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(segmentsCapture.pJitterBuffer, pRtpPacket));
+    }
+
+    // The marker packet completed the frame, the segments keep its packets alive after the jitter buffer let go of them
+    EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&segmentsCapture.pJitterBuffer));
+    ASSERT_TRUE(segmentsCapture.pFrameSegments != NULL);
+    EXPECT_EQ(capture.packetCount, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+
+    // Start codes for SPS, PPS and IDR, the payload of every packet and the IDR header rebuilt in the first fragment
+    EXPECT_EQ(SIZEOF(frame), segmentsCapture.pFrameSegments->size);
+    EXPECT_EQ(2 + 2 + 2 + 1 + 1, segmentsCapture.pFrameSegments->segmentCount);
+    for (i = 0; i < segmentsCapture.pFrameSegments->segmentCount; i++) {
+        EXPECT_GE(SIZEOF(frame), offset + segmentsCapture.pFrameSegments->pSegments[i].size);
+        EXPECT_EQ(0, MEMCMP(frame + offset, segmentsCapture.pFrameSegments->pSegments[i].pData, segmentsCapture.pFrameSegments->pSegments[i].size));
+        offset += segmentsCapture.pFrameSegments->pSegments[i].size;
+    }
+    EXPECT_EQ(SIZEOF(frame), offset);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtcFrameSegments(&segmentsCapture.pFrameSegments));
+    EXPECT_TRUE(segmentsCapture.pFrameSegments == NULL);
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+TEST_F(RtpFunctionalityTest, packetPoolReusesReleasedPackets)
+{
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpPacket pRtpPacket = NULL, pAdoptedPacket = NULL, pPackets[3];
+    BYTE rawPacket[] = {0x80, 0x60, 0x00, 0x05, 0x00, 0x00, 0x03, 0xe8, 0x12, 0x34, 0x56, 0x78, 0xAA, 0xBB};
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtpPacketPool(MIN_HEADER_LENGTH - 1, 2, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, 0, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(RTP_PACKET_POOL_BUFFER_SIZE, 2, &pRtpPacketPool));
+
+    // Received bytes are parsed in place
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGet(pRtpPacketPool, &pRtpPacket));
+    MEMCPY(pRtpPacket->pRawPacket, rawPacket, SIZEOF(rawPacket));
+    pRtpPacket->rawPacketLength = SIZEOF(rawPacket);
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
+    EXPECT_EQ(5, pRtpPacket->header.sequenceNumber);
+    EXPECT_EQ(0x12345678, pRtpPacket->header.ssrc);
+    EXPECT_EQ(pRtpPacket->pRawPacket + MIN_HEADER_LENGTH, pRtpPacket->payload);
+    EXPECT_EQ(2, pRtpPacket->payloadLength);
+
+    // A second owner keeps the packet alive after the first one lets go
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketAddReference(pRtpPacket));
+    pAdoptedPacket = pRtpPacket;
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+    EXPECT_TRUE(pRtpPacket == NULL);
+    EXPECT_EQ(1, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(0xAA, pAdoptedPacket->payload[0]);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pAdoptedPacket));
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(1, pRtpPacketPool->freePacketCount);
+
+    // Released packets are handed out again instead of allocating new ones, only capacity of them are kept
+    for (i = 0; i < ARRAY_SIZE(pPackets); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGet(pRtpPacketPool, &pPackets[i]));
+        EXPECT_EQ(0, pPackets[i]->rawPacketLength);
+    }
+    EXPECT_EQ(3, ATOMIC_LOAD(&pRtpPacketPool->allocationCount));
+    for (i = 0; i < ARRAY_SIZE(pPackets); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pPackets[i]));
+    }
+    EXPECT_EQ(2, pRtpPacketPool->freePacketCount);
+
+    for (i = 0; i < 100; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGet(pRtpPacketPool, &pRtpPacket));
+        EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+    }
+    EXPECT_EQ(3, ATOMIC_LOAD(&pRtpPacketPool->allocationCount));
+
+    // A packet larger than the pool buffers gets one of its own that is not kept once released
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetWithSize(pRtpPacketPool, RTP_PACKET_POOL_BUFFER_SIZE + 100, &pRtpPacket));
+    EXPECT_EQ(RTP_PACKET_POOL_BUFFER_SIZE + 100, pRtpPacket->rawPacketBufferSize);
+    EXPECT_EQ(4, ATOMIC_LOAD(&pRtpPacketPool->allocationCount));
+    EXPECT_EQ(2, pRtpPacketPool->freePacketCount);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+    EXPECT_EQ(0, ATOMIC_LOAD(&pRtpPacketPool->outstandingCount));
+    EXPECT_EQ(2, pRtpPacketPool->freePacketCount);
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetWithSize(pRtpPacketPool, 100, &pRtpPacket));
+    EXPECT_EQ(RTP_PACKET_POOL_BUFFER_SIZE, pRtpPacket->rawPacketBufferSize);
+    EXPECT_EQ(4, ATOMIC_LOAD(&pRtpPacketPool->allocationCount));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+
+    // Only pooled packets are reference counted
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketFromBytes(rawPacket, SIZEOF(rawPacket), &pRtpPacket));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, rtpPacketAddReference(pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+    EXPECT_TRUE(pRtpPacketPool == NULL);
+}
+
 TEST_F(RtpFunctionalityTest, invalidNaluParse)
 {
     BYTE data[] = {0x01, 0x00, 0x02};
@@ -525,6 +943,43 @@ TEST_F(RtpFunctionalityTest, validMultipleNaluParse)
     EXPECT_EQ(3, naluLength);
 }
 
+TEST_F(RtpFunctionalityTest, keyFramePayloadDetection)
+{
+    // Single NAL unit IDR slice and non-IDR slice
+    BYTE h264Idr[] = {0x65, 0x88, 0x84};
+    BYTE h264Slice[] = {0x41, 0x9a, 0x02};
+    // First and middle fragment of a fragmented IDR slice
+    BYTE h264FuStart[] = {0x7c, 0x85, 0x88};
+    BYTE h264FuMiddle[] = {0x7c, 0x05, 0x88};
+    // SPS and PPS aggregated in front of an IDR slice
+    BYTE h264StapA[] = {0x78, 0x00, 0x02, 0x67, 0x42, 0x00, 0x02, 0x68, 0xce};
+    // Payload descriptor with a 15 bit picture id followed by the payload header of a key frame and of an inter frame
+    BYTE vp8KeyFrame[] = {0x90, 0x80, 0x80, 0x01, 0x10, 0x02};
+    BYTE vp8InterFrame[] = {0x90, 0x80, 0x80, 0x01, 0x11, 0x02};
+    // Continuation of a partition has no payload header
+    BYTE vp8Continuation[] = {0x80, 0x80, 0x80, 0x01, 0x10, 0x02};
+    BOOL isKeyFrame = FALSE;
+
+    EXPECT_EQ(STATUS_NULL_ARG, isH264KeyFrameRtpPayload(h264Idr, SIZEOF(h264Idr), NULL));
+    EXPECT_EQ(STATUS_SUCCESS, isH264KeyFrameRtpPayload(h264Idr, SIZEOF(h264Idr), &isKeyFrame));
+    EXPECT_TRUE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isH264KeyFrameRtpPayload(h264Slice, SIZEOF(h264Slice), &isKeyFrame));
+    EXPECT_FALSE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isH264KeyFrameRtpPayload(h264FuStart, SIZEOF(h264FuStart), &isKeyFrame));
+    EXPECT_TRUE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isH264KeyFrameRtpPayload(h264FuMiddle, SIZEOF(h264FuMiddle), &isKeyFrame));
+    EXPECT_FALSE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isH264KeyFrameRtpPayload(h264StapA, SIZEOF(h264StapA), &isKeyFrame));
+    EXPECT_TRUE(isKeyFrame);
+
+    EXPECT_EQ(STATUS_NULL_ARG, isVP8KeyFrameRtpPayload(vp8KeyFrame, SIZEOF(vp8KeyFrame), NULL));
+    EXPECT_EQ(STATUS_SUCCESS, isVP8KeyFrameRtpPayload(vp8KeyFrame, SIZEOF(vp8KeyFrame), &isKeyFrame));
+    EXPECT_TRUE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isVP8KeyFrameRtpPayload(vp8InterFrame, SIZEOF(vp8InterFrame), &isKeyFrame));
+    EXPECT_FALSE(isKeyFrame);
+    EXPECT_EQ(STATUS_SUCCESS, isVP8KeyFrameRtpPayload(vp8Continuation, SIZEOF(vp8Continuation), &isKeyFrame));
+    EXPECT_FALSE(isKeyFrame);
+}
 
 TEST_F(RtpFunctionalityTest, trailingZerosWouldBeReturned)
 {
@@ -536,6 +991,79 @@ TEST_F(RtpFunctionalityTest, trailingZerosWouldBeReturned)
     EXPECT_EQ(7, naluLength);
 }
 
+TEST_F(RtpFunctionalityTest, startCodeScanMatchesScalarScan)
+{
+    PBYTE payload = (PBYTE) MEMALLOC(200000); // Assuming this is enough
+    BYTE data[256];
+    UINT32 payloadLen = 0, offset, length, i, j;
+
+    // Every start code position and buffer length around the vector widths, with 3 and 4 byte start codes
+    for (length = 3; length < 80; length++) {
+        for (offset = 0; offset + 3 <= length; offset++) {
+            for (i = 0; i < length; i++) {
+                data[i] = (BYTE) (i % 2 == 0 ? 0x01 : 0xff);
+            }
+            data[offset] = 0x00;
+            data[offset + 1] = 0x00;
+            data[offset + 2] = 0x01;
+            EXPECT_EQ(findStartCodeScalar(data, length), findStartCode(data, length));
+            data[offset] = 0xff;
+            EXPECT_EQ(findStartCodeScalar(data, length), findStartCode(data, length));
+        }
+    }
+
+    for (i = 0; i < 100; i++) {
+        for (j = 0; j < SIZEOF(data); j++) {
+            data[j] = (BYTE) (RAND() % 4 == 0 ? 0 : RAND() % 3);
+        }
+        EXPECT_EQ(findStartCodeScalar(data, SIZEOF(data)), findStartCode(data, SIZEOF(data)));
+    }
+
+    for (i = 1; i <= NUMBER_OF_FRAME_FILES; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, readFrameData(payload, &payloadLen, i, (PCHAR) "../samples/h264SampleFrames"));
+        for (offset = 0; offset < payloadLen; offset += length + 1) {
+            length = findStartCode(payload + offset, payloadLen - offset);
+            EXPECT_EQ(findStartCodeScalar(payload + offset, payloadLen - offset), length);
+        }
+    }
+
+    MEMFREE(payload);
+}
+
+TEST_F(RtpFunctionalityTest, startCodeScanMatchesScalarScanOnMisalignedBuffers)
+{
+    UINT32 bufferLength = 4096, length, alignment, position, i, j;
+    PBYTE buffer = (PBYTE) MEMALLOC(bufferLength + 64), pData;
+
+    // Vector loads start at every alignment, over random bytes that either hold no zero or are dense with zeros and ones
+    for (i = 0; i < 200; i++) {
+        alignment = i % 64;
+        pData = buffer + alignment;
+        length = RAND() % bufferLength + 1;
+        for (j = 0; j < length; j++) {
+            pData[j] = (BYTE) (i % 2 == 0 ? RAND() % 255 + 1 : RAND() % 3);
+        }
+
+        EXPECT_EQ(findStartCodeScalar(pData, length), findStartCode(pData, length));
+
+        // A single start code anywhere, including one ending on the last byte
+        if (length >= 3) {
+            position = RAND() % (length - 2);
+            pData[position] = 0x00;
+            pData[position + 1] = 0x00;
+            pData[position + 2] = 0x01;
+            EXPECT_EQ(findStartCodeScalar(pData, length), findStartCode(pData, length));
+            EXPECT_GE(position, findStartCode(pData, length));
+
+            // Trailing zeros do not make a start code
+            pData[position + 2] = 0x00;
+            EXPECT_EQ(findStartCodeScalar(pData, length), findStartCode(pData, length));
+        }
+    }
+
+    MEMFREE(buffer);
+}
+
 }
 }
 }
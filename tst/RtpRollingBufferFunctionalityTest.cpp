@@ -67,6 +67,87 @@ TEST_F(RtpRollingBufferFunctionalityTest, appendDataToBufferAndVerify)
     EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
 }
 
+TEST_F(RtpRollingBufferFunctionalityTest, evictedPacketsAreRecycled)
+{
+    PRtpRollingBuffer pRtpRollingBuffer;
+    PRtpPacket pRtpPacket = NULL, pBufferedPacket = NULL;
+    UINT64 item = 0;
+
+    // add 0 - 99 with capacity 5, only the first 5 packets should allocate
+    pushConsecutiveRtpPacketsIntoBuffer(100, 5, &pRtpRollingBuffer, &pRtpPacket);
+    EXPECT_EQ(5, pRtpRollingBuffer->allocationCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, rollingBufferExtractData(pRtpRollingBuffer->pRollingBuffer, 99, &item));
+    pBufferedPacket = (PRtpPacket) item;
+    ASSERT_TRUE(pBufferedPacket != NULL);
+    EXPECT_EQ(pRtpPacket->rawPacketLength, pBufferedPacket->rawPacketLength);
+    EXPECT_EQ(0, MEMCMP(pRtpPacket->pRawPacket, pBufferedPacket->pRawPacket, pRtpPacket->rawPacketLength));
+    EXPECT_EQ(pRtpPacket->payloadLength, pBufferedPacket->payloadLength);
+    EXPECT_EQ(STATUS_SUCCESS, rollingBufferInsertData(pRtpRollingBuffer->pRollingBuffer, 99, item));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpRollingBuffer(&pRtpRollingBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+}
+
+TEST_F(RtpRollingBufferFunctionalityTest, packetsAddedWhileRetransmitterBorrowsThem)
+{
+    PRtpRollingBuffer pRtpRollingBuffer;
+    PRtpPacket pRtpPacket = NULL, pBorrowedPacket = NULL;
+    volatile ATOMIC_BOOL done = FALSE;
+    UINT16 sequenceNumbers[2];
+    UINT64 validIndexList[2], item = 0, lastIndex;
+    UINT32 validIndexListLen, size = 0, i;
+    STATUS retStatus;
+
+    pushConsecutiveRtpPacketsIntoBuffer(5, 5, &pRtpRollingBuffer, &pRtpPacket);
+
+    // Sender keeps adding, recycling the tail of the full buffer
+    std::thread sender([&]() {
+        for (UINT32 j = 5; j < 20000; j++) {
+            updateRtpPacketSeqNum(pRtpPacket, GET_UINT16_SEQ_NUM(j));
+            EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket));
+        }
+        ATOMIC_STORE_BOOL(&done, TRUE);
+    });
+
+    // Same as resendPacketOnNack, borrowing the oldest and newest packets and putting them back
+    while (!ATOMIC_LOAD_BOOL(&done)) {
+        MUTEX_LOCK(pRtpRollingBuffer->pRollingBuffer->lock);
+        lastIndex = pRtpRollingBuffer->lastIndex;
+        MUTEX_UNLOCK(pRtpRollingBuffer->pRollingBuffer->lock);
+        sequenceNumbers[0] = GET_UINT16_SEQ_NUM(lastIndex - 4);
+        sequenceNumbers[1] = GET_UINT16_SEQ_NUM(lastIndex);
+        validIndexListLen = ARRAY_SIZE(validIndexList);
+        EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferGetValidSeqIndexList(pRtpRollingBuffer, sequenceNumbers, 2, validIndexList, &validIndexListLen));
+        for (UINT32 j = 0; j < validIndexListLen; j++) {
+            EXPECT_EQ(STATUS_SUCCESS, rollingBufferExtractData(pRtpRollingBuffer->pRollingBuffer, validIndexList[j], &item));
+            pBorrowedPacket = (PRtpPacket) item;
+            if (pBorrowedPacket != NULL) {
+                retStatus = rollingBufferInsertData(pRtpRollingBuffer->pRollingBuffer, validIndexList[j], item);
+                EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE);
+                if (retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE) {
+                    freeRtpPacket(&pBorrowedPacket);
+                }
+            }
+        }
+    }
+
+    sender.join();
+
+    // Every packet put back ended up either in the buffer or freed, and the buffer stayed full
+    EXPECT_EQ(STATUS_SUCCESS, rollingBufferGetSize(pRtpRollingBuffer->pRollingBuffer, &size));
+    EXPECT_EQ(5, size);
+    EXPECT_EQ(19999, pRtpRollingBuffer->lastIndex);
+    for (i = 0; i < size; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, rollingBufferExtractData(pRtpRollingBuffer->pRollingBuffer, pRtpRollingBuffer->lastIndex - i, &item));
+        EXPECT_NE((UINT64) NULL, item);
+        EXPECT_EQ(STATUS_SUCCESS, rollingBufferInsertData(pRtpRollingBuffer->pRollingBuffer, pRtpRollingBuffer->lastIndex - i, item));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpRollingBuffer(&pRtpRollingBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketAndRawPacket(&pRtpPacket));
+}
+
 TEST_F(RtpRollingBufferFunctionalityTest, getIndexForSeqListReturnEmptyList)
 {
     PRtpRollingBuffer pRtpRollingBuffer;
@@ -596,6 +596,82 @@ a=fmtp:102 strange
     freePeerConnection(&pRtcPeerConnection);
 }
 
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestTransportWideCongestionControl) {
+    auto remoteSessionDescription = std::string(R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS
+m=video 16485 UDP/TLS/RTP/SAVPF 96 102
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtcp-rsize
+)");
+
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    RtcConfiguration rtcConfiguration;
+    RtcMediaStreamTrack rtcMediaStreamTrack;
+    RtcRtpTransceiverInit rtcRtpTransceiverInit;
+    RtcSessionDescriptionInit rtcSessionDescriptionInit;
+
+    remoteSessionDescription += "a=extmap:3 ";
+    remoteSessionDescription += TWCC_EXT_URL;
+    remoteSessionDescription += "\na=rtpmap:102 H264/90000\n";
+
+    MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+    MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+    MEMSET(&rtcRtpTransceiverInit, 0x00, SIZEOF(RtcRtpTransceiverInit));
+
+    EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+    EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE), STATUS_SUCCESS);
+
+    rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY;
+    rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    rtcMediaStreamTrack.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+    STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+    STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+    EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+    // The answer uses the id the offer picked
+    STRCPY(rtcSessionDescriptionInit.sdp, remoteSessionDescription.c_str());
+    rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+    EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+    EXPECT_TRUE(((PKvsPeerConnection) pRtcPeerConnection)->pTwccManager != NULL);
+    EXPECT_EQ(3, ((PKvsPeerConnection) pRtcPeerConnection)->twccExtensionId);
+    EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, (std::string("extmap:3 ") + TWCC_EXT_URL).c_str(), rtcSessionDescriptionInit.sdp);
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtcp-fb:102 transport-cc", rtcSessionDescriptionInit.sdp);
+    closePeerConnection(pRtcPeerConnection);
+    freePeerConnection(&pRtcPeerConnection);
+
+    // Without the extension in the offer there is none in the answer
+    EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+    EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE), STATUS_SUCCESS);
+    EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+    remoteSessionDescription.replace(remoteSessionDescription.find("a=extmap:3 "), STRLEN("a=extmap:3 ") + STRLEN(TWCC_EXT_URL) + 1, "");
+    STRCPY(rtcSessionDescriptionInit.sdp, remoteSessionDescription.c_str());
+    rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+    EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+    EXPECT_TRUE(((PKvsPeerConnection) pRtcPeerConnection)->pTwccManager == NULL);
+    EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+    EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "transport-cc", rtcSessionDescriptionInit.sdp);
+    closePeerConnection(pRtcPeerConnection);
+    freePeerConnection(&pRtcPeerConnection);
+}
+
 }
 }
 }
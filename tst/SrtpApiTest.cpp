@@ -81,6 +81,49 @@ TEST_F(SrtpApiTest, noSrtpKeyReturnsFailure)
     EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
 }
 
+struct SrtpTestProfile {
+    SRTP_PROFILE profile;
+    INT32 authTagSize;
+    PCHAR name;
+};
+
+SrtpTestProfile SRTP_TEST_PROFILES[] = {
+    {SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, 10, (PCHAR) "AES128_CM_HMAC_SHA1_80"},
+    {SRTP_PROFILE_AES128_CM_HMAC_SHA1_32, 4, (PCHAR) "AES128_CM_HMAC_SHA1_32"},
+    {SRTP_PROFILE_AEAD_AES_128_GCM, 16, (PCHAR) "AEAD_AES_128_GCM"},
+    {SRTP_PROFILE_AEAD_AES_256_GCM, 16, (PCHAR) "AEAD_AES_256_GCM"},
+};
+
+// Master key followed by the master salt, profiles with a shorter key or salt use the beginning
+BYTE SRTP_TEST_KEY[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D};
+
+TEST_F(SrtpApiTest, encryptDecryptRtpPacketWithEachProfile)
+{
+    PSrtpSession pSrtpSession = NULL;
+    BYTE rtpPacket[SIZEOF(SKEL_RTP_PACKET) + SRTP_MAX_TRAILER_LEN];
+    INT32 len;
+
+    for (auto& testProfile : SRTP_TEST_PROFILES) {
+        EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(SRTP_TEST_KEY, SRTP_TEST_KEY, testProfile.profile, &pSrtpSession));
+
+        MEMCPY(rtpPacket, SKEL_RTP_PACKET, SIZEOF(SKEL_RTP_PACKET));
+        len = SIZEOF(SKEL_RTP_PACKET);
+
+        EXPECT_EQ(STATUS_SUCCESS, encryptRtpPacket(pSrtpSession, rtpPacket, &len));
+        EXPECT_EQ(len, SIZEOF(SKEL_RTP_PACKET) + testProfile.authTagSize) << testProfile.name;
+        EXPECT_LE(testProfile.authTagSize, SRTP_AUTH_TAG_OVERHEAD);
+
+        EXPECT_EQ(STATUS_SUCCESS, decryptSrtpPacket(pSrtpSession, rtpPacket, &len));
+        EXPECT_EQ(len, SIZEOF(SKEL_RTP_PACKET));
+        EXPECT_EQ(0, MEMCMP(rtpPacket, SKEL_RTP_PACKET, SIZEOF(SKEL_RTP_PACKET))) << testProfile.name;
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
+    }
+}
+
 }
 }
 }
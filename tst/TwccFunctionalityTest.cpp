@@ -0,0 +1,342 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video { namespace webrtcclient {
+
+class TwccFunctionalityTest : public WebRtcClientTestBase {
+};
+
+#define TWCC_TEST_PACKET_INTERVAL (10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define TWCC_TEST_PROPAGATION_DELAY (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+typedef struct {
+    PTwccManager pSender;
+    PTwccManager pReceiver;
+    UINT64 currentTime;
+    UINT64 queuingDelay;
+    UINT64 targetBitrate;
+    UINT32 feedbackCount;
+} TwccSimulation, *PTwccSimulation;
+
+VOID processTwccFeedback(PTwccSimulation pSimulation, PBYTE pFeedback, UINT32 feedbackLen, UINT64 currentTime)
+{
+    UINT64 targetBitrate;
+    RtcpPacket rtcpPacket;
+
+    if (feedbackLen == 0) {
+        return;
+    }
+
+    pSimulation->feedbackCount++;
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(pFeedback, feedbackLen, &rtcpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnFeedback(pSimulation->pSender, rtcpPacket.payload, rtcpPacket.payloadLength, currentTime, &targetBitrate));
+    if (targetBitrate != 0) {
+        pSimulation->targetBitrate = targetBitrate;
+    }
+}
+
+// Sends a packet every TWCC_TEST_PACKET_INTERVAL over a path whose queuing delay grows by extraDelay for every packet,
+// dropping every lossInterval-th packet, and feeds the feedbacks back to the sender
+VOID simulateTwccPackets(PTwccSimulation pSimulation, UINT32 packetCount, UINT32 packetSize, UINT64 extraDelay, UINT32 lossInterval)
+{
+    BYTE feedback[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 feedbackLen, i;
+    UINT16 sequenceNumber;
+    UINT64 arrivalTime;
+
+    for (i = 0; i < packetCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketSent(pSimulation->pSender, packetSize, pSimulation->currentTime, &sequenceNumber));
+        pSimulation->queuingDelay += extraDelay;
+        arrivalTime = pSimulation->currentTime + TWCC_TEST_PROPAGATION_DELAY + pSimulation->queuingDelay;
+        pSimulation->currentTime += TWCC_TEST_PACKET_INTERVAL;
+
+        // The feedback timer fires as packets arrive
+        feedbackLen = SIZEOF(feedback);
+        EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pSimulation->pReceiver, arrivalTime, feedback, &feedbackLen));
+        processTwccFeedback(pSimulation, feedback, feedbackLen, arrivalTime);
+
+        if (lossInterval != 0 && i % lossInterval == 0) {
+            continue;
+        }
+
+        feedbackLen = SIZEOF(feedback);
+        EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pSimulation->pReceiver, sequenceNumber, arrivalTime, 1, 2, feedback, &feedbackLen));
+        processTwccFeedback(pSimulation, feedback, feedbackLen, arrivalTime);
+    }
+}
+
+VOID createTwccSimulation(PTwccSimulation pSimulation)
+{
+    MEMSET(pSimulation, 0x00, SIZEOF(TwccSimulation));
+    pSimulation->currentTime = HUNDREDS_OF_NANOS_IN_A_SECOND;
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pSimulation->pSender));
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pSimulation->pReceiver));
+}
+
+VOID freeTwccSimulation(PTwccSimulation pSimulation)
+{
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pSimulation->pSender));
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pSimulation->pReceiver));
+    EXPECT_TRUE(pSimulation->pSender == NULL);
+}
+
+TEST_F(TwccFunctionalityTest, sequenceNumbersWrap)
+{
+    PTwccManager pTwccManager = NULL;
+    UINT16 sequenceNumber;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createTwccManager(NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pTwccManager));
+    EXPECT_EQ(STATUS_NULL_ARG, twccManagerOnPacketSent(pTwccManager, 100, 1, NULL));
+
+    for (i = 0; i <= MAX_UINT16 + 1; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketSent(pTwccManager, 100, i + 1, &sequenceNumber));
+        EXPECT_EQ((UINT16) i, sequenceNumber);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pTwccManager));
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pTwccManager));
+}
+
+TEST_F(TwccFunctionalityTest, receiverReportsReceivedAndLostPackets)
+{
+    PTwccManager pTwccManager = NULL;
+    BYTE feedback[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 feedbackLen, packetCount;
+    INT64 arrivalTimes[TWCC_FEEDBACK_MAX_PACKET_COUNT];
+    UINT16 baseSequenceNumber;
+    UINT8 feedbackCount;
+    UINT64 startTime = 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    RtcpPacket rtcpPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pTwccManager));
+
+    // 12 is lost
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 10, startTime, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 11, startTime + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 13, startTime + 3 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    // Receiving packets never sends a feedback that fits more of them
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 14, startTime + TWCC_FEEDBACK_INTERVAL, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(feedback, feedbackLen, &rtcpPacket));
+    EXPECT_EQ(1, getUnalignedInt32BigEndian(rtcpPacket.payload));
+    EXPECT_EQ(2, getUnalignedInt32BigEndian(rtcpPacket.payload + SIZEOF(UINT32)));
+    packetCount = ARRAY_SIZE(arrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, arrivalTimes, &packetCount));
+    EXPECT_EQ(10, baseSequenceNumber);
+    EXPECT_EQ(0, feedbackCount);
+    EXPECT_EQ(5, packetCount);
+    EXPECT_EQ(startTime, arrivalTimes[0]);
+    EXPECT_EQ(startTime + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, arrivalTimes[1]);
+    EXPECT_EQ(RTCP_TWCC_PACKET_NOT_RECEIVED, arrivalTimes[2]);
+    EXPECT_EQ(startTime + 3 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, arrivalTimes[3]);
+    EXPECT_EQ(startTime + TWCC_FEEDBACK_INTERVAL, arrivalTimes[4]);
+
+    // The late 12 was reported lost already, it does not start a feedback of its own
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 12, startTime + TWCC_FEEDBACK_INTERVAL, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + 3 * TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    // A packet too far ahead to share a feedback with 15 sends it right away
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 15, startTime + TWCC_FEEDBACK_INTERVAL + 1, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 15 + TWCC_FEEDBACK_MAX_PACKET_COUNT, startTime + TWCC_FEEDBACK_INTERVAL + 2,
+                                                          1, 2, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(feedback, feedbackLen, &rtcpPacket));
+    packetCount = ARRAY_SIZE(arrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, arrivalTimes, &packetCount));
+    EXPECT_EQ(15, baseSequenceNumber);
+    EXPECT_EQ(1, feedbackCount);
+    EXPECT_EQ(1, packetCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pTwccManager));
+}
+
+TEST_F(TwccFunctionalityTest, lateOldPacketDoesNotShiftNextFeedback)
+{
+    PTwccManager pTwccManager = NULL;
+    BYTE feedback[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 feedbackLen, packetCount;
+    INT64 arrivalTimes[TWCC_FEEDBACK_MAX_PACKET_COUNT];
+    UINT16 baseSequenceNumber;
+    UINT8 feedbackCount;
+    UINT64 startTime = 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    RtcpPacket rtcpPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pTwccManager));
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 10, startTime, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 11, startTime + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+
+    // The late 5 is dropped, leaving no feedback pending
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 5, startTime + TWCC_FEEDBACK_INTERVAL, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    // 13 is recorded at its own offset from 12, which is reported lost
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 13, startTime + TWCC_FEEDBACK_INTERVAL + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + 2 * TWCC_FEEDBACK_INTERVAL + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(feedback, feedbackLen, &rtcpPacket));
+    packetCount = ARRAY_SIZE(arrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, arrivalTimes, &packetCount));
+    EXPECT_EQ(12, baseSequenceNumber);
+    EXPECT_EQ(1, feedbackCount);
+    EXPECT_EQ(2, packetCount);
+    EXPECT_EQ(RTCP_TWCC_PACKET_NOT_RECEIVED, arrivalTimes[0]);
+    EXPECT_EQ(startTime + TWCC_FEEDBACK_INTERVAL + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, arrivalTimes[1]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pTwccManager));
+}
+
+TEST_F(TwccFunctionalityTest, pendingFeedbackIsFlushedOnceDue)
+{
+    PTwccManager pTwccManager = NULL;
+    BYTE feedback[TWCC_FEEDBACK_MAX_PACKET_LEN];
+    UINT32 feedbackLen, packetCount;
+    INT64 arrivalTimes[TWCC_FEEDBACK_MAX_PACKET_COUNT];
+    UINT16 baseSequenceNumber;
+    UINT8 feedbackCount;
+    UINT64 startTime = 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    RtcpPacket rtcpPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, createTwccManager(&pTwccManager));
+
+    // Nothing received yet
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 10, startTime, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 11, startTime + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + TWCC_FEEDBACK_INTERVAL - 1, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    // No packet comes in after 11, the feedback goes out anyway
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(feedback, feedbackLen, &rtcpPacket));
+    EXPECT_EQ(1, getUnalignedInt32BigEndian(rtcpPacket.payload));
+    EXPECT_EQ(2, getUnalignedInt32BigEndian(rtcpPacket.payload + SIZEOF(UINT32)));
+    packetCount = ARRAY_SIZE(arrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, arrivalTimes, &packetCount));
+    EXPECT_EQ(10, baseSequenceNumber);
+    EXPECT_EQ(0, feedbackCount);
+    EXPECT_EQ(2, packetCount);
+    EXPECT_EQ(startTime + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, arrivalTimes[1]);
+
+    // Only once
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + 2 * TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+
+    // The next packet starts the next feedback right after the flushed one
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerOnPacketReceived(pTwccManager, 12, startTime + 2 * TWCC_FEEDBACK_INTERVAL, 1, 2, feedback, &feedbackLen));
+    EXPECT_EQ(0, feedbackLen);
+    feedbackLen = SIZEOF(feedback);
+    EXPECT_EQ(STATUS_SUCCESS, twccManagerFlushFeedback(pTwccManager, startTime + 3 * TWCC_FEEDBACK_INTERVAL, feedback, &feedbackLen));
+    EXPECT_LT(0, feedbackLen);
+    EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(feedback, feedbackLen, &rtcpPacket));
+    packetCount = ARRAY_SIZE(arrivalTimes);
+    EXPECT_EQ(STATUS_SUCCESS, rtcpTwccFeedbackGet(rtcpPacket.payload, rtcpPacket.payloadLength, &baseSequenceNumber, &feedbackCount, arrivalTimes, &packetCount));
+    EXPECT_EQ(12, baseSequenceNumber);
+    EXPECT_EQ(1, feedbackCount);
+    EXPECT_EQ(1, packetCount);
+
+    EXPECT_EQ(STATUS_NULL_ARG, twccManagerFlushFeedback(NULL, startTime, feedback, &feedbackLen));
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccManager(&pTwccManager));
+}
+
+TEST_F(TwccFunctionalityTest, estimateGrowsWhileDelayIsStable)
+{
+    TwccSimulation simulation;
+
+    createTwccSimulation(&simulation);
+
+    // 300 bytes every 10 ms is 240 kbps, the estimate grows towards the headroom over it
+    simulateTwccPackets(&simulation, 1000, 300, 0, 0);
+    EXPECT_LT(90, simulation.feedbackCount);
+    EXPECT_LT(TWCC_INITIAL_BITRATE, simulation.targetBitrate);
+    EXPECT_GE((UINT64) (TWCC_ACKED_BITRATE_HEADROOM_FACTOR * 250000) + TWCC_ACKED_BITRATE_HEADROOM, simulation.targetBitrate);
+
+    freeTwccSimulation(&simulation);
+}
+
+TEST_F(TwccFunctionalityTest, estimateDropsWhenDelayGrows)
+{
+    TwccSimulation simulation;
+    UINT64 stableBitrate;
+
+    createTwccSimulation(&simulation);
+
+    simulateTwccPackets(&simulation, 500, 300, 0, 0);
+    stableBitrate = simulation.targetBitrate;
+    EXPECT_LT(TWCC_INITIAL_BITRATE, stableBitrate);
+
+    // The queue grows by 1 ms every 10 ms, the path carries less than what is sent
+    simulateTwccPackets(&simulation, 200, 300, HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 0);
+    EXPECT_GT(240000, simulation.targetBitrate);
+    EXPECT_LE(TWCC_MIN_BITRATE, simulation.targetBitrate);
+
+    freeTwccSimulation(&simulation);
+}
+
+TEST_F(TwccFunctionalityTest, estimateDropsOnLoss)
+{
+    TwccSimulation simulation;
+
+    createTwccSimulation(&simulation);
+
+    // Every fifth packet is lost while the delay stays the same
+    simulateTwccPackets(&simulation, 500, 300, 0, 5);
+    EXPECT_GT(TWCC_INITIAL_BITRATE / 2, simulation.targetBitrate);
+    EXPECT_LE(TWCC_MIN_BITRATE, simulation.targetBitrate);
+
+    freeTwccSimulation(&simulation);
+}
+
+}
+}
+}
+}
+}